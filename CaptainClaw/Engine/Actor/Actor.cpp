@@ -11,6 +11,8 @@ Actor::Actor(uint32 actorGUID)
     _GUID = actorGUID;
     _name = "Unknown";
     _resource = "Unknown";
+
+    _componentSlots.resize(GetComponentSlotsCount(), NULL);
 }
 
 Actor::~Actor()
@@ -58,14 +60,30 @@ void Actor::PostPostInit()
 void Actor::Destroy()
 {
     //LOG("Destroying actor: " + _name);
+    std::fill(_componentSlots.begin(), _componentSlots.end(), (ActorComponent*)NULL);
+    _updatedComponents.clear();
     _components.clear();
 }
 
 void Actor::Update(uint32 msDiff)
 {
-    for (auto component : _components)
+    UpdateComponents(msDiff, 0, UINT32_MAX);
+}
+
+void Actor::GetUpdatedComponentRange(uint64 fromComponentId, uint64 toComponentId, uint32& outFirst, uint32& outEnd) const
+{
+    auto compareId = [](const std::pair<uint32, ActorComponent*>& component, uint64 componentId) { return component.first < componentId; };
+
+    outFirst = std::lower_bound(_updatedComponents.begin(), _updatedComponents.end(), fromComponentId, compareId) - _updatedComponents.begin();
+    outEnd = std::lower_bound(_updatedComponents.begin() + outFirst, _updatedComponents.end(), toComponentId, compareId) - _updatedComponents.begin();
+}
+
+void Actor::UpdateComponents(uint32 msDiff, uint32 first, uint32 end)
+{
+    // Components can be added while updating and actor can be destroyed by its own component
+    for (uint32 i = first; i < end && i < _updatedComponents.size(); i++)
     {
-        component.second->VUpdate(msDiff);
+        _updatedComponents[i].second->VUpdate(msDiff);
     }
 }
 
@@ -82,4 +100,45 @@ void Actor::AddComponent(StrongActorComponentPtr component)
         _components.insert(std::make_pair(component->VGetId(), component));
 
     assert(success.second);
+
+    uint32 slot = GetComponentSlot(component->VGetId());
+    if (slot >= _componentSlots.size())
+    {
+        _componentSlots.resize(slot + 1, NULL);
+    }
+    _componentSlots[slot] = component.get();
+
+    if (!component->VIsUpdatedBySystem())
+    {
+        uint32 componentId = component->VGetId();
+        auto insertIter = std::upper_bound(_updatedComponents.begin(), _updatedComponents.end(), componentId,
+            [](uint32 id, const std::pair<uint32, ActorComponent*>& other) { return id < other.first; });
+        _updatedComponents.insert(insertIter, std::make_pair(componentId, component.get()));
+    }
+}
+
+static std::map<uint32, uint32>& GetComponentSlotMap()
+{
+    static std::map<uint32, uint32> s_ComponentSlotMap;
+    return s_ComponentSlotMap;
+}
+
+uint32 Actor::GetComponentSlot(uint32 componentId)
+{
+    std::map<uint32, uint32>& componentSlotMap = GetComponentSlotMap();
+    auto findIt = componentSlotMap.find(componentId);
+    if (findIt != componentSlotMap.end())
+    {
+        return findIt->second;
+    }
+
+    uint32 slot = componentSlotMap.size();
+    componentSlotMap.insert(std::make_pair(componentId, slot));
+
+    return slot;
+}
+
+uint32 Actor::GetComponentSlotsCount()
+{
+    return GetComponentSlotMap().size();
 }
\ No newline at end of file
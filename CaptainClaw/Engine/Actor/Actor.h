@@ -5,6 +5,7 @@
 #include <stdint.h>
 #include <memory>
 #include <map>
+#include <vector>
 
 #include "../SharedDefines.h"
 
@@ -25,6 +26,10 @@ public:
     void PostPostInit();
     void Destroy();
     void Update(uint32_t msDiff);
+    // Finds updated components with ids in range [fromComponentId, toComponentId), returned as
+    // index range [outFirst, outEnd) for UpdateComponents()
+    void GetUpdatedComponentRange(uint64 fromComponentId, uint64 toComponentId, uint32& outFirst, uint32& outEnd) const;
+    void UpdateComponents(uint32_t msDiff, uint32 first, uint32 end);
 
     std::string ToXML();
 
@@ -69,7 +74,7 @@ public:
     template <class ComponentType>
     weak_ptr<ComponentType> GetComponent()
     {
-        uint32 id = ActorComponent::GetIdFromName(ComponentType::g_Name);
+        static const uint32 id = ActorComponent::GetIdFromName(ComponentType::g_Name);
         ActorComponentsMap::iterator findIter = _components.find(id);
         if (findIter != _components.end())
         {
@@ -84,6 +89,28 @@ public:
         }
     }
 
+    // Retrieves component by its type or NULL if component not found. This is just an indexed
+    // load - no name hashing, no map lookup and no reference counting. Returned pointer is valid
+    // as long as the actor is not destroyed. Works only for components whose registered name
+    // is ComponentType::g_Name
+    template <class ComponentType>
+    inline ComponentType* GetRawComponent() const
+    {
+        const uint32 slot = GetComponentSlot<ComponentType>();
+        return slot < _componentSlots.size() ? static_cast<ComponentType*>(_componentSlots[slot]) : NULL;
+    }
+
+    // Component slots are small sequential indices. ActorFactory assigns them to all of its registered
+    // component types up front, any other type gets its slot on first use
+    template <class ComponentType>
+    static uint32 GetComponentSlot()
+    {
+        static const uint32 slot = GetComponentSlot(ActorComponent::GetIdFromName(ComponentType::g_Name));
+        return slot;
+    }
+    static uint32 GetComponentSlot(uint32 componentId);
+    static uint32 GetComponentSlotsCount();
+
     const ActorComponentsMap* GetComponents() { return &_components; }
 
     void AddComponent(StrongActorComponentPtr pComponent);
@@ -103,6 +130,14 @@ private:
 
     ActorComponentsMap _components;
 
+    // Non-owning, components are owned by _components. Sized to the number of slots known when
+    // the actor is created, grows if a component with a newer slot is added
+    std::vector<ActorComponent*> _componentSlots;
+
+    // Components which are not updated by any ComponentSystem, non-owning.
+    // Sorted by component id, which is the order they were updated in when stored in _components
+    std::vector<std::pair<uint32, ActorComponent*>> _updatedComponents;
+
     // Resource from which this actor was loaded
     std::string _resource;
 
@@ -12,11 +12,15 @@
 #include "../SharedDefines.h"
 #include "ActorFactory.h"
 
+template <class ComponentType> class ComponentSystem;
+
 class ActorComponent
 {
     friend class ActorFactory;
+    template <class ComponentType> friend class ComponentSystem;
 
 public:
+    ActorComponent() : _systemIndex(-1) { }
     virtual ~ActorComponent() { _owner.reset(); }
 
     // These functions are meant to be overriden by the implementation classes of the components
@@ -26,6 +30,14 @@ public:
     virtual void VUpdate(uint32 msDiff) { }
     virtual void VOnChanged() { }
 
+    // Used by compiled actor prototypes. Component initialized once from prototype's xml is copied
+    // into every spawned actor. Only components registered as cloneable in ActorFactory have to
+    // implement this and they must not depend on their owner before VPostInit
+    virtual ActorComponent* VClone() const { return NULL; }
+
+    // Components which are updated in batch by ComponentSystem are skipped by Actor::Update
+    virtual bool VIsUpdatedBySystem() const { return false; }
+
     // For potential editor
     virtual TiXmlElement* VGenerateXml() = 0;
 
@@ -43,6 +55,9 @@ protected:
 
 private:
     void SetOwner(StrongActorPtr owner) { _owner = owner; }
+
+    // Position in ComponentSystem's array, -1 if not updated by any system
+    int32 _systemIndex;
 };
 
 #endif
\ No newline at end of file
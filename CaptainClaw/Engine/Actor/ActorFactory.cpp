@@ -113,6 +113,24 @@ ActorFactory::ActorFactory()
     _componentFactory.Register<SteppingGroundComponent>(SteppingGroundComponent::GetIdFromName(SteppingGroundComponent::g_Name));
     _componentFactory.Register<SpringBoardComponent>(SpringBoardComponent::GetIdFromName(SpringBoardComponent::g_Name));
     _componentFactory.Register<KatherineBossAIStateComponent>(KatherineBossAIStateComponent::GetIdFromName(KatherineBossAIStateComponent::g_Name));
+
+    // Actors get slot table large enough for every registered component type right away
+    for (uint32 componentId : _componentFactory.GetRegisteredIds())
+    {
+        Actor::GetComponentSlot(componentId);
+    }
+
+    // Components which implement VClone() and can be copied from compiled prototypes
+    _cloneableComponentIds.insert(ActorComponent::GetIdFromName(PositionComponent::g_Name));
+    _cloneableComponentIds.insert(ActorComponent::GetIdFromName(PhysicsComponent::g_Name));
+    _cloneableComponentIds.insert(ActorComponent::GetIdFromName(ActorRenderComponent::g_Name));
+    _cloneableComponentIds.insert(ActorComponent::GetIdFromName(ProjectileAIComponent::g_Name));
+}
+
+CompiledActorPrototype::~CompiledActorPrototype()
+{
+    components.clear();
+    SAFE_DELETE(pActorElem);
 }
 
 StrongActorPtr ActorFactory::CreateActor(TiXmlElement* pActorRoot, TiXmlElement* overrides)
@@ -170,6 +188,95 @@ StrongActorPtr ActorFactory::CreateActor(const char* actorResource, TiXmlElement
     return CreateActor(root, overrides);
 }
 
+StrongActorPtr ActorFactory::CreateActor(ActorPrototype proto, const ActorInstanceOverrides& overrides)
+{
+    shared_ptr<CompiledActorPrototype> pCompiledProto = GetCompiledPrototype(proto);
+    if (!pCompiledProto)
+    {
+        LOG_ERROR("Could not compile actor prototype: " + EnumToString_ActorPrototype(proto));
+        return nullptr;
+    }
+
+    return CreateActor(pCompiledProto, overrides);
+}
+
+StrongActorPtr ActorFactory::CreateActor(const std::string& templateKey, const ActorXmlCreator& createActorXml, const ActorInstanceOverrides& overrides)
+{
+    shared_ptr<CompiledActorPrototype> pCompiledProto;
+
+    auto findIt = _compiledTemplateMap.find(templateKey);
+    if (findIt != _compiledTemplateMap.end())
+    {
+        pCompiledProto = findIt->second;
+    }
+    else
+    {
+        TiXmlElement* pActorElem = createActorXml();
+        if (pActorElem == NULL)
+        {
+            LOG_ERROR("Could not create xml of actor template: " + templateKey);
+            return nullptr;
+        }
+
+        pCompiledProto = CompileActorPrototype(pActorElem);
+        if (!pCompiledProto)
+        {
+            LOG_ERROR("Could not compile actor template: " + templateKey);
+            return nullptr;
+        }
+
+        _compiledTemplateMap.insert(std::make_pair(templateKey, pCompiledProto));
+    }
+
+    return CreateActor(pCompiledProto, overrides);
+}
+
+StrongActorPtr ActorFactory::CreateActor(shared_ptr<CompiledActorPrototype> pCompiledProto, const ActorInstanceOverrides& overrides)
+{
+    uint32 nextActorGUID = GetNextActorGUID();
+    StrongActorPtr actor(new Actor(nextActorGUID));
+    if (!actor->Init(pCompiledProto->pActorElem))
+    {
+        LOG_ERROR("Failed to initialize actor.");
+        return NULL;
+    }
+
+    for (const CompiledComponentDef& componentDef : pCompiledProto->components)
+    {
+        StrongActorComponentPtr component;
+        if (componentDef.pTemplate)
+        {
+            component.reset(componentDef.pTemplate->VClone());
+        }
+        else
+        {
+            component = VCreateComponent(componentDef.pXmlData);
+        }
+
+        if (component)
+        {
+            actor->AddComponent(component);
+            component->SetOwner(actor);
+        }
+        else
+        {
+            LOG_ERROR("Failed to create component from node: " + std::string(componentDef.pXmlData->Value()));
+            actor->Destroy();
+            return nullptr;
+        }
+    }
+
+    if (overrides)
+    {
+        overrides(actor);
+    }
+
+    actor->PostInit();
+    actor->PostPostInit();
+
+    return actor;
+}
+
 void ActorFactory::ModifyActor(StrongActorPtr actor, TiXmlElement* overrides)
 {
     for (TiXmlElement* node = overrides->FirstChildElement(); node != NULL; node = node->NextSiblingElement())
@@ -195,6 +302,54 @@ void ActorFactory::ModifyActor(StrongActorPtr actor, TiXmlElement* overrides)
     }
 }
 
+shared_ptr<CompiledActorPrototype> ActorFactory::GetCompiledPrototype(ActorPrototype proto)
+{
+    auto findIt = _compiledPrototypeMap.find(proto);
+    if (findIt != _compiledPrototypeMap.end())
+    {
+        return findIt->second;
+    }
+
+    TiXmlElement* pActorElem = g_pApp->GetActorPrototypeElem(proto);
+    assert(pActorElem != NULL);
+
+    shared_ptr<CompiledActorPrototype> pCompiledProto = CompileActorPrototype(pActorElem);
+    if (!pCompiledProto)
+    {
+        return nullptr;
+    }
+
+    _compiledPrototypeMap.insert(std::make_pair(proto, pCompiledProto));
+
+    return pCompiledProto;
+}
+
+// Takes ownership of given xml element
+shared_ptr<CompiledActorPrototype> ActorFactory::CompileActorPrototype(TiXmlElement* pActorElem)
+{
+    shared_ptr<CompiledActorPrototype> pCompiledProto(new CompiledActorPrototype());
+    pCompiledProto->pActorElem = pActorElem;
+
+    for (TiXmlElement* node = pCompiledProto->pActorElem->FirstChildElement(); node != NULL; node = node->NextSiblingElement())
+    {
+        CompiledComponentDef componentDef;
+        componentDef.pXmlData = node;
+
+        if (_cloneableComponentIds.count(ActorComponent::GetIdFromName(node->Value())) > 0)
+        {
+            componentDef.pTemplate = VCreateComponent(node);
+            if (!componentDef.pTemplate)
+            {
+                return nullptr;
+            }
+        }
+
+        pCompiledProto->components.push_back(componentDef);
+    }
+
+    return pCompiledProto;
+}
+
 StrongActorComponentPtr ActorFactory::VCreateComponent(TiXmlElement* data)
 {
     const char* name = data->Value();
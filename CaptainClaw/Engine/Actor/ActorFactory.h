@@ -2,9 +2,45 @@
 #define ACTORFACTORY_H_
 
 #include <map>
+#include <set>
+#include <vector>
+#include <functional>
 
 #include "ActorComponent.h"
 
+//-------------------------------------------------------------------------------------------------
+// Compiled actor prototype
+//
+//     Actor prototype with already resolved inheritance, split into its components. Cloneable
+//     components are initialized from xml only once and spawned actors get their copies, the rest
+//     keeps its xml element which is passed to VInit for every spawned actor.
+//-------------------------------------------------------------------------------------------------
+
+struct CompiledComponentDef
+{
+    // Points into CompiledActorPrototype::pActorElem
+    TiXmlElement* pXmlData;
+
+    // NULL if the component has to be initialized from xml
+    StrongActorComponentPtr pTemplate;
+};
+
+struct CompiledActorPrototype
+{
+    CompiledActorPrototype() : pActorElem(NULL) { }
+    ~CompiledActorPrototype();
+
+    TiXmlElement* pActorElem;
+    std::vector<CompiledComponentDef> components;
+};
+
+// Per-instance changes (position, direction, ...) applied to freshly created components
+// before they are post-initialized
+typedef std::function<void(StrongActorPtr)> ActorInstanceOverrides;
+
+// Creates xml of templated actor, called only when its template is compiled
+typedef std::function<TiXmlElement*()> ActorXmlCreator;
+
 //-------------------------------------------------------------------------------------------------
 // Actor factory
 //-------------------------------------------------------------------------------------------------
@@ -16,14 +52,30 @@ public:
 
     StrongActorPtr CreateActor(TiXmlElement* pActorRoot, TiXmlElement* overrides);
     StrongActorPtr CreateActor(const char* actorResource, TiXmlElement* overrides);
+    StrongActorPtr CreateActor(ActorPrototype proto, const ActorInstanceOverrides& overrides);
+    // Spawns actor from xml compiled upon first request of given template key. The key has to identify
+    // everything the xml depends on, per-instance data (e.g. position) are applied by overrides
+    StrongActorPtr CreateActor(const std::string& templateKey, const ActorXmlCreator& createActorXml, const ActorInstanceOverrides& overrides);
     void ModifyActor(StrongActorPtr actor, TiXmlElement* overrides);
 
     virtual StrongActorComponentPtr VCreateComponent(TiXmlElement* data);
 
+    // Compiled prototypes hold components initialized against current level's physics and palette,
+    // so they have to be dropped whenever these change
+    void ClearCompiledPrototypes() { _compiledPrototypeMap.clear(); _compiledTemplateMap.clear(); }
+
 protected:
+    shared_ptr<CompiledActorPrototype> GetCompiledPrototype(ActorPrototype proto);
+    shared_ptr<CompiledActorPrototype> CompileActorPrototype(TiXmlElement* pActorElem);
+    StrongActorPtr CreateActor(shared_ptr<CompiledActorPrototype> pCompiledProto, const ActorInstanceOverrides& overrides);
+
     GenericObjectFactory<ActorComponent, uint32_t> _componentFactory;
+    std::set<uint32> _cloneableComponentIds;
 
 private:
+    std::map<ActorPrototype, shared_ptr<CompiledActorPrototype>> _compiledPrototypeMap;
+    std::map<std::string, shared_ptr<CompiledActorPrototype>> _compiledTemplateMap;
+
     uint32_t _lastActorGUID;
     uint32_t GetNextActorGUID() { ++_lastActorGUID; return _lastActorGUID; }
 };
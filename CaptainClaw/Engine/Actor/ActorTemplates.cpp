@@ -4,6 +4,11 @@
 #include "../Events/EventMgr.h"
 #include "../Events/Events.h"
 
+#include "Components/PositionComponent.h"
+#include "Components/RenderComponent.h"
+#include "Components/PhysicsComponent.h"
+#include "Components/AIComponents/ProjectileAIComponent.h"
+
 #include <time.h>
 
 namespace ActorTemplates
@@ -331,6 +336,51 @@ namespace ActorTemplates
         return pActor;
     }
 
+    // Places spawned actor and applies the rest of its per-instance overrides
+    static void ApplyInstanceOverrides(StrongActorPtr pActor, const Point& position, const ActorInstanceOverrides& overrides)
+    {
+        shared_ptr<PositionComponent> pPositionComponent = MakeStrongPtr(pActor->GetComponent<PositionComponent>());
+        assert(pPositionComponent != nullptr);
+
+        // Keep whole-pixel positions, same as xml templates
+        pPositionComponent->SetPosition((int)position.x, (int)position.y);
+
+        if (overrides)
+        {
+            overrides(pActor);
+        }
+    }
+
+    // Spawns actor from compiled prototype, no xml is created or parsed here
+    StrongActorPtr CreateAndReturnActor(ActorPrototype proto, const Point& position, const ActorInstanceOverrides& overrides)
+    {
+        StrongActorPtr pActor = g_pApp->GetGameLogic()->VCreateActor(proto, [&position, &overrides](StrongActorPtr pNewActor)
+        {
+            ApplyInstanceOverrides(pNewActor, position, overrides);
+        });
+        assert(pActor && "Failed to create actor");
+
+        shared_ptr<EventData_New_Actor> pNewActorEvent(new EventData_New_Actor(pActor->GetGUID()));
+        IEventMgr::Get()->VQueueEvent(pNewActorEvent);
+
+        return pActor;
+    }
+
+    // Spawns actor from xml template which is created and compiled only for the first spawn of given key
+    StrongActorPtr CreateAndReturnActor(const std::string& templateKey, const ActorXmlCreator& createActorXml, const Point& position, const ActorInstanceOverrides& overrides)
+    {
+        StrongActorPtr pActor = g_pApp->GetGameLogic()->VCreateActor(templateKey, createActorXml, [&position, &overrides](StrongActorPtr pNewActor)
+        {
+            ApplyInstanceOverrides(pNewActor, position, overrides);
+        });
+        assert(pActor && "Failed to create actor");
+
+        shared_ptr<EventData_New_Actor> pNewActorEvent(new EventData_New_Actor(pActor->GetGUID()));
+        IEventMgr::Get()->VQueueEvent(pNewActorEvent);
+
+        return pActor;
+    }
+
     void ImageSetToWildcardImagePath(std::string& imageSet)
     {
         std::replace(imageSet.begin(), imageSet.end(), '_', '/');
@@ -1983,12 +2033,32 @@ namespace ActorTemplates
 
     StrongActorPtr CreateActor(ActorPrototype proto, Point position)
     {
-        return CreateAndReturnActor(CreateXmlData_Actor(proto, position));
+        return CreateAndReturnActor(proto, position, nullptr);
     }
 
     StrongActorPtr CreateActor_Projectile(ActorPrototype proto, Point position, Direction dir)
     {
-        return CreateAndReturnActor(CreateXmlData_ProjectileActor(proto, position, dir));
+        if (dir != Direction_Left)
+        {
+            return CreateAndReturnActor(proto, position, nullptr);
+        }
+
+        // Same as CreateXmlData_ProjectileActor - invert speed and mirror render component when shooting left
+        return CreateAndReturnActor(proto, position, [](StrongActorPtr pActor)
+        {
+            shared_ptr<ProjectileAIComponent> pProjectileAIComponent = MakeStrongPtr(pActor->GetComponent<ProjectileAIComponent>());
+            assert(pProjectileAIComponent != nullptr);
+
+            Point projectileSpeed = pProjectileAIComponent->GetProjectileSpeed();
+            projectileSpeed.x *= -1.0;
+            pProjectileAIComponent->SetProjectileSpeed(projectileSpeed);
+
+            shared_ptr<ActorRenderComponent> pRenderComponent = MakeStrongPtr(pActor->GetComponent<ActorRenderComponent>());
+            if (pRenderComponent)
+            {
+                pRenderComponent->SetMirrored(!pRenderComponent->IsMirrored());
+            }
+        });
     }
 
     StrongActorPtr CreateActor_StaticImage(ActorPrototype proto, Point position, const std::string& imagePath, const AnimationDef& aniDef)
@@ -2352,7 +2422,23 @@ namespace ActorTemplates
 
     StrongActorPtr CreateActorPickup(PickupType pickupType, Point position, bool isStatic)
     {
-        return CreateAndReturnActor(CreateXmlData_PickupActor(pickupType, position, isStatic));
+        const std::string templateKey = "Pickup_" + ToStr((int)pickupType) + (isStatic ? "_Static" : "_Dynamic");
+
+        return CreateAndReturnActor(templateKey,
+            [pickupType, position, isStatic]() { return CreateXmlData_PickupActor(pickupType, position, isStatic); },
+            position,
+            [](StrongActorPtr pActor)
+            {
+                // Same as CreateXmlData_GeneralPickupActor - every pickup flies off in its own random direction
+                double speedX = 0.5 + (rand() % 100) / 50.0;
+                double speedY = -(1 + (rand() % 100) / 50.0);
+
+                if (rand() % 2 == 1) { speedX *= -1; }
+
+                shared_ptr<PhysicsComponent> pPhysicsComponent = MakeStrongPtr(pActor->GetComponent<PhysicsComponent>());
+                assert(pPhysicsComponent != nullptr);
+                pPhysicsComponent->SetInitialSpeed(Point(speedX, speedY));
+            });
     }
 
     StrongActorPtr CreateRenderedActor(Point position, std::string imageSet, std::string animPath, int zCoord)
@@ -2372,12 +2458,20 @@ namespace ActorTemplates
 
     StrongActorPtr CreatePowerupSparkleActor()
     {
-        return CreateAndReturnActor(CreateXmlData_PowerupSparkleActor("GAME_SPARKLE"));
+        return CreateAndReturnActor("PowerupSparkle",
+            []() { return CreateXmlData_PowerupSparkleActor("GAME_SPARKLE"); },
+            Point(0, 0),
+            nullptr);
     }
 
     StrongActorPtr CreateClawProjectile(AmmoType ammoType, Direction direction, Point position)
     {
-        return CreateAndReturnActor(CreateXmlData_ClawProjectileActor(ammoType, direction, position));
+        const std::string templateKey = "ClawProjectile_" + ToStr((int)ammoType) + "_" + ToStr((int)direction);
+
+        return CreateAndReturnActor(templateKey,
+            [ammoType, direction, position]() { return CreateXmlData_ClawProjectileActor(ammoType, direction, position); },
+            position,
+            nullptr);
     }
 
     StrongActorPtr CreateProjectile(
@@ -2389,14 +2483,23 @@ namespace ActorTemplates
         CollisionFlag collisionFlag, 
         uint32 collisionMask)
     {
-        return CreateAndReturnActor(CreateXmlData_ProjectileActor(
-            imageSet, 
-            damage, 
-            damageType, 
-            direction, 
-            position, 
-            collisionFlag, 
-            collisionMask));
+        const std::string templateKey = "Projectile_" + imageSet + "_" + ToStr(damage) + "_" + ToStr((int)damageType) + "_" +
+            ToStr((int)direction) + "_" + ToStr((int)collisionFlag) + "_" + ToStr(collisionMask);
+
+        return CreateAndReturnActor(templateKey,
+            [=]()
+            {
+                return CreateXmlData_ProjectileActor(
+                    imageSet,
+                    damage,
+                    damageType,
+                    direction,
+                    position,
+                    collisionFlag,
+                    collisionMask);
+            },
+            position,
+            nullptr);
     }
 
     StrongActorPtr CreateAreaDamage(Point position, Point size, int32 damage, CollisionFlag collisionFlag, std::string shape, DamageType damageType, Direction hitDirection, Point positionOffset, std::string imageSet, int32 zCoord)
@@ -2406,12 +2509,22 @@ namespace ActorTemplates
 
     StrongActorPtr CreateGlitter(std::string glitterType, Point position, int32 zCoord)
     {
-        return CreateAndReturnActor(CreateXmlData_GlitterActor(glitterType, position, zCoord));
+        const std::string templateKey = "Glitter_" + glitterType + "_" + ToStr(zCoord);
+
+        return CreateAndReturnActor(templateKey,
+            [glitterType, position, zCoord]() { return CreateXmlData_GlitterActor(glitterType, position, zCoord); },
+            position,
+            nullptr);
     }
 
     StrongActorPtr CreateScorePopupActor(Point position, int score)
     {
-        return CreateAndReturnActor(CreateXmlData_ScorePopupActor(position, score));
+        const std::string templateKey = "ScorePopup_" + ToStr(score);
+
+        return CreateAndReturnActor(templateKey,
+            [position, score]() { return CreateXmlData_ScorePopupActor(position, score); },
+            position,
+            nullptr);
     }
 
     // From XML to Struct
@@ -0,0 +1,112 @@
+#ifndef __COMPONENT_SYSTEM_H__
+#define __COMPONENT_SYSTEM_H__
+
+#include <vector>
+
+#include "../SharedDefines.h"
+#include "ActorComponent.h"
+
+//=================================================================================================
+// class ComponentSystem
+//
+//     Opt-in batched update of a single component type. Component which migrates here returns
+//     true from VIsUpdatedBySystem(), adds itself in VPostInit and removes itself in destructor.
+//     Actor::Update then skips it and all components of given type are instead updated in one pass
+//     over a dense array - no actor map walk, no component map walk and no virtual dispatch.
+//
+//=================================================================================================
+
+template <class ComponentType>
+class ComponentSystem
+{
+public:
+    ComponentSystem() : m_IsUpdating(false), m_NumRemovedWhileUpdating(0) { }
+
+    void Add(ComponentType* pComponent)
+    {
+        assert(pComponent != NULL);
+        assert(pComponent->_systemIndex == -1 && "Component is already part of a system");
+
+        pComponent->_systemIndex = (int32)m_Components.size();
+        m_Components.push_back(pComponent);
+    }
+
+    void Remove(ComponentType* pComponent)
+    {
+        assert(pComponent != NULL);
+
+        int32 index = pComponent->_systemIndex;
+        if (index < 0)
+        {
+            return;
+        }
+
+        assert(index < (int32)m_Components.size() && m_Components[index] == pComponent);
+        pComponent->_systemIndex = -1;
+
+        // Keep order of not yet updated components, array is compacted after the update pass
+        if (m_IsUpdating)
+        {
+            m_Components[index] = NULL;
+            m_NumRemovedWhileUpdating++;
+            return;
+        }
+
+        ComponentType* pLast = m_Components.back();
+        m_Components[index] = pLast;
+        pLast->_systemIndex = index;
+        m_Components.pop_back();
+    }
+
+    void Update(uint32 msDiff)
+    {
+        m_IsUpdating = true;
+
+        // Components added during the update are appended and updated in this pass as well
+        for (size_t i = 0; i < m_Components.size(); i++)
+        {
+            if (ComponentType* pComponent = m_Components[i])
+            {
+                pComponent->ComponentType::VUpdate(msDiff);
+            }
+        }
+
+        m_IsUpdating = false;
+
+        if (m_NumRemovedWhileUpdating > 0)
+        {
+            Compact();
+        }
+    }
+
+    size_t GetCount() const { return m_Components.size() - m_NumRemovedWhileUpdating; }
+
+private:
+    void Compact()
+    {
+        size_t numValid = 0;
+        for (size_t i = 0; i < m_Components.size(); i++)
+        {
+            if (ComponentType* pComponent = m_Components[i])
+            {
+                pComponent->_systemIndex = (int32)numValid;
+                m_Components[numValid++] = pComponent;
+            }
+        }
+
+        m_Components.resize(numValid);
+        m_NumRemovedWhileUpdating = 0;
+    }
+
+    std::vector<ComponentType*> m_Components;
+    bool m_IsUpdating;
+    size_t m_NumRemovedWhileUpdating;
+};
+
+class AnimationComponent;
+class KinematicComponent;
+
+typedef ComponentSystem<AnimationComponent> AnimationSystem;
+typedef ComponentSystem<KinematicComponent> KinematicSystem;
+
+#endif
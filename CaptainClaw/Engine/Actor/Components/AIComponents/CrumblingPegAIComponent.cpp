@@ -62,7 +62,7 @@ TiXmlElement* CrumblingPegAIComponent::VGenerateXml()
     return baseElement;
 }
 
-void CrumblingPegAIComponent::VOnAnimationFrameChanged(Animation* pAnimation, AnimationFrame* pLastFrame, AnimationFrame* pNewFrame)
+void CrumblingPegAIComponent::VOnAnimationFrameChanged(Animation* pAnimation, const AnimationFrame* pLastFrame, const AnimationFrame* pNewFrame)
 {
     if (pNewFrame->idx == 9)
     {
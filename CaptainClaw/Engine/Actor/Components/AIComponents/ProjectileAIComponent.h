@@ -19,6 +19,10 @@ public:
 
     virtual bool VInit(TiXmlElement* data) override;
     virtual TiXmlElement* VGenerateXml() override;
+    virtual ActorComponent* VClone() const override { return new ProjectileAIComponent(*this); }
+
+    Point GetProjectileSpeed() const { return m_ProjectileSpeed; }
+    void SetProjectileSpeed(const Point& speed) { m_ProjectileSpeed = speed; }
 
     void OnCollidedWithSolidTile();
     void OnCollidedWithActor(Actor* pActorWhoWasShot);
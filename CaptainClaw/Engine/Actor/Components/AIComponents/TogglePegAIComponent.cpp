@@ -107,7 +107,10 @@ static int SetupPlayMusicThread(void* pData)
     DelayEventInfo* pEventInfo = (DelayEventInfo*)pData;
 
     SDL_Delay(pEventInfo->msDelay);
-    IEventMgr::Get()->VTriggerEvent(pEventInfo->pEvent);
+
+    // Listeners have to run on the game thread
+    IEventMgr::Get()->VThreadSafeQueueEvent(pEventInfo->pEvent);
+    delete pEventInfo;
 
     return 0;
 }
@@ -121,7 +124,7 @@ static void DelayEvent(IEventDataPtr pEvent, uint32 msDelay)
     SDL_DetachThread(pThread);
 }
 
-void TogglePegAIComponent::VOnAnimationFrameChanged(Animation* pAnimation, AnimationFrame* pLastFrame, AnimationFrame* pNewFrame)
+void TogglePegAIComponent::VOnAnimationFrameChanged(Animation* pAnimation, const AnimationFrame* pLastFrame, const AnimationFrame* pNewFrame)
 {
     bool didToggle = false;
     /*LOG(ToStr(_owner->GetGUID()));
@@ -5,63 +5,99 @@
 #include "PositionComponent.h"
 #include "../Actor.h"
 
+#include "../../GameApp/BaseGameApp.h"
+#include "../../Resource/ResourceCache.h"
+#include "../../Resource/Loaders/AniLoader.h"
+
 #include "../../Events/EventMgr.h"
 #include "../../Events/Events.h"
 
-Animation::Animation() :
-    _name("Unknown"),
-    _currentTime(0),
-    _paused(false),
-    _reversed(false),
-    _isBeingReversed(false),
-    _owner(NULL)
-{ }
+//=================================================================================================
+// AnimationTableCache implementation
+//=================================================================================================
 
-Animation::~Animation()
-{
-    _animationFrames.clear();
-}
+static std::map<std::string, AnimationTableMap> g_AnimationTablesByPath;
+static std::map<std::string, AnimationTablePtr> g_CycleAnimationTables;
 
-Animation* Animation::CreateAnimation(WapAni* wapAni, const char* animationName, const char* resourcePath, AnimationComponent* owner)
+const AnimationTableMap* AnimationTableCache::LoadAnimationTables(const std::string& pathPattern)
 {
-    Animation* animation = new Animation();
-    if (!animation->Initialize(wapAni, animationName, resourcePath, owner))
+    auto findIt = g_AnimationTablesByPath.find(pathPattern);
+    if (findIt != g_AnimationTablesByPath.end())
     {
-        delete animation;
-        return NULL;
+        return &findIt->second;
     }
 
-    return animation;
-}
+    AnimationTableMap animationTables;
 
-Animation* Animation::CreateAnimation(std::vector<AnimationFrame> animFrames, const char* animName, AnimationComponent* owner)
-{
-    Animation* animation = new Animation();
-    if (!animation->Initialize(animFrames, animName, owner))
+    // TODO: Rework. Consult with RenderComponent.cpp for proper fast implementation.
+    // Take the algo from there and make it general purpose, dont copy-paste stuff
+    std::vector<std::string> matchingAnimNames =
+        g_pApp->GetResourceCache()->Match(pathPattern);
+
+    for (std::string animPath : matchingAnimNames)
     {
-        delete animation;
-        return NULL;
+        WapAni* wapAni = AniResourceLoader::LoadAndReturnAni(animPath.c_str());
+        std::string animNameKey = StripPathAndExtension(animPath);
+
+        // Check if we dont already have the animation loaded
+        if (animationTables.count(animNameKey) > 0)
+        {
+            LOG_WARNING("Trying to load existing animation: " + animPath);
+            continue;
+        }
+
+        AnimationTablePtr pTable = wapAni ? CreateAnimationTable(wapAni, animNameKey, animPath) : AnimationTablePtr();
+        if (!pTable)
+        {
+            LOG_ERROR("Could not create animation: " + animPath);
+            return NULL;
+        }
+
+        animationTables.insert(std::make_pair(animNameKey, pTable));
     }
 
-    return animation;
+    return &g_AnimationTablesByPath.insert(std::make_pair(pathPattern, animationTables)).first->second;
 }
 
-Animation* Animation::CreateAnimation(int numAnimFrames, int animFrameTime, const char* animName, AnimationComponent* owner)
+AnimationTablePtr AnimationTableCache::GetCycleAnimationTable(int numAnimFrames, int animFrameTime, const std::string& animName)
 {
-    Animation* animation = new Animation();
-    if (!animation->Initialize(numAnimFrames, animFrameTime, animName, owner))
+    std::string key = animName + "_" + ToStr(numAnimFrames) + "_" + ToStr(animFrameTime);
+    auto findIt = g_CycleAnimationTables.find(key);
+    if (findIt != g_CycleAnimationTables.end())
     {
-        delete animation;
-        return NULL;
+        return findIt->second;
     }
 
-    return animation;
+    shared_ptr<AnimationTable> pTable(new AnimationTable());
+    pTable->name = animName;
+    for (int frameIdx = 0; frameIdx < numAnimFrames; ++frameIdx)
+    {
+        AnimationFrame animFrame;
+        animFrame.idx = frameIdx;
+        animFrame.imageId = frameIdx + 1;
+        animFrame.imageName = "frame" + Util::ConvertToThreeDigitsString(animFrame.imageId);
+        animFrame.duration = animFrameTime;
+        animFrame.hasEvent = false;
+        animFrame.eventName = "";
+
+        pTable->frames.push_back(animFrame);
+    }
+
+    if (pTable->frames.empty())
+    {
+        LOG_ERROR("Animation: " + animName + " has no animation frames");
+        return AnimationTablePtr();
+    }
+
+    g_CycleAnimationTables.insert(std::make_pair(key, pTable));
+
+    return pTable;
 }
 
-bool Animation::Initialize(WapAni* wapAni, const char* animationName, const char* resourcePath, AnimationComponent* owner)
+AnimationTablePtr AnimationTableCache::CreateAnimationTable(WapAni* wapAni, const std::string& animName, const std::string& resourcePath)
 {
-    _name = animationName;
-    _owner = owner;
+    shared_ptr<AnimationTable> pTable(new AnimationTable());
+    pTable->name = animName;
 
     // Load animation frame from WapAni
     uint32 numAnimFrames = wapAni->animationFramesCount;
@@ -117,66 +153,88 @@ bool Animation::Initialize(WapAni* wapAni, const char* animationName, const char
         }
 
         // HACK: For specific reason, dynamite jump throw takes too long
-        if (_name == "jumpdynamite")
+        if (animName == "jumpdynamite")
         {
             animFrame.duration = 60;
         }
 
-        _animationFrames.push_back(animFrame);
+        pTable->frames.push_back(animFrame);
     }
 
-    if (_animationFrames.empty())
+    if (pTable->frames.empty())
     {
-        LOG_ERROR("Animation: " + _name + " has no animation frames");
-        return false;
+        LOG_ERROR("Animation: " + animName + " has no animation frames");
+        return AnimationTablePtr();
     }
 
-    _currentAnimationFrame = _animationFrames[0];
+    return pTable;
+}
+
+//=================================================================================================
+// Animation implementation
+//=================================================================================================
+
+Animation::Animation() :
+    _currentFrameIdx(0),
+    _currentTime(0),
+    _paused(false),
+    _reversed(false),
+    _isBeingReversed(false),
+    _owner(NULL)
+{ }
+
+Animation::~Animation()
+{
 
-    return true;
 }
 
-bool Animation::Initialize(std::vector<AnimationFrame> animFrames, const char* animationName, AnimationComponent* owner)
+Animation* Animation::CreateAnimation(AnimationTablePtr pTable, AnimationComponent* owner)
 {
-    if (animFrames.empty())
+    Animation* animation = new Animation();
+    if (!animation->Initialize(pTable, owner))
     {
-        LOG_ERROR("Animation: " + std::string(animationName) + " has no animation frames");
-        return false;
+        delete animation;
+        return NULL;
     }
 
-    _name = animationName;
-    _owner = owner;
-    _animationFrames = animFrames;
-
-    _currentAnimationFrame = _animationFrames[0];
+    return animation;
+}
 
-    return true;
+Animation* Animation::CreateAnimation(WapAni* wapAni, const char* animationName, const char* resourcePath, AnimationComponent* owner)
+{
+    return CreateAnimation(AnimationTableCache::CreateAnimationTable(wapAni, animationName, resourcePath), owner);
 }
 
-bool Animation::Initialize(int numAnimFrames, int animFrameTime, const char* animName, AnimationComponent* owner)
+Animation* Animation::CreateAnimation(std::vector<AnimationFrame> animFrames, const char* animName, AnimationComponent* owner)
 {
-    for (int frameIdx = 0; frameIdx < numAnimFrames; ++frameIdx)
+    if (animFrames.empty())
     {
-        AnimationFrame animFrame;
-        animFrame.idx = frameIdx;
-        animFrame.imageId = frameIdx + 1;
-        animFrame.imageName = "frame" + Util::ConvertToThreeDigitsString(animFrame.imageId);
-        animFrame.duration = animFrameTime;
-        animFrame.hasEvent = false;
-        animFrame.eventName = "";
-
-        _animationFrames.push_back(animFrame);
+        LOG_ERROR("Animation: " + std::string(animName) + " has no animation frames");
+        return NULL;
     }
-    _name = animName;
-    _owner = owner;
 
-    if (_animationFrames.empty())
+    shared_ptr<AnimationTable> pTable(new AnimationTable());
+    pTable->name = animName;
+    pTable->frames = animFrames;
+
+    return CreateAnimation(pTable, owner);
+}
+
+Animation* Animation::CreateAnimation(int numAnimFrames, int animFrameTime, const char* animName, AnimationComponent* owner)
+{
+    return CreateAnimation(AnimationTableCache::GetCycleAnimationTable(numAnimFrames, animFrameTime, animName), owner);
+}
+
+bool Animation::Initialize(AnimationTablePtr pTable, AnimationComponent* owner)
+{
+    if (!pTable || pTable->frames.empty())
     {
-        LOG_ERROR("Animation: " + _name + " has no animation frames");
         return false;
     }
 
-    _currentAnimationFrame = _animationFrames[0];
+    _pTable = pTable;
+    _owner = owner;
+    _currentFrameIdx = 0;
 
     return true;
 }
@@ -188,25 +246,27 @@ void Animation::Update(uint32 msDiff)
         return;
     }
 
+    const AnimationFrame* pCurrentFrame = GetCurrentAnimationFrame();
+
     // Hack for now
-    if (_currentAnimationFrame.hasEvent)
+    if (pCurrentFrame->hasEvent)
     {
-        if (_currentAnimationFrame.idx == 0 && _currentTime == 0)
+        if (_currentFrameIdx == 0 && _currentTime == 0)
         {
-            PlayFrameSound(_currentAnimationFrame.eventName);
+            PlayFrameSound(pCurrentFrame->eventName);
         }
     }
 
     _currentTime += msDiff;
 
-    int32 currentFrameDuration = _currentAnimationFrame.duration;
+    int32 currentFrameDuration = pCurrentFrame->duration;
     if (_currentTime >= currentFrameDuration)
     {
         _currentTime = _currentTime - currentFrameDuration;
 
         if (_owner)
         {
-            _owner->OnAnimationFrameFinished(&_currentAnimationFrame);
+            _owner->OnAnimationFrameFinished(pCurrentFrame);
         }
 
         SetNextFrame();
@@ -215,25 +275,25 @@ void Animation::Update(uint32 msDiff)
 
 void Animation::Reset()
 {
-    _currentAnimationFrame = _animationFrames[0];
+    _currentFrameIdx = 0;
     _currentTime = 0;
     _paused = false;
 }
 
 void Animation::SetNextFrame()
 {
-    uint32 countAnimationFrames = _animationFrames.size();
+    uint32 countAnimationFrames = _pTable->frames.size();
 
     bool looped = false;
     // Certain animations play in loop while being reversed - e.g.: 0,1,2,3,4,3,2,1,0,1,....
     if (_reversed)
     {
-        if (_currentAnimationFrame.idx == (_animationFrames.size() - 1))
+        if (_currentFrameIdx == (countAnimationFrames - 1))
         {
             _isBeingReversed = true;
             looped = true;
         }
-        else if (_isBeingReversed && _currentAnimationFrame.idx == 0)
+        else if (_isBeingReversed && _currentFrameIdx == 0)
         {
             _isBeingReversed = false;
             looped = true;
@@ -246,7 +306,7 @@ void Animation::SetNextFrame()
             looped = true;
         }
         // If next frame will be last
-        else if (_currentAnimationFrame.idx + 2 == _animationFrames.size())
+        else if (_currentFrameIdx + 2 == countAnimationFrames)
         {
             _owner->OnAnimationAtLastFrame();
         }
@@ -255,20 +315,22 @@ void Animation::SetNextFrame()
     int32 delta = 0;
     _isBeingReversed ? delta-- : delta++;
 
-    AnimationFrame* lastAnimFrame = &_animationFrames[_currentAnimationFrame.idx];
-    _currentAnimationFrame = _animationFrames[(_currentAnimationFrame.idx + delta) % countAnimationFrames];    
+    const AnimationFrame* lastAnimFrame = GetCurrentAnimationFrame();
+    _currentFrameIdx = (_currentFrameIdx + delta) % countAnimationFrames;
+
+    const AnimationFrame* pCurrentFrame = GetCurrentAnimationFrame();
 
-    _owner->OnAnimationFrameStarted(&_currentAnimationFrame);
+    _owner->OnAnimationFrameStarted(pCurrentFrame);
 
-    _owner->OnAnimationFrameChanged(lastAnimFrame, &_currentAnimationFrame);
+    _owner->OnAnimationFrameChanged(lastAnimFrame, pCurrentFrame);
     if (looped)
     {
         _owner->OnAnimationLooped();
     }
 
-    if (_currentAnimationFrame.idx != 0 && _currentAnimationFrame.hasEvent)
+    if (_currentFrameIdx != 0 && pCurrentFrame->hasEvent)
     {
-        PlayFrameSound(_currentAnimationFrame.eventName);
+        PlayFrameSound(pCurrentFrame->eventName);
     }
 }
 
@@ -282,4 +344,4 @@ void Animation::PlayFrameSound(const std::string& sound)
     soundInfo.soundSourcePosition = _owner->_owner->GetPositionComponent()->GetPosition();
     IEventMgr::Get()->VTriggerEvent(IEventDataPtr(
         new EventData_Request_Play_Sound(soundInfo)));
-}
\ No newline at end of file
+}
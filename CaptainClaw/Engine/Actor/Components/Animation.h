@@ -17,6 +17,39 @@ struct AnimationFrame
     bool hasEvent;
 };
 
+// Immutable frames of single animation. Tables are shared by all actors which use the same
+// animation, per-actor playback state lives in Animation.
+struct AnimationTable
+{
+    std::string name;
+    std::vector<AnimationFrame> frames;
+};
+
+typedef shared_ptr<const AnimationTable> AnimationTablePtr;
+typedef std::map<std::string, AnimationTablePtr> AnimationTableMap;
+
+//=================================================================================================
+// class AnimationTableCache
+//
+//     Animation tables are built only once per animation path (ANI files are matched, loaded
+//     and their sound paths resolved) or per cycle animation shape and kept for the whole run.
+//     They are tiny compared to images they refer to.
+//
+//=================================================================================================
+
+class AnimationTableCache
+{
+public:
+    // Returns all animations matching given path pattern keyed by their name, NULL if any of them
+    // could not be loaded
+    static const AnimationTableMap* LoadAnimationTables(const std::string& pathPattern);
+
+    // Animation cycling through images frame001 - frameN, every frame lasting frameTime
+    static AnimationTablePtr GetCycleAnimationTable(int numAnimFrames, int animFrameTime, const std::string& animName);
+
+    static AnimationTablePtr CreateAnimationTable(WapAni* wapAni, const std::string& animName, const std::string& resourcePath);
+};
+
 // AnimationComponent and Animation are tightly coupled together
 class AnimationComponent;
 class Animation
@@ -25,13 +58,14 @@ public:
     Animation();
     ~Animation();
 
+    static Animation* CreateAnimation(AnimationTablePtr pTable, AnimationComponent* owner);
     static Animation* CreateAnimation(WapAni* wapAni, const char* animationName, const char* resourcePath, AnimationComponent* owner);
     static Animation* CreateAnimation(std::vector<AnimationFrame> animFrames, const char* animName, AnimationComponent* owner);
     static Animation* CreateAnimation(int numAnimFrames, int animFrameTime, const char* animName, AnimationComponent* owner);
 
-    inline std::string GetName() const { return _name; }
+    inline const std::string& GetName() const { return _pTable->name; }
 
-    AnimationFrame* GetCurrentAnimationFrame() { return &_currentAnimationFrame; }
+    const AnimationFrame* GetCurrentAnimationFrame() const { return &_pTable->frames[_currentFrameIdx]; }
 
     void Update(uint32 msDiff);
     void Reset();
@@ -43,32 +77,24 @@ public:
 
     void SetReverseAnim(bool reverse) { _reversed = reverse; }
 
-    uint32 GetAnimFramesSize() const { return _animationFrames.size(); }
-    bool IsAtLastAnimFrame() const { return _currentAnimationFrame.idx + 1 == _animationFrames.size(); }
-    bool IsAtFirstAnimFrame() const { return _currentAnimationFrame.idx == 0; }
+    uint32 GetAnimFramesSize() const { return _pTable->frames.size(); }
+    bool IsAtLastAnimFrame() const { return _currentFrameIdx + 1 == _pTable->frames.size(); }
+    bool IsAtFirstAnimFrame() const { return _currentFrameIdx == 0; }
     bool IsPaused() const { return _paused; }
 
 private:
-    void AddAnimationFrame(AnimationFrame& animFrame) { _animationFrames.push_back(animFrame); }
-    void SetName(const char* name) { _name = name; }
-    void SetOwner(AnimationComponent* owner) { assert(!_owner && owner); _owner = owner; }
-
-    bool Initialize(WapAni* wapAni, const char* animationName, const char* resourcePath, AnimationComponent* owner);
-    bool Initialize(std::vector<AnimationFrame> animFrames, const char* animationName, AnimationComponent* owner);
-    bool Initialize(int numAnimFrames, int animFrameTime, const char* animName, AnimationComponent* owner);
+    bool Initialize(AnimationTablePtr pTable, AnimationComponent* owner);
 
     void PlayFrameSound(const std::string& sound);
 
-    std::string _name;
-    AnimationFrame _currentAnimationFrame;
+    AnimationTablePtr _pTable;
+    uint32 _currentFrameIdx;
     int32 _currentTime;
     bool _paused;
     bool _reversed;
     bool _isBeingReversed;
 
     AnimationComponent* _owner;
-
-    std::vector<AnimationFrame> _animationFrames;
 };
 
-#endif
\ No newline at end of file
+#endif
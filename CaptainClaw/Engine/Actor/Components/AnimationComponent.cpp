@@ -1,7 +1,7 @@
 #include "AnimationComponent.h"
 #include "../Actor.h"
 #include "../../GameApp/BaseGameApp.h"
-#include "../../Resource/Loaders/AniLoader.h"
+#include "../../GameApp/BaseGameLogic.h"
 #include "RenderComponent.h"
 #include "PositionComponent.h"
 
@@ -13,11 +13,21 @@ AnimationComponent::AnimationComponent()
     :
     _currentAnimation(NULL),
     m_PauseOnStart(false),
-    m_PauseOnEnd(false)
+    m_PauseOnEnd(false),
+    m_pRenderComponent(NULL)
 { }
 
 AnimationComponent::~AnimationComponent()
 {
+    if (m_pAnimationSystem)
+    {
+        m_pAnimationSystem->Remove(this);
+    }
+
+    for (auto animIter : _animationMap)
+    {
+        delete animIter.second;
+    }
     _animationMap.clear();
 }
 
@@ -32,31 +42,30 @@ bool AnimationComponent::VInit(TiXmlElement* data)
     {
         const char* animationsPath = animPathElem->GetText();
 
-        // TODO: Rework. Consult with RenderComponent.cpp for proper fast implementation.
-        // Take the algo from there and make it general purpose, dont copy-paste stuff
-        std::vector<std::string> matchingAnimNames =
-            g_pApp->GetResourceCache()->Match(animationsPath);
-
-        for (std::string animPath : matchingAnimNames)
+        // Animation tables are shared by all actors with the same animation path
+        const AnimationTableMap* pAnimationTables = AnimationTableCache::LoadAnimationTables(animationsPath);
+        if (!pAnimationTables)
         {
-            WapAni* wapAni = AniResourceLoader::LoadAndReturnAni(animPath.c_str());
-            std::string animNameKey = StripPathAndExtension(animPath);
+            return false;
+        }
 
+        for (const auto& tableIter : *pAnimationTables)
+        {
             // Check if we dont already have the animation loaded
-            if (_animationMap.count(animNameKey) > 0)
+            if (_animationMap.count(tableIter.first) > 0)
             {
-                LOG_WARNING("Trying to load existing animation: " + animPath);
+                LOG_WARNING("Trying to load existing animation: " + tableIter.first);
                 continue;
             }
-            
-            Animation* animation = Animation::CreateAnimation(wapAni, animNameKey.c_str(), animPath.c_str(), this);
+
+            Animation* animation = Animation::CreateAnimation(tableIter.second, this);
             if (!animation)
             {
-                LOG_ERROR("Could not create animation: " + animPath);
+                LOG_ERROR("Could not create animation: " + tableIter.first);
                 return false;
             }
 
-            _animationMap.insert(std::make_pair(animNameKey, animation));
+            _animationMap.insert(std::make_pair(tableIter.first, animation));
         }
     }
 
@@ -101,6 +110,9 @@ bool AnimationComponent::VInit(TiXmlElement* data)
 
 void AnimationComponent::VPostInit()
 {
+    m_pAnimationSystem = g_pApp->GetGameLogic()->GetAnimationSystem();
+    m_pAnimationSystem->Add(this);
+
     // TODO: Get rid of this. Obfuscated, unmaintanable...
     for (std::string animType : m_SpecialAnimationRequestList)
     {
@@ -316,7 +328,7 @@ std::string AnimationComponent::GetCurrentAnimationName() const
 // Animation listeners
 //
 
-void AnimationComponent::OnAnimationFrameFinished(AnimationFrame* frame)
+void AnimationComponent::OnAnimationFrameFinished(const AnimationFrame* frame)
 {
     if (!frame->eventName.empty())
     {
@@ -324,7 +336,7 @@ void AnimationComponent::OnAnimationFrameFinished(AnimationFrame* frame)
     }
 }
 
-void AnimationComponent::OnAnimationFrameStarted(AnimationFrame* frame)
+void AnimationComponent::OnAnimationFrameStarted(const AnimationFrame* frame)
 {
     if (!frame->eventName.empty())
     {
@@ -332,15 +344,21 @@ void AnimationComponent::OnAnimationFrameStarted(AnimationFrame* frame)
     }
 
     // Notify render component to change frame image
-    shared_ptr<ActorRenderComponent> renderComponent =
-        MakeStrongPtr(_owner->GetComponent<ActorRenderComponent>(ActorRenderComponent::g_Name));
-    if (renderComponent)
+    if (!m_pRenderComponent)
     {
-        renderComponent->SetImage(frame->imageName);
+        // Both components belong to the same actor so plain pointer is safe
+        shared_ptr<ActorRenderComponent> pRenderComponent =
+            MakeStrongPtr(_owner->GetComponent<ActorRenderComponent>(ActorRenderComponent::g_Name));
+        if (!pRenderComponent)
+        {
+            pRenderComponent = MakeStrongPtr(_owner->GetComponent<HUDRenderComponent>(HUDRenderComponent::g_Name));
+        }
+        m_pRenderComponent = pRenderComponent.get();
     }
-    else if ((renderComponent = MakeStrongPtr(_owner->GetComponent<HUDRenderComponent>(HUDRenderComponent::g_Name))))
+
+    if (m_pRenderComponent)
     {
-        renderComponent->SetImage(frame->imageName);
+        m_pRenderComponent->SetImage(frame->imageId);
     }
     else
     {
@@ -353,7 +371,7 @@ void AnimationComponent::OnAnimationFinished()
 
 }
 
-void AnimationComponent::OnAnimationFrameChanged(AnimationFrame* pLastFrame, AnimationFrame* pNewFrame)
+void AnimationComponent::OnAnimationFrameChanged(const AnimationFrame* pLastFrame, const AnimationFrame* pNewFrame)
 {
     NotifyAnimationFrameChanged(_currentAnimation, pLastFrame, pNewFrame);
 }
@@ -403,7 +421,7 @@ void AnimationSubject::NotifyAnimationStarted(Animation* pAnimation)
     }
 }
 
-void AnimationSubject::NotifyAnimationFrameChanged(Animation* pAnimation, AnimationFrame* pLastFrame, AnimationFrame* pNewFrame)
+void AnimationSubject::NotifyAnimationFrameChanged(Animation* pAnimation, const AnimationFrame* pLastFrame, const AnimationFrame* pNewFrame)
 {
     for (AnimationObserver* pSubject : m_AnimationObservers)
     {
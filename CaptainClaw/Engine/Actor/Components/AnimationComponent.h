@@ -5,6 +5,7 @@
 
 #include "../../SharedDefines.h"
 #include "../ActorComponent.h"
+#include "../ComponentSystem.h"
 #include "Animation.h"
 
 class Animation;
@@ -14,7 +15,7 @@ class AnimationSubject
 public:
     void NotifyAnimationLooped(Animation* pAnimation);
     void NotifyAnimationStarted(Animation* pAnimation);
-    void NotifyAnimationFrameChanged(Animation* pAnimation, AnimationFrame* pLastFrame, AnimationFrame* pNewFrame);
+    void NotifyAnimationFrameChanged(Animation* pAnimation, const AnimationFrame* pLastFrame, const AnimationFrame* pNewFrame);
     void NotifyAnimationPaused(Animation* pAnimation);
     void NotifyAnimationResumed(Animation* pAnimation);
     void NotifyAnimationAtLastFrame(Animation* pAnimation);
@@ -30,7 +31,7 @@ class AnimationObserver
 public:
     virtual void VOnAnimationLooped(Animation* pAnimation) { }
     virtual void VOnAnimationStarted(Animation* pAnimation) { }
-    virtual void VOnAnimationFrameChanged(Animation* pAnimation, AnimationFrame* pLastFrame, AnimationFrame* pNewFrame) { }
+    virtual void VOnAnimationFrameChanged(Animation* pAnimation, const AnimationFrame* pLastFrame, const AnimationFrame* pNewFrame) { }
     virtual void VOnAnimationPaused(Animation* pAnimation) { }
     virtual void VOnAnimationResumed(Animation* pAnimation) { }
     virtual void VOnAnimationAtLastFrame(Animation* pAnimation) { }
@@ -52,6 +53,7 @@ struct SpecialAnimation
 typedef std::map<std::string, Animation*> AnimationMap;
 
 class Image;
+class ActorRenderComponent;
 class AnimationComponent : public ActorComponent, public AnimationSubject
 {
     friend class Animation;
@@ -69,6 +71,7 @@ public:
     virtual void VPostInit() override;
 
     virtual void VUpdate(uint32 msDiff) override;
+    virtual bool VIsUpdatedBySystem() const override { return true; }
 
     // API
     bool SetAnimation(std::string animationName);
@@ -87,10 +90,10 @@ private:
     bool m_PauseOnEnd;
 
     // Animation events
-    void OnAnimationFrameFinished(AnimationFrame* frame);
-    void OnAnimationFrameStarted(AnimationFrame* frame);
+    void OnAnimationFrameFinished(const AnimationFrame* frame);
+    void OnAnimationFrameStarted(const AnimationFrame* frame);
     void OnAnimationFinished();
-    void OnAnimationFrameChanged(AnimationFrame* pLastFrame, AnimationFrame* pNewFrame);
+    void OnAnimationFrameChanged(const AnimationFrame* pLastFrame, const AnimationFrame* pNewFrame);
     void OnAnimationLooped();
     void OnAnimationAtLastFrame();
 
@@ -102,6 +105,11 @@ private:
     std::vector<std::string> m_SpecialAnimationRequestList;
 
     std::vector<SpecialAnimation> m_SpecialAnimationList;
+
+    shared_ptr<AnimationSystem> m_pAnimationSystem;
+
+    // Resolved on first frame change
+    ActorRenderComponent* m_pRenderComponent;
 };
 
 #endif
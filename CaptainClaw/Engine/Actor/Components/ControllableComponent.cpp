@@ -621,7 +621,7 @@ void ClawControllableComponent::SetCurrentPhysicsState()
     m_pPhysicsComponent->RestoreGravityScale();
 }
 
-void ClawControllableComponent::VOnAnimationFrameChanged(Animation* pAnimation, AnimationFrame* pLastFrame, AnimationFrame* pNewFrame)
+void ClawControllableComponent::VOnAnimationFrameChanged(Animation* pAnimation, const AnimationFrame* pLastFrame, const AnimationFrame* pNewFrame)
 {
     std::string animName = pAnimation->GetName();
 
@@ -9,6 +9,7 @@
 #include "../../../GameApp/BaseGameLogic.h"
 #include "../../../GameApp/BaseGameApp.h"
 #include "../../../Physics/ClawPhysics.h"
+#include "../../../Physics/TileCollisionGrid.h"
 #include "../ControllableComponent.h"
 
 #include "../../../Events/EventMgr.h"
@@ -112,16 +113,11 @@ bool BaseEnemyAIStateComponent::VInit(TiXmlElement* pData)
 
 void BaseEnemyAIStateComponent::VPostInit()
 {
-    m_pAnimationComponent = 
-        MakeStrongPtr(_owner->GetComponent<AnimationComponent>(AnimationComponent::g_Name)).get();
-    m_pPhysicsComponent =
-        MakeStrongPtr(_owner->GetComponent<PhysicsComponent>(PhysicsComponent::g_Name)).get();
-    m_pPositionComponent =
-        MakeStrongPtr(_owner->GetComponent<PositionComponent>(PositionComponent::g_Name)).get();
-    m_pEnemyAIComponent = 
-        MakeStrongPtr(_owner->GetComponent<EnemyAIComponent>(EnemyAIComponent::g_Name)).get();
-    m_pRenderComponent =
-        MakeStrongPtr(_owner->GetComponent<ActorRenderComponent>(ActorRenderComponent::g_Name)).get();
+    m_pAnimationComponent = _owner->GetRawComponent<AnimationComponent>();
+    m_pPhysicsComponent = _owner->GetRawComponent<PhysicsComponent>();
+    m_pPositionComponent = _owner->GetRawComponent<PositionComponent>();
+    m_pEnemyAIComponent = _owner->GetRawComponent<EnemyAIComponent>();
+    m_pRenderComponent = _owner->GetRawComponent<ActorRenderComponent>();
 
     assert(m_pAnimationComponent);
     assert(m_pPhysicsComponent);
@@ -396,8 +392,15 @@ void PatrolEnemyAIStateComponent::VOnAnimationLooped(Animation* pAnimation)
     }
 }
 
-double PatrolEnemyAIStateComponent::FindClosestHole(Point center, int height, float maxSearchDistance)
+bool PatrolEnemyAIStateComponent::FindClosestHole(Point center, int height, float maxSearchDistance, double& outDelta)
 {
+    // Tile grid walks tile sub-rects instead of casting a ray per pixel
+    const TileCollisionGrid* pTileGrid = g_pApp->GetGameLogic()->GetCurrentLevelData()->GetTileCollisionGrid();
+    if (pTileGrid)
+    {
+        return pTileGrid->FindLedge(center, maxSearchDistance, height, (CollisionFlag_Solid | CollisionFlag_Ground), outDelta);
+    }
+
     double leftDelta = 0.0;
     for (leftDelta = 0.0; leftDelta < fabs(maxSearchDistance); leftDelta += 1.0)
     {
@@ -412,13 +415,14 @@ double PatrolEnemyAIStateComponent::FindClosestHole(Point center, int height, fl
         RaycastResult raycastResultDown = m_pPhysics->VRayCast(fromPoint, toPoint, (CollisionFlag_Solid | CollisionFlag_Ground));
         if (!raycastResultDown.foundIntersection)
         {
-            return leftDelta;
+            outDelta = leftDelta;
+            return true;
         }
 
         leftDelta = fabs(leftDelta);
     }
 
-    return 0.0;
+    return false;
 }
 
 void PatrolEnemyAIStateComponent::CalculatePatrolBorders()
@@ -430,8 +434,19 @@ void PatrolEnemyAIStateComponent::CalculatePatrolBorders()
     Point toLeftRay = Point(center.x - 10000, center.y);
     Point toRightRay = Point(center.x + 10000, center.y);
 
-    RaycastResult raycastResultLeft = m_pPhysics->VRayCast(center, toLeftRay, CollisionFlag_Solid);
-    RaycastResult raycastResultRight = m_pPhysics->VRayCast(center, toRightRay, CollisionFlag_Solid);
+    RaycastResult raycastResultLeft;
+    RaycastResult raycastResultRight;
+    const TileCollisionGrid* pTileGrid = g_pApp->GetGameLogic()->GetCurrentLevelData()->GetTileCollisionGrid();
+    if (pTileGrid)
+    {
+        raycastResultLeft.foundIntersection = pTileGrid->FindWall(center, -10000, CollisionFlag_Solid, raycastResultLeft.deltaX);
+        raycastResultRight.foundIntersection = pTileGrid->FindWall(center, 10000, CollisionFlag_Solid, raycastResultRight.deltaX);
+    }
+    else
+    {
+        raycastResultLeft = m_pPhysics->VRayCast(center, toLeftRay, CollisionFlag_Solid);
+        raycastResultRight = m_pPhysics->VRayCast(center, toRightRay, CollisionFlag_Solid);
+    }
 
     if (!raycastResultLeft.foundIntersection)
     {
@@ -451,8 +466,8 @@ void PatrolEnemyAIStateComponent::CalculatePatrolBorders()
     double patrolLeftBorder = 0.0;
     double patrolRightBorder = 0.0;
 
-    double leftDelta = FindClosestHole(center, aabb.h, raycastResultLeft.deltaX);
-    if (fabs(leftDelta) < DBL_EPSILON)
+    double leftDelta = 0.0;
+    if (!FindClosestHole(center, aabb.h, raycastResultLeft.deltaX, leftDelta))
     {
         patrolLeftBorder = center.x + raycastResultLeft.deltaX;
     }
@@ -461,8 +476,8 @@ void PatrolEnemyAIStateComponent::CalculatePatrolBorders()
         patrolLeftBorder = center.x + leftDelta;
     }
 
-    double rightDelta = FindClosestHole(center, aabb.h, raycastResultRight.deltaX);
-    if (fabs(rightDelta) < DBL_EPSILON)
+    double rightDelta = 0.0;
+    if (!FindClosestHole(center, aabb.h, raycastResultRight.deltaX, rightDelta))
     {
         patrolRightBorder = center.x + raycastResultRight.deltaX;
     }
@@ -668,8 +683,8 @@ void BaseAttackAIStateComponent::VOnAnimationLooped(Animation* pAnimation)
 
 void BaseAttackAIStateComponent::VOnAnimationFrameChanged(
     Animation* pAnimation,
-    AnimationFrame* pLastFrame,
-    AnimationFrame* pNewFrame)
+    const AnimationFrame* pLastFrame,
+    const AnimationFrame* pNewFrame)
 {
     if (!m_IsActive)
     {
@@ -732,8 +747,7 @@ Actor* BaseAttackAIStateComponent::FindClosestHostileActor()
     {
         assert(pHostileActor != NULL);
 
-        shared_ptr<PositionComponent> pHostileActorPositionComponent =
-            MakeStrongPtr(pHostileActor->GetComponent<PositionComponent>(PositionComponent::g_Name));
+        PositionComponent* pHostileActorPositionComponent = pHostileActor->GetRawComponent<PositionComponent>();
         assert(pHostileActorPositionComponent);
 
         Point positionDiff = pHostileActorPositionComponent->GetPosition() - m_pPositionComponent->GetPosition();
@@ -760,8 +774,7 @@ Point BaseAttackAIStateComponent::FindClosestHostileActorOffset()
         return closest;
     }
 
-    shared_ptr<PositionComponent> pHostileActorPositionComponent =
-        MakeStrongPtr(pClosestEnemy->GetComponent<PositionComponent>(PositionComponent::g_Name));
+    PositionComponent* pHostileActorPositionComponent = pClosestEnemy->GetRawComponent<PositionComponent>();
     assert(pHostileActorPositionComponent);
 
     return pHostileActorPositionComponent->GetPosition() - m_pPositionComponent->GetPosition();
@@ -781,10 +794,13 @@ bool BaseAttackAIStateComponent::VCanEnter()
     Point fromPoint = _owner->GetPositionComponent()->GetPosition();
     Point toPoint = m_EnemyAgroList[0]->GetPositionComponent()->GetPosition();
 
-    RaycastResult raycastResultDown = g_pApp->GetGameLogic()->VGetGamePhysics()->VRayCast(
-        fromPoint, 
-        toPoint, 
-        CollisionFlag_Solid);
+    const TileCollisionGrid* pTileGrid = g_pApp->GetGameLogic()->GetCurrentLevelData()->GetTileCollisionGrid();
+    RaycastResult raycastResultDown = pTileGrid ? 
+        pTileGrid->RayCast(fromPoint, toPoint, CollisionFlag_Solid) : 
+        g_pApp->GetGameLogic()->VGetGamePhysics()->VRayCast(
+            fromPoint, 
+            toPoint, 
+            CollisionFlag_Solid);
     if (raycastResultDown.foundIntersection)
     {
         // Vision is obstructed
@@ -156,7 +156,8 @@ public:
 
 private:
     void CalculatePatrolBorders();
-    double FindClosestHole(Point center, int height, float maxSearchDistance);
+    // Returns false if there is no hole within maxSearchDistance
+    bool FindClosestHole(Point center, int height, float maxSearchDistance, double& outDelta);
     void ChangeDirection(Direction newDirection);
     void CommenceIdleBehaviour();
 
@@ -207,7 +208,7 @@ public:
     virtual bool VCanEnter() override;
 
     virtual void VOnAnimationLooped(Animation* pAnimation) override;
-    virtual void VOnAnimationFrameChanged(Animation* pAnimation, AnimationFrame* pLastFrame, AnimationFrame* pNewFrame) override;
+    virtual void VOnAnimationFrameChanged(Animation* pAnimation, const AnimationFrame* pLastFrame, const AnimationFrame* pNewFrame) override;
 
     // BaseAttackAIStateComponent API
     virtual void VExecuteAttack();
@@ -43,7 +43,7 @@ void FloorSpikeComponent::VPostInit()
     pAnimComponent->GetCurrentAnimation()->SetReverseAnim(true);
 }
 
-void FloorSpikeComponent::VOnAnimationFrameChanged(Animation* pAnimation, AnimationFrame* pLastFrame, AnimationFrame* pNewFrame)
+void FloorSpikeComponent::VOnAnimationFrameChanged(Animation* pAnimation, const AnimationFrame* pLastFrame, const AnimationFrame* pNewFrame)
 {
     if (pNewFrame->idx > pLastFrame->idx)
     {
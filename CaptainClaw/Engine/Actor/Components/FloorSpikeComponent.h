@@ -20,7 +20,7 @@ public:
 
     virtual TiXmlElement* VGenerateXml() override { assert(false && "Unimplemented"); return NULL; }
 
-    void VOnAnimationFrameChanged(Animation* pAnimation, AnimationFrame* pLastFrame, AnimationFrame* pNewFrame) override;
+    void VOnAnimationFrameChanged(Animation* pAnimation, const AnimationFrame* pLastFrame, const AnimationFrame* pNewFrame) override;
 
 private:
     // XML Data
@@ -82,8 +82,8 @@ void FollowableComponent::VUpdate(uint32 msDiff)
         Point ownerPos = m_pPositionComponent->GetPosition();
         m_pTargetPositionComponent->SetPosition(ownerPos.x + m_Offset.x, ownerPos.y + m_Offset.y);
 
-        shared_ptr<EventData_Move_Actor> pEvent(
-            new EventData_Move_Actor(m_pFollowingActor->GetGUID(), m_pTargetPositionComponent->GetPosition()));
+        shared_ptr<EventData_Move_Actor> pEvent = MakePooledEvent<EventData_Move_Actor>(
+            m_pFollowingActor->GetGUID(), m_pTargetPositionComponent->GetPosition());
         IEventMgr::Get()->VTriggerEvent(pEvent);
     }
     else if (m_MsDuration > 0)
@@ -75,7 +75,7 @@ void GlitterComponent::VUpdate(uint32 msDiff)
     // Update position if necessary
     if (m_pGlitter && m_FollowOwner)
     {
-        shared_ptr<EventData_Move_Actor> pEvent(new EventData_Move_Actor(m_pGlitter->GetGUID(), m_pPositonComponent->GetPosition()));
+        shared_ptr<EventData_Move_Actor> pEvent = MakePooledEvent<EventData_Move_Actor>(m_pGlitter->GetGUID(), m_pPositonComponent->GetPosition());
         IEventMgr::Get()->VTriggerEvent(pEvent);
     }
     // Spawn glitter
@@ -25,6 +25,11 @@ KinematicComponent::KinematicComponent()
 
 KinematicComponent::~KinematicComponent()
 {
+    if (m_pKinematicSystem)
+    {
+        m_pKinematicSystem->Remove(this);
+    }
+
     IEventMgr::Get()->VRemoveListener(MakeDelegate(this, &KinematicComponent::ClawDiedDelegate), EventData_Claw_Died::sk_EventType);
 }
 
@@ -55,6 +60,9 @@ bool KinematicComponent::VInit(TiXmlElement* pData)
 
 void KinematicComponent::VPostInit()
 {
+    m_pKinematicSystem = g_pApp->GetGameLogic()->GetKinematicSystem();
+    m_pKinematicSystem->Add(this);
+
     shared_ptr<PositionComponent> pPositionComponent =
         MakeStrongPtr(_owner->GetComponent<PositionComponent>(PositionComponent::g_Name));
     assert(pPositionComponent);
@@ -3,6 +3,7 @@
 
 #include "../../SharedDefines.h"
 #include "../ActorComponent.h"
+#include "../ComponentSystem.h"
 #include "../../Events/EventMgr.h"
 #include "../../Events/Events.h"
 #include <Box2D/Box2D.h>
@@ -19,6 +20,7 @@ public:
     virtual void VPostInit() override;
 
     virtual void VUpdate(uint32 msDiff) override;
+    virtual bool VIsUpdatedBySystem() const override { return true; }
 
     virtual bool VInit(TiXmlElement* data) override;
     virtual TiXmlElement* VGenerateXml() override;
@@ -60,6 +62,8 @@ private:
     shared_ptr<IGamePhysics> m_pPhysics;
 
     std::vector<b2Body*> m_CarriedBodiesList;
+
+    shared_ptr<KinematicSystem> m_pKinematicSystem;
 };
 
 #endif
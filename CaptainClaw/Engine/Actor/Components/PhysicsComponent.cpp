@@ -4,6 +4,7 @@
 #include "../../GameApp/BaseGameApp.h"
 #include "RenderComponent.h"
 #include "../../Graphics2D/Image.h"
+#include "../../Physics/TileCollisionGrid.h"
 
 #include "PositionComponent.h"
 #include "ControllableComponent.h"
@@ -47,7 +48,11 @@ PhysicsComponent::PhysicsComponent() :
 
 PhysicsComponent::~PhysicsComponent()
 {
-    m_pPhysics->VRemoveActor(_owner->GetGUID());
+    // Components held by compiled actor prototypes have no owner
+    if (_owner)
+    {
+        m_pPhysics->VRemoveActor(_owner->GetGUID());
+    }
 }
 
 bool PhysicsComponent::VInit(TiXmlElement* data)
@@ -241,11 +246,31 @@ void PhysicsComponent::VPostInit()
     {
         // Position enemy to the floor
         Point fromPoint = pPositionComponent->GetPosition();
-        Point toPoint = pPositionComponent->GetPosition() + Point(0, 1000);
-        RaycastResult raycastDown = m_pPhysics->VRayCast(fromPoint, toPoint, (CollisionFlag_Solid | CollisionFlag_Ground));
-        assert(raycastDown.foundIntersection && "Did not find intersection. Enemy is too far in the air with no ground below him");
+        float groundDistance = 0.0f;
+        bool foundGround = false;
+
+        // Most enemies stand on tiles, only those on e.g. crates need Box2D query
+        const TileCollisionGrid* pTileGrid = g_pApp->GetGameLogic()->GetCurrentLevelData()->GetTileCollisionGrid();
+        if (pTileGrid)
+        {
+            if (pTileGrid->GetCollisionFlagsAt(fromPoint) & CollisionFlag_Solid)
+            {
+                LOG_WARNING("Actor: " + _owner->GetName() + " is placed inside solid tile at: " + fromPoint.ToString());
+            }
+
+            foundGround = pTileGrid->FindGroundBelow(fromPoint, 1000, (CollisionFlag_Solid | CollisionFlag_Ground), groundDistance);
+        }
+
+        if (!foundGround)
+        {
+            Point toPoint = pPositionComponent->GetPosition() + Point(0, 1000);
+            RaycastResult raycastDown = m_pPhysics->VRayCast(fromPoint, toPoint, (CollisionFlag_Solid | CollisionFlag_Ground));
+            foundGround = raycastDown.foundIntersection;
+            groundDistance = raycastDown.deltaY;
+        }
+        assert(foundGround && "Did not find intersection. Enemy is too far in the air with no ground below him");
 
-        double deltaY = raycastDown.deltaY - m_pPhysics->VGetAABB(_owner->GetGUID(), true).h / 2;
+        double deltaY = groundDistance - m_pPhysics->VGetAABB(_owner->GetGUID(), true).h / 2;
 
         pPositionComponent->SetY(pPositionComponent->GetY() + deltaY - 1);
         m_pPhysics->VSetPosition(_owner->GetGUID(), pPositionComponent->GetPosition());
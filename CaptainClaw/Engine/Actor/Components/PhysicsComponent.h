@@ -19,6 +19,7 @@ public:
     virtual bool VInit(TiXmlElement* data) override;
     virtual TiXmlElement* VGenerateXml() override;
     virtual void VPostInit() override;
+    virtual ActorComponent* VClone() const override { return new PhysicsComponent(*this); }
 
     virtual void VUpdate(uint32 msDiff) override;
 
@@ -42,6 +43,8 @@ public:
     float GetDensity() { return m_Density; }
 
     Point GetBodySize() const { return m_ActorBodyDef.size; }
+    // Has effect only before the body is created in VPostInit
+    void SetInitialSpeed(const Point& initialSpeed) { m_ActorBodyDef.initialSpeed = initialSpeed; }
     double GetBodyWidth() const { return m_ActorBodyDef.size.x; }
     double GetBodyHeight() const { return m_ActorBodyDef.size.y; }
 
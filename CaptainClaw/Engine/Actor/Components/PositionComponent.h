@@ -12,6 +12,7 @@ public:
 
     virtual bool VInit(TiXmlElement* data) override;
     virtual TiXmlElement* VGenerateXml() override;
+    virtual ActorComponent* VClone() const override { return new PositionComponent(*this); }
 
     // API
     Point GetPosition() const { return &m_Position; } 
@@ -56,7 +56,7 @@ void PowerupSparkleAIComponent::VOnAnimationLooped(Animation* pAnimation)
     m_pPositonComponent->SetX(targetPos.x - m_TargetSize.x / 2 + rand() % (int)m_TargetSize.x);
     m_pPositonComponent->SetY(targetPos.y - m_TargetSize.y / 2  + rand() % (int)m_TargetSize.y);
 
-    shared_ptr<EventData_Move_Actor> pEvent(new EventData_Move_Actor(_owner->GetGUID(), m_pPositonComponent->GetPosition()));
+    shared_ptr<EventData_Move_Actor> pEvent = MakePooledEvent<EventData_Move_Actor>(_owner->GetGUID(), m_pPositonComponent->GetPosition());
     IEventMgr::Get()->VTriggerEvent(pEvent);
 }
 
@@ -75,7 +75,7 @@ void PredefinedMoveComponent::VUpdate(uint32 msDiff)
 
         m_pPositonComponent->SetPosition(currentPos + moveDelta);
 
-        shared_ptr<EventData_Move_Actor> pEvent(new EventData_Move_Actor(_owner->GetGUID(), m_pPositonComponent->GetPosition()));
+        shared_ptr<EventData_Move_Actor> pEvent = MakePooledEvent<EventData_Move_Actor>(_owner->GetGUID(), m_pPositonComponent->GetPosition());
         IEventMgr::Get()->VTriggerEvent(pEvent);
 
         m_CurrMoveTime += msDiff;
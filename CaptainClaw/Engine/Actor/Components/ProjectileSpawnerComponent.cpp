@@ -104,8 +104,8 @@ void ProjectileSpawnerComponent::VOnAnimationLooped(Animation* pAnimation)
 
 void ProjectileSpawnerComponent::VOnAnimationFrameChanged(
     Animation* pAnimation, 
-    AnimationFrame* pLastFrame, 
-    AnimationFrame* pNewFrame)
+    const AnimationFrame* pLastFrame, 
+    const AnimationFrame* pNewFrame)
 {
     if (m_Properties.projectileSpawnAnimFrameIdx == pNewFrame->idx)
     {
@@ -27,7 +27,7 @@ public:
     virtual void VOnActorLeftTrigger(Actor* pActorWhoLeft) override;
 
     virtual void VOnAnimationLooped(Animation* pAnimation) override;
-    virtual void VOnAnimationFrameChanged(Animation* pAnimation, AnimationFrame* pLastFrame, AnimationFrame* pNewFrame) override;
+    virtual void VOnAnimationFrameChanged(Animation* pAnimation, const AnimationFrame* pLastFrame, const AnimationFrame* pNewFrame) override;
 
 private:
     bool TryToFire();
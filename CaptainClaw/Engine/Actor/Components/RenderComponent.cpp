@@ -44,31 +44,13 @@ bool BaseRenderComponent::VInit(TiXmlElement* pXmlData)
         const char* imagesPath = pImagePathElem->GetText();
         assert(imagesPath != NULL);
 
-        // Get all files residing in given directory
+        // Get all files residing in given directory which conform to the given pattern
         // !!! THIS ASSUMES THAT WE ONLY WANT IMAGES FROM THIS DIRECTORY. IT IGNORES ALL NESTED DIRECTORIES !!!
-        // Maybe add recursive algo to libwap
-        std::string imageDir = std::string(imagesPath);
-        //imageDir = imageDir.substr(0, imageDir.find("*")); // Get rid of everything after '*' including '*'
-        imageDir = imageDir.substr(0, imageDir.find_last_of("/")); // Get rid of filenames - get just path to the final directory
         std::vector<std::string> matchingPathNames =
-            g_pApp->GetResourceCache()->GetAllFilesInDirectory(imageDir.c_str());
-
-        // Remove all images which dont conform to the given pattern
-        // This affects probably only object with "DoNothing" logic
-        // Compute everything in lowercase to assure compatibility with everything in the engine
-        std::string imageDirLowercase(imagesPath);
-        std::transform(imageDirLowercase.begin(), imageDirLowercase.end(), imageDirLowercase.begin(), (int(*)(int)) std::tolower);
-        for (auto iter = matchingPathNames.begin(); iter != matchingPathNames.end(); /*++iter*/)
-        {
-            if (!WildcardMatch(imageDirLowercase.c_str(), (*iter).c_str()))
-            {
-                iter = matchingPathNames.erase(iter);
-            }
-            else
-            {
-                iter++;
-            }
-        }
+            g_pApp->GetResourceCache()->MatchInDirectory(imagesPath);
+
+        // Whole image set shares texture atlas so that it can be drawn without switching textures
+        PidResourceLoader::LoadImageSetIntoAtlas(matchingPathNames, palette);
 
         for (std::string imagePath : matchingPathNames)
         {
@@ -218,6 +200,41 @@ ActorRenderComponent::ActorRenderComponent()
     m_ColorMod.r = m_ColorMod.g = m_ColorMod.b = m_ColorMod.a = 255;
 }
 
+ActorRenderComponent::~ActorRenderComponent()
+{
+    for (shared_ptr<Image> pImage : m_PinnedImages)
+    {
+        pImage->Unpin();
+    }
+}
+
+void ActorRenderComponent::VPostInit()
+{
+    BaseRenderComponent::VPostInit();
+
+    // Templates are never post initialized, so only live actors keep their images resident
+    if (m_PinnedImages.empty())
+    {
+        for (auto& imageIter : m_ImageMap)
+        {
+            if (imageIter.second)
+            {
+                imageIter.second->Pin();
+                m_PinnedImages.push_back(imageIter.second);
+            }
+        }
+    }
+}
+
+ActorComponent* ActorRenderComponent::VClone() const
+{
+    // Clone pins its images on its own
+    ActorRenderComponent* pClone = new ActorRenderComponent(*this);
+    pClone->m_PinnedImages.clear();
+
+    return pClone;
+}
+
 bool ActorRenderComponent::VDelegateInit(TiXmlElement* pXmlData)
 {
     if (TiXmlElement* pElem = pXmlData->FirstChildElement("Visible"))
@@ -322,7 +339,36 @@ void ActorRenderComponent::VCreateInheritedXmlElements(TiXmlElement* pBaseElemen
 
 }
 
+void ActorRenderComponent::SetImage(uint32 imageId)
+{
+    if (imageId >= m_FrameImages.size())
+    {
+        m_FrameImages.resize(imageId + 1);
+    }
+
+    // Name based lookup has to handle quite a few actor specific quirks, do it only once
+    ResolvedFrameImage& frameImage = m_FrameImages[imageId];
+    if (!frameImage.isResolved)
+    {
+        frameImage.pImage = FindImage("frame" + Util::ConvertToThreeDigitsString(imageId));
+        frameImage.isResolved = true;
+    }
+
+    if (frameImage.pImage)
+    {
+        m_CurrentImage = frameImage.pImage;
+    }
+}
+
 void ActorRenderComponent::SetImage(std::string imageName)
+{
+    if (shared_ptr<Image> pImage = FindImage(imageName))
+    {
+        m_CurrentImage = pImage;
+    }
+}
+
+shared_ptr<Image> ActorRenderComponent::FindImage(std::string imageName)
 {
     // Hack.. only 2, 3, 4
     if (_owner->GetName() == "LEVEL_TORCH2")
@@ -336,38 +382,38 @@ void ActorRenderComponent::SetImage(std::string imageName)
         imageName = imageName.substr(5);
     }
 
-    if (m_ImageMap.count(imageName) > 0)
+    auto findIt = m_ImageMap.find(imageName);
+    if (findIt != m_ImageMap.end())
     {
-        m_CurrentImage = m_ImageMap[imageName];
+        return findIt->second;
     }
-    else
-    {
-        // Known... Treasure chest HUD
-        if (imageName == "frame000")
-        {
-            return;
-        }
 
-        // Try 01, 02, 03...
-        std::string newImageName = imageName.substr(6);
-        if (m_ImageMap.count(newImageName) > 0)
-        {
-            LOG("Setting: " + newImageName);
-            m_CurrentImage = m_ImageMap[newImageName];
-        }
-        else
-        {
-            LOG("NewImageName: " + newImageName);
-            LOG_ERROR("Trying to set nonexistant image: " + imageName + " to render component of actor: " +
-                _owner->GetName());
-        }
+    // Known... Treasure chest HUD
+    if (imageName == "frame000")
+    {
+        return shared_ptr<Image>();
+    }
 
-        /*LOG("Actor has following images: ");
-        for (auto iter : m_ImageMap)
-        {
-            LOG("Image: " + iter.first);
-        }*/
+    // Try 01, 02, 03...
+    std::string newImageName = imageName.substr(6);
+    findIt = m_ImageMap.find(newImageName);
+    if (findIt != m_ImageMap.end())
+    {
+        LOG("Setting: " + newImageName);
+        return findIt->second;
     }
+
+    LOG("NewImageName: " + newImageName);
+    LOG_ERROR("Trying to set nonexistant image: " + imageName + " to render component of actor: " +
+        _owner->GetName());
+
+    /*LOG("Actor has following images: ");
+    for (auto iter : m_ImageMap)
+    {
+        LOG("Image: " + iter.first);
+    }*/
+
+    return shared_ptr<Image>();
 }
 
 //=================================================================================================
@@ -379,76 +425,9 @@ void ActorRenderComponent::SetImage(std::string imageName)
 
 void TilePlaneRenderComponent::ProcessMainPlaneTiles(const TileList& tileList)
 {
-    const int tilesCount = tileList.size();
-    int currentTileIdx = 0;
-    
-    while (currentTileIdx < tilesCount)
-    {
-        TileList continuousTiles = GetAllContinuousTiles(tileList, currentTileIdx);
-        assert(continuousTiles.size() >= 1);
-
-        // Discard all empty tiles
-        if (continuousTiles[0] != -1)
-        {
-            int tileWidth = m_PlaneProperties.tilePixelWidth;
-            TileInfo firstTileInfo = GetTileInfo(tileList, currentTileIdx);
-            int currentX = firstTileInfo.x;
-            int currentY = firstTileInfo.y;
-
-            shared_ptr<EventData_Collideable_Tile_Created> pEvent(
-                new EventData_Collideable_Tile_Created(firstTileInfo.tileId, currentX, currentY, continuousTiles.size()));
-            IEventMgr::Get()->VTriggerEvent(pEvent);
-
-            /*for (int tileId : continuousTiles)
-            {
-                shared_ptr<EventData_Collideable_Tile_Created> pEvent(
-                    new EventData_Collideable_Tile_Created(tileId, currentX, currentY, 1));
-                IEventMgr::Get()->VTriggerEvent(pEvent);
-
-                currentX += tileWidth;
-            }*/
-        }
-
-        currentTileIdx += continuousTiles.size();
-    }
-}
-
-TileList TilePlaneRenderComponent::GetAllContinuousTiles(const TileList& tileList, int fromTileIdx)
-{
-    const int tilesCount = tileList.size();
-
-    TileList continuousTileList;
-
-    // First tile always belongs in the list
-    TileInfo currentTile = GetTileInfo(tileList, fromTileIdx);
-    continuousTileList.push_back(currentTile.tileId);
-
-    // We already have the first tile, check next one
-    int currentTileIdx = fromTileIdx + 1;
-
-    // Continue adding tiles as long as its ID and Y position matches the first tile
-    while (true)
-    {
-        // Keep track of the idx so we do not step out of bounds
-        if (currentTileIdx >= tilesCount)
-        {
-            break;
-        }
-
-        TileInfo nextTile = GetTileInfo(tileList, currentTileIdx);
-        if ((nextTile.tileId == currentTile.tileId) && (nextTile.y == currentTile.y))
-        {
-            continuousTileList.push_back(nextTile.tileId);
-            currentTile = nextTile;
-            currentTileIdx++;
-        }
-        else
-        {
-            break;
-        }
-    }
-
-    return continuousTileList;
+    // Whole plane is handed over at once so that tile collisions can be merged in both directions
+    g_pApp->GetGameLogic()->CreateMainPlaneCollisions(tileList, m_PlaneProperties.tilesOnAxisX,
+        m_PlaneProperties.tilePixelWidth, m_PlaneProperties.tilePixelHeight);
 }
 
 TileInfo TilePlaneRenderComponent::GetTileInfo(const TileList& tileList, int tileIdx)
@@ -553,26 +532,37 @@ bool TilePlaneRenderComponent::VDelegateInit(TiXmlElement* pXmlData)
         return false;
     }
     PROFILE_CPU("PLANE CREATION");
-    int32 tileIdx = 0;
 
+    // Temporarily keep track of the tiles stored. Levels loaded through level cache have
+    // their tiles stored in raw arrays, explicit <Tile> elements are supported as well
     TileList tileList;
-    for (TiXmlElement* pTileNode = pTileElements->FirstChildElement(); 
-        pTileNode != NULL; 
-        pTileNode = pTileNode->NextSiblingElement())
+    if (pTileElements->FirstChildElement())
+    {
+        for (TiXmlElement* pTileNode = pTileElements->FirstChildElement();
+            pTileNode != NULL;
+            pTileNode = pTileNode->NextSiblingElement())
+        {
+            tileList.push_back(std::stoi(pTileNode->GetText()));
+        }
+    }
+    else if (const std::vector<int32>* pPlaneTiles =
+        g_pApp->GetGameLogic()->GetCurrentLevelData()->GetPlaneTiles(m_PlaneProperties.name))
     {
-        std::string tileFileName(pTileNode->GetText());
+        tileList.assign(pPlaneTiles->begin(), pPlaneTiles->end());
+    }
 
-        // Temporarily keep track of the tiles stored
-        int32 tileId = std::stoi(tileFileName);
-        tileList.push_back(tileId);
+    bool isFirstLevel = g_pApp->GetGameLogic()->GetCurrentLevelData()->GetLevelNumber() == 1;
+    m_TileImageList.reserve(tileList.size());
+    for (int32 tileId : tileList)
+    {
+        std::string tileFileName = ToStr(tileId);
 
         // Convert to three digits, e.g. "2" -> "002" or "15" -> "015"
         if (tileFileName.length() == 1) 
         { 
             tileFileName = "00" + tileFileName; 
         }
-        else if (tileFileName.length() == 2 &&
-            !(g_pApp->GetGameLogic()->GetCurrentLevelData()->GetLevelNumber() == 1 && tileFileName == "74")) 
+        else if (tileFileName.length() == 2 && !(isFirstLevel && tileFileName == "74")) 
         { 
             tileFileName = "0" + tileFileName; 
         }
@@ -580,25 +570,23 @@ bool TilePlaneRenderComponent::VDelegateInit(TiXmlElement* pXmlData)
         auto findIt = m_ImageMap.find(tileFileName);
         if (findIt != m_ImageMap.end())
         {
-            m_TileImageList.push_back(findIt->second.get());
+            m_TileImageList.push_back(findIt->second);
         }
         else if (tileFileName == "0-1" || tileFileName == "-1")
         {
-            m_TileImageList.push_back(NULL);
+            m_TileImageList.push_back(nullptr);
         }
         else if (m_PlaneProperties.name == "Background") // Use fill color, only aplicable to background
         {
             assert(m_pFillImage != nullptr);
 
-            m_TileImageList.push_back(m_pFillImage.get());
+            m_TileImageList.push_back(m_pFillImage);
         }
         else
         {
             LOG_ERROR("Could not find plane tile: " + tileFileName);
             return false;
         }
-
-        tileIdx++;
     }
 
     if (m_PlaneProperties.isMainPlane)
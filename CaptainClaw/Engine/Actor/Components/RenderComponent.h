@@ -60,16 +60,21 @@ class ActorRenderComponent : public BaseRenderComponent
 {
 public:
     ActorRenderComponent();
+    virtual ~ActorRenderComponent();
 
     static const char* g_Name;
     virtual const char* VGetName() const override { return g_Name; }
 
     virtual bool VDelegateInit(TiXmlElement* pXmlData) override;
+    virtual void VPostInit() override;
+    virtual ActorComponent* VClone() const override;
 
     virtual SDL_Rect VGetPositionRect() const override;
 
     weak_ptr<Image> GetCurrentImage() { return m_CurrentImage; }
     void SetImage(std::string imageName);
+    // Same as SetImage("frameXXX"), image for each id is resolved only once
+    void SetImage(uint32 imageId);
 
     void SetMirrored(bool mirrored) { m_IsMirrored = mirrored; }
 
@@ -91,6 +96,23 @@ protected:
     shared_ptr<Image> m_CurrentImage;
 
 private:
+    // Image by its name with actor specific quirks applied, NULL if there is no such image
+    shared_ptr<Image> FindImage(std::string imageName);
+
+    struct ResolvedFrameImage
+    {
+        ResolvedFrameImage() : isResolved(false) { }
+
+        bool isResolved;
+        shared_ptr<Image> pImage;
+    };
+
+    // Indexed by animation frame image id
+    std::vector<ResolvedFrameImage> m_FrameImages;
+
+    // Images of live actor cannot be evicted, they are pinned once the actor is fully created
+    std::vector<shared_ptr<Image>> m_PinnedImages;
+
     bool m_IsVisible;
     bool m_IsMirrored;
     bool m_IsInverted;
@@ -113,7 +135,7 @@ enum TilePlaneRenderPosition
     TilePlaneRenderPosition_Foreground
 };
 
-typedef std::vector<Image*> TileImageList;
+typedef std::vector<shared_ptr<Image>> TileImageList;
 
 struct TilePlaneProperties
 {
@@ -172,7 +194,6 @@ protected:
 
 private:
     void ProcessMainPlaneTiles(const TileList& tileList);
-    TileList GetAllContinuousTiles(const TileList& tileList, int fromTileIdx);
     TileInfo GetTileInfo(const TileList& tileList, int tileIdx);
 
     // Background, action, foreground
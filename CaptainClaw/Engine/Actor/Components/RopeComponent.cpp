@@ -200,7 +200,7 @@ void RopeComponent::VPostPostInit()
     pTrigger->AddObserver(this);
 }
 
-void RopeComponent::VOnAnimationFrameChanged(Animation* pAnimation, AnimationFrame* pLastFrame, AnimationFrame* pNewFrame)
+void RopeComponent::VOnAnimationFrameChanged(Animation* pAnimation, const AnimationFrame* pLastFrame, const AnimationFrame* pNewFrame)
 {
     Point newPosition = GetRopeEndFramePosition(_owner->GetPositionComponent()->GetPosition(), pNewFrame->idx);
     if (pNewFrame->idx > 60)
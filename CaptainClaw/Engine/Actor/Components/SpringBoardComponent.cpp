@@ -39,7 +39,7 @@ void SpringBoardComponent::VPostInit()
     m_pAnimationComponent->SetAnimation(m_Properties.idleAnimName);
 }
 
-void SpringBoardComponent::VOnAnimationFrameChanged(Animation* pAnimation, AnimationFrame* pLastFrame, AnimationFrame* pNewFrame)
+void SpringBoardComponent::VOnAnimationFrameChanged(Animation* pAnimation, const AnimationFrame* pLastFrame, const AnimationFrame* pNewFrame)
 {
     if (pNewFrame->idx > pLastFrame->idx)
     {
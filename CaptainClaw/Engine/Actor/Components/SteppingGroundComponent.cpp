@@ -42,7 +42,7 @@ void SteppingGroundComponent::VPostInit()
     m_pAnimationComponent->AddObserver(this);
 }
 
-void SteppingGroundComponent::VOnAnimationFrameChanged(Animation* pAnimation, AnimationFrame* pLastFrame, AnimationFrame* pNewFrame)
+void SteppingGroundComponent::VOnAnimationFrameChanged(Animation* pAnimation, const AnimationFrame* pLastFrame, const AnimationFrame* pNewFrame)
 {
     if (pNewFrame->idx > pLastFrame->idx)
     {
@@ -2,6 +2,172 @@
 
 #include "../SharedDefines.h"
 
+// When event processing is time limited, the clock is checked only after this many events
+const unsigned int EVENTMANAGER_TIME_CHECK_INTERVAL = 16;
+
+//---------------------------------------------------------------------------------------------------------------------
+// EventRingQueue::PushBack
+//---------------------------------------------------------------------------------------------------------------------
+void EventRingQueue::PushBack(const IEventDataPtr& pEvent)
+{
+    if (m_Count == m_Buffer.size())
+    {
+        Grow();
+    }
+
+    m_Buffer[(m_Head + m_Count) % m_Buffer.size()] = pEvent;
+    m_Count++;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// EventRingQueue::PushFront
+//---------------------------------------------------------------------------------------------------------------------
+void EventRingQueue::PushFront(const IEventDataPtr& pEvent)
+{
+    if (m_Count == m_Buffer.size())
+    {
+        Grow();
+    }
+
+    m_Head = (m_Head + m_Buffer.size() - 1) % m_Buffer.size();
+    m_Buffer[m_Head] = pEvent;
+    m_Count++;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// EventRingQueue::PopFront
+//---------------------------------------------------------------------------------------------------------------------
+IEventDataPtr EventRingQueue::PopFront()
+{
+    assert(m_Count > 0);
+
+    IEventDataPtr pEvent;
+    pEvent.swap(m_Buffer[m_Head]);
+    m_Head = (m_Head + 1) % m_Buffer.size();
+    m_Count--;
+
+    return pEvent;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// EventRingQueue::PopBack
+//---------------------------------------------------------------------------------------------------------------------
+IEventDataPtr EventRingQueue::PopBack()
+{
+    assert(m_Count > 0);
+
+    IEventDataPtr pEvent;
+    pEvent.swap(m_Buffer[(m_Head + m_Count - 1) % m_Buffer.size()]);
+    m_Count--;
+
+    return pEvent;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// EventRingQueue::RemoveAt
+//---------------------------------------------------------------------------------------------------------------------
+void EventRingQueue::RemoveAt(size_t idx)
+{
+    assert(idx < m_Count);
+
+    // Shift everything behind removed event one slot towards the front to keep the order
+    for (size_t i = idx; i + 1 < m_Count; ++i)
+    {
+        m_Buffer[(m_Head + i) % m_Buffer.size()].swap(m_Buffer[(m_Head + i + 1) % m_Buffer.size()]);
+    }
+
+    m_Buffer[(m_Head + m_Count - 1) % m_Buffer.size()].reset();
+    m_Count--;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// EventRingQueue::Clear
+//---------------------------------------------------------------------------------------------------------------------
+void EventRingQueue::Clear()
+{
+    while (m_Count > 0)
+    {
+        PopFront();
+    }
+
+    m_Head = 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// EventRingQueue::Grow
+//---------------------------------------------------------------------------------------------------------------------
+void EventRingQueue::Grow()
+{
+    std::vector<IEventDataPtr> newBuffer(m_Buffer.empty() ? 64 : m_Buffer.size() * 2);
+    for (size_t i = 0; i < m_Count; ++i)
+    {
+        newBuffer[i].swap(m_Buffer[(m_Head + i) % m_Buffer.size()]);
+    }
+
+    m_Buffer.swap(newBuffer);
+    m_Head = 0;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+// ThreadSafeEventQueue::ThreadSafeEventQueue
+//---------------------------------------------------------------------------------------------------------------------
+ThreadSafeEventQueue::ThreadSafeEventQueue()
+{
+    // Queue always contains one already consumed node so that producers and consumer never touch the same pointer
+    Node* pStub = new Node();
+    pStub->pNext.store(NULL, std::memory_order_relaxed);
+
+    m_pHead.store(pStub, std::memory_order_relaxed);
+    m_pTail = pStub;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// ThreadSafeEventQueue::~ThreadSafeEventQueue
+//---------------------------------------------------------------------------------------------------------------------
+ThreadSafeEventQueue::~ThreadSafeEventQueue()
+{
+    IEventDataPtr pEvent;
+    while (TryPop(pEvent))
+    {
+    }
+
+    delete m_pTail;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// ThreadSafeEventQueue::Push
+//---------------------------------------------------------------------------------------------------------------------
+void ThreadSafeEventQueue::Push(const IEventDataPtr& pEvent)
+{
+    Node* pNode = new Node();
+    pNode->pNext.store(NULL, std::memory_order_relaxed);
+    pNode->pEvent = pEvent;
+
+    Node* pPrevHead = m_pHead.exchange(pNode, std::memory_order_acq_rel);
+    pPrevHead->pNext.store(pNode, std::memory_order_release);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// ThreadSafeEventQueue::TryPop
+//---------------------------------------------------------------------------------------------------------------------
+bool ThreadSafeEventQueue::TryPop(IEventDataPtr& outEvent)
+{
+    Node* pTail = m_pTail;
+    Node* pNext = pTail->pNext.load(std::memory_order_acquire);
+    if (!pNext)
+    {
+        return false;
+    }
+
+    // Next node becomes the consumed one
+    outEvent = std::move(pNext->pEvent);
+    m_pTail = pNext;
+
+    delete pTail;
+    return true;
+}
+
 
 //---------------------------------------------------------------------------------------------------------------------
 // EventMgr::EventMgr
@@ -11,6 +177,8 @@ EventMgr::EventMgr(const char* pName, bool setAsGlobal)
 {
     m_ActiveQueue = 0;
     m_bIsUpdating = false;
+    m_DispatchDepth = 0;
+    m_bHasClearedListeners = false;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -27,7 +195,15 @@ bool EventMgr::VAddListener(const EventListenerDelegate& eventDelegate, const Ev
 {
     //LOG_TAG("Events", "Attempting to add delegate function for event type: " + ToStr(type, 16));
 
-    EventListenerList& eventListenerList = m_EventListeners[type];  // this will find or create the entry
+    uint32_t eventId;
+    if (!FindEventId(type, eventId))
+    {
+        eventId = m_EventListeners.size();
+        m_EventIdMap[type] = eventId;
+        m_EventListeners.push_back(EventListenerList());
+    }
+
+    EventListenerList& eventListenerList = m_EventListeners[eventId];
     for (auto it = eventListenerList.begin(); it != eventListenerList.end(); ++it)
     {
         if (eventDelegate == (*it))
@@ -51,15 +227,24 @@ bool EventMgr::VRemoveListener(const EventListenerDelegate& eventDelegate, const
     //LOG_TAG("Events", "Attempting to remove delegate function from event type: " + ToStr(type, 16));
     bool success = false;
 
-    auto findIt = m_EventListeners.find(type);
-    if (findIt != m_EventListeners.end())
+    uint32_t eventId;
+    if (FindEventId(type, eventId))
     {
-        EventListenerList& listeners = findIt->second;
+        EventListenerList& listeners = m_EventListeners[eventId];
         for (auto it = listeners.begin(); it != listeners.end(); ++it)
         {
             if (eventDelegate == (*it))
             {
-                listeners.erase(it);
+                // Somebody may be iterating this list right now, leave the slot in place
+                if (m_DispatchDepth > 0)
+                {
+                    it->clear();
+                    m_bHasClearedListeners = true;
+                }
+                else
+                {
+                    listeners.erase(it);
+                }
                 //LOG_TAG("Events", "Successfully removed delegate function from event type: " + ToStr(type, 16));
                 success = true;
                 break;  // we don't need to continue because it should be impossible for the same delegate function to be registered for the same event more than once
@@ -77,22 +262,14 @@ bool EventMgr::VRemoveListener(const EventListenerDelegate& eventDelegate, const
 bool EventMgr::VTriggerEvent(const IEventDataPtr& pEvent) const
 {
     //LOG_TAG("Events", "Attempting to trigger event " + std::string(pEvent->GetName()));
-    bool processed = false;
 
-    auto findIt = m_EventListeners.find(pEvent->VGetEventType());
-    if (findIt != m_EventListeners.end())
+    uint32_t eventId;
+    if (!FindEventId(pEvent->VGetEventType(), eventId))
     {
-        const EventListenerList& eventListenerList = findIt->second;
-        for (EventListenerList::const_iterator it = eventListenerList.begin(); it != eventListenerList.end(); ++it)
-        {
-            EventListenerDelegate listener = (*it);
-            //LOG_TAG("Events", "Sending Event " + std::string(pEvent->GetName()) + " to delegate.");
-            listener(pEvent);  // call the delegate
-            processed = true;
-        }
+        return false;
     }
 
-    return processed;
+    return DispatchEvent(eventId, pEvent);
 }
 
 
@@ -113,10 +290,10 @@ bool EventMgr::VQueueEvent(const IEventDataPtr& pEvent)
 
     //LOG_TAG("Events", "Attempting to queue event: " + std::string(pEvent->GetName()));
 
-    auto findIt = m_EventListeners.find(pEvent->VGetEventType());
-    if (findIt != m_EventListeners.end())
+    uint32_t eventId;
+    if (FindEventId(pEvent->VGetEventType(), eventId))
     {
-        m_Queues[m_ActiveQueue].push_back(pEvent);
+        m_Queues[m_ActiveQueue].PushBack(pEvent);
         //LOG_TAG("Events", "Successfully queued event: " + std::string(pEvent->GetName()));
         return true;
     }
@@ -133,7 +310,13 @@ bool EventMgr::VQueueEvent(const IEventDataPtr& pEvent)
 //---------------------------------------------------------------------------------------------------------------------
 bool EventMgr::VThreadSafeQueueEvent(const IEventDataPtr& pEvent)
 {
-    //m_RealtimeEventQueue.push(pEvent);
+    // No logging here, this can be called from any thread
+    if (!pEvent)
+    {
+        return false;
+    }
+
+    m_RealtimeEventQueue.Push(pEvent);
     return true;
 }
 
@@ -147,26 +330,25 @@ bool EventMgr::VAbortEvent(const EventType& inType, bool allOfType)
     assert(m_ActiveQueue < EVENTMANAGER_NUM_QUEUES);
 
     bool success = false;
-    EventListenerMap::iterator findIt = m_EventListeners.find(inType);
 
-    if (findIt != m_EventListeners.end())
+    uint32_t eventId;
+    if (FindEventId(inType, eventId))
     {
-        EventQueue& eventQueue = m_Queues[m_ActiveQueue];
-        auto it = eventQueue.begin();
-        while (it != eventQueue.end())
+        EventRingQueue& eventQueue = m_Queues[m_ActiveQueue];
+        size_t idx = 0;
+        while (idx < eventQueue.Size())
         {
-            // Removing an item from the queue will invalidate the iterator, so have it point to the next member.  All
-            // work inside this loop will be done using thisIt.
-            auto thisIt = it;
-            ++it;
-
-            if ((*thisIt)->VGetEventType() == inType)
+            if (eventQueue.At(idx)->VGetEventType() == inType)
             {
-                eventQueue.erase(thisIt);
+                eventQueue.RemoveAt(idx);
                 success = true;
                 if (!allOfType)
                     break;
             }
+            else
+            {
+                ++idx;
+            }
         }
     }
 
@@ -181,9 +363,9 @@ void EventMgr::VAbortAllEvents()
     assert(m_ActiveQueue >= 0);
     assert(m_ActiveQueue < EVENTMANAGER_NUM_QUEUES);
 
-    for (EventQueue& queue : m_Queues)
+    for (EventRingQueue& queue : m_Queues)
     {
-        queue.clear();
+        queue.Clear();
     }
 }
 
@@ -194,78 +376,79 @@ bool EventMgr::VUpdate(unsigned long maxMillis)
 {
     assert(!m_bIsUpdating && "Attempted to nest updating events - EventMgr::VUpdate inside EventMgr::VUpdate");
 
-    m_bIsUpdating = true;
-    unsigned long currMs = SDL_GetTicks();
-    unsigned long maxMs = ((maxMillis == IEventMgr::kINFINITE) ? (IEventMgr::kINFINITE) : (currMs + maxMillis));
+    if (m_bHasClearedListeners && m_DispatchDepth == 0)
+    {
+        CompactListeners();
+    }
 
-    // This section added to handle events from other threads.  Check out Chapter 20.
-    /*IEventDataPtr pRealtimeEvent;
-    while (m_RealtimeEventQueue.try_pop(pRealtimeEvent))
+    m_bIsUpdating = true;
+    const bool isTimeLimited = (maxMillis != IEventMgr::kINFINITE);
+    unsigned long currMs = isTimeLimited ? SDL_GetTicks() : 0;
+    unsigned long maxMs = isTimeLimited ? (currMs + maxMillis) : (unsigned long)IEventMgr::kINFINITE;
+
+    // Move events posted from other threads to the active queue, they are processed in this update
+    IEventDataPtr pRealtimeEvent;
+    unsigned int numRealtimeEvents = 0;
+    while (m_RealtimeEventQueue.TryPop(pRealtimeEvent))
     {
         VQueueEvent(pRealtimeEvent);
 
-        currMs = GetTickCount();
-        if (maxMillis != IEventManager::kINFINITE)
+        numRealtimeEvents++;
+        if (isTimeLimited && (numRealtimeEvents % EVENTMANAGER_TIME_CHECK_INTERVAL) == 0)
         {
+            currMs = SDL_GetTicks();
             if (currMs >= maxMs)
             {
-                GCC_ERROR("A realtime process is spamming the event manager!");
+                // Rest stays in the realtime queue for the next update
+                LOG_ERROR("A realtime process is spamming the event manager!");
+                break;
             }
         }
-    }*/
+    }
 
     // swap active queues and clear the new queue after the swap
     int queueToProcess = m_ActiveQueue;
     m_ActiveQueue = (m_ActiveQueue + 1) % EVENTMANAGER_NUM_QUEUES;
-    m_Queues[m_ActiveQueue].clear();
+    m_Queues[m_ActiveQueue].Clear();
 
-    //LOG_TAG("EventLoop", "Processing Event Queue " + ToStr(queueToProcess) + "; " + ToStr((unsigned long)m_Queues[queueToProcess].size()) + " events to process");
+    //LOG_TAG("EventLoop", "Processing Event Queue " + ToStr(queueToProcess) + "; " + ToStr((unsigned long)m_Queues[queueToProcess].Size()) + " events to process");
 
     // Process the queue
-    while (!m_Queues[queueToProcess].empty())
+    unsigned int numProcessedEvents = 0;
+    while (!m_Queues[queueToProcess].Empty())
     {
         // pop the front of the queue
-        IEventDataPtr pEvent = m_Queues[queueToProcess].front();
-        m_Queues[queueToProcess].pop_front();
+        IEventDataPtr pEvent = m_Queues[queueToProcess].PopFront();
         //LOG_TAG("EventLoop", "\t\tProcessing Event " + std::string(pEvent->GetName()));
 
-        const EventType& eventType = pEvent->VGetEventType();
-
-        // find all the delegate functions registered for this event
-        auto findIt = m_EventListeners.find(eventType);
-        if (findIt != m_EventListeners.end())
+        // call all the delegate functions registered for this event
+        uint32_t eventId;
+        if (FindEventId(pEvent->VGetEventType(), eventId))
         {
-            const EventListenerList& eventListeners = findIt->second;
-            //LOG_TAG("EventLoop", "\t\tFound " + ToStr((unsigned long)eventListeners.size()) + " delegates");
-
-            // call each listener
-            for (auto it = eventListeners.begin(); it != eventListeners.end(); ++it)
-            {
-                EventListenerDelegate listener = (*it);
-                //LOG_TAG("EventLoop", "\t\tSending event " + std::string(pEvent->GetName()) + " to delegate");
-                listener(pEvent);
-            }
+            DispatchEvent(eventId, pEvent);
         }
 
         // check to see if time ran out
-        currMs = SDL_GetTicks();
-        if (maxMillis != IEventMgr::kINFINITE && currMs >= maxMs)
+        numProcessedEvents++;
+        if (isTimeLimited && (numProcessedEvents % EVENTMANAGER_TIME_CHECK_INTERVAL) == 0)
         {
-            LOG_TAG("EventLoop", "Aborting event processing; time ran out");
-            break;
+            currMs = SDL_GetTicks();
+            if (currMs >= maxMs)
+            {
+                LOG_TAG("EventLoop", "Aborting event processing; time ran out");
+                break;
+            }
         }
     }
 
     // If we couldn't process all of the events, push the remaining events to the new active queue.
     // Note: To preserve sequencing, go back-to-front, inserting them at the head of the active queue
-    bool queueFlushed = (m_Queues[queueToProcess].empty());
+    bool queueFlushed = (m_Queues[queueToProcess].Empty());
     if (!queueFlushed)
     {
-        while (!m_Queues[queueToProcess].empty())
+        while (!m_Queues[queueToProcess].Empty())
         {
-            IEventDataPtr pEvent = m_Queues[queueToProcess].back();
-            m_Queues[queueToProcess].pop_back();
-            m_Queues[m_ActiveQueue].push_front(pEvent);
+            m_Queues[m_ActiveQueue].PushFront(m_Queues[queueToProcess].PopBack());
         }
     }
 
@@ -274,3 +457,57 @@ bool EventMgr::VUpdate(unsigned long maxMillis)
     return queueFlushed;
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+// EventMgr::FindEventId
+//---------------------------------------------------------------------------------------------------------------------
+bool EventMgr::FindEventId(const EventType& type, uint32_t& outEventId) const
+{
+    auto findIt = m_EventIdMap.find(type);
+    if (findIt == m_EventIdMap.end())
+    {
+        return false;
+    }
+
+    outEventId = findIt->second;
+    return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// EventMgr::DispatchEvent
+//---------------------------------------------------------------------------------------------------------------------
+bool EventMgr::DispatchEvent(uint32_t eventId, const IEventDataPtr& pEvent) const
+{
+    bool processed = false;
+
+    // Delegates are free to add or remove listeners, so the table is indexed anew every iteration
+    m_DispatchDepth++;
+    for (size_t listenerIdx = 0; listenerIdx < m_EventListeners[eventId].size(); ++listenerIdx)
+    {
+        EventListenerDelegate listener = m_EventListeners[eventId][listenerIdx];
+        if (listener)
+        {
+            //LOG_TAG("Events", "Sending Event " + std::string(pEvent->GetName()) + " to delegate.");
+            listener(pEvent);  // call the delegate
+            processed = true;
+        }
+    }
+    m_DispatchDepth--;
+
+    return processed;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// EventMgr::CompactListeners
+//---------------------------------------------------------------------------------------------------------------------
+void EventMgr::CompactListeners()
+{
+    assert(m_DispatchDepth == 0);
+
+    for (EventListenerList& listeners : m_EventListeners)
+    {
+        listeners.erase(std::remove_if(listeners.begin(), listeners.end(),
+            [](const EventListenerDelegate& listener) { return listener.empty(); }), listeners.end());
+    }
+
+    m_bHasClearedListeners = false;
+}
@@ -1,13 +1,76 @@
 #ifndef __EVENTMGRIMPL_H__
 #define __EVENTMGRIMPL_H__
 
-#include <map>
-#include <list>
+#include <atomic>
+#include <vector>
+#include <unordered_map>
 
 #include "EventMgr.h"
 
 const unsigned int EVENTMANAGER_NUM_QUEUES = 2;
 
+//---------------------------------------------------------------------------------------------------------------------
+// EventRingQueue
+// FIFO of queued events kept in one circular buffer. The buffer only grows, so once it is large enough queueing an
+// event does not allocate anything.
+//---------------------------------------------------------------------------------------------------------------------
+class EventRingQueue
+{
+public:
+    EventRingQueue() : m_Head(0), m_Count(0) { }
+
+    bool Empty() const { return m_Count == 0; }
+    size_t Size() const { return m_Count; }
+
+    // idx is counted from the front of the queue
+    const IEventDataPtr& At(size_t idx) const { return m_Buffer[(m_Head + idx) % m_Buffer.size()]; }
+
+    void PushBack(const IEventDataPtr& pEvent);
+    void PushFront(const IEventDataPtr& pEvent);
+    IEventDataPtr PopFront();
+    IEventDataPtr PopBack();
+    void RemoveAt(size_t idx);
+    void Clear();
+
+private:
+    void Grow();
+
+    std::vector<IEventDataPtr> m_Buffer;
+    size_t m_Head;
+    size_t m_Count;
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+// ThreadSafeEventQueue
+// Lock-free multiple producer / single consumer queue. Any thread may push, only the thread running
+// EventMgr::VUpdate may pop. Push is one atomic exchange, so producers never wait for each other or for the consumer.
+//---------------------------------------------------------------------------------------------------------------------
+class ThreadSafeEventQueue
+{
+public:
+    ThreadSafeEventQueue();
+    ~ThreadSafeEventQueue();
+
+    void Push(const IEventDataPtr& pEvent);
+
+    // Returns false when there is nothing to pop. Event which is just being pushed may not be visible yet,
+    // it will be popped on the next call.
+    bool TryPop(IEventDataPtr& outEvent);
+
+private:
+    struct Node
+    {
+        std::atomic<Node*> pNext;
+        IEventDataPtr pEvent;
+    };
+
+    ThreadSafeEventQueue(const ThreadSafeEventQueue&);
+    ThreadSafeEventQueue& operator=(const ThreadSafeEventQueue&);
+
+    std::atomic<Node*> m_pHead;     // last pushed node, shared by producers
+    Node* m_pTail;                  // already consumed node, owned by consumer
+};
+
 class EventMgr : public IEventMgr
 {
 public:
@@ -27,16 +90,29 @@ public:
     virtual bool VUpdate(unsigned long maxMilis = kINFINITE) override;
 
 private:
-    typedef std::list<EventListenerDelegate> EventListenerList;
-    typedef std::map<EventType, EventListenerList> EventListenerMap;
-    typedef std::list<IEventDataPtr> EventQueue;
+    // Event types are sparse 32-bit GUIDs, each one gets dense id on its first registration
+    // which indexes the listener table
+    typedef std::vector<EventListenerDelegate> EventListenerList;
+    typedef std::vector<EventListenerList> EventListenerTable;
+    typedef std::unordered_map<EventType, uint32_t> EventIdMap;
+
+    bool FindEventId(const EventType& type, uint32_t& outEventId) const;
+    bool DispatchEvent(uint32_t eventId, const IEventDataPtr& pEvent) const;
+    void CompactListeners();
+
+    EventIdMap m_EventIdMap;
+    EventListenerTable m_EventListeners;
+
+    // Listeners removed while an event is being dispatched are only cleared and they get compacted
+    // once nothing is iterating the listener table
+    mutable uint32_t m_DispatchDepth;
+    bool m_bHasClearedListeners;
 
-    EventListenerMap m_EventListeners;
-    EventQueue m_Queues[EVENTMANAGER_NUM_QUEUES];
+    EventRingQueue m_Queues[EVENTMANAGER_NUM_QUEUES];
     int m_ActiveQueue;  // index of actively processing queue; events enque to the opposing queue
     bool m_bIsUpdating;
 
-    //ThreadSafeEventQueue m_realtimeEventQueue;
+    ThreadSafeEventQueue m_RealtimeEventQueue;
 };
 
-#endif
\ No newline at end of file
+#endif
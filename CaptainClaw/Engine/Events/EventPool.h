@@ -0,0 +1,123 @@
+#ifndef __EVENT_POOL_H__
+#define __EVENT_POOL_H__
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+//---------------------------------------------------------------------------------------------------------------------
+// EventBlockPool
+// Free list of equally sized memory blocks. Blocks are allocated in chunks and never returned to the system, so
+// after a few frames frequently sent events stop hitting the heap. Events can be created from helper threads
+// (delayed events, music loading), hence the lock.
+//---------------------------------------------------------------------------------------------------------------------
+template <size_t BlockSize>
+class EventBlockPool
+{
+public:
+    static EventBlockPool& Get()
+    {
+        // Intentionally leaked - events can still be released during static destruction
+        static EventBlockPool* s_pPool = new EventBlockPool();
+        return *s_pPool;
+    }
+
+    void* Allocate()
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        if (!m_pFreeList)
+        {
+            AllocateChunk();
+        }
+
+        FreeBlock* pBlock = m_pFreeList;
+        m_pFreeList = pBlock->pNext;
+        return pBlock;
+    }
+
+    void Free(void* pMemory)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        FreeBlock* pBlock = static_cast<FreeBlock*>(pMemory);
+        pBlock->pNext = m_pFreeList;
+        m_pFreeList = pBlock;
+    }
+
+private:
+    union FreeBlock
+    {
+        FreeBlock* pNext;
+        typename std::aligned_storage<BlockSize>::type storage;
+    };
+
+    static const size_t s_BlocksPerChunk = 64;
+
+    EventBlockPool() : m_pFreeList(NULL) { }
+
+    void AllocateChunk()
+    {
+        FreeBlock* pChunk = static_cast<FreeBlock*>(::operator new(sizeof(FreeBlock) * s_BlocksPerChunk));
+        for (size_t blockIdx = 0; blockIdx < s_BlocksPerChunk; ++blockIdx)
+        {
+            pChunk[blockIdx].pNext = m_pFreeList;
+            m_pFreeList = &pChunk[blockIdx];
+        }
+    }
+
+    std::mutex m_Mutex;
+    FreeBlock* m_pFreeList;
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+// EventPoolAllocator
+// Allocator handed to std::allocate_shared. Event object and its shared_ptr control block end up in a single pooled
+// block, one pool per event type.
+//---------------------------------------------------------------------------------------------------------------------
+template <class T>
+class EventPoolAllocator
+{
+public:
+    typedef T value_type;
+
+    EventPoolAllocator() { }
+    template <class U> EventPoolAllocator(const EventPoolAllocator<U>&) { }
+
+    T* allocate(size_t count)
+    {
+        if (count != 1)
+        {
+            return static_cast<T*>(::operator new(sizeof(T) * count));
+        }
+
+        return static_cast<T*>(EventBlockPool<sizeof(T)>::Get().Allocate());
+    }
+
+    void deallocate(T* pMemory, size_t count)
+    {
+        if (count != 1)
+        {
+            ::operator delete(pMemory);
+            return;
+        }
+
+        EventBlockPool<sizeof(T)>::Get().Free(pMemory);
+    }
+};
+
+template <class T, class U>
+bool operator==(const EventPoolAllocator<T>&, const EventPoolAllocator<U>&) { return true; }
+template <class T, class U>
+bool operator!=(const EventPoolAllocator<T>&, const EventPoolAllocator<U>&) { return false; }
+
+// Use instead of IEventDataPtr(new EventData_Xxx(...)) for events which are sent many times per frame
+template <class EventClass, class... Args>
+std::shared_ptr<EventClass> MakePooledEvent(Args&&... args)
+{
+    return std::allocate_shared<EventClass>(EventPoolAllocator<EventClass>(), std::forward<Args>(args)...);
+}
+
+#endif
@@ -6,6 +6,7 @@
 #include "../Scene/HUDSceneNode.h"
 
 #include "EventMgr.h"
+#include "EventPool.h"
 
 // Auxiliary data decls ...
 //
@@ -232,6 +233,78 @@ private:
 };
 
 
+//---------------------------------------------------------------------------------------------------------------------
+// EventData_Move_Actor_Batch - sent once per physics sync with all actors moved by physics during that step,
+// listeners get one call instead of one EventData_Move_Actor per moving body
+//---------------------------------------------------------------------------------------------------------------------
+class EventData_Move_Actor_Batch : public BaseEventData
+{
+public:
+    static const EventType sk_EventType;
+
+    typedef std::vector<std::pair<uint32_t, Point>> ActorMoveList;
+
+    virtual const EventType& VGetEventType(void) const
+    {
+        return sk_EventType;
+    }
+
+    EventData_Move_Actor_Batch(void) { }
+
+    explicit EventData_Move_Actor_Batch(const ActorMoveList& moves)
+        : m_Moves(moves)
+    {
+        //
+    }
+
+    virtual void VSerialize(std::ostringstream &out) const
+    {
+        out << m_Moves.size() << " ";
+        for (const auto& move : m_Moves)
+        {
+            out << move.first << " ";
+            out << move.second.x << " ";
+            out << move.second.y << " ";
+        }
+    }
+
+    virtual void VDeserialize(std::istringstream& in)
+    {
+        size_t numMoves = 0;
+        in >> numMoves;
+        m_Moves.resize(numMoves);
+        for (auto& move : m_Moves)
+        {
+            in >> move.first;
+            in >> move.second.x;
+            in >> move.second.y;
+        }
+    }
+
+    virtual IEventDataPtr VCopy() const
+    {
+        return IEventDataPtr(new EventData_Move_Actor_Batch(m_Moves));
+    }
+
+    virtual const char* GetName(void) const
+    {
+        return "EventData_Move_Actor_Batch";
+    }
+
+    void AddMove(uint32_t id, const Point& move) { m_Moves.push_back(std::make_pair(id, move)); }
+    void Clear() { m_Moves.clear(); }
+    bool IsEmpty() const { return m_Moves.empty(); }
+
+    const ActorMoveList& GetMoves(void) const
+    {
+        return m_Moves;
+    }
+
+private:
+    ActorMoveList m_Moves;
+};
+
+
 //---------------------------------------------------------------------------------------------------------------------
 // EventData_New_Render_Component - This event is sent out when an actor is *actually* created.
 //---------------------------------------------------------------------------------------------------------------------
@@ -999,53 +1072,6 @@ private:
     uint32 m_ActorId;
 };
 
-//---------------------------------------------------------------------------------------------------------------------
-// EventData_Collideable_Tile_Created - sent when collidable tile has been created
-//---------------------------------------------------------------------------------------------------------------------
-class EventData_Collideable_Tile_Created : public BaseEventData
-{
-public:
-    static const EventType sk_EventType;
-
-    EventData_Collideable_Tile_Created(void)
-    {
-        m_TileId = -1;
-        m_PositionX = 0;
-        m_PositionY = 0;
-        m_TilesCount = 0;
-    }
-
-    EventData_Collideable_Tile_Created(int32 tileId, int32 positionX, int32 positionY, int tilesCount)
-    {
-        m_TileId = tileId;
-        m_PositionX = positionX;
-        m_PositionY = positionY;
-        m_TilesCount = tilesCount;
-    }
-
-    virtual const EventType& VGetEventType(void) const { return sk_EventType; }
-
-    virtual IEventDataPtr VCopy() const
-    {
-        return IEventDataPtr(new EventData_Collideable_Tile_Created(m_TileId, m_PositionX, m_PositionY, m_TilesCount));
-    }
-
-    virtual void VSerialize(std::ostringstream& out) const { out << m_TileId << " " << m_PositionX << " " << m_PositionY << m_TilesCount; }
-    virtual void VDeserialize(std::istringstream& in) { in >> m_TileId >> m_PositionX >> m_PositionY >> m_TilesCount; }
-    virtual const char* GetName(void) const { return "EventData_Collideable_Tile_Created"; }
-
-    int32 GetTileId(void) const { return m_TileId; }
-    int32 GetPositionX(void) const { return m_PositionX; }
-    int32 GetPositionY(void) const { return m_PositionY; }
-    int32 GetTilesCount() { return m_TilesCount; }
-
-private:
-    int32 m_TileId;
-    int32 m_PositionX;
-    int32 m_PositionY;
-    int32 m_TilesCount;
-};
-
 //---------------------------------------------------------------------------------------------------------------------
 // EventData_Add_Static_Geometry
 //---------------------------------------------------------------------------------------------------------------------
@@ -7,6 +7,7 @@
 #include "../UserInterface/HumanView.h"
 #include "../Resource/ResourceMgr.h"
 #include "../Graphics2D/Image.h"
+#include "../Graphics2D/TextureResidencyManager.h"
 
 // Resource loaders
 #include "../Resource/Loaders/DefaultLoader.h"
@@ -19,6 +20,7 @@
 #include "../Resource/Loaders/MidiLoader.h"
 #include "../Resource/Loaders/PcxLoader.h"
 #include "../Resource/Loaders/PngLoader.h"
+#include "../Resource/Miniz.h"
 
 #include "BaseGameApp.h"
 
@@ -38,15 +40,18 @@ BaseGameApp::BaseGameApp()
 
     m_pGame = NULL;
     m_pResourceCache = NULL;
+    m_pTextureResidencyMgr = NULL;
     m_pEventMgr = NULL;
     m_pWindow = NULL;
     m_pRenderer = NULL;
     m_pPalette = NULL;
+    m_PaletteChecksum = 0;
     m_pAudio = NULL;
     m_pConsoleFont = NULL;
     m_IsRunning = false;
     m_QuitRequested = false;
     m_IsQuitting = false;
+    m_ActorPrototypesChecksum = 0;
 }
 
 bool BaseGameApp::Initialize(int argc, char** argv)
@@ -96,6 +101,8 @@ void BaseGameApp::Terminate()
     RemoveAllDelegates();
 
     SAFE_DELETE(m_pGame);
+    // Images which are still alive are left be, their textures go away with the renderer
+    SAFE_DELETE(m_pTextureResidencyMgr);
     SDL_DestroyRenderer(m_pRenderer);
     SDL_DestroyWindow(m_pWindow);
     SAFE_DELETE(m_pAudio);
@@ -266,6 +273,21 @@ void BaseGameApp::OnEvent(SDL_Event& event)
             break;
         }
 
+        // Contents of render target textures are lost, views have to render them again
+        case SDL_RENDER_TARGETS_RESET:
+        case SDL_RENDER_DEVICE_RESET:
+        {
+            LOG_WARNING("Render targets were reset");
+            if (m_pGame)
+            {
+                for (auto pGameView : m_pGame->m_GameViews)
+                {
+                    pGameView->VOnLostDevice();
+                }
+            }
+            break;
+        }
+
         case SDL_APP_LOWMEMORY:
         {
             LOG_WARNING("Running low on memory");
@@ -389,6 +411,20 @@ bool BaseGameApp::LoadGameOptions(const char* inConfigFile)
             displayElem->FirstChildElement("IsFullscreenDesktop"));
     }
 
+    //-------------------------------------------------------------------------
+    // Simulation
+    //-------------------------------------------------------------------------
+    TiXmlElement* simulationElem = configRoot->FirstChildElement("Simulation");
+    if (simulationElem)
+    {
+        ParseValueFromXmlElem(&m_GameOptions.useFixedTimestep,
+            simulationElem->FirstChildElement("UseFixedTimestep"));
+        ParseValueFromXmlElem(&m_GameOptions.fixedTimestepHz,
+            simulationElem->FirstChildElement("FixedTimestepHz"));
+        ParseValueFromXmlElem(&m_GameOptions.maxSimulationSubsteps,
+            simulationElem->FirstChildElement("MaxSimulationSubsteps"));
+    }
+
     //-------------------------------------------------------------------------
     // Audio
     //-------------------------------------------------------------------------
@@ -429,8 +465,16 @@ bool BaseGameApp::LoadGameOptions(const char* inConfigFile)
             assetsElem->FirstChildElement("CustomArchive")));
         assert(ParseValueFromXmlElem(&m_GameOptions.resourceCacheSize,
             assetsElem->FirstChildElement("ResourceCacheSize")));
+        ParseValueFromXmlElem(&m_GameOptions.mapRezArchive,
+            assetsElem->FirstChildElement("MapRezArchive"));
         ParseValueFromXmlElem(&m_GameOptions.tempDir,
             assetsElem->FirstChildElement("TempDir"));
+        ParseValueFromXmlElem(&m_GameOptions.exportLevelXml,
+            assetsElem->FirstChildElement("ExportLevelXml"));
+        ParseValueFromXmlElem(&m_GameOptions.useDecodedAssetCache,
+            assetsElem->FirstChildElement("UseDecodedAssetCache"));
+        ParseValueFromXmlElem(&m_GameOptions.textureMemoryBudget,
+            assetsElem->FirstChildElement("TextureMemoryBudget"));
         assert(ParseValueFromXmlElem(&m_GameOptions.savesFile,
             assetsElem->FirstChildElement("SavesFile")));
     }
@@ -573,7 +617,6 @@ void BaseGameApp::RegisterEngineEvents()
     REGISTER_EVENT(EventData_Request_New_Actor);
     REGISTER_EVENT(EventData_Network_Player_Actor_Assignment);
     REGISTER_EVENT(EventData_Attach_Actor);
-    REGISTER_EVENT(EventData_Collideable_Tile_Created);
     REGISTER_EVENT(EventData_Start_Climb);
     REGISTER_EVENT(EventData_Actor_Fire);
     REGISTER_EVENT(EventData_Actor_Attack);
@@ -680,9 +723,12 @@ bool BaseGameApp::InitializeResources(GameOptions& gameOptions)
         return false;
     }
 
+    // Has to exist before any image is created so that all of them are accounted for
+    m_pTextureResidencyMgr = new TextureResidencyManager(m_pRenderer, (uint64)gameOptions.textureMemoryBudget * 1024 * 1024);
+
     std::string rezArchivePath = gameOptions.assetsFolder + gameOptions.rezArchive;
 
-    IResourceFile* rezArchive = new ResourceRezArchive(rezArchivePath);
+    IResourceFile* rezArchive = new ResourceRezArchive(rezArchivePath, gameOptions.mapRezArchive);
 
     m_pResourceCache = new ResourceCache(gameOptions.resourceCacheSize, rezArchive, ORIGINAL_RESOURCE);
     if (!m_pResourceCache->Init())
@@ -701,6 +747,15 @@ bool BaseGameApp::InitializeResources(GameOptions& gameOptions)
     m_pResourceCache->RegisterLoader(MidiResourceLoader::Create());
     m_pResourceCache->RegisterLoader(PcxResourceLoader::Create());
 
+    if (gameOptions.useDecodedAssetCache)
+    {
+        shared_ptr<DecodedAssetCache> pDecodedAssetCache(new DecodedAssetCache(gameOptions.tempDir + "/DecodedAssets"));
+        if (pDecodedAssetCache->Init())
+        {
+            m_pResourceCache->SetDecodedAssetCache(pDecodedAssetCache);
+        }
+    }
+
     std::string customArchivePath = gameOptions.assetsFolder + gameOptions.customArchive;
 
     IResourceFile* pCustomArchive = new ResourceZipArchive(customArchivePath);
@@ -795,6 +850,16 @@ bool BaseGameApp::ReadActorXmlPrototypes(GameOptions& gameOptions)
         }
     }
 
+    // Map is ordered by prototype, so the checksum does not depend on order of the files
+    m_ActorPrototypesChecksum = MZ_CRC32_INIT;
+    for (auto& actorProtoIter : m_ActorXmlPrototypeMap)
+    {
+        TiXmlPrinter printer;
+        actorProtoIter.second->Accept(&printer);
+        m_ActorPrototypesChecksum = (uint32)mz_crc32(m_ActorPrototypesChecksum,
+            (const unsigned char*)printer.CStr(), printer.Size());
+    }
+
     bool loadedAllRequired = true;
 
     // When I provide specific purpose API, I should be very dilligent
@@ -839,6 +904,15 @@ bool BaseGameApp::InitializeEventMgr()
     return true;
 }
 
+void BaseGameApp::SetCurrentPalette(WapPal* palette)
+{
+    m_pPalette = palette;
+
+    // Palettes do not change once loaded, so the checksum is calculated only once per palette switch
+    m_PaletteChecksum = palette != NULL ?
+        (uint32)mz_crc32(MZ_CRC32_INIT, (const unsigned char*)palette->colors, sizeof(palette->colors)) : 0;
+}
+
 Point BaseGameApp::GetScale()
 {
     float scaleX, scaleY;
@@ -965,6 +1039,22 @@ private:
 // Remark: Caller is getting a NEW copy of the prototype -> caller is responsible for freeing this copy !
 TiXmlElement* BaseGameApp::GetActorPrototypeElem(ActorPrototype proto)
 {
+    const TiXmlElement* pResolvedElem = GetResolvedActorPrototypeElem(proto);
+    assert(pResolvedElem != NULL);
+
+    return pResolvedElem->Clone()->ToElement();
+}
+
+// Merging parent prototypes is done only once per prototype, resolved prototypes are kept
+// for the lifetime of the application just like the raw ones
+const TiXmlElement* BaseGameApp::GetResolvedActorPrototypeElem(ActorPrototype proto)
+{
+    auto resolvedIt = m_ResolvedActorPrototypeMap.find(proto);
+    if (resolvedIt != m_ResolvedActorPrototypeMap.end())
+    {
+        return resolvedIt->second;
+    }
+
     auto findIt = m_ActorXmlPrototypeMap.find(proto);
     assert(findIt != m_ActorXmlPrototypeMap.end());
 
@@ -978,7 +1068,7 @@ TiXmlElement* BaseGameApp::GetActorPrototypeElem(ActorPrototype proto)
     if (pRootElem->Attribute("Parent") != NULL)
     {
         ActorPrototype parentProto = StringToEnum_ActorPrototype(pRootElem->Attribute("Parent"));
-        TiXmlElement* pParentRootElem = GetActorPrototypeElem(parentProto);
+        TiXmlElement* pParentRootElem = GetResolvedActorPrototypeElem(parentProto)->Clone()->ToElement();
         assert(pParentRootElem != NULL);
 
         // Merge changes from child to parent (child contains only delta changes)
@@ -994,10 +1084,12 @@ TiXmlElement* BaseGameApp::GetActorPrototypeElem(ActorPrototype proto)
 
         //pParentRootElem->Print(stdout, -1);
 
-        return pParentRootElem;
+        pRootElem = pParentRootElem;
     }
 
-    return pCopy->ToElement();
+    m_ResolvedActorPrototypeMap.insert(std::make_pair(proto, pRootElem));
+
+    return pRootElem;
 }
 
 //=====================================================================================================================
@@ -1071,6 +1163,8 @@ TiXmlElement* CreateDefaultAssetsConfig()
 
     XML_ADD_TEXT_ELEMENT("RezArchive", "CLAW.REZ", assets);
     XML_ADD_TEXT_ELEMENT("ResourceCacheSize", "50", assets);
+    XML_ADD_TEXT_ELEMENT("TextureMemoryBudget", "256", assets);
+    XML_ADD_TEXT_ELEMENT("MapRezArchive", "true", assets);
     XML_ADD_TEXT_ELEMENT("TempDir", ".", assets);
     XML_ADD_TEXT_ELEMENT("SavesFile", "SAVES.XML", assets);
 
@@ -23,6 +23,10 @@ struct GameOptions
         isFullscreen = false;
         isFullscreenDesktop = false;
 
+        useFixedTimestep = false;
+        fixedTimestepHz = 120;
+        maxSimulationSubsteps = 5;
+
         frequency = 44100;
         soundChannels = 2;
         mixingChannels = 24;
@@ -40,7 +44,11 @@ struct GameOptions
         rezArchive = "CLAW.REZ";
         customArchive = "ASSETS.ZIP";
         resourceCacheSize = 50;
+        mapRezArchive = true;
         tempDir = ".";
+        exportLevelXml = false;
+        useDecodedAssetCache = true;
+        textureMemoryBudget = 256;
         savesFile = "SAVES.XML";
 
         startupCommandsFile = "startup_commands.txt";
@@ -59,6 +67,13 @@ struct GameOptions
     bool isFullscreen;
     bool isFullscreenDesktop;
 
+    // Simulation
+    // Whether game logic should advance in fixed steps with actor positions interpolated between them when rendering
+    bool useFixedTimestep;
+    unsigned fixedTimestepHz;
+    // Max simulation steps per frame, remaining time is dropped when game can not keep up
+    unsigned maxSimulationSubsteps;
+
     // Audio
     unsigned frequency;
     unsigned soundChannels;
@@ -80,7 +95,15 @@ struct GameOptions
     std::string rezArchive;
     std::string customArchive;
     unsigned resourceCacheSize;
+    // Whether REZ archive should be memory-mapped so that its resources can be read without copying
+    bool mapRezArchive;
     std::string tempDir;
+    // Whether converted levels should be also saved as XML into temp directory, used only for debugging
+    bool exportLevelXml;
+    // Whether decoded assets (e.g. images, music) should be cached in temp directory for subsequent runs
+    bool useDecodedAssetCache;
+    // Video memory in MB which textures can take before the least recently drawn ones are evicted, 0 means unlimited
+    unsigned textureMemoryBudget;
     std::string savesFile;
 
     // Console config
@@ -155,6 +178,7 @@ class BaseGameLogic;
 class HumanView;
 class ResourceCache;
 class IResourceMgr;
+class TextureResidencyManager;
 class Audio;
 
 typedef std::map<std::string, std::string> LocalizedStringsMap;
@@ -199,9 +223,12 @@ public:
     inline SDL_Renderer* GetRenderer() const { return m_pRenderer; }
     // TODO: Memory leak most likely
     inline WapPal* GetCurrentPalette() const { return m_pPalette; }
-    void SetCurrentPalette(WapPal* palette) { m_pPalette = palette; }
+    void SetCurrentPalette(WapPal* palette);
+    // Checksum of current palette colors, 0 if there is no palette
+    inline uint32 GetCurrentPaletteChecksum() const { return m_PaletteChecksum; }
     inline ResourceCache* GetResourceCache() const { return m_pResourceCache; }
     inline IResourceMgr* GetResourceMgr() const { return m_pResourceMgr; }
+    inline TextureResidencyManager* GetTextureResidencyManager() const { return m_pTextureResidencyMgr; }
 
     BaseGameLogic* GetGameLogic() const { return m_pGame; }
     HumanView* GetHumanView() const;
@@ -229,7 +256,10 @@ public:
     const GameOptions* GetGameConfig() const { return &m_GameOptions; }
     GlobalOptions* GetGlobalOptions() { return &m_GlobalOptions; }
 
+    // Returns copy of the prototype with its parent prototypes already merged in
     TiXmlElement* GetActorPrototypeElem(ActorPrototype proto);
+    // Checksum of all loaded prototype xmls, changes whenever any of the prototypes changes
+    uint32 GetActorPrototypesChecksum() const { return m_ActorPrototypesChecksum; }
 
 protected:
     virtual void VRegisterGameEvents() { }
@@ -238,6 +268,7 @@ protected:
     BaseGameLogic* m_pGame;
     ResourceCache* m_pResourceCache;
     IResourceMgr* m_pResourceMgr; // This should replace m_pResourceCache since it wraps it
+    TextureResidencyManager* m_pTextureResidencyMgr;
     EventMgr* m_pEventMgr;
     TTF_Font* m_pConsoleFont;
     Audio* m_pAudio;
@@ -258,6 +289,7 @@ private:
     bool InitializeEventMgr();
     bool ReadConsoleConfig();
     bool ReadActorXmlPrototypes(GameOptions& gameOptions);
+    const TiXmlElement* GetResolvedActorPrototypeElem(ActorPrototype proto);
 
     void RegisterEngineEvents();
 
@@ -272,6 +304,7 @@ private:
     SDL_Window* m_pWindow;
     SDL_Renderer* m_pRenderer;
     WapPal* m_pPalette;
+    uint32 m_PaletteChecksum;
 
     bool m_IsRunning;
     bool m_QuitRequested;
@@ -283,6 +316,10 @@ private:
     GlobalOptions m_GlobalOptions;
 
     ActorXmlPrototypeMap m_ActorXmlPrototypeMap;
+    uint32 m_ActorPrototypesChecksum;
+
+    // Prototypes with resolved inheritance, built on first request
+    ActorXmlPrototypeMap m_ResolvedActorPrototypeMap;
 };
 
 extern BaseGameApp* g_pApp;
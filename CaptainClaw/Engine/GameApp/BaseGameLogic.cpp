@@ -17,14 +17,18 @@
 #include "../Actor/Components/ControllerComponents/LifeComponent.h"
 #include "../Actor/Components/ControllerComponents/AmmoComponent.h"
 #include "../Actor/Components/ControllableComponent.h"
+#include "../Actor/Components/AnimationComponent.h"
+#include "../Actor/Components/KinematicComponent.h"
 
 #include "../Util/Converters.h"
 
 #include "GameSaves.h"
 #include "BaseGameLogic.h"
 #include "GameSaves.h"
+#include "LevelCache.h"
 
 #include "../Physics/ClawPhysics.h"
+#include "../Physics/TileCollisionGrid.h"
 
 #include <algorithm>
 #include <fstream>
@@ -51,9 +55,24 @@ BaseGameLogic::BaseGameLogic()
     m_RenderDiagnostics = true;
     m_SelectedLevel = -1;
     m_bRunning = true;
+    m_SimulationTick = 0;
+    m_SimulationTimeAccumulator = 0;
+    m_InterpolationAlpha = 1.0f;
+    m_ActorUpdateOrderDirty = true;
+    m_IsUpdatingActors = false;
 
     m_pGameSaveMgr.reset(new GameSaveMgr());
 
+    m_pAnimationSystem.reset(new AnimationSystem());
+    m_pKinematicSystem.reset(new KinematicSystem());
+
+    m_ComponentSystemStages.push_back({ ActorComponent::GetIdFromName(AnimationComponent::g_Name),
+        [this](uint32 msDiff) { m_pAnimationSystem->Update(msDiff); } });
+    m_ComponentSystemStages.push_back({ ActorComponent::GetIdFromName(KinematicComponent::g_Name),
+        [this](uint32 msDiff) { m_pKinematicSystem->Update(msDiff); } });
+    std::sort(m_ComponentSystemStages.begin(), m_ComponentSystemStages.end(),
+        [](const ComponentSystemStage& left, const ComponentSystemStage& right) { return left.componentId < right.componentId; });
+
     //RegisterEngineScriptEvents();
     RegisterAllDelegates();
 }
@@ -74,6 +93,7 @@ BaseGameLogic::~BaseGameLogic()
         actorIter.second->Destroy();
     }
     m_ActorMap.clear();
+    m_ActorUpdateOrder.clear();
 
     RemoveAllDelegates();
 
@@ -183,7 +203,55 @@ void RenderLoadingScreen(shared_ptr<Image> pBackground, SDL_Rect& renderRect, Po
     SDL_DestroyTexture(pRemainingProgressBar);
 }
 
+// Loading screen which is being updated while level resources are preloaded
+struct PreloadLoadingScreen
+{
+    shared_ptr<Image> pBackground;
+    SDL_Rect renderRect;
+    Point scale;
+    float progressFrom;
+    float progressTo;
+};
+
+static PreloadLoadingScreen* s_pPreloadLoadingScreen = NULL;
+
+static void OnLevelPreloadProgress(int32 progress, bool& cancel)
+{
+    if (s_pPreloadLoadingScreen == NULL)
+    {
+        return;
+    }
+
+    float progressRange = s_pPreloadLoadingScreen->progressTo - s_pPreloadLoadingScreen->progressFrom;
+    RenderLoadingScreen(
+        s_pPreloadLoadingScreen->pBackground,
+        s_pPreloadLoadingScreen->renderRect,
+        s_pPreloadLoadingScreen->scale,
+        s_pPreloadLoadingScreen->progressFrom + (progressRange * progress) / 100.0f);
+}
+
 bool BaseGameLogic::VLoadGame(const char* xmlLevelResource)
+{
+    // Level is going to be loaded from XML WWD
+    TiXmlElement* pXmlLevelRoot = XmlResourceLoader::LoadAndReturnRootXmlElement(xmlLevelResource, true);
+    if (pXmlLevelRoot == NULL)
+    {
+        LOG_ERROR("Could not load level resource file: " + std::string(xmlLevelResource));
+        return false;
+    }
+
+    shared_ptr<LevelCache> pLevel = LevelCache::CreateFromXml(pXmlLevelRoot, 0, 0);
+    delete pXmlLevelRoot->GetDocument();
+    if (!pLevel)
+    {
+        LOG_ERROR("Level: " + std::string(xmlLevelResource) + " is not valid.");
+        return false;
+    }
+
+    return LoadLevel(pLevel);
+}
+
+bool BaseGameLogic::LoadLevel(shared_ptr<LevelCache> pLevel)
 {
     PROFILE_CPU("GAME LOADING");
     PROFILE_MEMORY("GAME LOADING");
@@ -191,15 +259,12 @@ bool BaseGameLogic::VLoadGame(const char* xmlLevelResource)
     // Stop all audio
     g_pApp->GetAudio()->StopAllSounds();
 
+    m_pActorFactory->ClearCompiledPrototypes();
     m_pPhysics.reset(CreateClawPhysics());
 
     float loadingProgress = 0.0f;
     float lastProgress = 0.0f;
 
-    // Preload level resources
-    std::string levelPath = "/LEVEL" + ToStr(m_pCurrentLevel->GetLevelNumber()) + "/*";
-    g_pApp->GetResourceCache()->Preload(levelPath, NULL);
-
     // Start rendering the loading screen
     Point windowSize = g_pApp->GetWindowSize();
     Point scale = g_pApp->GetScale();
@@ -214,21 +279,11 @@ bool BaseGameLogic::VLoadGame(const char* xmlLevelResource)
 
     RenderLoadingScreen(pBackgroundImage, backgroundRect, scale, loadingProgress);
 
-    // Level is going to be loaded from XML WWD
-    TiXmlElement* pXmlLevelRoot = XmlResourceLoader::LoadAndReturnRootXmlElement(xmlLevelResource, true);
-    if (pXmlLevelRoot == NULL)
-    {
-        LOG_ERROR("Could not load level resource file: " + std::string(xmlLevelResource));
-        return false;
-    }
+    TiXmlElement* pXmlLevelRoot = pLevel->GetLevelRoot();
 
     // Get level palette
     TiXmlElement* pLevelProperties = pXmlLevelRoot->FirstChildElement("LevelProperties");
-    if (!pLevelProperties)
-    {
-        LOG_ERROR("Level: " + std::string(xmlLevelResource) + " does not have level properties node.");
-        return false;
-    }
+    assert(pLevelProperties != NULL && "Level cache is always created with level properties");
 
     if (TiXmlElement* pLevelNameElem = pLevelProperties->FirstChildElement("LevelName"))
     {
@@ -243,59 +298,38 @@ bool BaseGameLogic::VLoadGame(const char* xmlLevelResource)
         m_pCurrentLevel->m_LevelCreatedDate = pLevelCreatedDateElem->GetText();
     }
 
-    // Tile descriptions
-    if (TiXmlElement* pTileDescRootElem = pLevelProperties->FirstChildElement("TileDescriptions"))
-    {
-        for (TiXmlElement* pTileDescElem = pTileDescRootElem->FirstChildElement("TileDescription");
-            pTileDescElem; pTileDescElem = pTileDescElem->NextSiblingElement("TileDescription"))
-        {
-
-            // Maybe code more deffensively here, revisit in future probably.. right now I dont want to
-            // add 10000 conditions to assert correct xml format
-
-            // TileDescription will maybe be used by editor, it is not used directly by game
-            //    but only to parse TileCollisionPrototype from it which is used by physics subsystem
-            TileDescription tileDesc;
-            tileDesc.tileId = std::stoi(pTileDescElem->FirstChildElement("TileId")->GetText());
+    // Tile descriptions and plane tiles are already parsed by level cache
+    m_pCurrentLevel->m_TileDescriptionMap = pLevel->GetTileDescriptions();
+    m_pCurrentLevel->m_PlaneTilesMap = pLevel->GetPlaneTiles();
 
-            TiXmlElement* pTileSizeElem = pTileDescElem->FirstChildElement("Size");
-            tileDesc.width = std::stoi(pTileSizeElem->Attribute("width"));
-            tileDesc.height = std::stoi(pTileSizeElem->Attribute("height"));
-
-            if (std::string(pTileDescElem->FirstChildElement("Type")->GetText()) == "single")
-            {
-                tileDesc.type = WAP_TILE_TYPE_SINGLE;
-            }
-            else
-            {
-                tileDesc.type = WAP_TILE_TYPE_DOUBLE;
-                tileDesc.outsideAttrib = std::stoi(pTileDescElem->FirstChildElement("OutsideAttrib")->GetText());
-            }
-            tileDesc.insideAttrib = std::stoi(pTileDescElem->FirstChildElement("InsideAttrib")->GetText());
+    // TileDescription will maybe be used by editor, it is not used directly by game
+    //    but only to parse TileCollisionPrototype from it which is used by physics subsystem
+    for (auto& tileDescIter : m_pCurrentLevel->m_TileDescriptionMap)
+    {
+        TileDescription& tileDesc = tileDescIter.second;
 
-            TiXmlElement* pTileRectElem = pTileDescElem->FirstChildElement("TileRect");
-            tileDesc.rect.left = std::stoi(pTileRectElem->Attribute("left"));
-            tileDesc.rect.top = std::stoi(pTileRectElem->Attribute("top"));
-            tileDesc.rect.right = std::stoi(pTileRectElem->Attribute("right"));
-            tileDesc.rect.bottom = std::stoi(pTileRectElem->Attribute("bottom"));
+        // This structure is actually used in game in order to prevent recalculating the collision rects
+        //    over and over again
+        TileCollisionPrototype tileProto;
+        tileProto.id = tileDesc.tileId;
+        tileProto.width = tileDesc.width;
+        tileProto.height = tileDesc.height;
+        Util::ParseCollisionRectanglesFromTile(&tileProto, &tileDesc);
 
-            m_pCurrentLevel->m_TileDescriptionMap.insert(std::make_pair(tileDesc.tileId, tileDesc));
+        m_pCurrentLevel->m_TileCollisionPrototypeMap.insert(std::make_pair(tileProto.id, tileProto));
+    }
 
-            // This structure is actually used in game in order to prevent recalculating the collision rects
-            //    over and over again
-            TileCollisionPrototype tileProto;
-            tileProto.id = tileDesc.tileId;
-            tileProto.width = tileDesc.width;
-            tileProto.height = tileDesc.height;
-            Util::ParseCollisionRectanglesFromTile(&tileProto, &tileDesc);
+    // Palette has to be set before preloading so that level images can be decoded while preloading
+    std::string palettePath = pLevelProperties->FirstChildElement("Palette")->GetText();
+    std::replace(palettePath.begin(), palettePath.end(), '\\', '/');
+    g_pApp->SetCurrentPalette(PalResourceLoader::LoadAndReturnPal(palettePath.c_str()));
 
-            m_pCurrentLevel->m_TileCollisionPrototypeMap.insert(std::make_pair(tileProto.id, tileProto));
-        }
-    }
-    else
-    {
-        assert(false && "Tile descriptions element not found.");
-    }
+    // Preload level resources
+    PreloadLoadingScreen preloadLoadingScreen = { pBackgroundImage, backgroundRect, scale, loadingProgress, 10.0f };
+    s_pPreloadLoadingScreen = &preloadLoadingScreen;
+    std::string levelPath = "/LEVEL" + ToStr(m_pCurrentLevel->GetLevelNumber()) + "/*";
+    g_pApp->GetResourceCache()->Preload(levelPath, OnLevelPreloadProgress);
+    s_pPreloadLoadingScreen = NULL;
 
     loadingProgress = 10.0f;
     RenderLoadingScreen(pBackgroundImage, backgroundRect, scale, loadingProgress);
@@ -309,10 +343,6 @@ bool BaseGameLogic::VLoadGame(const char* xmlLevelResource)
     // Leave 90% for actor's processing
     float actorToPercent = (100.0f - loadingProgress - 5.0f) / (float)numActors;
 
-    std::string palettePath = pLevelProperties->FirstChildElement("Palette")->GetText();
-    std::replace(palettePath.begin(), palettePath.end(), '\\', '/');
-    g_pApp->SetCurrentPalette(PalResourceLoader::LoadAndReturnPal(palettePath.c_str()));
-
     uint32 clawId = -1;
     for (TiXmlElement* pActorElem = pXmlLevelRoot->FirstChildElement("Actor"); 
         pActorElem != NULL;
@@ -412,7 +442,8 @@ bool BaseGameLogic::VLoadGame(const char* xmlLevelResource)
     LOG("Level author: " + m_pCurrentLevel->m_LevelAuthor);
     LOG("Level created date: " + m_pCurrentLevel->m_LevelCreatedDate);
 
-    SAFE_DELETE(pXmlLevelRoot);
+    // Plane tiles were needed only to create tile planes
+    m_pCurrentLevel->m_PlaneTilesMap.clear();
 
     // TODO: This is a bit hacky but it helps with development (prevents entering cheats over and over again). It can be data driven.
     LOG("Loading startup ingame commands...");
@@ -646,6 +677,7 @@ StrongActorPtr BaseGameLogic::VCreateActor(const std::string& xmlActorResource,
     if (pActor)
     {
         m_ActorMap.insert(std::make_pair(pActor->GetGUID(), pActor));
+        InvalidateActorUpdateOrder();
         if (m_GameState == GameState_IngameRunning)
         {
             // Create event that actor was created
@@ -666,6 +698,7 @@ StrongActorPtr BaseGameLogic::VCreateActor(TiXmlElement* pActorRoot, TiXmlElemen
     if (pActor)
     {
         m_ActorMap.insert(std::make_pair(pActor->GetGUID(), pActor));
+        InvalidateActorUpdateOrder();
         if (m_GameState == GameState_IngameRunning)
         {
             // Create event that actor was created
@@ -678,6 +711,40 @@ StrongActorPtr BaseGameLogic::VCreateActor(TiXmlElement* pActorRoot, TiXmlElemen
     }
 }
 
+StrongActorPtr BaseGameLogic::VCreateActor(ActorPrototype proto, const ActorInstanceOverrides& overrides)
+{
+    assert(m_pActorFactory);
+
+    StrongActorPtr pActor = m_pActorFactory->CreateActor(proto, overrides);
+    if (pActor)
+    {
+        m_ActorMap.insert(std::make_pair(pActor->GetGUID(), pActor));
+        InvalidateActorUpdateOrder();
+        return pActor;
+    }
+    else
+    {
+        return StrongActorPtr();
+    }
+}
+
+StrongActorPtr BaseGameLogic::VCreateActor(const std::string& templateKey, const ActorXmlCreator& createActorXml, const ActorInstanceOverrides& overrides)
+{
+    assert(m_pActorFactory);
+
+    StrongActorPtr pActor = m_pActorFactory->CreateActor(templateKey, createActorXml, overrides);
+    if (pActor)
+    {
+        m_ActorMap.insert(std::make_pair(pActor->GetGUID(), pActor));
+        InvalidateActorUpdateOrder();
+        return pActor;
+    }
+    else
+    {
+        return StrongActorPtr();
+    }
+}
+
 void BaseGameLogic::VDestroyActor(const uint32 actorId)
 {
     // Trigger actor destroyed event prior removing it here
@@ -688,6 +755,7 @@ void BaseGameLogic::VDestroyActor(const uint32 actorId)
         //LOG("Destroying: " + ToStr(actorId));
         findIter->second->Destroy();
         m_ActorMap.erase(findIter);
+        InvalidateActorUpdateOrder();
     }
 }
 
@@ -710,6 +778,7 @@ void BaseGameLogic::VModifyActor(const uint32 actorId, TiXmlElement* overrides)
     if (findIter != m_ActorMap.end())
     {
         m_pActorFactory->ModifyActor(findIter->second, overrides);
+        InvalidateActorUpdateOrder();
     }
 }
 
@@ -771,37 +840,47 @@ void BaseGameLogic::VOnUpdate(uint32 msDiff)
 
         case GameState_IngameRunning:
         {
-            if (m_pProcessMgr)
+            const GameOptions* pGameOptions = g_pApp->GetGameConfig();
+            if (pGameOptions->useFixedTimestep)
             {
-                m_pProcessMgr->UpdateProcesses(msDiff);
+                // Step length is rounded to whole milliseconds since that is what the whole engine works with
+                const uint32 stepMs = max(1u, 1000 / max(1u, pGameOptions->fixedTimestepHz));
+                const uint32 maxSubsteps = max(1u, pGameOptions->maxSimulationSubsteps);
+
+                m_SimulationTimeAccumulator += msDiff;
+
+                uint32 substeps = 0;
+                while (m_SimulationTimeAccumulator >= stepMs && substeps < maxSubsteps)
+                {
+                    UpdateSimulationStep(stepMs);
+                    m_SimulationTimeAccumulator -= stepMs;
+                    substeps++;
+                }
+
+                // Could not keep up, drop the backlog instead of spiraling into ever longer frames
+                if (m_SimulationTimeAccumulator >= stepMs)
+                {
+                    m_SimulationTimeAccumulator %= stepMs;
+                }
+
+                m_InterpolationAlpha = (float)m_SimulationTimeAccumulator / (float)stepMs;
             }
-            
-            if (m_pPhysics)
+            else
             {
-                //PROFILE_CPU("PHYSICS");
-                // TODO: Add config to choose between fixed physics timestep and variable
-                if (true)
+                if (m_pProcessMgr)
                 {
-                    m_pPhysics->VOnUpdate(msDiff);
-                    m_pPhysics->VSyncVisibleScene();
+                    m_pProcessMgr->UpdateProcesses(msDiff);
                 }
-                else
+
+                if (m_pPhysics)
                 {
-                    static uint32 timeSinceLastUpdate = 0;
-                    const uint32 updateInterval = 1000 / 120;
-
-                    timeSinceLastUpdate += msDiff;
-                    if (timeSinceLastUpdate >= updateInterval)
-                    {
-                        //PROFILE_CPU("PHYSICS");
-                        //LOG(ToStr(timeSinceLastUpdate));
-                        m_pPhysics->VOnUpdate(timeSinceLastUpdate);
-                        m_pPhysics->VSyncVisibleScene();
-
-                        timeSinceLastUpdate = 0;
-                    }
+                    //PROFILE_CPU("PHYSICS");
+                    m_pPhysics->VOnUpdate(msDiff);
+                    m_pPhysics->VSyncVisibleScene();
                 }
-                break;
+
+                m_SimulationTick++;
+                m_InterpolationAlpha = 1.0f;
             }
 
             break;
@@ -820,20 +899,116 @@ void BaseGameLogic::VOnUpdate(uint32 msDiff)
         pGameView->VOnUpdate(msDiff);
     }
 
+    // Fixed timestep updates actors within simulation steps
+    if (m_GameState == GameState_IngameRunning && g_pApp->GetGameConfig()->useFixedTimestep)
+    {
+        return;
+    }
+
     // Limit update to max 100 times / second
     static int msAccumulation = 0;
     msAccumulation += msDiff;
     if (msAccumulation >= 5)
     {
-        // Update all game actors
-        for (auto actorIter : m_ActorMap)
+        UpdateActors(msAccumulation);
+        msAccumulation = 0;
+    }
+}
+
+void BaseGameLogic::UpdateSimulationStep(uint32 msDiff)
+{
+    m_SimulationTick++;
+
+    if (m_pProcessMgr)
+    {
+        m_pProcessMgr->UpdateProcesses(msDiff);
+    }
+
+    if (m_pPhysics)
+    {
+        //PROFILE_CPU("PHYSICS");
+        m_pPhysics->VOnUpdate(msDiff);
+        m_pPhysics->VSyncVisibleScene();
+    }
+
+    UpdateActors(msDiff);
+}
+
+void BaseGameLogic::UpdateActors(uint32 msDiff)
+{
+    if (m_ActorUpdateOrderDirty)
+    {
+        RebuildActorUpdateOrder();
+    }
+
+    // Actors created during this update are updated from the next one
+    m_IsUpdatingActors = true;
+    for (const ActorUpdateStep& step : m_ActorUpdateOrder)
+    {
+        if (step.pActor)
         {
-            actorIter.second->Update(msAccumulation);
+            step.pActor->UpdateComponents(msDiff, step.first, step.end);
+        }
+        else
+        {
+            m_ComponentSystemStages[step.first].update(msDiff);
         }
-        msAccumulation = 0;
+    }
+    m_IsUpdatingActors = false;
+
+    // Release actors which got destroyed meanwhile
+    if (m_ActorUpdateOrderDirty)
+    {
+        m_ActorUpdateOrder.clear();
     }
 }
 
+void BaseGameLogic::InvalidateActorUpdateOrder()
+{
+    m_ActorUpdateOrderDirty = true;
+
+    // Update order holds its actors alive, destroyed ones are released as soon as it is not being walked
+    if (!m_IsUpdatingActors)
+    {
+        m_ActorUpdateOrder.clear();
+    }
+}
+
+void BaseGameLogic::RebuildActorUpdateOrder()
+{
+    // Actors update their components in order of component ids. Components migrated to
+    // batched systems are not updated by their actors, so each system runs between two actor
+    // passes at the position of its component's id. That keeps the order every actor saw when
+    // all of its components were updated by itself - e.g. AI ordered after animation still reads
+    // the animation frame of this tick, not the one of the previous tick
+    m_ActorUpdateOrder.clear();
+
+    uint64 fromComponentId = 0;
+    for (uint32 stageIdx = 0; stageIdx <= m_ComponentSystemStages.size(); stageIdx++)
+    {
+        const bool isLastPass = (stageIdx == m_ComponentSystemStages.size());
+        const uint64 toComponentId = isLastPass ? UINT64_MAX : m_ComponentSystemStages[stageIdx].componentId;
+
+        for (auto& actorIter : m_ActorMap)
+        {
+            uint32 first, end;
+            actorIter.second->GetUpdatedComponentRange(fromComponentId, toComponentId, first, end);
+            if (first < end)
+            {
+                m_ActorUpdateOrder.push_back({ actorIter.second, first, end });
+            }
+        }
+
+        if (!isLastPass)
+        {
+            m_ActorUpdateOrder.push_back({ nullptr, stageIdx, stageIdx + 1 });
+            fromComponentId = toComponentId;
+        }
+    }
+
+    m_ActorUpdateOrderDirty = false;
+}
+
 void BaseGameLogic::VChangeState(GameState newState)
 {
 
@@ -867,21 +1042,42 @@ void BaseGameLogic::VChangeState(GameState newState)
         // Load Monolith's WWD, they are located in /LEVEL[1-14]/WORLDS/WORLD.WWD
         std::string levelName = "LEVEL" + ToStr(levelNumber);
         std::string pathToLevelWwd = "/" + levelName + "/WORLDS/WORLD.WWD";
-        WapWwd* pWwd = WwdResourceLoader::LoadAndReturnWwd(pathToLevelWwd.c_str());
+        WapWwdStream* pWwd = WwdResourceLoader::LoadAndReturnWwd(pathToLevelWwd.c_str());
         assert(pWwd != NULL);
+        uint32 wwdChecksum = WwdResourceLoader::LoadAndReturnWwdChecksum(pathToLevelWwd.c_str());
+        uint32 inputsChecksum = LevelCache::CalculateInputsChecksum();
+
+        // Precompiled level, e.g. LEVEL1.lvc, is rebuilt only when WWD or anything else WwdToXml reads changes
+        const GameOptions* pGameOptions = g_pApp->GetGameConfig();
+        std::string levelCachePath = pGameOptions->tempDir + "/" + levelName + ".lvc";
+        shared_ptr<LevelCache> pLevel;
+        if (!pGameOptions->exportLevelXml)
+        {
+            pLevel = LevelCache::LoadFromFile(levelCachePath, wwdChecksum, inputsChecksum);
+        }
 
-        // Convert Monolith .WWD format to my .XML format
-        TiXmlElement* pXmlLevel = WwdToXml(pWwd, levelNumber);
-        assert(pXmlLevel != NULL);
+        if (!pLevel)
+        {
+            // Convert Monolith .WWD format to my .XML format
+            TiXmlElement* pXmlLevel = WwdToXml(pWwd, levelNumber);
+            assert(pXmlLevel != NULL);
 
-        // Save converted level to file, e.g. LEVEL1.xml
-        TiXmlDocument xmlDoc;
-        xmlDoc.LinkEndChild(pXmlLevel);
-        std::string outFileLevelName = g_pApp->GetGameConfig()->tempDir + "/" + levelName + ".xml";
-        xmlDoc.SaveFile(outFileLevelName.c_str());
+            TiXmlDocument xmlDoc;
+            xmlDoc.LinkEndChild(pXmlLevel);
 
-        // Load saved level file, e.g. LEVEL1.xml
-        if (!VLoadGame(outFileLevelName.c_str()))
+            // XML is not needed by the game, it is exported only for debugging purposes, e.g. LEVEL1.xml
+            if (pGameOptions->exportLevelXml)
+            {
+                std::string outFileLevelName = pGameOptions->tempDir + "/" + levelName + ".xml";
+                xmlDoc.SaveFile(outFileLevelName.c_str());
+            }
+
+            pLevel = LevelCache::CreateFromXml(pXmlLevel, wwdChecksum, inputsChecksum);
+            assert(pLevel != nullptr);
+            pLevel->SaveToFile(levelCachePath);
+        }
+
+        if (!LoadLevel(pLevel))
         {
             LOG_ERROR("Could not load level");
             exit(1);
@@ -979,141 +1175,218 @@ static FixtureType CollisonToFixtureType(CollisionType collisionType)
     return findIt->second;
 }
 
-// Helper function
-void BaseGameLogic::CreateSinglePhysicsTile(int x, int y, const TileCollisionPrototype& proto)
+// Some ladders have ground on their top which is not part of the tile description.
+// Returns the ground rect relative to tile's top left corner.
+static bool GetTopLadderGroundRect(uint32 levelNumber, int32 tileId, SDL_Rect& outRect)
 {
-    for (auto tileCollisionRect : proto.collisionRectangles)
+    int offsetY = -1;
+    if (levelNumber == 1 && tileId == 310) offsetY = 0;
+    else if (levelNumber == 2 && tileId == 16) offsetY = 50;
+    else if (levelNumber == 3 && tileId == 668) offsetY = 5;
+    else if (levelNumber == 3 && tileId == 667) offsetY = 0;
+    else if (levelNumber == 4 && tileId == 181) offsetY = 7;
+
+    if (offsetY < 0)
     {
-        Point position = Point(x + tileCollisionRect.collisionRect.x,
-            y + tileCollisionRect.collisionRect.y);
-        Point size = Point(tileCollisionRect.collisionRect.w, tileCollisionRect.collisionRect.h);
-
-        m_pPhysics->VAddStaticGeometry(
-            position, 
-            size, 
-            tileCollisionRect.collisionType, 
-            CollisonToFixtureType(tileCollisionRect.collisionType));
+        return false;
     }
 
-    // LEVEL1: Top of the ladder
-    if (m_pCurrentLevel->GetLevelNumber() == 1 && proto.id == 310)
+    outRect = { 0, offsetY, 64, 10 };
+    return true;
+}
+
+// Greedy merge of world space tile rects. First adjacent rects of the same type and row span
+// are joined horizontally, then the resulting strips of the same type and column span are
+// joined vertically. Ladders are only merged vertically since climbing snaps to the center
+// of ladder fixture and ground only horizontally so that every one-way platform keeps its
+// own top edge.
+static void MergeTileCollisionRects(std::vector<TileCollisionRectangle>& rects)
+{
+    if (rects.size() < 2)
     {
-        Point position(x, y);
-        Point size(64, 10);
-        m_pPhysics->VAddStaticGeometry(position, size, CollisionType_Ground, FixtureType_TopLadderGround);
+        return;
     }
-    else if (m_pCurrentLevel->GetLevelNumber() == 2 && proto.id == 16)
+
+    // Horizontal pass
+    std::sort(rects.begin(), rects.end(), [](const TileCollisionRectangle& l, const TileCollisionRectangle& r)
     {
-        Point position(x, y + 50);
-        Point size(64, 10);
-        m_pPhysics->VAddStaticGeometry(position, size, CollisionType_Ground, FixtureType_TopLadderGround);
-    }
-    else if (m_pCurrentLevel->GetLevelNumber() == 3 && proto.id == 668)
+        if (l.collisionType != r.collisionType) return l.collisionType < r.collisionType;
+        if (l.collisionRect.y != r.collisionRect.y) return l.collisionRect.y < r.collisionRect.y;
+        if (l.collisionRect.h != r.collisionRect.h) return l.collisionRect.h < r.collisionRect.h;
+        return l.collisionRect.x < r.collisionRect.x;
+    });
+
+    size_t mergedCount = 0;
+    for (size_t rectIdx = 0; rectIdx < rects.size(); rectIdx++)
     {
-        Point position(x, y + 5);
-        Point size(64, 10);
-        m_pPhysics->VAddStaticGeometry(position, size, CollisionType_Ground, FixtureType_TopLadderGround);
+        const TileCollisionRectangle& current = rects[rectIdx];
+        if (mergedCount > 0)
+        {
+            TileCollisionRectangle& last = rects[mergedCount - 1];
+            if (last.collisionType == current.collisionType &&
+                last.collisionType != CollisionType_Climb &&
+                last.collisionRect.y == current.collisionRect.y &&
+                last.collisionRect.h == current.collisionRect.h &&
+                current.collisionRect.x <= last.collisionRect.x + last.collisionRect.w)
+            {
+                int right = max(last.collisionRect.x + last.collisionRect.w, current.collisionRect.x + current.collisionRect.w);
+                last.collisionRect.w = right - last.collisionRect.x;
+                continue;
+            }
+        }
+
+        rects[mergedCount++] = current;
     }
-    else if (m_pCurrentLevel->GetLevelNumber() == 3 && proto.id == 667)
+    rects.resize(mergedCount);
+
+    // Vertical pass
+    std::sort(rects.begin(), rects.end(), [](const TileCollisionRectangle& l, const TileCollisionRectangle& r)
     {
-        Point position(x, y);
-        Point size(64, 10);
-        m_pPhysics->VAddStaticGeometry(position, size, CollisionType_Ground, FixtureType_TopLadderGround);
-    }
-    else if (m_pCurrentLevel->GetLevelNumber() == 4 && proto.id == 181)
+        if (l.collisionType != r.collisionType) return l.collisionType < r.collisionType;
+        if (l.collisionRect.x != r.collisionRect.x) return l.collisionRect.x < r.collisionRect.x;
+        if (l.collisionRect.w != r.collisionRect.w) return l.collisionRect.w < r.collisionRect.w;
+        return l.collisionRect.y < r.collisionRect.y;
+    });
+
+    mergedCount = 0;
+    for (size_t rectIdx = 0; rectIdx < rects.size(); rectIdx++)
     {
-        Point position(x, y + 7);
-        Point size(64, 10);
-        m_pPhysics->VAddStaticGeometry(position, size, CollisionType_Ground, FixtureType_TopLadderGround);
+        const TileCollisionRectangle& current = rects[rectIdx];
+        if (mergedCount > 0)
+        {
+            TileCollisionRectangle& last = rects[mergedCount - 1];
+            if (last.collisionType == current.collisionType &&
+                last.collisionType != CollisionType_Ground &&
+                last.collisionRect.x == current.collisionRect.x &&
+                last.collisionRect.w == current.collisionRect.w &&
+                current.collisionRect.y <= last.collisionRect.y + last.collisionRect.h)
+            {
+                int bottom = max(last.collisionRect.y + last.collisionRect.h, current.collisionRect.y + current.collisionRect.h);
+                last.collisionRect.h = bottom - last.collisionRect.y;
+                continue;
+            }
+        }
+
+        rects[mergedCount++] = current;
     }
+    rects.resize(mergedCount);
 }
 
-void BaseGameLogic::CollideableTileCreatedDelegate(IEventDataPtr pEventData)
+void BaseGameLogic::CreateMainPlaneCollisions(const std::vector<int32>& tiles, int tilesOnAxisX, int tileWidth, int tileHeight)
 {
-    shared_ptr<EventData_Collideable_Tile_Created> pCastEventData = static_pointer_cast<EventData_Collideable_Tile_Created>(pEventData);
+    assert(tilesOnAxisX > 0);
 
     //-------------------------------------------------------------------------
-    // (1) First get all info about the tile, its position etc we want to create
+    // (1) Gather collision rects of all tiles in world coordinates
     //-------------------------------------------------------------------------
 
-    int tileId = pCastEventData->GetTileId();
-    int tileX = pCastEventData->GetPositionX();
-    int tileY = pCastEventData->GetPositionY();
-    int numTiles = pCastEventData->GetTilesCount();
-    assert(numTiles >= 1);
+    std::vector<TileCollisionRectangle> collisionRects;
+    std::vector<SDL_Rect> topLadderGroundRects;
+    collisionRects.reserve(tiles.size());
 
-    auto findIt = m_pCurrentLevel->m_TileCollisionPrototypeMap.find(tileId);
-    if (findIt == m_pCurrentLevel->m_TileCollisionPrototypeMap.end())
+    int32 lastTileId = -1;
+    const TileCollisionPrototype* pTileProto = NULL;
+    for (size_t tileIdx = 0; tileIdx < tiles.size(); tileIdx++)
     {
-        LOG_ERROR("Unknown tile! Id = " + ToStr(tileId));
-        assert(false && "Unknown tile");
-    }
+        int32 tileId = tiles[tileIdx];
+        if (tileId == -1)
+        {
+            continue;
+        }
 
-    TileCollisionPrototype& tileProto = findIt->second;
+        if (pTileProto == NULL || tileId != lastTileId)
+        {
+            auto findIt = m_pCurrentLevel->m_TileCollisionPrototypeMap.find(tileId);
+            if (findIt == m_pCurrentLevel->m_TileCollisionPrototypeMap.end())
+            {
+                LOG_ERROR("Unknown tile! Id = " + ToStr(tileId));
+                pTileProto = NULL;
+                continue;
+            }
 
-    //-------------------------------------------------------------------------
-    // (2) Create the tile in the physics world appropriately
-    //    - If its single tile, create it simply from prototype
-    //    - If its multiple same tiles, check if we can merge them, if yes, 
-    //      merge and create, if not, create them separately
-    //-------------------------------------------------------------------------
+            lastTileId = tileId;
+            pTileProto = &findIt->second;
+        }
 
-    if (numTiles == 1)
-    {
-        CreateSinglePhysicsTile(tileX, tileY, tileProto);
-    }
-    else
-    {
-        // Multiple tiles in a row, check if we can marge them
-        bool bCanBeMerged = true;
+        int tileX = (int)(tileIdx % tilesOnAxisX) * tileWidth;
+        int tileY = (int)(tileIdx / tilesOnAxisX) * tileHeight;
 
-        int countAttrTiles = 0;
-        TileCollisionRectangle mergedRect;
-        for (TileCollisionRectangle& colRect : tileProto.collisionRectangles)
+        for (const TileCollisionRectangle& tileCollisionRect : pTileProto->collisionRectangles)
         {
-            if (colRect.collisionType != CollisionType_None)
+            if (tileCollisionRect.collisionType == CollisionType_None ||
+                tileCollisionRect.collisionRect.w <= 0 ||
+                tileCollisionRect.collisionRect.h <= 0)
             {
-                countAttrTiles++;
-                mergedRect = colRect;
-
-                if (colRect.collisionRect.w != tileProto.width)
-                {
-                    bCanBeMerged = false;
-                }
+                continue;
             }
-        }
 
-        if (countAttrTiles != 1)
-        {
-            bCanBeMerged = false;
+            TileCollisionRectangle worldRect = tileCollisionRect;
+            worldRect.collisionRect.x += tileX;
+            worldRect.collisionRect.y += tileY;
+            collisionRects.push_back(worldRect);
         }
 
-        // If they can be merged, merge them
-        if (bCanBeMerged)
+        SDL_Rect topLadderGroundRect;
+        if (GetTopLadderGroundRect(m_pCurrentLevel->GetLevelNumber(), tileId, topLadderGroundRect))
         {
-            assert(mergedRect.collisionRect.x == 0);
-            assert(mergedRect.collisionRect.w == tileProto.width);
-            assert(mergedRect.collisionRect.h > 0);
-
-            Point mergedPosition(tileX + mergedRect.collisionRect.x, tileY + mergedRect.collisionRect.y);
-            Point mergedSize(tileProto.width * numTiles, mergedRect.collisionRect.h);
-
-            m_pPhysics->VAddStaticGeometry(
-                mergedPosition, 
-                mergedSize, 
-                mergedRect.collisionType,
-                CollisonToFixtureType(mergedRect.collisionType));
+            topLadderGroundRect.x += tileX;
+            topLadderGroundRect.y += tileY;
+            topLadderGroundRects.push_back(topLadderGroundRect);
         }
-        else
+    }
+
+    //-------------------------------------------------------------------------
+    // (2) Merge them so that there are as few Box2D fixtures as possible
+    //-------------------------------------------------------------------------
+
+    MergeTileCollisionRects(collisionRects);
+
+    //-------------------------------------------------------------------------
+    // (3) Create them in the physics world
+    //-------------------------------------------------------------------------
+
+    for (const TileCollisionRectangle& collisionRect : collisionRects)
+    {
+        m_pPhysics->VAddStaticGeometry(
+            Point(collisionRect.collisionRect.x, collisionRect.collisionRect.y),
+            Point(collisionRect.collisionRect.w, collisionRect.collisionRect.h),
+            collisionRect.collisionType,
+            CollisonToFixtureType(collisionRect.collisionType));
+    }
+
+    // Ladder top patches have their own fixture type and are never merged
+    for (const SDL_Rect& topLadderGroundRect : topLadderGroundRects)
+    {
+        m_pPhysics->VAddStaticGeometry(
+            Point(topLadderGroundRect.x, topLadderGroundRect.y),
+            Point(topLadderGroundRect.w, topLadderGroundRect.h),
+            CollisionType_Ground, 
+            FixtureType_TopLadderGround);
+    }
+
+    //-------------------------------------------------------------------------
+    // (4) Tile grid for queries which do not need Box2D
+    //-------------------------------------------------------------------------
+
+    CreateTileCollisionGrid(tiles, tilesOnAxisX, tileWidth, tileHeight);
+}
+
+void BaseGameLogic::CreateTileCollisionGrid(const std::vector<int32>& tiles, int tilesOnAxisX, int tileWidth, int tileHeight)
+{
+    // Grid has to see the same geometry as Box2D world, including the ladder tops
+    TileCollisionPrototypeMap tilePrototypes = m_pCurrentLevel->m_TileCollisionPrototypeMap;
+    for (auto& protoIter : tilePrototypes)
+    {
+        TileCollisionRectangle topLadderGround;
+        if (GetTopLadderGroundRect(m_pCurrentLevel->GetLevelNumber(), protoIter.first, topLadderGround.collisionRect))
         {
-            // If not, create them one by one
-            for (int tileNumIdx = 0; tileNumIdx < numTiles; tileNumIdx++)
-            {
-                CreateSinglePhysicsTile(tileX, tileY, tileProto);
-                tileX += tileProto.width;
-            }
+            topLadderGround.collisionType = CollisionType_Ground;
+            protoIter.second.collisionRectangles.push_back(topLadderGround);
         }
     }
+
+    m_pCurrentLevel->m_pTileCollisionGrid = 
+        TileCollisionGrid::Create(tiles, tilesOnAxisX, tileWidth, tileHeight, tilePrototypes);
 }
 
 void BaseGameLogic::CreateStaticGeometryDelegate(IEventDataPtr pEventData)
@@ -1209,6 +1482,7 @@ void BaseGameLogic::UnloadLevel()
 
     //m_pCurrentLevel.reset();
 
+    m_pActorFactory->ClearCompiledPrototypes();
     m_pPhysics.reset();
 }
 
@@ -1229,6 +1503,7 @@ void BaseGameLogic::VResetLevel()
     IEventMgr::Get()->VUpdate(IEventMgr::kINFINITE);
 
     // Reset physics. TODO: is replacing pointer which is shared between multiple classes OK like this ?
+    m_pActorFactory->ClearCompiledPrototypes();
     m_pPhysics.reset(CreateClawPhysics());
 
     // Load new level
@@ -1241,7 +1516,6 @@ void BaseGameLogic::VResetLevel()
 
 void BaseGameLogic::RegisterAllDelegates()
 {
-    IEventMgr::Get()->VAddListener(MakeDelegate(this, &BaseGameLogic::CollideableTileCreatedDelegate), EventData_Collideable_Tile_Created::sk_EventType);
     IEventMgr::Get()->VAddListener(MakeDelegate(this, &BaseGameLogic::RequestDestroyActorDelegate), EventData_Destroy_Actor::sk_EventType);
     IEventMgr::Get()->VAddListener(MakeDelegate(this, &BaseGameLogic::CreateStaticGeometryDelegate), EventData_Add_Static_Geometry::sk_EventType);
     IEventMgr::Get()->VAddListener(MakeDelegate(this, &BaseGameLogic::ItemPickedUpDelegate), EventData_Item_Picked_Up::sk_EventType);
@@ -1253,7 +1527,6 @@ void BaseGameLogic::RegisterAllDelegates()
 
 void BaseGameLogic::RemoveAllDelegates()
 {
-    IEventMgr::Get()->VRemoveListener(MakeDelegate(this, &BaseGameLogic::CollideableTileCreatedDelegate), EventData_Collideable_Tile_Created::sk_EventType);
     IEventMgr::Get()->VRemoveListener(MakeDelegate(this, &BaseGameLogic::RequestDestroyActorDelegate), EventData_Destroy_Actor::sk_EventType);
     IEventMgr::Get()->VRemoveListener(MakeDelegate(this, &BaseGameLogic::CreateStaticGeometryDelegate), EventData_Add_Static_Geometry::sk_EventType);
     IEventMgr::Get()->VRemoveListener(MakeDelegate(this, &BaseGameLogic::ItemPickedUpDelegate), EventData_Item_Picked_Up::sk_EventType);
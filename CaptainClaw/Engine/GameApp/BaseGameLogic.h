@@ -4,13 +4,18 @@
 #include "../SharedDefines.h"
 #include "../Process/ProcessMgr.h"
 #include "../Actor/Actor.h"
+#include "../Actor/ComponentSystem.h"
 #include "CommandHandler.h"
 
+#include <functional>
+
 typedef std::map<uint32, StrongActorPtr> ActorMap;
 
 class GameSaveMgr;
 class LevelData;
+class LevelCache;
 class ActorFactory;
+class TileCollisionGrid;
 class BaseGameApp;
 class BaseGameLogic : public IGameLogic
 {
@@ -46,6 +51,8 @@ public:
     // Actor management
     virtual StrongActorPtr VCreateActor(const std::string& xmlActorResource, TiXmlElement* overrides);
     virtual StrongActorPtr VCreateActor(TiXmlElement* pActorRoot, TiXmlElement* overrides);
+    virtual StrongActorPtr VCreateActor(ActorPrototype proto, const ActorInstanceOverrides& overrides);
+    virtual StrongActorPtr VCreateActor(const std::string& templateKey, const ActorXmlCreator& createActorXml, const ActorInstanceOverrides& overrides);
     virtual void VDestroyActor(const uint32 actorId);
     virtual WeakActorPtr VGetActor(const uint32 actorId);
     virtual void VModifyActor(const uint32 actorId, TiXmlElement* overrides);
@@ -88,14 +95,29 @@ public:
     void SetRunning(bool running) { m_bRunning = running; }
     bool IsRunning() { return m_bRunning; }
 
+    // Called by main plane once its tiles are known. Creates merged static tile geometry in
+    // physics world and tile collision grid.
+    void CreateMainPlaneCollisions(const std::vector<int32>& tiles, int tilesOnAxisX, int tileWidth, int tileHeight);
+
+    // Batched component updates, see ComponentSystem.h
+    shared_ptr<AnimationSystem> GetAnimationSystem() { return m_pAnimationSystem; }
+    shared_ptr<KinematicSystem> GetKinematicSystem() { return m_pKinematicSystem; }
+
+    // Simulation tick is incremented with every simulation step. Interpolation alpha is the part
+    // of next fixed step which is already accumulated, it is always 1.0 with variable timestep.
+    uint32 GetSimulationTick() const { return m_SimulationTick; }
+    float GetInterpolationAlpha() const { return m_InterpolationAlpha; }
+
 protected:
     virtual ActorFactory* VCreateActorFactory();
 
     virtual bool VLoadGameDelegate(TiXmlElement* pLevelData) { return true; }
 
+    // Builds level from its precompiled form, VLoadGame() and level loading state both end up here
+    bool LoadLevel(shared_ptr<LevelCache> pLevel);
+
     void MoveActorDelegate(IEventDataPtr pEventData);
     void RequestNewActorDelegate(IEventDataPtr pEventData);
-    void CollideableTileCreatedDelegate(IEventDataPtr pEventData);
     void CreateStaticGeometryDelegate(IEventDataPtr pEventData);
     void RequestDestroyActorDelegate(IEventDataPtr pEventData);
     void ItemPickedUpDelegate(IEventDataPtr pEventData);
@@ -126,13 +148,46 @@ protected:
     shared_ptr<LevelData> m_pCurrentLevel;
     shared_ptr<GameSaveMgr> m_pGameSaveMgr;
 
+    shared_ptr<AnimationSystem> m_pAnimationSystem;
+    shared_ptr<KinematicSystem> m_pKinematicSystem;
+
+    // Batched systems sorted by id of the component type they update, see UpdateActors()
+    struct ComponentSystemStage
+    {
+        uint32 componentId;
+        std::function<void(uint32)> update;
+    };
+    std::vector<ComponentSystemStage> m_ComponentSystemStages;
+
+    // Flat order in which UpdateActors() updates actor components and runs batched systems.
+    // Rebuilt on the first update after an actor was created, modified or destroyed
+    struct ActorUpdateStep
+    {
+        // NULL when this step runs batched system
+        StrongActorPtr pActor;
+        // Index range of actor's updated components or index of the system stage
+        uint32 first;
+        uint32 end;
+    };
+    std::vector<ActorUpdateStep> m_ActorUpdateOrder;
+    bool m_ActorUpdateOrderDirty;
+    bool m_IsUpdatingActors;
+
     int m_SelectedLevel;
 
     Point m_CurrentSpawnPosition;
 
+    uint32 m_SimulationTick;
+    uint32 m_SimulationTimeAccumulator;
+    float m_InterpolationAlpha;
+
 private:
+    void UpdateSimulationStep(uint32 msDiff);
+    void UpdateActors(uint32 msDiff);
+    void InvalidateActorUpdateOrder();
+    void RebuildActorUpdateOrder();
     void ExecuteStartupCommands(const std::string& startupCommandsFile);
-    void CreateSinglePhysicsTile(int x, int y, const TileCollisionPrototype& proto);
+    void CreateTileCollisionGrid(const std::vector<int32>& tiles, int tilesOnAxisX, int tileWidth, int tileHeight);
     //void LoadGameWorkerThread(const char* pXmlLevelPath, float* pProgress, bool* pRet);
 
     void RegisterAllDelegates();
@@ -179,6 +234,8 @@ struct TileDescription
 typedef std::map<int32, TileDescription> TileDescriptionMap;
 typedef std::map<int32, TileCollisionPrototype> TileCollisionPrototypeMap;
 typedef std::map<PickupType, int> PickupMap;
+// Plane name -> tile ids of the plane from top left to bottom right corner
+typedef std::map<std::string, std::vector<int32>> PlaneTilesMap;
 
 // Class containing level (meta)data
 class LevelData
@@ -212,6 +269,15 @@ public:
 
     const PickupMap* GetLootedItems() { return &m_LootedPickupsMap; }
 
+    const std::vector<int32>* GetPlaneTiles(const std::string& planeName) const
+    {
+        auto findIt = m_PlaneTilesMap.find(planeName);
+        return findIt != m_PlaneTilesMap.end() ? &findIt->second : NULL;
+    }
+
+    // Main plane tile collisions for AI queries which do not need Box2D, can be NULL before main plane is loaded
+    const TileCollisionGrid* GetTileCollisionGrid() const { return m_pTileCollisionGrid.get(); }
+
 private:
     std::string m_LevelName;
     std::string m_LevelAuthor;
@@ -223,6 +289,8 @@ private:
 
     TileDescriptionMap m_TileDescriptionMap;
     TileCollisionPrototypeMap m_TileCollisionPrototypeMap;
+    PlaneTilesMap m_PlaneTilesMap;
+    shared_ptr<TileCollisionGrid> m_pTileCollisionGrid;
 
     // How many times were certain pickups picked up
     PickupMap m_LootedPickupsMap;
@@ -1,6 +1,7 @@
 #include "BaseGameApp.h"
 #include "BaseGameLogic.h"
 #include "../UserInterface/Console.h"
+#include "../Graphics2D/TextureResidencyManager.h"
 
 #include "../Actor/Components/ControllerComponents/PowerupComponent.h"
 
@@ -161,6 +162,38 @@ void CommandHandler::HandleCommand(const char* command, void* userdata)
         }
     }
 
+    if (commandStr == "texture stats")
+    {
+        if (TextureResidencyManager* pResidencyMgr = g_pApp->GetTextureResidencyManager())
+        {
+            const uint64 MB = 1024 * 1024;
+            TextureResidencyStats stats = pResidencyMgr->GetStats();
+            std::string budget = stats.budgetBytes > 0 ? ToStr(stats.budgetBytes / MB) + " MB" : "unlimited";
+
+            pConsole->AddLine("Textures: " + ToStr((stats.imageBytes + stats.renderTargetBytes) / MB) + " MB of " + budget +
+                " (images: " + ToStr(stats.imageBytes / MB) + " MB, evictable: " + ToStr(stats.evictableBytes / MB) +
+                " MB, render targets: " + ToStr(stats.renderTargetBytes / MB) + " MB)", COLOR_GREEN);
+            pConsole->AddLine("Images resident: " + ToStr(stats.residentImagesCount) + ", evicted: " + ToStr(stats.evictedImagesCount) +
+                ", total evictions: " + ToStr(stats.evictionsCount) + ", total reloads: " + ToStr(stats.reloadsCount), COLOR_GREEN);
+        }
+        else
+        {
+            pConsole->AddLine("Texture residency manager is not created", COLOR_RED);
+        }
+        wasCommandExecuted = true;
+    }
+
+    if (commandStr.find("texture budget ") == 0 && commandArgs.size() == 3)
+    {
+        if (TextureResidencyManager* pResidencyMgr = g_pApp->GetTextureResidencyManager())
+        {
+            uint64 budgetMB = std::stoul(commandArgs[2]);
+            pResidencyMgr->SetBudget(budgetMB * 1024 * 1024);
+            pConsole->AddLine("Texture memory budget: " + ToStr(budgetMB) + " MB", COLOR_GREEN);
+        }
+        wasCommandExecuted = true;
+    }
+
     if (commandStr.find("cpudelay ") != std::string::npos && commandArgs.size() == 2)
     {
         g_pApp->m_GlobalOptions.cpuDelayMs = std::stoi(commandArgs[1]);
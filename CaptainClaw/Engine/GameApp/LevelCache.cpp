@@ -0,0 +1,533 @@
+#include "LevelCache.h"
+#include "BaseGameApp.h"
+#include "../Resource/Miniz.h"
+
+#include <fstream>
+
+// File layout (native byte order, cache is machine local):
+//
+//     LevelCacheHeader
+//     uint32 tileDescriptionsCount, TileDescription[tileDescriptionsCount]
+//     uint32 planesCount, { string planeName, uint32 tilesCount, int32[tilesCount] }[planesCount]
+//     Element levelRoot
+//
+// where string is uint32 length followed by its characters and Element is name string,
+// uint32 attributesCount, { string name, string value }[attributesCount], uint32 childrenCount
+// and for each child uint8 node type followed by either Element or text string.
+
+const uint32 LevelCache::g_Version = 3;
+
+static const char g_LevelCacheMagic[4] = { 'C', 'C', 'L', 'V' };
+
+// Guards against stack overflow on corrupted files, level xml is only a few levels deep
+static const int MAX_ELEMENT_DEPTH = 64;
+
+enum LevelCacheNodeType
+{
+    LevelCacheNode_Element = 0,
+    LevelCacheNode_Text = 1
+};
+
+struct LevelCacheHeader
+{
+    char magic[4];
+    uint32 version;
+    uint32 wwdChecksum;
+    uint32 inputsChecksum;
+    uint32 dataSize;
+};
+
+static_assert(sizeof(TileDescription) == 10 * sizeof(int32), "TileDescription is expected to be tightly packed");
+
+//=================================================================================================
+// class LevelCacheWriter
+//
+//     Serializes level cache data into single contiguous buffer
+//
+//=================================================================================================
+
+class LevelCacheWriter
+{
+public:
+    void Write(const void* pData, uint32 size)
+    {
+        const char* pBytes = (const char*)pData;
+        m_Buffer.insert(m_Buffer.end(), pBytes, pBytes + size);
+    }
+
+    void WriteUInt32(uint32 value) { Write(&value, sizeof(value)); }
+
+    void WriteString(const char* str)
+    {
+        uint32 length = str ? (uint32)strlen(str) : 0;
+        WriteUInt32(length);
+        Write(str, length);
+    }
+
+    void WriteElement(const TiXmlElement* pElem)
+    {
+        WriteString(pElem->Value());
+
+        uint32 attributesCount = 0;
+        for (const TiXmlAttribute* pAttr = pElem->FirstAttribute(); pAttr; pAttr = pAttr->Next())
+        {
+            attributesCount++;
+        }
+        WriteUInt32(attributesCount);
+        for (const TiXmlAttribute* pAttr = pElem->FirstAttribute(); pAttr; pAttr = pAttr->Next())
+        {
+            WriteString(pAttr->Name());
+            WriteString(pAttr->Value());
+        }
+
+        // Comments and other node types are not relevant to the game
+        uint32 childrenCount = 0;
+        for (const TiXmlNode* pNode = pElem->FirstChild(); pNode; pNode = pNode->NextSibling())
+        {
+            if (pNode->ToElement() || pNode->ToText())
+            {
+                childrenCount++;
+            }
+        }
+        WriteUInt32(childrenCount);
+        for (const TiXmlNode* pNode = pElem->FirstChild(); pNode; pNode = pNode->NextSibling())
+        {
+            if (const TiXmlElement* pChildElem = pNode->ToElement())
+            {
+                uint8 nodeType = LevelCacheNode_Element;
+                Write(&nodeType, sizeof(nodeType));
+                WriteElement(pChildElem);
+            }
+            else if (const TiXmlText* pText = pNode->ToText())
+            {
+                uint8 nodeType = LevelCacheNode_Text;
+                Write(&nodeType, sizeof(nodeType));
+                WriteString(pText->Value());
+            }
+        }
+    }
+
+    std::vector<char>& GetBuffer() { return m_Buffer; }
+
+private:
+    std::vector<char> m_Buffer;
+};
+
+//=================================================================================================
+// class LevelCacheReader
+//
+//     Reads level cache data from memory buffer. Every read is bounds checked, once any read
+//     fails all subsequent reads fail as well so that errors can be checked only once at the end
+//
+//=================================================================================================
+
+class LevelCacheReader
+{
+public:
+    LevelCacheReader(const char* pData, uint32 size)
+        :
+        m_pData(pData),
+        m_Size(size),
+        m_Offset(0),
+        m_bFailed(false)
+    { }
+
+    const char* Read(uint32 size)
+    {
+        if (m_bFailed || size > m_Size - m_Offset)
+        {
+            m_bFailed = true;
+            return NULL;
+        }
+
+        const char* pData = m_pData + m_Offset;
+        m_Offset += size;
+        return pData;
+    }
+
+    const char* ReadArray(uint32 count, uint32 elementSize)
+    {
+        uint64 size = (uint64)count * elementSize;
+        if (size > m_Size - m_Offset)
+        {
+            m_bFailed = true;
+            return NULL;
+        }
+
+        return Read((uint32)size);
+    }
+
+    uint32 ReadUInt32()
+    {
+        uint32 value = 0;
+        if (const char* pData = Read(sizeof(value)))
+        {
+            memcpy(&value, pData, sizeof(value));
+        }
+        return value;
+    }
+
+    std::string ReadString()
+    {
+        uint32 length = ReadUInt32();
+        const char* pData = Read(length);
+        if (pData == NULL || memchr(pData, '\0', length) != NULL)
+        {
+            // Strings are written without their terminating zero
+            m_bFailed = true;
+            return std::string();
+        }
+        return std::string(pData, length);
+    }
+
+    TiXmlElement* ReadElement(int depth = 0)
+    {
+        if (depth > MAX_ELEMENT_DEPTH)
+        {
+            m_bFailed = true;
+            return NULL;
+        }
+
+        std::string elemName = ReadString();
+        if (elemName.empty())
+        {
+            m_bFailed = true;
+            return NULL;
+        }
+
+        TiXmlElement* pElem = new TiXmlElement(elemName.c_str());
+
+        uint32 attributesCount = ReadUInt32();
+        for (uint32 attrIdx = 0; attrIdx < attributesCount && !m_bFailed; attrIdx++)
+        {
+            std::string name = ReadString();
+            std::string value = ReadString();
+            if (name.empty())
+            {
+                m_bFailed = true;
+                break;
+            }
+            pElem->SetAttribute(name.c_str(), value.c_str());
+        }
+
+        uint32 childrenCount = ReadUInt32();
+        for (uint32 childIdx = 0; childIdx < childrenCount && !m_bFailed; childIdx++)
+        {
+            const char* pNodeType = Read(sizeof(uint8));
+            if (pNodeType == NULL)
+            {
+                break;
+            }
+
+            if (*pNodeType == LevelCacheNode_Element)
+            {
+                if (TiXmlElement* pChildElem = ReadElement(depth + 1))
+                {
+                    pElem->LinkEndChild(pChildElem);
+                }
+            }
+            else if (*pNodeType == LevelCacheNode_Text)
+            {
+                pElem->LinkEndChild(new TiXmlText(ReadString().c_str()));
+            }
+            else
+            {
+                m_bFailed = true;
+            }
+        }
+
+        if (m_bFailed)
+        {
+            delete pElem;
+            return NULL;
+        }
+
+        return pElem;
+    }
+
+    bool IsFailed() const { return m_bFailed; }
+    bool IsAtEnd() const { return m_Offset == m_Size; }
+
+private:
+    const char* m_pData;
+    uint32 m_Size;
+    uint32 m_Offset;
+    bool m_bFailed;
+};
+
+//=================================================================================================
+// class LevelCache
+//=================================================================================================
+
+static bool ParseTileDescription(TiXmlElement* pTileDescElem, TileDescription& tileDesc)
+{
+    TiXmlElement* pTileIdElem = pTileDescElem->FirstChildElement("TileId");
+    TiXmlElement* pTileSizeElem = pTileDescElem->FirstChildElement("Size");
+    TiXmlElement* pTypeElem = pTileDescElem->FirstChildElement("Type");
+    TiXmlElement* pInsideAttribElem = pTileDescElem->FirstChildElement("InsideAttrib");
+    TiXmlElement* pTileRectElem = pTileDescElem->FirstChildElement("TileRect");
+    if (!pTileIdElem || !pTileSizeElem || !pTypeElem || !pInsideAttribElem || !pTileRectElem)
+    {
+        return false;
+    }
+
+    tileDesc.tileId = std::stoi(pTileIdElem->GetText());
+    tileDesc.width = std::stoi(pTileSizeElem->Attribute("width"));
+    tileDesc.height = std::stoi(pTileSizeElem->Attribute("height"));
+
+    tileDesc.outsideAttrib = 0;
+    if (std::string(pTypeElem->GetText()) == "single")
+    {
+        tileDesc.type = WAP_TILE_TYPE_SINGLE;
+    }
+    else
+    {
+        tileDesc.type = WAP_TILE_TYPE_DOUBLE;
+        TiXmlElement* pOutsideAttribElem = pTileDescElem->FirstChildElement("OutsideAttrib");
+        if (!pOutsideAttribElem)
+        {
+            return false;
+        }
+        tileDesc.outsideAttrib = std::stoi(pOutsideAttribElem->GetText());
+    }
+    tileDesc.insideAttrib = std::stoi(pInsideAttribElem->GetText());
+
+    tileDesc.rect.left = std::stoi(pTileRectElem->Attribute("left"));
+    tileDesc.rect.top = std::stoi(pTileRectElem->Attribute("top"));
+    tileDesc.rect.right = std::stoi(pTileRectElem->Attribute("right"));
+    tileDesc.rect.bottom = std::stoi(pTileRectElem->Attribute("bottom"));
+
+    return true;
+}
+
+LevelCache::LevelCache(uint32 wwdChecksum, uint32 inputsChecksum)
+    :
+    m_WwdChecksum(wwdChecksum),
+    m_InputsChecksum(inputsChecksum),
+    m_pLevelRoot(NULL)
+{ }
+
+LevelCache::~LevelCache()
+{
+    SAFE_DELETE(m_pLevelRoot);
+}
+
+static uint32 UpdateChecksum(uint32 checksum, const void* pData, size_t size)
+{
+    return (uint32)mz_crc32(checksum, (const unsigned char*)pData, size);
+}
+
+uint32 LevelCache::CalculateInputsChecksum()
+{
+    // Has to cover every value WwdToXml reads from outside the WWD
+    uint32 checksum = MZ_CRC32_INIT;
+
+    uint32 actorPrototypesChecksum = g_pApp->GetActorPrototypesChecksum();
+    checksum = UpdateChecksum(checksum, &actorPrototypesChecksum, sizeof(actorPrototypesChecksum));
+
+    // Claw's physics component
+    float maxJumpHeight = g_pApp->GetGlobalOptions()->maxJumpHeight;
+    checksum = UpdateChecksum(checksum, &maxJumpHeight, sizeof(maxJumpHeight));
+
+    // HUD elements positioned proportionally to the window
+    Point windowSize = g_pApp->GetWindowSize();
+    Point windowScale = g_pApp->GetScale();
+    double windowProperties[] = { windowSize.x, windowSize.y, windowScale.x, windowScale.y };
+    checksum = UpdateChecksum(checksum, windowProperties, sizeof(windowProperties));
+
+    return checksum;
+}
+
+shared_ptr<LevelCache> LevelCache::CreateFromXml(TiXmlElement* pXmlLevel, uint32 wwdChecksum, uint32 inputsChecksum)
+{
+    assert(pXmlLevel != NULL);
+
+    PROFILE_CPU("LEVEL CACHE FROM XML");
+
+    shared_ptr<LevelCache> pLevel(new LevelCache(wwdChecksum, inputsChecksum));
+    pLevel->m_pLevelRoot = pXmlLevel->Clone()->ToElement();
+    assert(pLevel->m_pLevelRoot != NULL);
+
+    TiXmlElement* pLevelProperties = pLevel->m_pLevelRoot->FirstChildElement("LevelProperties");
+    if (!pLevelProperties)
+    {
+        LOG_ERROR("Level does not have level properties node.");
+        return nullptr;
+    }
+
+    TiXmlElement* pTileDescRootElem = pLevelProperties->FirstChildElement("TileDescriptions");
+    if (!pTileDescRootElem)
+    {
+        LOG_ERROR("Tile descriptions element not found.");
+        return nullptr;
+    }
+
+    for (TiXmlElement* pTileDescElem = pTileDescRootElem->FirstChildElement("TileDescription");
+        pTileDescElem; pTileDescElem = pTileDescElem->NextSiblingElement("TileDescription"))
+    {
+        TileDescription tileDesc;
+        if (!ParseTileDescription(pTileDescElem, tileDesc))
+        {
+            LOG_ERROR("Invalid tile description.");
+            return nullptr;
+        }
+
+        pLevel->m_TileDescriptionMap.insert(std::make_pair(tileDesc.tileId, tileDesc));
+    }
+    pTileDescRootElem->Clear();
+
+    for (TiXmlElement* pActorElem = pLevel->m_pLevelRoot->FirstChildElement("Actor");
+        pActorElem != NULL;
+        pActorElem = pActorElem->NextSiblingElement("Actor"))
+    {
+        TiXmlElement* pPlaneComponentElem = pActorElem->FirstChildElement("TilePlaneRenderComponent");
+        if (!pPlaneComponentElem)
+        {
+            continue;
+        }
+
+        TiXmlElement* pPlaneNameElem = TiXmlHandle(pPlaneComponentElem)
+            .FirstChildElement("PlaneProperties").FirstChildElement("PlaneName").ToElement();
+        TiXmlElement* pTilesElem = pPlaneComponentElem->FirstChildElement("Tiles");
+        if (!pPlaneNameElem || !pPlaneNameElem->GetText() || !pTilesElem)
+        {
+            LOG_ERROR("Tile plane is missing its name or tiles.");
+            return nullptr;
+        }
+
+        std::vector<int32>& planeTiles = pLevel->m_PlaneTilesMap[pPlaneNameElem->GetText()];
+        for (TiXmlElement* pTileElem = pTilesElem->FirstChildElement();
+            pTileElem != NULL;
+            pTileElem = pTileElem->NextSiblingElement())
+        {
+            planeTiles.push_back(std::stoi(pTileElem->GetText()));
+        }
+        pTilesElem->Clear();
+    }
+
+    return pLevel;
+}
+
+shared_ptr<LevelCache> LevelCache::LoadFromFile(const std::string& filePath, uint32 wwdChecksum, uint32 inputsChecksum)
+{
+    PROFILE_CPU("LEVEL CACHE LOAD");
+
+    std::ifstream file(filePath, std::ios::in | std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+    {
+        return nullptr;
+    }
+
+    std::streamoff fileSize = file.tellg();
+    if (fileSize < (std::streamoff)sizeof(LevelCacheHeader) || fileSize > UINT32_MAX)
+    {
+        LOG_WARNING("Level cache has invalid size: " + filePath);
+        return nullptr;
+    }
+
+    std::vector<char> buffer((size_t)fileSize);
+    file.seekg(0, std::ios::beg);
+    if (!file.read(buffer.data(), fileSize))
+    {
+        LOG_WARNING("Failed to read level cache: " + filePath);
+        return nullptr;
+    }
+
+    LevelCacheHeader header;
+    memcpy(&header, buffer.data(), sizeof(header));
+    if (memcmp(header.magic, g_LevelCacheMagic, sizeof(header.magic)) != 0 ||
+        header.version != g_Version ||
+        header.wwdChecksum != wwdChecksum ||
+        header.inputsChecksum != inputsChecksum ||
+        header.dataSize != fileSize - sizeof(header))
+    {
+        // Outdated cache, it will be rebuilt
+        return nullptr;
+    }
+
+    LevelCacheReader reader(buffer.data() + sizeof(header), header.dataSize);
+    shared_ptr<LevelCache> pLevel(new LevelCache(wwdChecksum, inputsChecksum));
+
+    uint32 tileDescriptionsCount = reader.ReadUInt32();
+    if (const char* pTileDescriptions = reader.ReadArray(tileDescriptionsCount, sizeof(TileDescription)))
+    {
+        for (uint32 tileDescIdx = 0; tileDescIdx < tileDescriptionsCount; tileDescIdx++)
+        {
+            TileDescription tileDesc;
+            memcpy(&tileDesc, pTileDescriptions + tileDescIdx * sizeof(TileDescription), sizeof(tileDesc));
+            pLevel->m_TileDescriptionMap.insert(std::make_pair(tileDesc.tileId, tileDesc));
+        }
+    }
+
+    uint32 planesCount = reader.ReadUInt32();
+    for (uint32 planeIdx = 0; planeIdx < planesCount && !reader.IsFailed(); planeIdx++)
+    {
+        std::string planeName = reader.ReadString();
+        uint32 tilesCount = reader.ReadUInt32();
+        if (const char* pTiles = reader.ReadArray(tilesCount, sizeof(int32)))
+        {
+            std::vector<int32>& planeTiles = pLevel->m_PlaneTilesMap[planeName];
+            planeTiles.resize(tilesCount);
+            if (tilesCount > 0)
+            {
+                memcpy(planeTiles.data(), pTiles, tilesCount * sizeof(int32));
+            }
+        }
+    }
+
+    pLevel->m_pLevelRoot = reader.ReadElement();
+
+    if (reader.IsFailed() || !reader.IsAtEnd() || pLevel->m_pLevelRoot == NULL)
+    {
+        LOG_WARNING("Level cache is corrupted: " + filePath);
+        return nullptr;
+    }
+
+    return pLevel;
+}
+
+bool LevelCache::SaveToFile(const std::string& filePath) const
+{
+    PROFILE_CPU("LEVEL CACHE SAVE");
+
+    assert(m_pLevelRoot != NULL);
+
+    LevelCacheWriter writer;
+
+    LevelCacheHeader header;
+    memcpy(header.magic, g_LevelCacheMagic, sizeof(header.magic));
+    header.version = g_Version;
+    header.wwdChecksum = m_WwdChecksum;
+    header.inputsChecksum = m_InputsChecksum;
+    header.dataSize = 0;
+    writer.Write(&header, sizeof(header));
+
+    writer.WriteUInt32((uint32)m_TileDescriptionMap.size());
+    for (auto& tileDescIter : m_TileDescriptionMap)
+    {
+        writer.Write(&tileDescIter.second, sizeof(TileDescription));
+    }
+
+    writer.WriteUInt32((uint32)m_PlaneTilesMap.size());
+    for (auto& planeTilesIter : m_PlaneTilesMap)
+    {
+        writer.WriteString(planeTilesIter.first.c_str());
+        writer.WriteUInt32((uint32)planeTilesIter.second.size());
+        writer.Write(planeTilesIter.second.data(), (uint32)(planeTilesIter.second.size() * sizeof(int32)));
+    }
+
+    writer.WriteElement(m_pLevelRoot);
+
+    std::vector<char>& buffer = writer.GetBuffer();
+    header.dataSize = (uint32)(buffer.size() - sizeof(header));
+    memcpy(buffer.data(), &header, sizeof(header));
+
+    std::ofstream file(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open() || !file.write(buffer.data(), buffer.size()))
+    {
+        LOG_WARNING("Failed to write level cache: " + filePath);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,56 @@
+#ifndef __LEVEL_CACHE_H__
+#define __LEVEL_CACHE_H__
+
+#include "../SharedDefines.h"
+#include "BaseGameLogic.h"
+
+//=================================================================================================
+// class LevelCache
+//
+//     Precompiled level. Level xml produced by WwdToXml is split into tile descriptions, raw
+//     plane tile arrays and actor records and stored in a compact binary file keyed by
+//     checksum of the WWD it was built from and checksum of all other inputs of WwdToXml.
+//     Next time the level is loaded, the whole file is read at once and no xml text has to
+//     be parsed.
+//
+//=================================================================================================
+
+class LevelCache
+{
+public:
+    // Has to be bumped whenever file layout or WwdToXml output changes so that stale caches get rebuilt
+    static const uint32 g_Version;
+
+    ~LevelCache();
+
+    // Checksum of everything besides WWD that WwdToXml output depends on - actor prototypes
+    // it expands and game options / window properties it bakes into actor xmls
+    static uint32 CalculateInputsChecksum();
+
+    // Copies given level xml, it is expected to be in format produced by WwdToXml
+    static shared_ptr<LevelCache> CreateFromXml(TiXmlElement* pXmlLevel, uint32 wwdChecksum, uint32 inputsChecksum);
+
+    // Returns nullptr if cache file does not exist, is corrupted or was built from different WWD, inputs or version
+    static shared_ptr<LevelCache> LoadFromFile(const std::string& filePath, uint32 wwdChecksum, uint32 inputsChecksum);
+    bool SaveToFile(const std::string& filePath) const;
+
+    uint32 GetWwdChecksum() const { return m_WwdChecksum; }
+    uint32 GetInputsChecksum() const { return m_InputsChecksum; }
+
+    // Level properties and actors. <TileDescriptions> and plane <Tiles> elements are left empty,
+    // their contents are accessible through GetTileDescriptions() and GetPlaneTiles()
+    TiXmlElement* GetLevelRoot() const { return m_pLevelRoot; }
+    const TileDescriptionMap& GetTileDescriptions() const { return m_TileDescriptionMap; }
+    const PlaneTilesMap& GetPlaneTiles() const { return m_PlaneTilesMap; }
+
+private:
+    LevelCache(uint32 wwdChecksum, uint32 inputsChecksum);
+
+    uint32 m_WwdChecksum;
+    uint32 m_InputsChecksum;
+    TiXmlElement* m_pLevelRoot;
+    TileDescriptionMap m_TileDescriptionMap;
+    PlaneTilesMap m_PlaneTilesMap;
+};
+
+#endif
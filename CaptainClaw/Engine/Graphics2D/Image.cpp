@@ -1,6 +1,8 @@
 #include <assert.h>
+#include <vector>
 #include <SDL2/SDL_image.h>
 #include "Image.h"
+#include "TextureResidencyManager.h"
 #include "../SharedDefines.h"
 
 Image::Image()
@@ -9,100 +11,116 @@ Image::Image()
     m_Height(0),
     m_OffsetX(0),
     m_OffsetY(0),
-    m_pTexture(NULL)
+    m_pTexture(NULL),
+    m_LastUsedFrame(0),
+    m_ResidentMemorySize(0),
+    m_PinCount(0)
 {
-    
+    m_SourceRect = { 0, 0, 0, 0 };
+
+    if (TextureResidencyManager* pResidencyManager = TextureResidencyManager::Get())
+    {
+        pResidencyManager->RegisterImage(this);
+    }
 }
 
 Image::~Image()
 {
-    SDL_DestroyTexture(m_pTexture);
+    if (TextureResidencyManager* pResidencyManager = TextureResidencyManager::Get())
+    {
+        pResidencyManager->UnregisterImage(this);
+    }
+
+    // Pages are destroyed with their last view, evicted textures are already gone
+    if (m_pTexture != NULL)
+    {
+        SDL_DestroyTexture(m_pTexture);
+    }
     m_pTexture = NULL;
 }
 
-SDL_Rect Image::GetPositonRect(int32_t x, int32_t y)
+SDL_Texture* Image::GetTexture()
 {
-    int positionX = x - m_Width / 2 + m_OffsetX;
-    int positionY = y - m_Height / 2 + m_OffsetY;
+    // Whole page is stamped as used and reloaded, views do not have textures of their own
+    if (m_pPageImage)
+    {
+        return m_pPageImage->GetTexture();
+    }
 
-    SDL_Rect rect = { positionX, positionY, m_Width, m_Height };
+    if (TextureResidencyManager* pResidencyManager = TextureResidencyManager::Get())
+    {
+        pResidencyManager->OnImageUsed(this);
+    }
 
-    return rect;
+    return m_pTexture;
 }
 
-static void PutPixel(SDL_Surface *surface, int x, int y, Uint32 pixel)
+void Image::Pin()
 {
-    int bpp = surface->format->BytesPerPixel;
-    /* Here p is the address to the pixel we want to set */
-    Uint8 *p = (Uint8 *)surface->pixels + y * surface->pitch + x * bpp;
-
-    switch (bpp) {
-    case 1:
-        *p = pixel;
-        break;
-
-    case 2:
-        *(Uint16 *)p = pixel;
-        break;
+    m_PinCount++;
+    if (m_pPageImage)
+    {
+        m_pPageImage->Pin();
+    }
+}
 
-    case 3:
-        if (SDL_BYTEORDER == SDL_BIG_ENDIAN) {
-            p[0] = (pixel >> 16) & 0xff;
-            p[1] = (pixel >> 8) & 0xff;
-            p[2] = pixel & 0xff;
-        }
-        else {
-            p[0] = pixel & 0xff;
-            p[1] = (pixel >> 8) & 0xff;
-            p[2] = (pixel >> 16) & 0xff;
-        }
-        break;
+void Image::Unpin()
+{
+    assert(m_PinCount > 0);
 
-    case 4:
-        *(Uint32 *)p = pixel;
-        break;
+    m_PinCount--;
+    if (m_pPageImage)
+    {
+        m_pPageImage->Unpin();
     }
 }
 
-SDL_Texture* Image::GetTextureFromPid(WapPid* pid, SDL_Renderer* renderer)
+SDL_Rect Image::GetPositonRect(int32_t x, int32_t y)
 {
-    assert(pid != NULL);
-    assert(renderer != NULL);
-    
-    uint32_t rmask, gmask, bmask, amask;
-    uint32_t width = pid->width;
-    uint32_t height = pid->height;
+    int positionX = x - m_Width / 2 + m_OffsetX;
+    int positionY = y - m_Height / 2 + m_OffsetY;
 
+    SDL_Rect rect = { positionX, positionY, m_Width, m_Height };
+
+    return rect;
+}
+
+// Texture format with the same memory layout as WAP_ColorRGBA, so that decoded
+// PID pixels can be uploaded as they are without any conversion
 #if SDL_BYTEORDER == SDL_BIG_ENDIAN
-    rmask = 0xff000000;
-    gmask = 0x00ff0000;
-    bmask = 0x0000ff00;
-    amask = 0x000000ff;
+static const Uint32 PID_PIXEL_FORMAT = SDL_PIXELFORMAT_RGBA8888;
 #else
-    rmask = 0x000000ff;
-    gmask = 0x0000ff00;
-    bmask = 0x00ff0000;
-    amask = 0xff000000;
+static const Uint32 PID_PIXEL_FORMAT = SDL_PIXELFORMAT_ABGR8888;
 #endif
 
-    SDL_Surface* surface = SDL_CreateRGBSurface(0, width, height, 32, rmask, gmask, bmask, amask);
-    assert(surface != NULL);
-
-    uint32_t colorIdx;
-    uint32_t colorsCount = pid->colorsCount;
-    for (colorIdx = 0; colorIdx < colorsCount; colorIdx++)
+SDL_Texture* Image::CreateTextureFromPixels(const void* pixels, int width, int height, int pitch, SDL_Renderer* renderer)
+{
+    SDL_Texture* texture = SDL_CreateTexture(renderer, PID_PIXEL_FORMAT, SDL_TEXTUREACCESS_STATIC, width, height);
+    if (texture == NULL)
     {
-        WAP_ColorRGBA color = pid->colors[colorIdx];
-        uint32_t x = colorIdx % width;
-        uint32_t y = colorIdx / width;
+        LOG_ERROR(SDL_GetError());
+        return NULL;
+    }
+
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
 
-        PutPixel(surface, x, y, SDL_MapRGBA(surface->format, color.r, color.g, color.b, color.a));
+    if (SDL_UpdateTexture(texture, NULL, pixels, pitch) != 0)
+    {
+        LOG_ERROR(SDL_GetError());
+        SDL_DestroyTexture(texture);
+        return NULL;
     }
 
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    assert(texture != NULL);
+    return texture;
+}
 
-    SDL_FreeSurface(surface);
+SDL_Texture* Image::GetTextureFromPid(WapPid* pid, SDL_Renderer* renderer)
+{
+    assert(pid != NULL);
+    assert(renderer != NULL);
+
+    SDL_Texture* texture = CreateTextureFromPixels(pid->colors, pid->width, pid->height, pid->width * sizeof(WAP_ColorRGBA), renderer);
+    assert(texture != NULL);
 
     return texture;
 }
@@ -119,6 +137,66 @@ Image* Image::CreateImage(WapPid* pid, SDL_Renderer* renderer)
     return image;
 }
 
+Image* Image::CreatePidImage(char* rawBuffer, uint32_t size, WapPal* palette, SDL_Renderer* renderer)
+{
+    WapPid pidHeader;
+    if (WAP_PidLoadHeaderFromData(rawBuffer, size, &pidHeader) < 0)
+    {
+        LOG_ERROR("Invalid PID header");
+        return NULL;
+    }
+
+    // Width and height are read from file, reject them before anything gets allocated
+    if ((pidHeader.width == 0) || (pidHeader.height == 0) ||
+        (pidHeader.width > WAP_PID_MAX_DIMENSION) || (pidHeader.height > WAP_PID_MAX_DIMENSION))
+    {
+        LOG_ERROR("Invalid PID dimensions: " + ToStr(pidHeader.width) + "x" + ToStr(pidHeader.height));
+        return NULL;
+    }
+
+    SDL_Texture* pTexture = CreateTextureFromPidData(rawBuffer, size, palette, renderer);
+    if (pTexture == NULL)
+    {
+        return NULL;
+    }
+
+    Image* pImage = new Image();
+    if (!pImage->Initialize(pTexture))
+    {
+        delete pImage;
+        SDL_DestroyTexture(pTexture);
+        return NULL;
+    }
+
+    pImage->SetOffset(pidHeader.offsetX, pidHeader.offsetY);
+
+    return pImage;
+}
+
+SDL_Texture* Image::CreateTextureFromPidData(char* rawBuffer, uint32_t size, WapPal* palette, SDL_Renderer* renderer)
+{
+    WapPid pidHeader;
+    if (WAP_PidLoadHeaderFromData(rawBuffer, size, &pidHeader) < 0)
+    {
+        LOG_ERROR("Invalid PID header");
+        return NULL;
+    }
+
+    // Pixels are decoded in single pass straight into the buffer which is uploaded to texture.
+    // Images are created only on main thread so the buffer can be reused
+    static std::vector<uint32_t> s_PixelBuffer;
+    s_PixelBuffer.resize((size_t)pidHeader.width * pidHeader.height);
+
+    uint32_t pitch = pidHeader.width * sizeof(uint32_t);
+    if (WAP_PidDecodeIntoBuffer(rawBuffer, size, palette, s_PixelBuffer.data(), pitch) < 0)
+    {
+        LOG_ERROR("Could not decode PID image");
+        return NULL;
+    }
+
+    return CreateTextureFromPixels(s_PixelBuffer.data(), pidHeader.width, pidHeader.height, pitch, renderer);
+}
+
 Image* Image::CreatePcxImage(char* rawBuffer, uint32_t size, SDL_Renderer* renderer, bool useColorKey, SDL_Color colorKey)
 {
     Image* pImage = new Image();
@@ -213,6 +291,37 @@ Image* Image::CreateImageFromColor(SDL_Color color, int w, int h, SDL_Renderer*
     return pImage;
 }
 
+Image* Image::CreateImageFromTexture(SDL_Texture* pTexture)
+{
+    Image* pImage = new Image();
+    if (!pImage->Initialize(pTexture))
+    {
+        delete pImage;
+        return NULL;
+    }
+
+    return pImage;
+}
+
+Image* Image::CreateImageView(std::shared_ptr<Image> pPageImage, const SDL_Rect& sourceRect, int offsetX, int offsetY)
+{
+    if (!pPageImage)
+    {
+        return NULL;
+    }
+
+    // Views take no memory of their own, the page is accounted for as a whole
+    Image* pImage = new Image();
+    pImage->m_pPageImage = pPageImage;
+    pImage->m_SourceRect = sourceRect;
+    pImage->m_Width = sourceRect.w;
+    pImage->m_Height = sourceRect.h;
+    pImage->m_OffsetX = offsetX;
+    pImage->m_OffsetY = offsetY;
+
+    return pImage;
+}
+
 bool Image::Initialize(WapPid* pid, SDL_Renderer* renderer)
 {
     if (pid == NULL || renderer == NULL)
@@ -231,6 +340,13 @@ bool Image::Initialize(WapPid* pid, SDL_Renderer* renderer)
         return false;
     }
 
+    m_SourceRect = { 0, 0, m_Width, m_Height };
+
+    if (TextureResidencyManager* pResidencyManager = TextureResidencyManager::Get())
+    {
+        pResidencyManager->UpdateImageMemory(this);
+    }
+
     return true;
 }
 
@@ -244,6 +360,12 @@ bool Image::Initialize(SDL_Texture* pTexture)
     SDL_QueryTexture(pTexture, NULL, NULL, &m_Width, &m_Height);
     m_OffsetX = m_OffsetY = 0;
     m_pTexture = pTexture;
+    m_SourceRect = { 0, 0, m_Width, m_Height };
+
+    if (TextureResidencyManager* pResidencyManager = TextureResidencyManager::Get())
+    {
+        pResidencyManager->UpdateImageMemory(this);
+    }
 
     return true;
 }
\ No newline at end of file
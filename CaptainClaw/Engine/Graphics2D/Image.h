@@ -4,7 +4,15 @@
 #include <libwap.h>
 #include <SDL2/SDL.h>
 #include <stdint.h>
+#include <functional>
+#include <memory>
 
+// Creates texture of the image again after it was evicted from video memory
+typedef std::function<SDL_Texture*(SDL_Renderer*)> TextureReloader;
+// Tells whether the reloader would currently produce the same texture
+typedef std::function<bool()> TextureReloadCondition;
+
+class TextureResidencyManager;
 class Image
 {
 public:
@@ -13,29 +21,72 @@ public:
 
     static SDL_Texture* GetTextureFromPid(WapPid* pid, SDL_Renderer* renderer);
     static Image* CreateImage(WapPid* pid, SDL_Renderer* renderer);
+    // Decodes PID data straight into the texture, without intermediate WapPid
+    static Image* CreatePidImage(char* rawBuffer, uint32_t size, WapPal* palette, SDL_Renderer* renderer);
+    static SDL_Texture* CreateTextureFromPidData(char* rawBuffer, uint32_t size, WapPal* palette, SDL_Renderer* renderer);
     static Image* CreatePcxImage(char* rawBuffer, uint32_t size, SDL_Renderer* renderer, bool useColorKey = false, SDL_Color colorKey = { 0, 0, 0, 0 });
     static Image* CreatePngImage(char* rawBuffer, uint32_t size, SDL_Renderer* renderer);
     static Image* CreateImageFromColor(SDL_Color color, int w, int h, SDL_Renderer* pRenderer);
+    // Takes ownership of the texture
+    static Image* CreateImageFromTexture(SDL_Texture* pTexture);
+    // Image which is only a part of page image's texture, e.g. texture atlas page
+    static Image* CreateImageView(std::shared_ptr<Image> pPageImage, const SDL_Rect& sourceRect, int offsetX, int offsetY);
+
+    // Creates texture from 32-bit pixels with the same memory layout as WAP_ColorRGBA
+    static SDL_Texture* CreateTextureFromPixels(const void* pixels, int width, int height, int pitch, SDL_Renderer* renderer);
 
-    inline SDL_Texture* GetTexture() { return m_pTexture; }
+    // Texture is uploaded again if it was evicted, so this should be called only when it is about to be drawn
+    SDL_Texture* GetTexture();
+    inline bool IsTextureResident() const { return m_pPageImage ? m_pPageImage->IsTextureResident() : m_pTexture != NULL; }
     inline int GetWidth() { return m_Width; }
     inline int GetHeight() { return m_Height; }
     inline int GetOffsetX() { return m_OffsetX; }
     inline int GetOffsetY() { return m_OffsetY; }
+    // Part of the texture which belongs to this image - whole texture unless the image is a view
+    inline const SDL_Rect* GetSourceRect() const { return &m_SourceRect; }
+    inline bool IsTextureShared() const { return m_pPageImage != nullptr; }
+    // Image which owns the shared texture, NULL unless the image is a view
+    inline const std::shared_ptr<Image>& GetPageImage() const { return m_pPageImage; }
+    // Approximate video memory taken by the image, views count only their part of the shared texture
+    inline uint32_t GetMemorySize() const { return m_Width * m_Height * 4; }
+
+    // Pinned images are never evicted, e.g. while they are used by live actors. Pinning a view pins its page
+    void Pin();
+    void Unpin();
+    inline bool IsPinned() const { return m_PinCount > 0; }
 
     void SetOffset(int x, int y) { m_OffsetX = x; m_OffsetY = y; }
+    // Images with reloader can have their texture evicted when video memory budget is exceeded,
+    // but only while the condition (if any) holds
+    void SetTextureReloader(const TextureReloader& reloader, const TextureReloadCondition& condition = nullptr)
+    {
+        m_TextureReloader = reloader;
+        m_TextureReloadCondition = condition;
+    }
 
     SDL_Rect GetPositonRect(int32_t x, int32_t y);
 
 private:
+    friend class TextureResidencyManager;
+
     bool Initialize(WapPid* pid, SDL_Renderer* renderer);
     bool Initialize(SDL_Texture* pTexture);
 
+    // NULL for views, their texture is owned by the page image
     SDL_Texture* m_pTexture;
+    std::shared_ptr<Image> m_pPageImage;
+    SDL_Rect m_SourceRect;
     int m_Width;
     int m_Height;
     int m_OffsetX;
     int m_OffsetY;
+
+    TextureReloader m_TextureReloader;
+    TextureReloadCondition m_TextureReloadCondition;
+    // Residency bookkeeping, see TextureResidencyManager
+    uint32_t m_LastUsedFrame;
+    uint32_t m_ResidentMemorySize;
+    uint32_t m_PinCount;
 };
 
 #endif
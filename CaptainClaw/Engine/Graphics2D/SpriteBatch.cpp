@@ -0,0 +1,349 @@
+#include <algorithm>
+#include <SDL2/SDL_loadso.h>
+
+#include "SpriteBatch.h"
+
+// Quads are bucketed into square cells of this size, in renderer's logical pixels
+static const int GRID_CELL_SIZE = 64;
+// Protects against absurdly large viewports, cells are coarser then
+static const int MAX_GRID_CELLS_ON_AXIS = 64;
+
+static bool RectsOverlap(const SDL_Rect& lhs, const SDL_Rect& rhs)
+{
+    return lhs.x < rhs.x + rhs.w && rhs.x < lhs.x + lhs.w &&
+           lhs.y < rhs.y + rhs.h && rhs.y < lhs.y + lhs.h;
+}
+
+static uint32_t PackColorMod(const SDL_Color& colorMod, uint8_t alpha)
+{
+    return ((uint32_t)colorMod.r << 24) | ((uint32_t)colorMod.g << 16) | ((uint32_t)colorMod.b << 8) | alpha;
+}
+
+SpriteBatch::SpriteBatch(SDL_Renderer* pRenderer)
+    :
+    m_pRenderer(pRenderer),
+    m_SortMode(SpriteSortMode_PreserveOverlaps),
+    m_UseGeometry(false),
+    m_pRenderGeometry(NULL),
+    m_GridWidth(1),
+    m_GridHeight(1),
+    m_LastDrawCallsCount(0)
+{
+    m_pRenderGeometry = LoadRenderGeometry();
+    m_UseGeometry = m_pRenderGeometry != NULL;
+}
+
+// Bundled SDL headers are older than 2.0.18, so SDL_RenderGeometry cannot be called directly.
+// SDL library which is actually loaded may have it, it is then looked up by its name
+SpriteBatch::RenderGeometryFunc SpriteBatch::LoadRenderGeometry()
+{
+    SDL_version linkedVersion;
+    SDL_GetVersion(&linkedVersion);
+    if (SDL_VERSIONNUM(linkedVersion.major, linkedVersion.minor, linkedVersion.patch) < SDL_VERSIONNUM(2, 0, 18))
+    {
+        return NULL;
+    }
+
+#if defined(_WIN32)
+    const char* sdlLibraryName = "SDL2.dll";
+#elif defined(__APPLE__)
+    const char* sdlLibraryName = "libSDL2-2.0.0.dylib";
+#elif defined(__ANDROID__)
+    const char* sdlLibraryName = "libSDL2.so";
+#else
+    const char* sdlLibraryName = "libSDL2-2.0.so.0";
+#endif
+
+    // Library is already loaded by the process, this only takes reference to it which is kept
+    // for the lifetime of the process
+    static void* s_pSdlLibrary = SDL_LoadObject(sdlLibraryName);
+    if (s_pSdlLibrary == NULL)
+    {
+        return NULL;
+    }
+
+    return (RenderGeometryFunc)SDL_LoadFunction(s_pSdlLibrary, "SDL_RenderGeometry");
+}
+
+void SpriteBatch::Begin(SpriteSortMode sortMode)
+{
+    m_SortMode = sortMode;
+    m_Quads.clear();
+
+    for (uint32_t cellIdx : m_UsedGridCells)
+    {
+        m_GridCells[cellIdx].clear();
+    }
+    m_UsedGridCells.clear();
+
+    if (m_SortMode == SpriteSortMode_PreserveOverlaps)
+    {
+        SDL_Rect viewport;
+        SDL_RenderGetViewport(m_pRenderer, &viewport);
+
+        m_GridWidth = std::min(std::max((viewport.w + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE, 1), MAX_GRID_CELLS_ON_AXIS);
+        m_GridHeight = std::min(std::max((viewport.h + GRID_CELL_SIZE - 1) / GRID_CELL_SIZE, 1), MAX_GRID_CELLS_ON_AXIS);
+        if (m_GridCells.size() < (size_t)(m_GridWidth * m_GridHeight))
+        {
+            m_GridCells.resize(m_GridWidth * m_GridHeight);
+        }
+    }
+}
+
+void SpriteBatch::Draw(SDL_Texture* pTexture, const SDL_Rect* pSourceRect, const SDL_Rect& destRect,
+    SDL_RendererFlip flip, SDL_Color colorMod, uint8_t alpha)
+{
+    if (pTexture == NULL || destRect.w <= 0 || destRect.h <= 0)
+    {
+        return;
+    }
+
+    SpriteQuad quad;
+    quad.pTexture = pTexture;
+    if (pSourceRect != NULL)
+    {
+        quad.sourceRect = *pSourceRect;
+    }
+    else
+    {
+        quad.sourceRect = { 0, 0, 0, 0 };
+        SDL_QueryTexture(pTexture, NULL, NULL, &quad.sourceRect.w, &quad.sourceRect.h);
+    }
+    quad.destRect = destRect;
+    quad.flip = flip;
+    quad.colorMod = colorMod;
+    quad.alpha = alpha;
+    quad.order = (uint32_t)m_Quads.size();
+    if (m_SortMode == SpriteSortMode_Disjoint)
+    {
+        quad.layer = 0;
+        m_Quads.push_back(quad);
+    }
+    else
+    {
+        quad.layer = CalculateLayer(quad);
+        m_Quads.push_back(quad);
+        AddToGrid(quad.order);
+    }
+}
+
+void SpriteBatch::Flush()
+{
+    m_LastDrawCallsCount = 0;
+    if (m_Quads.empty())
+    {
+        return;
+    }
+
+    SortQuads();
+    RenderQuads();
+
+    m_Quads.clear();
+}
+
+bool SpriteBatch::HasSameState(const SpriteQuad& lhs, const SpriteQuad& rhs) const
+{
+    if (lhs.pTexture != rhs.pTexture)
+    {
+        return false;
+    }
+
+    // Geometry carries modulation in its vertices, copies have to change texture's state
+    return m_UseGeometry || PackColorMod(lhs.colorMod, lhs.alpha) == PackColorMod(rhs.colorMod, rhs.alpha);
+}
+
+uint32_t SpriteBatch::CalculateLayer(const SpriteQuad& quad) const
+{
+    // Quad has to be drawn after every earlier quad it overlaps. If that quad has different state,
+    // it cannot be in the same group, so this quad goes to the next layer. Overlapping quads always
+    // share at least one cell. Quad spanning several cells can be tested more than once, which
+    // does not change the result
+    int minX, minY, maxX, maxY;
+    GetGridCells(quad.destRect, minX, minY, maxX, maxY);
+
+    uint32_t layer = 0;
+    for (int y = minY; y <= maxY; ++y)
+    {
+        for (int x = minX; x <= maxX; ++x)
+        {
+            for (uint32_t otherQuadIdx : m_GridCells[y * m_GridWidth + x])
+            {
+                const SpriteQuad& otherQuad = m_Quads[otherQuadIdx];
+                if (RectsOverlap(quad.destRect, otherQuad.destRect))
+                {
+                    uint32_t minLayer = HasSameState(quad, otherQuad) ? otherQuad.layer : otherQuad.layer + 1;
+                    layer = std::max(layer, minLayer);
+                }
+            }
+        }
+    }
+
+    return layer;
+}
+
+void SpriteBatch::GetGridCells(const SDL_Rect& rect, int& outMinX, int& outMinY, int& outMaxX, int& outMaxY) const
+{
+    // Clamping keeps cell ranges of overlapping rects overlapping
+    auto toCell = [](int coord, int numCells)
+    {
+        int cell = (coord >= 0) ? (coord / GRID_CELL_SIZE) : -1;
+        return std::min(std::max(cell, 0), numCells - 1);
+    };
+
+    outMinX = toCell(rect.x, m_GridWidth);
+    outMinY = toCell(rect.y, m_GridHeight);
+    outMaxX = toCell(rect.x + rect.w - 1, m_GridWidth);
+    outMaxY = toCell(rect.y + rect.h - 1, m_GridHeight);
+}
+
+void SpriteBatch::AddToGrid(uint32_t quadIdx)
+{
+    int minX, minY, maxX, maxY;
+    GetGridCells(m_Quads[quadIdx].destRect, minX, minY, maxX, maxY);
+
+    for (int y = minY; y <= maxY; ++y)
+    {
+        for (int x = minX; x <= maxX; ++x)
+        {
+            uint32_t cellIdx = y * m_GridWidth + x;
+            if (m_GridCells[cellIdx].empty())
+            {
+                m_UsedGridCells.push_back(cellIdx);
+            }
+            m_GridCells[cellIdx].push_back(quadIdx);
+        }
+    }
+}
+
+void SpriteBatch::SortQuads()
+{
+    m_SortedQuads.resize(m_Quads.size());
+    for (uint32_t quadIdx = 0; quadIdx < m_Quads.size(); ++quadIdx)
+    {
+        m_SortedQuads[quadIdx] = quadIdx;
+    }
+
+    const bool useGeometry = m_UseGeometry;
+    const std::vector<SpriteQuad>& quads = m_Quads;
+    std::sort(m_SortedQuads.begin(), m_SortedQuads.end(), [&quads, useGeometry](uint32_t lhsIdx, uint32_t rhsIdx)
+    {
+        const SpriteQuad& lhs = quads[lhsIdx];
+        const SpriteQuad& rhs = quads[rhsIdx];
+        if (lhs.layer != rhs.layer)
+        {
+            return lhs.layer < rhs.layer;
+        }
+        if (lhs.pTexture != rhs.pTexture)
+        {
+            return lhs.pTexture < rhs.pTexture;
+        }
+        if (!useGeometry)
+        {
+            uint32_t lhsMod = PackColorMod(lhs.colorMod, lhs.alpha);
+            uint32_t rhsMod = PackColorMod(rhs.colorMod, rhs.alpha);
+            if (lhsMod != rhsMod)
+            {
+                return lhsMod < rhsMod;
+            }
+        }
+
+        return lhs.order < rhs.order;
+    });
+}
+
+void SpriteBatch::RenderQuads()
+{
+    if (m_UseGeometry)
+    {
+        uint32_t runStart = 0;
+        while (runStart < m_SortedQuads.size())
+        {
+            SDL_Texture* pTexture = m_Quads[m_SortedQuads[runStart]].pTexture;
+
+            int textureWidth = 0, textureHeight = 0;
+            SDL_QueryTexture(pTexture, NULL, NULL, &textureWidth, &textureHeight);
+            if (textureWidth <= 0 || textureHeight <= 0)
+            {
+                textureWidth = textureHeight = 1;
+            }
+
+            m_Vertices.clear();
+            m_Indices.clear();
+
+            uint32_t runEnd = runStart;
+            for (; runEnd < m_SortedQuads.size(); ++runEnd)
+            {
+                const SpriteQuad& quad = m_Quads[m_SortedQuads[runEnd]];
+                if (quad.pTexture != pTexture)
+                {
+                    break;
+                }
+
+                float u0 = quad.sourceRect.x / (float)textureWidth;
+                float v0 = quad.sourceRect.y / (float)textureHeight;
+                float u1 = (quad.sourceRect.x + quad.sourceRect.w) / (float)textureWidth;
+                float v1 = (quad.sourceRect.y + quad.sourceRect.h) / (float)textureHeight;
+                if (quad.flip & SDL_FLIP_HORIZONTAL)
+                {
+                    std::swap(u0, u1);
+                }
+                if (quad.flip & SDL_FLIP_VERTICAL)
+                {
+                    std::swap(v0, v1);
+                }
+
+                float x0 = (float)quad.destRect.x;
+                float y0 = (float)quad.destRect.y;
+                float x1 = (float)(quad.destRect.x + quad.destRect.w);
+                float y1 = (float)(quad.destRect.y + quad.destRect.h);
+                SDL_Color color = { quad.colorMod.r, quad.colorMod.g, quad.colorMod.b, quad.alpha };
+
+                int firstVertex = (int)m_Vertices.size();
+                m_Vertices.push_back({ x0, y0, color, u0, v0 });
+                m_Vertices.push_back({ x1, y0, color, u1, v0 });
+                m_Vertices.push_back({ x1, y1, color, u1, v1 });
+                m_Vertices.push_back({ x0, y1, color, u0, v1 });
+
+                const int quadIndices[] = { 0, 1, 2, 0, 2, 3 };
+                for (int index : quadIndices)
+                {
+                    m_Indices.push_back(firstVertex + index);
+                }
+            }
+
+            // Modulation is in the vertices, texture itself must not modulate again
+            SDL_SetTextureColorMod(pTexture, 255, 255, 255);
+            SDL_SetTextureAlphaMod(pTexture, 255);
+            m_pRenderGeometry(m_pRenderer, pTexture, m_Vertices.data(), (int)m_Vertices.size(),
+                m_Indices.data(), (int)m_Indices.size());
+            m_LastDrawCallsCount++;
+
+            runStart = runEnd;
+        }
+
+        return;
+    }
+
+    const SpriteQuad* pPreviousQuad = NULL;
+    for (uint32_t quadIdx : m_SortedQuads)
+    {
+        const SpriteQuad& quad = m_Quads[quadIdx];
+        if (pPreviousQuad == NULL || !HasSameState(*pPreviousQuad, quad))
+        {
+            SDL_SetTextureAlphaMod(quad.pTexture, quad.alpha);
+            SDL_SetTextureColorMod(quad.pTexture, quad.colorMod.r, quad.colorMod.g, quad.colorMod.b);
+        }
+
+        if (quad.flip == SDL_FLIP_NONE)
+        {
+            SDL_RenderCopy(m_pRenderer, quad.pTexture, &quad.sourceRect, &quad.destRect);
+        }
+        else
+        {
+            SDL_RenderCopyEx(m_pRenderer, quad.pTexture, &quad.sourceRect, &quad.destRect, 0, NULL, quad.flip);
+        }
+        m_LastDrawCallsCount++;
+
+        pPreviousQuad = &quad;
+    }
+}
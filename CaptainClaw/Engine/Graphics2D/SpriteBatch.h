@@ -0,0 +1,94 @@
+#ifndef SPRITEBATCH_H_
+#define SPRITEBATCH_H_
+
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <vector>
+
+enum SpriteSortMode
+{
+    // Quads never overlap (e.g. tiles of one plane), so they can be freely grouped by texture
+    SpriteSortMode_Disjoint,
+    // Quads may overlap, they are grouped by texture only where it does not change what is seen on top
+    SpriteSortMode_PreserveOverlaps
+};
+
+//=================================================================================================
+// class SpriteBatch
+//
+//     Collects textured quads of one render pass and submits them together once the pass is
+//     finished. Quads are grouped by texture so that images packed in the same atlas page are
+//     drawn by a single SDL_RenderGeometry call. Bundled SDL headers predate the geometry API,
+//     so it is looked up in the loaded SDL library at runtime. Without it (SDL older than 2.0.18)
+//     every quad is still copied separately, but texture color and alpha modulation is set only
+//     when it changes.
+//
+class SpriteBatch
+{
+public:
+    SpriteBatch(SDL_Renderer* pRenderer);
+
+    void Begin(SpriteSortMode sortMode);
+    // Source rect can be NULL to draw whole texture
+    void Draw(SDL_Texture* pTexture, const SDL_Rect* pSourceRect, const SDL_Rect& destRect,
+        SDL_RendererFlip flip = SDL_FLIP_NONE, SDL_Color colorMod = { 255, 255, 255, 255 }, uint8_t alpha = 255);
+    // Renders all quads queued since Begin(), has to be called before anything else is drawn
+    void Flush();
+
+    // Number of draw calls (geometry submissions or texture copies) issued by the last Flush()
+    uint32_t GetLastDrawCallsCount() const { return m_LastDrawCallsCount; }
+
+private:
+    // Same memory layout as SDL_Vertex of SDL 2.0.18
+    struct SpriteVertex
+    {
+        float x, y;
+        SDL_Color color;
+        float u, v;
+    };
+    typedef int (SDLCALL *RenderGeometryFunc)(SDL_Renderer* pRenderer, SDL_Texture* pTexture,
+        const SpriteVertex* pVertices, int numVertices, const int* pIndices, int numIndices);
+
+    struct SpriteQuad
+    {
+        SDL_Texture* pTexture;
+        SDL_Rect sourceRect;
+        SDL_Rect destRect;
+        SDL_RendererFlip flip;
+        SDL_Color colorMod;
+        uint8_t alpha;
+        // Quads of the same layer with different state never overlap
+        uint32_t layer;
+        uint32_t order;
+    };
+
+    static RenderGeometryFunc LoadRenderGeometry();
+
+    bool HasSameState(const SpriteQuad& lhs, const SpriteQuad& rhs) const;
+    uint32_t CalculateLayer(const SpriteQuad& quad) const;
+    void GetGridCells(const SDL_Rect& rect, int& outMinX, int& outMinY, int& outMaxX, int& outMaxY) const;
+    void AddToGrid(uint32_t quadIdx);
+    void SortQuads();
+    void RenderQuads();
+
+    SDL_Renderer* m_pRenderer;
+    SpriteSortMode m_SortMode;
+    bool m_UseGeometry;
+    RenderGeometryFunc m_pRenderGeometry;
+
+    std::vector<SpriteQuad> m_Quads;
+    std::vector<uint32_t> m_SortedQuads;
+    std::vector<SpriteVertex> m_Vertices;
+    std::vector<int> m_Indices;
+
+    // Quads which may overlap are bucketed by screen cells, so that only quads sharing a cell are
+    // tested for overlaps. Rects outside of the viewport are clamped to its border cells
+    std::vector<std::vector<uint32_t>> m_GridCells;
+    std::vector<uint32_t> m_UsedGridCells;
+    int m_GridWidth;
+    int m_GridHeight;
+
+    uint32_t m_LastDrawCallsCount;
+};
+
+#endif
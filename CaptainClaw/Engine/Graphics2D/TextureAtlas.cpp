@@ -0,0 +1,216 @@
+#include <assert.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "TextureAtlas.h"
+#include "Image.h"
+#include "../SharedDefines.h"
+
+// Largest atlas page, it is further limited by the renderer
+const int ATLAS_MAX_PAGE_SIZE = 2048;
+// Transparent space between packed images so that they do not bleed into each other when scaled
+const int ATLAS_PADDING = 1;
+
+TextureAtlas::TextureAtlas(SDL_Renderer* pRenderer)
+    :
+    m_pRenderer(pRenderer),
+    m_PagesCount(0)
+{
+
+}
+
+bool TextureAtlas::AddPid(const std::string& name, WapPid* pPid)
+{
+    if (pPid == NULL || pPid->colors == NULL)
+    {
+        return false;
+    }
+
+    AtlasEntry entry = { name, pPid, NULL, 0, (int)pPid->width, (int)pPid->height, pPid->offsetX, pPid->offsetY, -1 };
+    m_Entries.push_back(entry);
+
+    return true;
+}
+
+bool TextureAtlas::AddPidData(const std::string& name, char* pidData, uint32_t size)
+{
+    WapPid pidHeader;
+    if (WAP_PidLoadHeaderFromData(pidData, size, &pidHeader) < 0)
+    {
+        return false;
+    }
+
+    AtlasEntry entry = { name, NULL, pidData, size, (int)pidHeader.width, (int)pidHeader.height, pidHeader.offsetX, pidHeader.offsetY, -1 };
+    m_Entries.push_back(entry);
+
+    return true;
+}
+
+int TextureAtlas::GetMaxPageSize() const
+{
+    int maxPageSize = ATLAS_MAX_PAGE_SIZE;
+
+    SDL_RendererInfo rendererInfo;
+    if (m_pRenderer != NULL && SDL_GetRendererInfo(m_pRenderer, &rendererInfo) == 0)
+    {
+        if (rendererInfo.max_texture_width > 0)
+        {
+            maxPageSize = std::min(maxPageSize, rendererInfo.max_texture_width);
+        }
+        if (rendererInfo.max_texture_height > 0)
+        {
+            maxPageSize = std::min(maxPageSize, rendererInfo.max_texture_height);
+        }
+    }
+
+    return maxPageSize;
+}
+
+// Shelf packing - images sorted by their height are placed into rows from left to right
+void TextureAtlas::PackEntries(std::vector<AtlasPage>& pages)
+{
+    const int maxPageSize = GetMaxPageSize();
+
+    std::vector<uint32_t> sortedEntries;
+    int64_t totalArea = 0;
+    int maxEntryWidth = 0;
+    for (uint32_t entryIdx = 0; entryIdx < m_Entries.size(); entryIdx++)
+    {
+        const AtlasEntry& entry = m_Entries[entryIdx];
+        int paddedWidth = entry.width + ATLAS_PADDING;
+        int paddedHeight = entry.height + ATLAS_PADDING;
+
+        // Images which do not fit into any page stay out of the atlas
+        if (entry.width <= 0 || entry.height <= 0 || paddedWidth > maxPageSize || paddedHeight > maxPageSize)
+        {
+            continue;
+        }
+
+        sortedEntries.push_back(entryIdx);
+        totalArea += (int64_t)paddedWidth * paddedHeight;
+        maxEntryWidth = max(maxEntryWidth, paddedWidth);
+    }
+
+    std::sort(sortedEntries.begin(), sortedEntries.end(), [this](uint32_t left, uint32_t right)
+    {
+        const AtlasEntry& leftEntry = m_Entries[left];
+        const AtlasEntry& rightEntry = m_Entries[right];
+        if (leftEntry.height != rightEntry.height)
+        {
+            return leftEntry.height > rightEntry.height;
+        }
+        return leftEntry.width > rightEntry.width;
+    });
+
+    // Small image sets should not occupy the whole page, aim for roughly square pages
+    int pageWidth = (int)std::ceil(std::sqrt((double)totalArea) * 1.1);
+    pageWidth = std::min(max(pageWidth, maxEntryWidth), maxPageSize);
+
+    int shelfX = 0;
+    int shelfY = 0;
+    int shelfHeight = 0;
+    for (uint32_t entryIdx : sortedEntries)
+    {
+        AtlasEntry& entry = m_Entries[entryIdx];
+        int paddedWidth = entry.width + ATLAS_PADDING;
+        int paddedHeight = entry.height + ATLAS_PADDING;
+
+        // Next shelf
+        if (shelfX + paddedWidth > pageWidth)
+        {
+            shelfX = 0;
+            shelfY += shelfHeight;
+            shelfHeight = 0;
+        }
+
+        // Next page
+        if (pages.empty() || shelfY + paddedHeight > maxPageSize)
+        {
+            AtlasPage page;
+            page.width = pageWidth;
+            page.height = 0;
+            pages.push_back(page);
+
+            shelfX = 0;
+            shelfY = 0;
+            shelfHeight = 0;
+        }
+
+        AtlasPage& page = pages.back();
+
+        entry.pageIdx = (int)pages.size() - 1;
+        entry.rect = { shelfX, shelfY, entry.width, entry.height };
+        page.entries.push_back(entryIdx);
+        page.height = max(page.height, shelfY + paddedHeight);
+
+        shelfX += paddedWidth;
+        shelfHeight = max(shelfHeight, paddedHeight);
+    }
+}
+
+bool TextureAtlas::CopyEntryPixels(const AtlasEntry& entry, WapPal* palette, uint32_t* pagePixels, int pageWidth)
+{
+    uint32_t* pDest = pagePixels + entry.rect.y * pageWidth + entry.rect.x;
+    uint32_t pitch = pageWidth * sizeof(uint32_t);
+
+    // Raw data are decoded directly into the page
+    if (entry.pPid == NULL)
+    {
+        return WAP_PidDecodeIntoBuffer(entry.pidData, entry.pidDataSize, palette, pDest, pitch) == 0;
+    }
+
+    for (int y = 0; y < entry.height; y++)
+    {
+        memcpy(pDest + y * pageWidth, &entry.pPid->colors[y * entry.width], entry.width * sizeof(uint32_t));
+    }
+
+    return true;
+}
+
+std::map<std::string, std::shared_ptr<Image>> TextureAtlas::Build(WapPal* palette)
+{
+    std::map<std::string, std::shared_ptr<Image>> images;
+
+    std::vector<AtlasPage> pages;
+    PackEntries(pages);
+
+    std::vector<uint32_t> pagePixels;
+    for (const AtlasPage& page : pages)
+    {
+        // Everything which is not covered by any image stays transparent
+        pagePixels.assign(page.width * page.height, 0);
+
+        std::vector<uint32_t> copiedEntries;
+        for (uint32_t entryIdx : page.entries)
+        {
+            if (CopyEntryPixels(m_Entries[entryIdx], palette, pagePixels.data(), page.width))
+            {
+                copiedEntries.push_back(entryIdx);
+            }
+        }
+
+        SDL_Texture* pTexture = Image::CreateTextureFromPixels(pagePixels.data(), 
+            page.width, page.height, page.width * sizeof(uint32_t), m_pRenderer);
+        if (pTexture == NULL)
+        {
+            LOG_ERROR("Failed to create texture atlas page");
+            continue;
+        }
+
+        // Page lives as long as any of its views
+        std::shared_ptr<Image> pPageImage(Image::CreateImageFromTexture(pTexture));
+        for (uint32_t entryIdx : copiedEntries)
+        {
+            const AtlasEntry& entry = m_Entries[entryIdx];
+            images[entry.name] = std::shared_ptr<Image>(
+                Image::CreateImageView(pPageImage, entry.rect, entry.offsetX, entry.offsetY));
+        }
+
+        m_PagesCount++;
+    }
+
+    m_Entries.clear();
+
+    return images;
+}
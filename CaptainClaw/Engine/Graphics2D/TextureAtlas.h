@@ -0,0 +1,69 @@
+#ifndef TEXTUREATLAS_H_
+#define TEXTUREATLAS_H_
+
+#include <libwap.h>
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Image;
+
+//=================================================================================================
+// class TextureAtlas
+//
+//     Packs images of one image set (e.g. all frames of an actor or all tiles of a plane) into
+//     few large textures. Every packed image is only a view into its atlas page, so that drawing
+//     from the same image set does not need to switch textures.
+//
+class TextureAtlas
+{
+public:
+    TextureAtlas(SDL_Renderer* pRenderer);
+
+    // Queues already decoded PID, it has to stay valid until Build() is called
+    bool AddPid(const std::string& name, WapPid* pPid);
+    // Queues raw PID data which get decoded straight into atlas page, they have to stay valid until Build() is called
+    bool AddPidData(const std::string& name, char* pidData, uint32_t size);
+
+    // Packs all queued images and uploads atlas pages. Returns views into the pages keyed by image name,
+    // images which could not be packed (e.g. are larger than page) are not present in the result.
+    // Pages cannot be reloaded unless their owner sets reloader to their page images
+    std::map<std::string, std::shared_ptr<Image>> Build(WapPal* palette);
+
+    uint32_t GetPagesCount() const { return m_PagesCount; }
+
+private:
+    struct AtlasEntry
+    {
+        std::string name;
+        WapPid* pPid;
+        char* pidData;
+        uint32_t pidDataSize;
+        int width;
+        int height;
+        int offsetX;
+        int offsetY;
+        int pageIdx;
+        SDL_Rect rect;
+    };
+
+    struct AtlasPage
+    {
+        int width;
+        int height;
+        std::vector<uint32_t> entries;
+    };
+
+    int GetMaxPageSize() const;
+    void PackEntries(std::vector<AtlasPage>& pages);
+    bool CopyEntryPixels(const AtlasEntry& entry, WapPal* palette, uint32_t* pagePixels, int pageWidth);
+
+    SDL_Renderer* m_pRenderer;
+    std::vector<AtlasEntry> m_Entries;
+    uint32_t m_PagesCount;
+};
+
+#endif
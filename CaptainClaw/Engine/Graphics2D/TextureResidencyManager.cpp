@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <vector>
+
+#include "TextureResidencyManager.h"
+#include "Image.h"
+#include "../SharedDefines.h"
+
+static TextureResidencyManager* g_pTextureResidencyManager = NULL;
+
+TextureResidencyManager::TextureResidencyManager(SDL_Renderer* pRenderer, uint64_t budgetBytes)
+    :
+    m_pRenderer(pRenderer),
+    m_BudgetBytes(budgetBytes),
+    m_ImageBytes(0),
+    m_RenderTargetBytes(0),
+    m_BlockedUsageBytes(0),
+    m_FrameIdx(0),
+    m_EvictionsCount(0),
+    m_ReloadsCount(0)
+{
+    if (g_pTextureResidencyManager)
+    {
+        LOG_ERROR("Attempting to create two texture residency managers! The new one will replace the old one");
+    }
+
+    g_pTextureResidencyManager = this;
+}
+
+TextureResidencyManager::~TextureResidencyManager()
+{
+    // Images which outlive the manager are not accounted for anymore
+    for (Image* pImage : m_Images)
+    {
+        pImage->m_ResidentMemorySize = 0;
+    }
+
+    if (g_pTextureResidencyManager == this)
+    {
+        g_pTextureResidencyManager = NULL;
+    }
+}
+
+TextureResidencyManager* TextureResidencyManager::Get()
+{
+    return g_pTextureResidencyManager;
+}
+
+void TextureResidencyManager::RegisterImage(Image* pImage)
+{
+    m_Images.insert(pImage);
+    pImage->m_LastUsedFrame = m_FrameIdx;
+    UpdateImageMemory(pImage);
+}
+
+void TextureResidencyManager::UnregisterImage(Image* pImage)
+{
+    m_ImageBytes -= pImage->m_ResidentMemorySize;
+    pImage->m_ResidentMemorySize = 0;
+    m_Images.erase(pImage);
+}
+
+void TextureResidencyManager::UpdateImageMemory(Image* pImage)
+{
+    uint32_t memorySize = pImage->m_pTexture != NULL ? pImage->GetMemorySize() : 0;
+
+    m_ImageBytes = m_ImageBytes - pImage->m_ResidentMemorySize + memorySize;
+    pImage->m_ResidentMemorySize = memorySize;
+}
+
+void TextureResidencyManager::OnImageUsed(Image* pImage)
+{
+    pImage->m_LastUsedFrame = m_FrameIdx;
+
+    if (pImage->m_pTexture == NULL && pImage->m_TextureReloader && CanReloadTexture(pImage))
+    {
+        ReloadTexture(pImage);
+    }
+}
+
+void TextureResidencyManager::OnFrameRendered()
+{
+    uint64_t usedBytes = m_ImageBytes + m_RenderTargetBytes;
+    if (m_BudgetBytes > 0 && usedBytes > m_BudgetBytes)
+    {
+        // Evict a bit more than necessary so that it does not have to be done again next frame
+        if (!EvictTextures(m_BudgetBytes - m_BudgetBytes / 10) && m_ImageBytes + m_RenderTargetBytes != m_BlockedUsageBytes)
+        {
+            m_BlockedUsageBytes = m_ImageBytes + m_RenderTargetBytes;
+            LOG_WARNING("Texture memory budget cannot be met, " + ToStr((uint32)(m_BlockedUsageBytes / (1024 * 1024))) +
+                " MB is still in use after evicting everything which is not pinned or drawn");
+        }
+    }
+
+    m_FrameIdx++;
+}
+
+TextureResidencyStats TextureResidencyManager::GetStats() const
+{
+    TextureResidencyStats stats;
+    stats.budgetBytes = m_BudgetBytes;
+    stats.imageBytes = m_ImageBytes;
+    stats.renderTargetBytes = m_RenderTargetBytes;
+    stats.evictableBytes = 0;
+    stats.residentImagesCount = 0;
+    stats.evictedImagesCount = 0;
+    stats.evictionsCount = m_EvictionsCount;
+    stats.reloadsCount = m_ReloadsCount;
+
+    for (const Image* pImage : m_Images)
+    {
+        if (pImage->m_pTexture != NULL)
+        {
+            stats.residentImagesCount++;
+        }
+        else if (pImage->m_TextureReloader)
+        {
+            stats.evictedImagesCount++;
+        }
+
+        if (IsEvictable(pImage))
+        {
+            stats.evictableBytes += pImage->m_ResidentMemorySize;
+        }
+    }
+
+    return stats;
+}
+
+bool TextureResidencyManager::IsEvictable(const Image* pImage) const
+{
+    return pImage->m_pTexture != NULL && pImage->m_PinCount == 0 && pImage->m_TextureReloader &&
+        CanReloadTexture(pImage);
+}
+
+bool TextureResidencyManager::CanReloadTexture(const Image* pImage) const
+{
+    return !pImage->m_TextureReloadCondition || pImage->m_TextureReloadCondition();
+}
+
+bool TextureResidencyManager::EvictTextures(uint64_t targetBytes)
+{
+    // Textures drawn during this frame are needed, the rest goes from the least recently drawn
+    std::vector<Image*> candidates;
+    for (Image* pImage : m_Images)
+    {
+        if (IsEvictable(pImage) && pImage->m_LastUsedFrame != m_FrameIdx)
+        {
+            candidates.push_back(pImage);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const Image* pLhs, const Image* pRhs)
+    {
+        return pLhs->m_LastUsedFrame < pRhs->m_LastUsedFrame;
+    });
+
+    for (Image* pImage : candidates)
+    {
+        if (m_ImageBytes + m_RenderTargetBytes <= targetBytes)
+        {
+            break;
+        }
+
+        SDL_DestroyTexture(pImage->m_pTexture);
+        pImage->m_pTexture = NULL;
+        UpdateImageMemory(pImage);
+        m_EvictionsCount++;
+    }
+
+    return m_ImageBytes + m_RenderTargetBytes <= m_BudgetBytes;
+}
+
+bool TextureResidencyManager::ReloadTexture(Image* pImage)
+{
+    SDL_Texture* pTexture = pImage->m_TextureReloader(m_pRenderer);
+    if (pTexture == NULL)
+    {
+        // Do not try again every time the image is drawn
+        LOG_ERROR("Failed to upload evicted texture again");
+        pImage->m_TextureReloader = nullptr;
+        return false;
+    }
+
+    pImage->m_pTexture = pTexture;
+    UpdateImageMemory(pImage);
+    m_ReloadsCount++;
+
+    return true;
+}
@@ -0,0 +1,90 @@
+#ifndef TEXTURERESIDENCYMANAGER_H_
+#define TEXTURERESIDENCYMANAGER_H_
+
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_set>
+
+class Image;
+
+struct TextureResidencyStats
+{
+    uint64_t budgetBytes;
+    uint64_t imageBytes;
+    uint64_t renderTargetBytes;
+    // Part of image bytes which can be evicted and uploaded again later
+    uint64_t evictableBytes;
+    uint32_t residentImagesCount;
+    uint32_t evictedImagesCount;
+    uint32_t evictionsCount;
+    uint32_t reloadsCount;
+};
+
+//=================================================================================================
+// class TextureResidencyManager
+//
+//     Keeps track of video memory taken by all images and render targets. Every time image's
+//     texture is requested for drawing, it is stamped with current frame. Once the budget is
+//     exceeded, textures which were not drawn for the longest time are destroyed, as long as
+//     their images know how to upload them again (e.g. by decoding their resource). Evicted
+//     texture is uploaded again when it is requested next time. Views (e.g. into atlas page)
+//     have no texture of their own, drawing them stamps their page, which is accounted for and
+//     evicted as a whole. Pinned images (e.g. used by live actors) and images which cannot be
+//     reloaded are never evicted. If the rest does not get under the budget, as much as possible
+//     is evicted anyway.
+//
+class TextureResidencyManager
+{
+public:
+    // Budget of 0 means unlimited
+    TextureResidencyManager(SDL_Renderer* pRenderer, uint64_t budgetBytes);
+    ~TextureResidencyManager();
+
+    // Returns NULL if there is no manager, e.g. when images are used outside of the game
+    static TextureResidencyManager* Get();
+
+    void SetBudget(uint64_t budgetBytes) { m_BudgetBytes = budgetBytes; m_BlockedUsageBytes = 0; }
+    uint64_t GetBudget() const { return m_BudgetBytes; }
+
+    // Images register themselves upon creation and whenever their texture changes
+    void RegisterImage(Image* pImage);
+    void UnregisterImage(Image* pImage);
+    void UpdateImageMemory(Image* pImage);
+
+    // Called every time image's texture is requested, uploads it again if it was evicted
+    void OnImageUsed(Image* pImage);
+
+    // Render targets are only accounted for, their owners manage their lifetime
+    void OnRenderTargetCreated(uint32_t bytes) { m_RenderTargetBytes += bytes; }
+    void OnRenderTargetDestroyed(uint32_t bytes) { m_RenderTargetBytes -= bytes; }
+
+    // Has to be called once all drawing of the frame is done
+    void OnFrameRendered();
+
+    uint32_t GetFrameIdx() const { return m_FrameIdx; }
+    TextureResidencyStats GetStats() const;
+
+private:
+    bool IsEvictable(const Image* pImage) const;
+    bool CanReloadTexture(const Image* pImage) const;
+    // Evicts least recently used textures until target is reached, returns false if the budget
+    // is still exceeded afterwards
+    bool EvictTextures(uint64_t targetBytes);
+    bool ReloadTexture(Image* pImage);
+
+    SDL_Renderer* m_pRenderer;
+    uint64_t m_BudgetBytes;
+
+    std::unordered_set<Image*> m_Images;
+    uint64_t m_ImageBytes;
+    uint64_t m_RenderTargetBytes;
+    // Memory usage left after eviction last failed to meet the budget, so that it is not reported every frame
+    uint64_t m_BlockedUsageBytes;
+
+    uint32_t m_FrameIdx;
+    uint32_t m_EvictionsCount;
+    uint32_t m_ReloadsCount;
+};
+
+#endif
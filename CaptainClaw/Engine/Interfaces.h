@@ -552,6 +552,17 @@ public:
         return NULL;
     }
 
+    std::vector<IdType> GetRegisteredIds() const
+    {
+        std::vector<IdType> ids;
+        for (auto& creationFunctionIter : _creationFunctions)
+        {
+            ids.push_back(creationFunctionIter.first);
+        }
+
+        return ids;
+    }
+
 private:
     typedef BaseClass* (*ObjectCreationFunction)();
     std::map<IdType, ObjectCreationFunction> _creationFunctions;
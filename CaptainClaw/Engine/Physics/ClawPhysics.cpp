@@ -36,7 +36,7 @@ shared_ptr<PhysicsComponent> GetPhysicsComponentFromB2Body(const b2Body* pBody)
     }
 
     shared_ptr<PhysicsComponent> pPhysicsComponent =
-        MakeStrongPtr(pActor->GetComponent<PhysicsComponent>(PhysicsComponent::g_Name));
+        MakeStrongPtr(pActor->GetComponent<PhysicsComponent>());
     assert(pPhysicsComponent);
 
     return pPhysicsComponent;
@@ -53,7 +53,7 @@ shared_ptr<KinematicComponent> GetKinematicComponentFromB2Body(const b2Body* pBo
     }
 
     shared_ptr<KinematicComponent> pKinematicComponent =
-        MakeStrongPtr(pActor->GetComponent<KinematicComponent>(KinematicComponent::g_Name));
+        MakeStrongPtr(pActor->GetComponent<KinematicComponent>());
 
     return pKinematicComponent;
 }
@@ -85,7 +85,7 @@ shared_ptr<TriggerComponent> GetTriggerComponentFromB2Body(const b2Body* pBody)
         return nullptr;
     }
 
-    auto pWeakTrigComp = pActor->GetComponent<TriggerComponent>(TriggerComponent::g_Name);
+    auto pWeakTrigComp = pActor->GetComponent<TriggerComponent>();
     if (!pWeakTrigComp.expired())
     {
         shared_ptr<TriggerComponent> pTriggerComponent = MakeStrongPtr(pWeakTrigComp);
@@ -107,7 +107,7 @@ shared_ptr<ProjectileAIComponent> GetProjectileAIComponentFromB2Body(const b2Bod
 
     // May no longer be valid, calling methods have to check it
     shared_ptr<ProjectileAIComponent> pComponent =
-        MakeStrongPtr(pActor->GetComponent<ProjectileAIComponent>(ProjectileAIComponent::g_Name));
+        MakeStrongPtr(pActor->GetComponent<ProjectileAIComponent>());
 
     return pComponent;
 }
@@ -218,6 +218,12 @@ void ClawPhysics::VSyncVisibleScene()
     // check all the existing actor's bodies for changes. 
     //  If there is a change, send the appropriate event for the game system.
 
+    if (!m_pMoveActorBatch || m_pMoveActorBatch.use_count() != 1)
+    {
+        m_pMoveActorBatch = MakePooledEvent<EventData_Move_Actor_Batch>();
+    }
+    m_pMoveActorBatch->Clear();
+
     // Iterating vector or list has lower overhead
     /*for (ActorIDToBox2DBodyMap::const_iterator it = m_ActorToBodyMap.begin();
         it != m_ActorToBodyMap.end();
@@ -241,7 +247,7 @@ void ClawPhysics::VSyncVisibleScene()
         {
             /*shared_ptr<PositionComponent> pPositionComponent = MakeStrongPtr(pGameActor->GetComponent<PositionComponent>(PositionComponent::g_Name));*/
 
-            shared_ptr<PositionComponent> pPositionComponent = pGameActor->GetPositionComponent();
+            PositionComponent* pPositionComponent = pGameActor->GetRawComponent<PositionComponent>();
             assert(pPositionComponent);
 
             Point bodyPixelPosition = b2Vec2ToPoint(MetersToPixels(pActorBody->GetPosition()));
@@ -253,7 +259,8 @@ void ClawPhysics::VSyncVisibleScene()
             // This causes slight CPU (1.5%) overhead
             if (pActorBody->GetType() == b2_dynamicBody)
             {
-                shared_ptr<PhysicsComponent> pPhysicsComponent = GetPhysicsComponentFromB2Body(pActorBody);
+                PhysicsComponent* pPhysicsComponent = pGameActor->GetRawComponent<PhysicsComponent>();
+                assert(pPhysicsComponent);
                 bool wasFalling = pPhysicsComponent->IsFalling();
                 bool wasJumping = pPhysicsComponent->IsJumping();
                 // Set jumping / falling properties
@@ -361,8 +368,7 @@ void ClawPhysics::VSyncVisibleScene()
                 // Box2D has moved the physics object. Update actor's position and notify subsystems which care
                 pPositionComponent->SetPosition(bodyPixelPosition);
 
-                shared_ptr<EventData_Move_Actor> pEvent(new EventData_Move_Actor(actorId, bodyPixelPosition));
-                IEventMgr::Get()->VTriggerEvent(pEvent);
+                m_pMoveActorBatch->AddMove(actorId, bodyPixelPosition);
 
                 // If it is kinematic body (moving platform, elevator), notify it
                 if (pActorBody->GetType() == b2_kinematicBody)
@@ -380,6 +386,11 @@ void ClawPhysics::VSyncVisibleScene()
             }
         }
     }
+
+    if (!m_pMoveActorBatch->IsEmpty())
+    {
+        IEventMgr::Get()->VTriggerEvent(m_pMoveActorBatch);
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -12,6 +12,7 @@ typedef std::vector<std::pair<uint32, b2Body*>> ActorIdAndBodyList;
 
 class PhysicsContactListener;
 class PhysicsDebugDrawer;
+class EventData_Move_Actor_Batch;
 class ClawPhysics : public IGamePhysics
 {
 public:
@@ -91,6 +92,9 @@ private:
     ActorIDToBox2DBodyMap m_ActorToBodyMap;
     Box2DBodyToActorIDMap m_BodyToActorMap;
     ActorIdAndBodyList m_ActorIdAndBodyList;
+
+    // Reused every sync unless some listener kept the previous one
+    shared_ptr<EventData_Move_Actor_Batch> m_pMoveActorBatch;
 };
 
 class KinematicComponent;
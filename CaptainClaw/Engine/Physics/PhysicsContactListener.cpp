@@ -42,8 +42,7 @@ void TryCallActorEnteredOrLeftAgroRange(
 
             if (pActorwhoEntered && pActorWithMeleeSensor)
             {
-                shared_ptr<T> pStateComponent =
-                    MakeStrongPtr(pActorWithMeleeSensor->GetComponent<T>(T::g_Name));
+                T* pStateComponent = pActorWithMeleeSensor->GetRawComponent<T>();
                 assert(pStateComponent != nullptr);
                 if (pStateComponent)
                 {
@@ -295,23 +294,20 @@ void PhysicsContactListener::BeginContact(b2Contact* pContact)
                     Actor* pActor = static_cast<Actor*>(pFixtureA->GetBody()->GetUserData());
                     assert(pActor);
 
-                    shared_ptr<CrumblingPegAIComponent> pCrumblingPegComponent =
-                        MakeStrongPtr(pActor->GetComponent<CrumblingPegAIComponent>(CrumblingPegAIComponent::g_Name));
+                    CrumblingPegAIComponent* pCrumblingPegComponent = pActor->GetRawComponent<CrumblingPegAIComponent>();
                     if (pCrumblingPegComponent)
                     {
                         pCrumblingPegComponent->OnContact(pFixtureB->GetBody());
                     }
 
-                    shared_ptr<SteppingGroundComponent> pSteppingGroundComponent =
-                        MakeStrongPtr(pActor->GetComponent<SteppingGroundComponent>());
+                    SteppingGroundComponent* pSteppingGroundComponent = pActor->GetRawComponent<SteppingGroundComponent>();
                     if (pSteppingGroundComponent)
                     {
                         Actor* pOtherActor = static_cast<Actor*>(pFixtureB->GetBody()->GetUserData());
                         pSteppingGroundComponent->OnActorContact(pOtherActor);
                     }
 
-                    shared_ptr<SpringBoardComponent> pSpringBoardComponent =
-                        MakeStrongPtr(pActor->GetComponent<SpringBoardComponent>());
+                    SpringBoardComponent* pSpringBoardComponent = pActor->GetRawComponent<SpringBoardComponent>();
                     if (pSpringBoardComponent)
                     {
                         Actor* pOtherActor = static_cast<Actor*>(pFixtureB->GetBody()->GetUserData());
@@ -460,8 +456,7 @@ void PhysicsContactListener::BeginContact(b2Contact* pContact)
 
                 if (pActorwhoEntered && pActorWithDamageAura)
                 {
-                    shared_ptr<DamageAuraComponent> pDamageAuraComponent =
-                        MakeStrongPtr(pActorWithDamageAura->GetComponent<DamageAuraComponent>(DamageAuraComponent::g_Name));
+                    DamageAuraComponent* pDamageAuraComponent = pActorWithDamageAura->GetRawComponent<DamageAuraComponent>();
                     if (pDamageAuraComponent)
                     {
                         pDamageAuraComponent->OnActorEntered(pActorwhoEntered);
@@ -563,8 +558,7 @@ void PhysicsContactListener::EndContact(b2Contact* pContact)
                     Actor* pGroundActor = static_cast<Actor*>(pFixtureA->GetBody()->GetUserData());
                     if (pGroundActor)
                     {
-                        shared_ptr<SpringBoardComponent> pSpringBoardComponent =
-                            MakeStrongPtr(pGroundActor->GetComponent<SpringBoardComponent>());
+                        SpringBoardComponent* pSpringBoardComponent = pGroundActor->GetRawComponent<SpringBoardComponent>();
                         if (pSpringBoardComponent)
                         {
                             Actor* pOtherActor = static_cast<Actor*>(pFixtureB->GetBody()->GetUserData());
@@ -643,8 +637,7 @@ void PhysicsContactListener::EndContact(b2Contact* pContact)
 
                 if (pActorwhoEntered && pActorWithDamageAura)
                 {
-                    shared_ptr<DamageAuraComponent> pDamageAuraComponent =
-                        MakeStrongPtr(pActorWithDamageAura->GetComponent<DamageAuraComponent>(DamageAuraComponent::g_Name));
+                    DamageAuraComponent* pDamageAuraComponent = pActorWithDamageAura->GetRawComponent<DamageAuraComponent>();
                     if (pDamageAuraComponent)
                     {
                         pDamageAuraComponent->OnActorLeft(pActorwhoEntered);
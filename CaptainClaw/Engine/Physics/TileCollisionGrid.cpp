@@ -0,0 +1,418 @@
+#include "TileCollisionGrid.h"
+#include "../GameApp/BaseGameLogic.h"
+
+// Attribute bits stored per cell
+const uint8 TileAttribute_Solid = 0x1;
+const uint8 TileAttribute_Ground = 0x2;
+const uint8 TileAttribute_Climb = 0x4;
+const uint8 TileAttribute_Death = 0x8;
+
+//=================================================================================================
+// TileCollisionGrid Implementation
+//
+
+TileCollisionGrid::TileCollisionGrid(int tilesOnAxisX, int tilesOnAxisY, int tileWidth, int tileHeight)
+    :
+    m_TilesOnAxisX(tilesOnAxisX),
+    m_TilesOnAxisY(tilesOnAxisY),
+    m_TileWidth(tileWidth),
+    m_TileHeight(tileHeight)
+{
+    m_CellAttributes.resize(tilesOnAxisX * tilesOnAxisY, 0);
+    m_CellShapes.resize(tilesOnAxisX * tilesOnAxisY, 0);
+
+    // Shape 0 is shared by all empty tiles
+    TileShape emptyShape = { 0, 0, 0 };
+    m_Shapes.push_back(emptyShape);
+}
+
+shared_ptr<TileCollisionGrid> TileCollisionGrid::Create(
+    const std::vector<int32>& tiles,
+    int tilesOnAxisX,
+    int tileWidth,
+    int tileHeight,
+    const TileCollisionPrototypeMap& tilePrototypes)
+{
+    if (tilesOnAxisX <= 0 || tileWidth <= 0 || tileHeight <= 0)
+    {
+        LOG_ERROR("Invalid main plane dimensions, tile collision grid was not created");
+        return nullptr;
+    }
+
+    int tilesOnAxisY = (tiles.size() + tilesOnAxisX - 1) / tilesOnAxisX;
+    shared_ptr<TileCollisionGrid> pGrid(new TileCollisionGrid(tilesOnAxisX, tilesOnAxisY, tileWidth, tileHeight));
+
+    // Tile id -> shape index, every distinct tile has its rects stored only once
+    std::map<int32, uint16> tileIdToShapeMap;
+
+    for (size_t tileIdx = 0; tileIdx < tiles.size(); ++tileIdx)
+    {
+        int32 tileId = tiles[tileIdx];
+        if (tileId < 0)
+        {
+            continue;
+        }
+
+        auto shapeIt = tileIdToShapeMap.find(tileId);
+        if (shapeIt == tileIdToShapeMap.end())
+        {
+            TileShape shape = { 0, (uint32)pGrid->m_Rects.size(), 0 };
+
+            auto protoIt = tilePrototypes.find(tileId);
+            if (protoIt != tilePrototypes.end())
+            {
+                const SDL_Rect tileRect = { 0, 0, tileWidth, tileHeight };
+                for (const TileCollisionRectangle& tileCollisionRect : protoIt->second.collisionRectangles)
+                {
+                    uint8 attribute = CollisionTypeToAttribute(tileCollisionRect.collisionType);
+                    if (attribute == 0)
+                    {
+                        continue;
+                    }
+
+                    // Rects sticking out of their tile would break ray marching which only looks into
+                    // one cell at a time
+                    CollisionRect collisionRect;
+                    collisionRect.attribute = attribute;
+                    if (!SDL_IntersectRect(&tileRect, &tileCollisionRect.collisionRect, &collisionRect.rect))
+                    {
+                        continue;
+                    }
+
+                    pGrid->m_Rects.push_back(collisionRect);
+                    shape.attributes |= attribute;
+                    shape.numRects++;
+                }
+            }
+
+            if (pGrid->m_Shapes.size() > UINT16_MAX)
+            {
+                LOG_ERROR("Too many distinct tiles for tile collision grid");
+                return nullptr;
+            }
+
+            shapeIt = tileIdToShapeMap.insert(std::make_pair(tileId, (uint16)pGrid->m_Shapes.size())).first;
+            pGrid->m_Shapes.push_back(shape);
+        }
+
+        pGrid->m_CellShapes[tileIdx] = shapeIt->second;
+        pGrid->m_CellAttributes[tileIdx] = pGrid->m_Shapes[shapeIt->second].attributes;
+    }
+
+    return pGrid;
+}
+
+uint32 TileCollisionGrid::GetCollisionFlagsAt(const Point& point) const
+{
+    int cellX = (int)std::floor(point.x / m_TileWidth);
+    int cellY = (int)std::floor(point.y / m_TileHeight);
+    if (!IsInside(cellX, cellY))
+    {
+        return CollisionFlag_None;
+    }
+
+    int cellIdx = GetCellIdx(cellX, cellY);
+    if (m_CellAttributes[cellIdx] == 0)
+    {
+        return CollisionFlag_None;
+    }
+
+    const int localX = (int)std::floor(point.x) - cellX * m_TileWidth;
+    const int localY = (int)std::floor(point.y) - cellY * m_TileHeight;
+
+    uint8 attributes = 0;
+    const TileShape& shape = m_Shapes[m_CellShapes[cellIdx]];
+    for (uint32 rectIdx = shape.firstRectIdx; rectIdx < shape.firstRectIdx + shape.numRects; ++rectIdx)
+    {
+        const SDL_Rect& rect = m_Rects[rectIdx].rect;
+        if (localX >= rect.x && localX < rect.x + rect.w && localY >= rect.y && localY < rect.y + rect.h)
+        {
+            attributes |= m_Rects[rectIdx].attribute;
+        }
+    }
+
+    return AttributesToFilterMask(attributes);
+}
+
+RaycastResult TileCollisionGrid::RayCast(const Point& fromPoint, const Point& toPoint, uint32 filterMask) const
+{
+    RaycastResult result;
+
+    const Point delta(toPoint.x - fromPoint.x, toPoint.y - fromPoint.y);
+    const double length = sqrt(delta.x * delta.x + delta.y * delta.y);
+    const uint8 attributes = FilterMaskToAttributes(filterMask);
+
+    double hitFraction = 1.0;
+    if (length > 0.0 && attributes != 0)
+    {
+        int cellX = (int)std::floor(fromPoint.x / m_TileWidth);
+        int cellY = (int)std::floor(fromPoint.y / m_TileHeight);
+
+        const int stepX = delta.x > 0.0 ? 1 : -1;
+        const int stepY = delta.y > 0.0 ? 1 : -1;
+
+        // Fraction of the ray at which next vertical / horizontal cell border is crossed
+        double nextBorderX = DBL_MAX;
+        double nextBorderY = DBL_MAX;
+        double borderStepX = DBL_MAX;
+        double borderStepY = DBL_MAX;
+        if (delta.x != 0.0)
+        {
+            nextBorderX = ((cellX + (stepX > 0 ? 1 : 0)) * m_TileWidth - fromPoint.x) / delta.x;
+            borderStepX = m_TileWidth / fabs(delta.x);
+        }
+        if (delta.y != 0.0)
+        {
+            nextBorderY = ((cellY + (stepY > 0 ? 1 : 0)) * m_TileHeight - fromPoint.y) / delta.y;
+            borderStepY = m_TileHeight / fabs(delta.y);
+        }
+
+        while (true)
+        {
+            if (IsInside(cellX, cellY))
+            {
+                double cellHitFraction = CastRayInCell(cellX, cellY, fromPoint, delta, attributes);
+                if (cellHitFraction <= 1.0)
+                {
+                    hitFraction = cellHitFraction;
+                    result.foundIntersection = true;
+                    break;
+                }
+            }
+
+            if (nextBorderX < nextBorderY)
+            {
+                if (nextBorderX > 1.0)
+                {
+                    break;
+                }
+                cellX += stepX;
+                nextBorderX += borderStepX;
+            }
+            else
+            {
+                if (nextBorderY > 1.0)
+                {
+                    break;
+                }
+                cellY += stepY;
+                nextBorderY += borderStepY;
+            }
+        }
+    }
+
+    result.closestPixelDistance = (float)(hitFraction * length);
+    result.deltaX = (float)(delta.x * hitFraction);
+    result.deltaY = (float)(delta.y * hitFraction);
+
+    return result;
+}
+
+bool TileCollisionGrid::FindGroundBelow(const Point& fromPoint, float maxDistance, uint32 filterMask, float& outDistance) const
+{
+    RaycastResult result = RayCast(fromPoint, Point(fromPoint.x, fromPoint.y + maxDistance), filterMask);
+    if (!result.foundIntersection)
+    {
+        return false;
+    }
+
+    outDistance = result.deltaY;
+    return true;
+}
+
+bool TileCollisionGrid::FindWall(const Point& fromPoint, float signedMaxDistance, uint32 filterMask, float& outDeltaX) const
+{
+    RaycastResult result = RayCast(fromPoint, Point(fromPoint.x + signedMaxDistance, fromPoint.y), filterMask);
+    if (!result.foundIntersection)
+    {
+        return false;
+    }
+
+    outDeltaX = result.deltaX;
+    return true;
+}
+
+bool TileCollisionGrid::FindLedge(const Point& fromPoint, float signedMaxDistance, int depth, uint32 filterMask, double& outDeltaX) const
+{
+    const uint8 attributes = FilterMaskToAttributes(filterMask);
+    if (attributes == 0 || depth <= 0)
+    {
+        // Ray would not hit anything in the very first column
+        if (fabs(signedMaxDistance) > 0.0f)
+        {
+            outDeltaX = 0.0;
+            return true;
+        }
+
+        return false;
+    }
+
+    const int direction = signedMaxDistance < 0.0f ? -1 : 1;
+    const double maxSteps = fabs(signedMaxDistance);
+
+    // Downward ray hits rects whose top edge lies within [top, bottom], rects it starts in are ignored
+    const double top = fromPoint.y;
+    const double bottom = fromPoint.y + depth;
+    const int firstCellY = max(0, (int)std::floor(top / m_TileHeight));
+    const int lastCellY = std::min(m_TilesOnAxisY - 1, (int)std::floor(bottom / m_TileHeight));
+
+    double stepIdx = 0.0;
+    while (stepIdx < maxSteps)
+    {
+        const double x = fromPoint.x + direction * stepIdx;
+        const int cellX = (int)std::floor(x / m_TileWidth);
+        if (cellX < 0 || cellX >= m_TilesOnAxisX)
+        {
+            outDeltaX = direction * stepIdx;
+            return true;
+        }
+
+        // Find any rect below which covers current column and continue right behind it
+        double nextStepIdx = -1.0;
+        for (int cellY = firstCellY; cellY <= lastCellY && nextStepIdx < 0.0; ++cellY)
+        {
+            int cellIdx = GetCellIdx(cellX, cellY);
+            if ((m_CellAttributes[cellIdx] & attributes) == 0)
+            {
+                continue;
+            }
+
+            const TileShape& shape = m_Shapes[m_CellShapes[cellIdx]];
+            for (uint32 rectIdx = shape.firstRectIdx; rectIdx < shape.firstRectIdx + shape.numRects; ++rectIdx)
+            {
+                const CollisionRect& collisionRect = m_Rects[rectIdx];
+                if ((collisionRect.attribute & attributes) == 0)
+                {
+                    continue;
+                }
+
+                const double rectTop = cellY * m_TileHeight + collisionRect.rect.y;
+                const double rectLeft = cellX * m_TileWidth + collisionRect.rect.x;
+                const double rectRight = rectLeft + collisionRect.rect.w;
+                if (rectTop < top || rectTop > bottom || x < rectLeft || x >= rectRight)
+                {
+                    continue;
+                }
+
+                nextStepIdx = direction > 0 ?
+                    std::ceil(rectRight - fromPoint.x) :
+                    std::floor(fromPoint.x - rectLeft) + 1.0;
+                break;
+            }
+        }
+
+        if (nextStepIdx < 0.0)
+        {
+            outDeltaX = direction * stepIdx;
+            return true;
+        }
+
+        stepIdx = nextStepIdx;
+    }
+
+    return false;
+}
+
+uint8 TileCollisionGrid::CollisionTypeToAttribute(CollisionType collisionType)
+{
+    switch (collisionType)
+    {
+        case CollisionType_Solid: return TileAttribute_Solid;
+        case CollisionType_Ground: return TileAttribute_Ground;
+        case CollisionType_Climb: return TileAttribute_Climb;
+        case CollisionType_Death: return TileAttribute_Death;
+        default: return 0;
+    }
+}
+
+uint8 TileCollisionGrid::FilterMaskToAttributes(uint32 filterMask)
+{
+    uint8 attributes = 0;
+    if (filterMask & CollisionFlag_Solid) attributes |= TileAttribute_Solid;
+    if (filterMask & CollisionFlag_Ground) attributes |= TileAttribute_Ground;
+    if (filterMask & CollisionFlag_Ladder) attributes |= TileAttribute_Climb;
+    if (filterMask & CollisionFlag_Death) attributes |= TileAttribute_Death;
+
+    return attributes;
+}
+
+uint32 TileCollisionGrid::AttributesToFilterMask(uint8 attributes)
+{
+    uint32 filterMask = CollisionFlag_None;
+    if (attributes & TileAttribute_Solid) filterMask |= CollisionFlag_Solid;
+    if (attributes & TileAttribute_Ground) filterMask |= CollisionFlag_Ground;
+    if (attributes & TileAttribute_Climb) filterMask |= CollisionFlag_Ladder;
+    if (attributes & TileAttribute_Death) filterMask |= CollisionFlag_Death;
+
+    return filterMask;
+}
+
+double TileCollisionGrid::CastRayInCell(int cellX, int cellY, const Point& fromPoint, const Point& delta, uint8 attributes) const
+{
+    double closestFraction = DBL_MAX;
+
+    int cellIdx = GetCellIdx(cellX, cellY);
+    if ((m_CellAttributes[cellIdx] & attributes) == 0)
+    {
+        return closestFraction;
+    }
+
+    const double tileLeft = cellX * m_TileWidth;
+    const double tileTop = cellY * m_TileHeight;
+
+    const TileShape& shape = m_Shapes[m_CellShapes[cellIdx]];
+    for (uint32 rectIdx = shape.firstRectIdx; rectIdx < shape.firstRectIdx + shape.numRects; ++rectIdx)
+    {
+        const CollisionRect& collisionRect = m_Rects[rectIdx];
+        if ((collisionRect.attribute & attributes) == 0)
+        {
+            continue;
+        }
+
+        const double minBound[2] = { tileLeft + collisionRect.rect.x, tileTop + collisionRect.rect.y };
+        const double maxBound[2] = { minBound[0] + collisionRect.rect.w, minBound[1] + collisionRect.rect.h };
+        const double origin[2] = { fromPoint.x, fromPoint.y };
+        const double direction[2] = { delta.x, delta.y };
+
+        // Slab test. Like Box2D, ray starting inside the rect does not hit it.
+        double enterFraction = -DBL_MAX;
+        double exitFraction = DBL_MAX;
+        bool isMissed = false;
+        for (int axis = 0; axis < 2; ++axis)
+        {
+            if (direction[axis] == 0.0)
+            {
+                // Rects are half-open, otherwise ray running along a cell border would touch rects of cells
+                // it never visits
+                if (origin[axis] < minBound[axis] || origin[axis] >= maxBound[axis])
+                {
+                    isMissed = true;
+                    break;
+                }
+                continue;
+            }
+
+            double nearFraction = (minBound[axis] - origin[axis]) / direction[axis];
+            double farFraction = (maxBound[axis] - origin[axis]) / direction[axis];
+            if (nearFraction > farFraction)
+            {
+                std::swap(nearFraction, farFraction);
+            }
+
+            if (nearFraction > enterFraction) enterFraction = nearFraction;
+            if (farFraction < exitFraction) exitFraction = farFraction;
+        }
+
+        if (isMissed || enterFraction > exitFraction || enterFraction < 0.0 || enterFraction > 1.0)
+        {
+            continue;
+        }
+
+        if (enterFraction < closestFraction)
+        {
+            closestFraction = enterFraction;
+        }
+    }
+
+    return closestFraction;
+}
@@ -0,0 +1,94 @@
+#ifndef __TILE_COLLISION_GRID_H__
+#define __TILE_COLLISION_GRID_H__
+
+#include "../SharedDefines.h"
+
+struct TileCollisionPrototype;
+typedef std::map<int32, TileCollisionPrototype> TileCollisionPrototypeMap;
+
+//=================================================================================================
+// class TileCollisionGrid
+//
+//     Collision of the main plane tiles laid out in a flat grid, independent of Box2D world.
+//     Every cell has one attribute byte (which collision types are somewhere inside the tile)
+//     and points to a shared list of tile sub-rects, so that empty tiles are rejected with one
+//     memory read. Only static tile geometry is present - moving platforms, crates etc. still
+//     need Box2D queries.
+//
+//     All coordinates are world pixel coordinates, filter masks are CollisionFlag-s
+//     (Solid, Ground, Ladder and Death are recognized).
+//
+//=================================================================================================
+
+class TileCollisionGrid
+{
+public:
+    // tiles are tile ids of the main plane from top left to bottom right corner, -1 is empty tile
+    static shared_ptr<TileCollisionGrid> Create(
+        const std::vector<int32>& tiles,
+        int tilesOnAxisX,
+        int tileWidth,
+        int tileHeight,
+        const TileCollisionPrototypeMap& tilePrototypes);
+
+    // Collision flags of all tile sub-rects which contain given point
+    uint32 GetCollisionFlagsAt(const Point& point) const;
+
+    // Same semantics as IGamePhysics::VRayCast restricted to tiles. Cells along the ray are
+    // visited in order (DDA) and marching stops at the first cell with a hit.
+    RaycastResult RayCast(const Point& fromPoint, const Point& toPoint, uint32 filterMask) const;
+
+    // Distance to the closest top of matching tile geometry right below point. Returns false
+    // if there is none within maxDistance.
+    bool FindGroundBelow(const Point& fromPoint, float maxDistance, uint32 filterMask, float& outDistance) const;
+
+    // Horizontal distance to the closest matching tile geometry, signedMaxDistance < 0 searches left.
+    // Returns false if there is none within signedMaxDistance.
+    bool FindWall(const Point& fromPoint, float signedMaxDistance, uint32 filterMask, float& outDeltaX) const;
+
+    // Walks horizontally from fromPoint in whole pixels and finds signed offset of the first pixel
+    // column in which a ray cast depth pixels down would not hit matching tile geometry. Returns false
+    // if there is no such column. Columns covered by a tile sub-rect are skipped all at once.
+    bool FindLedge(const Point& fromPoint, float signedMaxDistance, int depth, uint32 filterMask, double& outDeltaX) const;
+
+    int GetTileWidth() const { return m_TileWidth; }
+    int GetTileHeight() const { return m_TileHeight; }
+
+private:
+    struct CollisionRect
+    {
+        uint8 attribute;
+        SDL_Rect rect;
+    };
+
+    struct TileShape
+    {
+        uint8 attributes;
+        uint32 firstRectIdx;
+        uint32 numRects;
+    };
+
+    TileCollisionGrid(int tilesOnAxisX, int tilesOnAxisY, int tileWidth, int tileHeight);
+
+    static uint8 CollisionTypeToAttribute(CollisionType collisionType);
+    static uint8 FilterMaskToAttributes(uint32 filterMask);
+    static uint32 AttributesToFilterMask(uint8 attributes);
+
+    bool IsInside(int cellX, int cellY) const { return cellX >= 0 && cellY >= 0 && cellX < m_TilesOnAxisX && cellY < m_TilesOnAxisY; }
+    int GetCellIdx(int cellX, int cellY) const { return cellY * m_TilesOnAxisX + cellX; }
+
+    // Returns entry fraction of the closest matching rect in the cell hit by the ray or a value > 1.0
+    double CastRayInCell(int cellX, int cellY, const Point& fromPoint, const Point& delta, uint8 attributes) const;
+
+    int m_TilesOnAxisX;
+    int m_TilesOnAxisY;
+    int m_TileWidth;
+    int m_TileHeight;
+
+    std::vector<uint8> m_CellAttributes;
+    std::vector<uint16> m_CellShapes;
+    std::vector<TileShape> m_Shapes;
+    std::vector<CollisionRect> m_Rects;
+};
+
+#endif
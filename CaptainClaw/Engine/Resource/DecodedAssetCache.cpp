@@ -0,0 +1,160 @@
+#include "DecodedAssetCache.h"
+#include "Miniz.h"
+
+#include <cstdio>
+#include <fstream>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// Entry layout (native byte order, cache is machine local):
+//
+//     DecodedAssetHeader
+//     char data[dataSize]
+
+const uint32 DecodedAssetCache::g_Version = 1;
+
+static const char g_DecodedAssetMagic[4] = { 'C', 'C', 'D', 'A' };
+
+struct DecodedAssetHeader
+{
+    char magic[4];
+    uint32 version;
+    uint32 fileId;
+    uint32 dateAndTime;
+    uint32 size;
+    uint32 variant;
+    uint32 dataSize;
+    uint32 dataChecksum;
+};
+
+DecodedAssetCache::DecodedAssetCache(const std::string& directory)
+    :
+    m_Directory(directory)
+{ }
+
+bool DecodedAssetCache::Init()
+{
+#ifdef _WIN32
+    _mkdir(m_Directory.c_str());
+#else
+    mkdir(m_Directory.c_str(), 0755);
+#endif
+
+    // Directory is expected to exist now, whether it was just created or not
+    std::string probePath = m_Directory + "/.probe";
+    std::ofstream probeFile(probePath, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!probeFile.is_open())
+    {
+        LOG_WARNING("Decoded asset cache directory is not writable: " + m_Directory);
+        return false;
+    }
+
+    probeFile.close();
+    std::remove(probePath.c_str());
+
+    return true;
+}
+
+std::string DecodedAssetCache::GetEntryPath(const std::string& resourceName, const ResourceStamp& stamp, uint32 variant) const
+{
+    // Resource file ids are unique, extension just makes the directory easier to browse
+    std::string extension;
+    size_t dotPos = resourceName.find_last_of('.');
+    if (dotPos != std::string::npos)
+    {
+        extension = resourceName.substr(dotPos);
+    }
+
+    char entryName[32];
+    snprintf(entryName, sizeof(entryName), "%08X_%08X", stamp.fileId, variant);
+
+    return m_Directory + "/" + entryName + extension;
+}
+
+bool DecodedAssetCache::Load(const std::string& resourceName, const ResourceStamp& stamp, uint32 variant, std::vector<char>& outData) const
+{
+    std::ifstream file(GetEntryPath(resourceName, stamp, variant), std::ios::in | std::ios::binary);
+    if (!file.is_open())
+    {
+        return false;
+    }
+
+    DecodedAssetHeader header;
+    if (!file.read((char*)&header, sizeof(header)) ||
+        memcmp(header.magic, g_DecodedAssetMagic, sizeof(header.magic)) != 0 ||
+        header.version != g_Version ||
+        header.fileId != stamp.fileId ||
+        header.dateAndTime != stamp.dateAndTime ||
+        header.size != stamp.size ||
+        header.variant != variant)
+    {
+        return false;
+    }
+
+    // Reject sizes the file cannot possibly hold before allocating anything
+    std::streamoff dataOffset = file.tellg();
+    file.seekg(0, std::ios::end);
+    if (file.tellg() - dataOffset != (std::streamoff)header.dataSize)
+    {
+        return false;
+    }
+    file.seekg(dataOffset);
+
+    outData.resize(header.dataSize);
+    if (header.dataSize > 0 && !file.read(outData.data(), header.dataSize))
+    {
+        outData.clear();
+        return false;
+    }
+
+    if (mz_crc32(MZ_CRC32_INIT, (const unsigned char*)outData.data(), outData.size()) != header.dataChecksum)
+    {
+        LOG_WARNING("Corrupted decoded asset cache entry of: " + resourceName);
+        outData.clear();
+        return false;
+    }
+
+    return true;
+}
+
+bool DecodedAssetCache::Store(const std::string& resourceName, const ResourceStamp& stamp, uint32 variant, const std::vector<char>& data) const
+{
+    DecodedAssetHeader header;
+    memcpy(header.magic, g_DecodedAssetMagic, sizeof(header.magic));
+    header.version = g_Version;
+    header.fileId = stamp.fileId;
+    header.dateAndTime = stamp.dateAndTime;
+    header.size = stamp.size;
+    header.variant = variant;
+    header.dataSize = (uint32)data.size();
+    header.dataChecksum = (uint32)mz_crc32(MZ_CRC32_INIT, (const unsigned char*)data.data(), data.size());
+
+    // Entry is written under temporary name first so that interrupted writes never leave
+    // truncated entry behind
+    std::string entryPath = GetEntryPath(resourceName, stamp, variant);
+    std::string tempPath = entryPath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!file.is_open() ||
+            !file.write((const char*)&header, sizeof(header)) ||
+            !file.write(data.data(), data.size()))
+        {
+            LOG_WARNING("Failed to write decoded asset cache entry: " + entryPath);
+            return false;
+        }
+    }
+
+    std::remove(entryPath.c_str());
+    if (std::rename(tempPath.c_str(), entryPath.c_str()) != 0)
+    {
+        LOG_WARNING("Failed to write decoded asset cache entry: " + entryPath);
+        std::remove(tempPath.c_str());
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,49 @@
+#ifndef __DECODED_ASSET_CACHE_H__
+#define __DECODED_ASSET_CACHE_H__
+
+#include "../SharedDefines.h"
+
+// Identifies contents of single resource within its resource file, e.g. REZ file entry.
+// Whenever the resource changes, so does its stamp.
+struct ResourceStamp
+{
+    ResourceStamp() : fileId(0), dateAndTime(0), size(0) { }
+
+    uint32 fileId;
+    uint32 dateAndTime;
+    uint32 size;
+};
+
+//=================================================================================================
+// class DecodedAssetCache
+//
+//     On-disk cache of decoded resources, e.g. PID pixels or MIDI converted from XMI. Every entry
+//     is a separate file named after resource's file id and variant (anything else the decoded
+//     data depend on, e.g. palette checksum) and it is valid only as long as resource's stamp
+//     matches the one it was stored with. Load and Store do not share any state so they can be
+//     called from preloading threads.
+//
+//=================================================================================================
+
+class DecodedAssetCache
+{
+public:
+    // Has to be bumped whenever entry layout or any decoder output changes so that stale entries get rebuilt
+    static const uint32 g_Version;
+
+    DecodedAssetCache(const std::string& directory);
+
+    // Creates cache directory if it does not exist yet
+    bool Init();
+
+    // Returns false if there is no valid entry for given resource stamp and variant
+    bool Load(const std::string& resourceName, const ResourceStamp& stamp, uint32 variant, std::vector<char>& outData) const;
+    bool Store(const std::string& resourceName, const ResourceStamp& stamp, uint32 variant, const std::vector<char>& data) const;
+
+private:
+    std::string GetEntryPath(const std::string& resourceName, const ResourceStamp& stamp, uint32 variant) const;
+
+    std::string m_Directory;
+};
+
+#endif
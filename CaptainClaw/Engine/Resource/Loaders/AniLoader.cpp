@@ -24,6 +24,16 @@ void AniResourceExtraData::LoadAni(char* rawBuffer, uint32 size, const char* res
     OnAniLoaded(resourceString, _ani);
 }
 
+uint32 AniResourceExtraData::VGetMemorySize()
+{
+    if (_ani == NULL)
+    {
+        return 0;
+    }
+
+    return sizeof(WapAni) + _ani->imageSetPathLength + _ani->animationFramesCount * sizeof(AniAnimationFrame);
+}
+
 //=================================================================================================
 // class AniResourceLoader
 //
@@ -32,20 +42,31 @@ void AniResourceExtraData::LoadAni(char* rawBuffer, uint32 size, const char* res
 
 bool AniResourceLoader::VLoadResource(char* rawBuffer, uint32 rawSize, std::shared_ptr<ResourceHandle> handle)
 {
-    if (rawSize <= 0 || rawBuffer == NULL)
+    shared_ptr<IResourceExtraData> extraData = VDecodeResource(rawBuffer, rawSize, handle->GetName());
+    if (!extraData)
     {
-        LOG_ERROR("Received invalid rawBuffer or its size");
         return false;
     }
 
-    shared_ptr<AniResourceExtraData> extraData = shared_ptr<AniResourceExtraData>(new AniResourceExtraData());
-    extraData->LoadAni(rawBuffer, rawSize, handle->GetName().c_str());
-
     handle->SetExtraData(extraData);
 
     return true;
 }
 
+shared_ptr<IResourceExtraData> AniResourceLoader::VDecodeResource(char* rawBuffer, uint32 rawSize, const std::string& resourceName)
+{
+    if (rawSize <= 0 || rawBuffer == NULL)
+    {
+        LOG_ERROR("Received invalid rawBuffer or its size");
+        return nullptr;
+    }
+
+    shared_ptr<AniResourceExtraData> extraData = shared_ptr<AniResourceExtraData>(new AniResourceExtraData());
+    extraData->LoadAni(rawBuffer, rawSize, resourceName.c_str());
+
+    return extraData;
+}
+
 WapAni* AniResourceLoader::LoadAndReturnAni(const char* resourceString)
 {
     Resource resource(resourceString);
@@ -11,6 +11,7 @@ public:
     virtual ~AniResourceExtraData();
 
     virtual std::string VToString() { return "AniResourceExtraData"; }
+    virtual uint32 VGetMemorySize();
     void LoadAni(char* rawBuffer, uint32 size, const char* resourceString);
     WapAni* GetAni() { return _ani; }
 
@@ -24,8 +25,8 @@ public:
     virtual std::string VGetPattern() { return "*.ani"; }
     virtual bool VUseRawFile() { return false; }
     virtual bool VDiscardRawBufferAfterLoad() { return true; }
-    virtual uint32 VGetLoadedResourceSize(char* rawBuffer, uint32 rawSize) { return rawSize; }
     virtual bool VLoadResource(char* rawBuffer, uint32 rawSize, std::shared_ptr<ResourceHandle> handle);
+    virtual std::shared_ptr<IResourceExtraData> VDecodeResource(char* rawBuffer, uint32 rawSize, const std::string& resourceName);
 
     static WapAni* LoadAndReturnAni(const char* resourceString);
     static std::shared_ptr<AniResourceLoader> Create();
@@ -32,6 +32,18 @@ void MidiResourceExtraData::LoadMidiFile(char* rawBuffer, uint32 size)
     }
 }
 
+void MidiResourceExtraData::LoadMidiData(const char* midiData, uint32 size)
+{
+    MidiFile* pMidiFile = WAP_MidiCreateFromData(midiData, size);
+    if (pMidiFile == NULL)
+    {
+        LOG_ERROR("Failed to load MidiFile");
+        return;
+    }
+
+    m_pMidiFile = shared_ptr<MidiFile>(pMidiFile, DeleteMidiFile);
+}
+
 //=================================================================================================
 // class MidiResourceLoader
 //
@@ -39,11 +51,24 @@ void MidiResourceExtraData::LoadMidiFile(char* rawBuffer, uint32 size)
 //
 
 bool MidiResourceLoader::VLoadResource(char* rawBuffer, uint32 rawSize, std::shared_ptr<ResourceHandle> handle)
+{
+    shared_ptr<IResourceExtraData> extraData = VDecodeResource(rawBuffer, rawSize, handle->GetName());
+    if (!extraData)
+    {
+        return false;
+    }
+
+    handle->SetExtraData(extraData);
+
+    return true;
+}
+
+shared_ptr<IResourceExtraData> MidiResourceLoader::VDecodeResource(char* rawBuffer, uint32 rawSize, const std::string& resourceName)
 {
     if (rawSize <= 0 || rawBuffer == NULL)
     {
         LOG_ERROR("Received invalid rawBuffer or its size");
-        return false;
+        return nullptr;
     }
 
     shared_ptr<MidiResourceExtraData> extraData = shared_ptr<MidiResourceExtraData>(new MidiResourceExtraData());
@@ -54,15 +79,33 @@ bool MidiResourceLoader::VLoadResource(char* rawBuffer, uint32 rawSize, std::sha
         LOG_ERROR("Failed to load MidiFile.");
     }
 
-    handle->SetExtraData(extraData);
+    return extraData;
+}
+
+// Converted MIDI data are cached as they are
+bool MidiResourceLoader::VSaveDecodedResource(shared_ptr<IResourceExtraData> extraData, std::vector<char>& outData)
+{
+    shared_ptr<MidiFile> pMidiFile = std::static_pointer_cast<MidiResourceExtraData>(extraData)->GetMidiFile();
+    if (!pMidiFile || pMidiFile->data == NULL)
+    {
+        return false;
+    }
+
+    outData.assign(pMidiFile->data, pMidiFile->data + pMidiFile->size);
 
     return true;
 }
 
-uint32 MidiResourceLoader::VGetLoadedResourceSize(char* rawBuffer, uint32 rawSize)
+shared_ptr<IResourceExtraData> MidiResourceLoader::VLoadDecodedResource(const std::vector<char>& data, const std::string& resourceName)
 {
-    // It is how it is - thats how Mix_Chunk consumes it.
-    return rawSize;
+    shared_ptr<MidiResourceExtraData> extraData = shared_ptr<MidiResourceExtraData>(new MidiResourceExtraData());
+    extraData->LoadMidiData(data.data(), (uint32)data.size());
+    if (extraData->GetMidiFile() == nullptr)
+    {
+        return nullptr;
+    }
+
+    return extraData;
 }
 
 shared_ptr<MidiFile> MidiResourceLoader::LoadAndReturnMidiFile(const char* resourceString)
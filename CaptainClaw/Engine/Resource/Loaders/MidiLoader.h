@@ -10,7 +10,10 @@ public:
     virtual ~MidiResourceExtraData();
 
     virtual std::string VToString() { return "MidiResourceExtraData"; }
+    virtual uint32 VGetMemorySize() { return m_pMidiFile ? (uint32)m_pMidiFile->size : 0; }
     void LoadMidiFile(char* rawBuffer, uint32 size);
+    // Already converted MIDI data, e.g. from decoded asset cache
+    void LoadMidiData(const char* midiData, uint32 size);
     shared_ptr<MidiFile> GetMidiFile() { return m_pMidiFile; }
 
 private:
@@ -23,8 +26,11 @@ public:
     virtual std::string VGetPattern() { return "*.xmi"; }
     virtual bool VUseRawFile() { return false; }
     virtual bool VDiscardRawBufferAfterLoad() { return true; }
-    virtual uint32 VGetLoadedResourceSize(char* rawBuffer, uint32 rawSize);
     virtual bool VLoadResource(char* rawBuffer, uint32 rawSize, std::shared_ptr<ResourceHandle> handle);
+    virtual std::shared_ptr<IResourceExtraData> VDecodeResource(char* rawBuffer, uint32 rawSize, const std::string& resourceName);
+    virtual bool VGetDecodedAssetVariant(uint32& outVariant) { outVariant = 0; return true; }
+    virtual bool VSaveDecodedResource(std::shared_ptr<IResourceExtraData> extraData, std::vector<char>& outData);
+    virtual std::shared_ptr<IResourceExtraData> VLoadDecodedResource(const std::vector<char>& data, const std::string& resourceName);
 
     static shared_ptr<MidiFile> LoadAndReturnMidiFile(const char* resourceString);
     static std::shared_ptr<MidiResourceLoader> Create();
@@ -28,19 +28,30 @@ void PalResourceExtraData::LoadPal(char* rawBuffer, uint32 size)
 //
 
 bool PalResourceLoader::VLoadResource(char* rawBuffer, uint32 rawSize, std::shared_ptr<ResourceHandle> handle)
+{
+    shared_ptr<IResourceExtraData> extraData = VDecodeResource(rawBuffer, rawSize, handle->GetName());
+    if (!extraData)
+    {
+        return false;
+    }
+
+    handle->SetExtraData(extraData);
+
+    return true;
+}
+
+shared_ptr<IResourceExtraData> PalResourceLoader::VDecodeResource(char* rawBuffer, uint32 rawSize, const std::string& resourceName)
 {
     if (rawSize <= 0 || rawBuffer == NULL)
     {
         LOG_ERROR("Received invalid rawBuffer or its size");
-        return false;
+        return nullptr;
     }
 
     shared_ptr<PalResourceExtraData> extraData = shared_ptr<PalResourceExtraData>(new PalResourceExtraData());
     extraData->LoadPal(rawBuffer, rawSize);
 
-    handle->SetExtraData(extraData);
-
-    return true;
+    return extraData;
 }
 
 WapPal* PalResourceLoader::LoadAndReturnPal(const char* resourceString)
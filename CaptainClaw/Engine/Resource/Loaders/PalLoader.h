@@ -11,6 +11,7 @@ public:
     virtual ~PalResourceExtraData();
 
     virtual std::string VToString() { return "PalResourceExtraData"; }
+    virtual uint32 VGetMemorySize() { return _palette ? sizeof(WapPal) : 0; }
     void LoadPal(char* rawBuffer, uint32 size);
     WapPal* GetPalette() { return _palette; }
 
@@ -24,8 +25,8 @@ public:
     virtual std::string VGetPattern() { return "*.pal"; }
     virtual bool VUseRawFile() { return false; }
     virtual bool VDiscardRawBufferAfterLoad() { return true; }
-    virtual uint32 VGetLoadedResourceSize(char* rawBuffer, uint32 rawSize) { return rawSize; }
     virtual bool VLoadResource(char* rawBuffer, uint32 rawSize, std::shared_ptr<ResourceHandle> handle);
+    virtual std::shared_ptr<IResourceExtraData> VDecodeResource(char* rawBuffer, uint32 rawSize, const std::string& resourceName);
 
     static WapPal* LoadAndReturnPal(const char* resourceString);
     static std::shared_ptr<PalResourceLoader> Create();
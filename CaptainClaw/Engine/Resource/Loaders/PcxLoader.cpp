@@ -18,6 +18,11 @@ void PcxResourceExtraData::LoadImage(char* rawBuffer, uint32 size, bool useColor
     }
 }
 
+uint32 PcxResourceExtraData::VGetMemorySize()
+{
+    return m_pImage ? m_pImage->GetMemorySize() : 0;
+}
+
 //=================================================================================================
 // class PcxResourceLoader
 //
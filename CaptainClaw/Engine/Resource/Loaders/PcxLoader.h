@@ -12,6 +12,7 @@ public:
     PcxResourceExtraData() { m_pImage = nullptr; }
 
     virtual std::string VToString() { return "PcxResourceExtraData"; }
+    virtual uint32 VGetMemorySize();
     void LoadImage(char* rawBuffer, uint32 size, bool useColorKey = false, SDL_Color colorKey = { 0, 0, 0, 0 });
     shared_ptr<Image> GetImage() { return m_pImage; }
 
@@ -25,7 +26,6 @@ public:
     virtual std::string VGetPattern() { return "*.pcx"; }
     virtual bool VUseRawFile() { return true; }
     virtual bool VDiscardRawBufferAfterLoad() { return true; }
-    virtual uint32 VGetLoadedResourceSize(char* rawBuffer, uint32 rawSize) { return rawSize; }
     virtual bool VLoadResource(char* rawBuffer, uint32 rawSize, std::shared_ptr<ResourceHandle> handle) { return true; }
 
     static shared_ptr<Image> LoadAndReturnImage(const char* resourceString, bool useColorKey = false, SDL_Color colorKey = { 0, 0, 0, 0 });
@@ -1,8 +1,10 @@
 #include "PidLoader.h"
 
 #include "../../Graphics2D/Image.h"
+#include "../../Graphics2D/TextureAtlas.h"
 #include "../../GameApp/BaseGameApp.h"
 #include "ResourceCorrection.h"
+#include "../Miniz.h"
 
 //=================================================================================================
 // class PidResourceExtraData
@@ -29,16 +31,114 @@ void PidResourceExtraData::LoadPid(char* rawBuffer, uint32 size, WapPal* palette
 
 void PidResourceExtraData::LoadImage(char* rawBuffer, uint32 size, WapPal* palette, const char* resourceString)
 {
-    if (_pid == NULL)
+    if (_image != NULL)
     {
-        LoadPid(rawBuffer, size, palette, resourceString);
+        return;
     }
-    if (_image == NULL)
+
+    SDL_Renderer* renderer = g_pApp->GetRenderer();
+
+    // Pid could be already decoded e.g. while preloading
+    if (_pid != NULL)
     {
-        SDL_Renderer* renderer = g_pApp->GetRenderer();
         _image = shared_ptr<Image>(Image::CreateImage(_pid, renderer));
         WAP_PidDestroy(_pid); _pid = NULL;
-        SAFE_DELETE_ARRAY(rawBuffer);
+        return;
+    }
+
+    // Otherwise decode it straight into the texture
+    _image = shared_ptr<Image>(Image::CreatePidImage(rawBuffer, size, palette, renderer));
+    if (_image != NULL)
+    {
+        WapPid pidHeader;
+        WAP_PidLoadHeaderFromData(rawBuffer, size, &pidHeader);
+        OnPidLoaded(resourceString, &pidHeader);
+        _image->SetOffset(pidHeader.offsetX, pidHeader.offsetY);
+    }
+}
+
+uint32 PidResourceExtraData::VGetMemorySize()
+{
+    uint32 size = 0;
+    if (_pid != NULL)
+    {
+        size += _pid->colorsCount * sizeof(WAP_ColorRGBA);
+    }
+    if (_image)
+    {
+        size += _image->GetMemorySize();
+    }
+
+    return size;
+}
+
+// Decoded pid is stored as its header followed by tightly packed RGBA pixels
+struct DecodedPidHeader
+{
+    uint32 flags;
+    uint32 width;
+    uint32 height;
+    int32 offsetX;
+    int32 offsetY;
+};
+
+bool PidResourceExtraData::SaveDecodedPid(std::vector<char>& outData) const
+{
+    if (_pid == NULL)
+    {
+        return false;
+    }
+
+    DecodedPidHeader header;
+    header.flags = _pid->flags;
+    header.width = _pid->width;
+    header.height = _pid->height;
+    header.offsetX = _pid->offsetX;
+    header.offsetY = _pid->offsetY;
+
+    const char* pPixels = (const char*)_pid->colors;
+    outData.assign((const char*)&header, (const char*)&header + sizeof(header));
+    outData.insert(outData.end(), pPixels, pPixels + _pid->colorsCount * sizeof(WAP_ColorRGBA));
+
+    return true;
+}
+
+bool PidResourceExtraData::LoadDecodedPid(const std::vector<char>& data, const char* resourceString)
+{
+    DecodedPidHeader header;
+    if (_pid != NULL || data.size() < sizeof(header))
+    {
+        return false;
+    }
+
+    memcpy(&header, data.data(), sizeof(header));
+    if ((uint64)header.width * header.height * sizeof(WAP_ColorRGBA) != data.size() - sizeof(header))
+    {
+        LOG_WARNING("Decoded pid size mismatch: " + ToStr(resourceString));
+        return false;
+    }
+
+    _pid = WAP_PidCreate(header.width, header.height);
+    if (_pid == NULL)
+    {
+        return false;
+    }
+
+    // Offsets were already corrected when the pid got decoded
+    _pid->flags = header.flags;
+    _pid->offsetX = header.offsetX;
+    _pid->offsetY = header.offsetY;
+    memcpy(_pid->colors, data.data() + sizeof(header), _pid->colorsCount * sizeof(WAP_ColorRGBA));
+
+    return true;
+}
+
+void PidResourceExtraData::SetImage(shared_ptr<Image> image)
+{
+    _image = image;
+    if (_pid != NULL)
+    {
+        WAP_PidDestroy(_pid); _pid = NULL;
     }
 }
 
@@ -48,6 +148,217 @@ void PidResourceExtraData::LoadImage(char* rawBuffer, uint32 size, WapPal* palet
 //     This class implements the IResourceLoader interface with PID file loading
 //
 
+// Images can outlive their resource handles, e.g. while actors hold them. Such images are reused
+// when their resource is loaded again instead of uploading the same texture once more
+static std::map<std::string, weak_ptr<Image>> g_LiveImages;
+// Expired entries are pruned whenever the map doubles in size since the last pruning
+static const size_t MIN_LIVE_IMAGES_PRUNE_SIZE = 256;
+static size_t g_LiveImagesPruneSize = MIN_LIVE_IMAGES_PRUNE_SIZE;
+
+static void TrackLiveImage(const std::string& resourceName, shared_ptr<Image> pImage)
+{
+    g_LiveImages[resourceName] = pImage;
+
+    if (g_LiveImages.size() >= g_LiveImagesPruneSize)
+    {
+        for (auto liveImageIter = g_LiveImages.begin(); liveImageIter != g_LiveImages.end();)
+        {
+            if (liveImageIter->second.expired())
+            {
+                liveImageIter = g_LiveImages.erase(liveImageIter);
+            }
+            else
+            {
+                ++liveImageIter;
+            }
+        }
+
+        g_LiveImagesPruneSize = max(MIN_LIVE_IMAGES_PRUNE_SIZE, g_LiveImages.size() * 2);
+    }
+}
+
+static shared_ptr<Image> FindLiveImage(const std::string& resourceName)
+{
+    auto findIt = g_LiveImages.find(resourceName);
+    if (findIt == g_LiveImages.end())
+    {
+        return nullptr;
+    }
+
+    shared_ptr<Image> pImage = findIt->second.lock();
+    if (!pImage)
+    {
+        g_LiveImages.erase(findIt);
+    }
+
+    return pImage;
+}
+
+static uint32 GetPaletteChecksum(WapPal* pPalette)
+{
+    if (pPalette == g_pApp->GetCurrentPalette())
+    {
+        return g_pApp->GetCurrentPaletteChecksum();
+    }
+
+    return pPalette != NULL ?
+        (uint32)mz_crc32(MZ_CRC32_INIT, (const unsigned char*)pPalette->colors, sizeof(pPalette->colors)) : 0;
+}
+
+// Uploads evicted image again. Resource handle reloaded from decoded asset cache already has
+// decoded pixels, otherwise its raw data are decoded. Both are decoded with current palette,
+// so the caller has to make sure it is still the palette the image was created with
+static SDL_Texture* ReloadPidTexture(const std::string& resourceName, SDL_Renderer* pRenderer)
+{
+    Resource resource(resourceName);
+    shared_ptr<ResourceHandle> handle = g_pApp->GetResourceCache()->GetHandle(&resource);
+    if (!handle)
+    {
+        return NULL;
+    }
+
+    shared_ptr<PidResourceExtraData> extraData = std::static_pointer_cast<PidResourceExtraData>(handle->GetExtraData());
+    if (extraData && extraData->GetPid())
+    {
+        return Image::GetTextureFromPid(extraData->GetPid(), pRenderer);
+    }
+
+    WapPal* pPalette = g_pApp->GetCurrentPalette();
+    if (pPalette == NULL || handle->GetDataBuffer() == NULL)
+    {
+        return NULL;
+    }
+
+    return Image::CreateTextureFromPidData(handle->GetDataBuffer(), handle->GetSize(), pPalette, pRenderer);
+}
+
+// Atlas page is evicted as a whole, so all images placed on it are decoded into it again.
+// Same as ReloadPidTexture, the caller has to make sure the palette did not change since
+static SDL_Texture* ReloadAtlasPageTexture(const std::vector<std::pair<std::string, SDL_Rect>>& pageImages,
+    int pageWidth, int pageHeight, SDL_Renderer* pRenderer)
+{
+    WapPal* pPalette = g_pApp->GetCurrentPalette();
+    if (pPalette == NULL)
+    {
+        return NULL;
+    }
+
+    // Everything which is not covered by any image stays transparent
+    std::vector<uint32> pagePixels((size_t)pageWidth * pageHeight, 0);
+    uint32 pitch = pageWidth * sizeof(uint32);
+    for (const auto& pageImage : pageImages)
+    {
+        const SDL_Rect& rect = pageImage.second;
+        uint32* pDest = pagePixels.data() + rect.y * pageWidth + rect.x;
+
+        Resource resource(pageImage.first);
+        shared_ptr<ResourceHandle> handle = g_pApp->GetResourceCache()->GetHandle(&resource);
+        if (!handle)
+        {
+            return NULL;
+        }
+
+        shared_ptr<PidResourceExtraData> extraData = std::static_pointer_cast<PidResourceExtraData>(handle->GetExtraData());
+        WapPid* pPid = extraData ? extraData->GetPid() : NULL;
+        if (pPid != NULL)
+        {
+            if ((int)pPid->width != rect.w || (int)pPid->height != rect.h)
+            {
+                return NULL;
+            }
+
+            for (int y = 0; y < rect.h; y++)
+            {
+                memcpy(pDest + y * pageWidth, &pPid->colors[y * rect.w], rect.w * sizeof(uint32));
+            }
+            continue;
+        }
+
+        // Image must not grow past its place on the page
+        WapPid pidHeader;
+        if (handle->GetDataBuffer() == NULL ||
+            WAP_PidLoadHeaderFromData(handle->GetDataBuffer(), handle->GetSize(), &pidHeader) < 0 ||
+            (int)pidHeader.width != rect.w || (int)pidHeader.height != rect.h ||
+            WAP_PidDecodeIntoBuffer(handle->GetDataBuffer(), handle->GetSize(), pPalette, pDest, pitch) != 0)
+        {
+            return NULL;
+        }
+    }
+
+    return Image::CreateTextureFromPixels(pagePixels.data(), pageWidth, pageHeight, pitch, pRenderer);
+}
+
+// Textures decoded with given palette are valid only as long as it stays current
+static TextureReloadCondition GetPaletteReloadCondition(WapPal* pPalette)
+{
+    uint32 paletteChecksum = GetPaletteChecksum(pPalette);
+    return [paletteChecksum]()
+    {
+        return g_pApp->GetCurrentPalette() != NULL && g_pApp->GetCurrentPaletteChecksum() == paletteChecksum;
+    };
+}
+
+void PidResourceLoader::VPrepareDecode()
+{
+    WapPal* pPalette = g_pApp->GetCurrentPalette();
+    _hasDecodePalette = (pPalette != NULL);
+    if (!_hasDecodePalette)
+    {
+        return;
+    }
+
+    _decodePalette = *pPalette;
+    _decodePaletteChecksum = g_pApp->GetCurrentPaletteChecksum();
+}
+
+shared_ptr<IResourceExtraData> PidResourceLoader::VDecodeResource(char* rawBuffer, uint32 rawSize, const std::string& resourceName)
+{
+    // Images can only be decoded with palette of the level which is being loaded,
+    // without it only raw data are kept and image is created upon first request
+    if (!_hasDecodePalette || rawSize <= 0 || rawBuffer == NULL)
+    {
+        return nullptr;
+    }
+
+    shared_ptr<PidResourceExtraData> extraData = shared_ptr<PidResourceExtraData>(new PidResourceExtraData());
+    extraData->LoadPid(rawBuffer, rawSize, &_decodePalette, resourceName.c_str());
+    if (extraData->GetPid() == NULL)
+    {
+        return nullptr;
+    }
+
+    return extraData;
+}
+
+// Decoded pixels depend on palette of the level which is being loaded
+bool PidResourceLoader::VGetDecodedAssetVariant(uint32& outVariant)
+{
+    if (!_hasDecodePalette)
+    {
+        return false;
+    }
+
+    outVariant = _decodePaletteChecksum;
+
+    return true;
+}
+
+bool PidResourceLoader::VSaveDecodedResource(shared_ptr<IResourceExtraData> extraData, std::vector<char>& outData)
+{
+    return std::static_pointer_cast<PidResourceExtraData>(extraData)->SaveDecodedPid(outData);
+}
+
+shared_ptr<IResourceExtraData> PidResourceLoader::VLoadDecodedResource(const std::vector<char>& data, const std::string& resourceName)
+{
+    shared_ptr<PidResourceExtraData> extraData = shared_ptr<PidResourceExtraData>(new PidResourceExtraData());
+    if (!extraData->LoadDecodedPid(data, resourceName.c_str()))
+    {
+        return nullptr;
+    }
+
+    return extraData;
+}
+
 WapPid* PidResourceLoader::LoadAndReturnPid(const char* resourceString, WapPal* palette)
 {
     Resource resource(resourceString);
@@ -79,6 +390,23 @@ shared_ptr<Image> PidResourceLoader::LoadAndReturnImage(const char* resourceStri
     shared_ptr<ResourceHandle> handle = g_pApp->GetResourceCache()->GetHandle(&resource);
     shared_ptr<PidResourceExtraData> extraData = std::static_pointer_cast<PidResourceExtraData>(handle->GetExtraData());
 
+    if (!extraData || !extraData->GetImage())
+    {
+        if (shared_ptr<Image> pLiveImage = FindLiveImage(handle->GetName()))
+        {
+            if (!extraData)
+            {
+                extraData = shared_ptr<PidResourceExtraData>(new PidResourceExtraData());
+                handle->SetExtraData(extraData);
+            }
+
+            extraData->SetImage(pLiveImage);
+            handle->UpdateExtraDataSize();
+
+            return pLiveImage;
+        }
+    }
+
     if (!extraData)
     {
         extraData = shared_ptr<PidResourceExtraData>(new PidResourceExtraData());
@@ -102,11 +430,128 @@ shared_ptr<Image> PidResourceLoader::LoadAndReturnImage(const char* resourceStri
             LOG_ERROR(extraData->VToString() + ": GetImage() returned nullptr. Check if PidResourceLoader is registered.");
             return NULL;
         }
+
+        handle->UpdateExtraDataSize();
+    }
+    else
+    {
+        return extraData->GetImage();
     }
 
+    // Image owns its texture so it can be evicted and uploaded again when needed, as long as
+    // the palette it was decoded with is still current. Otherwise it has to stay resident
+    std::string resourceName = handle->GetName();
+    extraData->GetImage()->SetTextureReloader(
+        [resourceName](SDL_Renderer* pRenderer)
+        {
+            return ReloadPidTexture(resourceName, pRenderer);
+        },
+        GetPaletteReloadCondition(palette));
+    TrackLiveImage(resourceName, extraData->GetImage());
+
     return extraData->GetImage();
 }
 
+void PidResourceLoader::LoadImageSetIntoAtlas(const std::vector<std::string>& imagePaths, WapPal* palette)
+{
+    TextureAtlas atlas(g_pApp->GetRenderer());
+
+    // Handles keep pid data alive until the atlas is built
+    std::vector<shared_ptr<ResourceHandle>> packedHandles;
+    for (const std::string& imagePath : imagePaths)
+    {
+        if (!WildcardMatch("*.pid", imagePath.c_str()))
+        {
+            continue;
+        }
+
+        Resource resource(imagePath);
+        shared_ptr<ResourceHandle> handle = g_pApp->GetResourceCache()->GetHandle(&resource);
+        if (!handle)
+        {
+            continue;
+        }
+
+        shared_ptr<PidResourceExtraData> extraData = std::static_pointer_cast<PidResourceExtraData>(handle->GetExtraData());
+
+        // Images which were already created can be referenced from elsewhere, leave them be
+        if (extraData && extraData->GetImage())
+        {
+            continue;
+        }
+
+        // Pid could be already decoded while preloading
+        bool added = (extraData && extraData->GetPid()) ?
+            atlas.AddPid(handle->GetName(), extraData->GetPid()) :
+            atlas.AddPidData(handle->GetName(), handle->GetDataBuffer(), handle->GetSize());
+        if (added)
+        {
+            packedHandles.push_back(handle);
+        }
+    }
+
+    // There is nothing to gain from atlas with single image
+    if (packedHandles.size() < 2)
+    {
+        return;
+    }
+
+    std::map<std::string, shared_ptr<Image>> atlasImages = atlas.Build(palette);
+
+    // Pages count towards texture memory budget as a whole, so they can be evicted once none
+    // of their images is drawn or pinned, and they are rebuilt from all of them
+    std::map<shared_ptr<Image>, std::vector<std::pair<std::string, SDL_Rect>>> pageImages;
+    for (const auto& atlasImage : atlasImages)
+    {
+        if (atlasImage.second && atlasImage.second->GetPageImage())
+        {
+            pageImages[atlasImage.second->GetPageImage()].push_back(
+                std::make_pair(atlasImage.first, *atlasImage.second->GetSourceRect()));
+        }
+    }
+
+    TextureReloadCondition reloadCondition = GetPaletteReloadCondition(palette);
+    for (const auto& page : pageImages)
+    {
+        std::vector<std::pair<std::string, SDL_Rect>> images = page.second;
+        int pageWidth = page.first->GetWidth();
+        int pageHeight = page.first->GetHeight();
+        page.first->SetTextureReloader(
+            [images, pageWidth, pageHeight](SDL_Renderer* pRenderer)
+            {
+                return ReloadAtlasPageTexture(images, pageWidth, pageHeight, pRenderer);
+            },
+            reloadCondition);
+    }
+
+    // Images which did not make it into the atlas are created separately upon first request
+    for (shared_ptr<ResourceHandle> handle : packedHandles)
+    {
+        auto findIt = atlasImages.find(handle->GetName());
+        if (findIt == atlasImages.end() || !findIt->second)
+        {
+            continue;
+        }
+
+        shared_ptr<PidResourceExtraData> extraData = std::static_pointer_cast<PidResourceExtraData>(handle->GetExtraData());
+        if (!extraData)
+        {
+            // Decoded pids already have their offsets corrected, raw ones do not
+            WapPid pidHeader;
+            WAP_PidLoadHeaderFromData(handle->GetDataBuffer(), handle->GetSize(), &pidHeader);
+            OnPidLoaded(handle->GetName().c_str(), &pidHeader);
+            findIt->second->SetOffset(pidHeader.offsetX, pidHeader.offsetY);
+
+            extraData = shared_ptr<PidResourceExtraData>(new PidResourceExtraData());
+            handle->SetExtraData(extraData);
+        }
+
+        extraData->SetImage(findIt->second);
+        handle->UpdateExtraDataSize();
+        TrackLiveImage(handle->GetName(), findIt->second);
+    }
+}
+
 shared_ptr<PidResourceLoader> PidResourceLoader::Create()
 {
     return shared_ptr<PidResourceLoader>(new PidResourceLoader());
@@ -13,8 +13,14 @@ public:
     virtual ~PidResourceExtraData();
 
     virtual std::string VToString() { return "PidResourceExtraData"; }
+    virtual uint32 VGetMemorySize();
     void LoadPid(char* rawBuffer, uint32 size, WapPal* palette, const char* resourceString);
     void LoadImage(char* rawBuffer, uint32 size, WapPal* palette, const char* resourceString);
+    // Replaces decoded pid with already created image, e.g. view into texture atlas
+    void SetImage(shared_ptr<Image> image);
+    // Decoded pid with its corrected header, stored in decoded asset cache
+    bool SaveDecodedPid(std::vector<char>& outData) const;
+    bool LoadDecodedPid(const std::vector<char>& data, const char* resourceString);
     WapPid* GetPid() { return _pid; }
     shared_ptr<Image> GetImage() { return _image; }
 
@@ -27,15 +33,29 @@ private:
 class PidResourceLoader : public IResourceLoader
 {
 public:
+    PidResourceLoader() : _hasDecodePalette(false), _decodePaletteChecksum(0) { }
+
     virtual std::string VGetPattern() { return "*.pid"; }
     virtual bool VUseRawFile() { return true; }
     virtual bool VDiscardRawBufferAfterLoad() { return false; }
-    virtual uint32 VGetLoadedResourceSize(char* rawBuffer, uint32 rawSize) { return rawSize; }
     virtual bool VLoadResource(char* rawBuffer, uint32 rawSize, std::shared_ptr<ResourceHandle> handle) { return true; }
+    virtual void VPrepareDecode();
+    virtual std::shared_ptr<IResourceExtraData> VDecodeResource(char* rawBuffer, uint32 rawSize, const std::string& resourceName);
+    virtual bool VGetDecodedAssetVariant(uint32& outVariant);
+    virtual bool VSaveDecodedResource(std::shared_ptr<IResourceExtraData> extraData, std::vector<char>& outData);
+    virtual std::shared_ptr<IResourceExtraData> VLoadDecodedResource(const std::vector<char>& data, const std::string& resourceName);
 
     static WapPid* LoadAndReturnPid(const char* resourceString, WapPal* palette);
     static shared_ptr<Image> LoadAndReturnImage(const char* resourceString, WapPal* palette);
+    // Creates all not yet created images from given image set within shared texture atlas
+    static void LoadImageSetIntoAtlas(const std::vector<std::string>& imagePaths, WapPal* palette);
     static std::shared_ptr<PidResourceLoader> Create();
+
+private:
+    // Copy of current palette taken on main thread, decoding threads never touch the app's palette
+    WapPal _decodePalette;
+    bool _hasDecodePalette;
+    uint32 _decodePaletteChecksum;
 };
 
 #endif
\ No newline at end of file
@@ -18,6 +18,11 @@ void PngResourceExtraData::LoadImage(char* rawBuffer, uint32 size)
     }
 }
 
+uint32 PngResourceExtraData::VGetMemorySize()
+{
+    return m_pImage ? m_pImage->GetMemorySize() : 0;
+}
+
 //=================================================================================================
 // class PngResourceLoader
 //
@@ -11,6 +11,7 @@ public:
     PngResourceExtraData() { m_pImage = nullptr; }
 
     virtual std::string VToString() { return "PngResourceExtraData"; }
+    virtual uint32 VGetMemorySize();
     void LoadImage(char* rawBuffer, uint32 size);
     shared_ptr<Image> GetImage() { return m_pImage; }
 
@@ -24,7 +25,6 @@ public:
     virtual std::string VGetPattern() { return "*.png"; }
     virtual bool VUseRawFile() { return true; }
     virtual bool VDiscardRawBufferAfterLoad() { return true; }
-    virtual uint32 VGetLoadedResourceSize(char* rawBuffer, uint32 rawSize) { return rawSize; }
     virtual bool VLoadResource(char* rawBuffer, uint32 rawSize, std::shared_ptr<ResourceHandle> handle) { return true; }
 
     static shared_ptr<Image> LoadAndReturnImage(const char* resourceString);
@@ -36,6 +36,8 @@ void WavResourceExtraData::LoadWavSound(char* rawBuffer, uint32 size)
 //     This class implements the IResourceLoader interface with WAV sound format
 //
 
+// Sounds are not decoded while preloading, SDL_mixer is not thread safe and converts them to the
+// format of the opened audio device. Only their raw data are read on worker threads.
 bool WavResourceLoader::VLoadResource(char* rawBuffer, uint32 rawSize, std::shared_ptr<ResourceHandle> handle)
 {
     if (rawSize <= 0 || rawBuffer == NULL)
@@ -57,15 +59,6 @@ bool WavResourceLoader::VLoadResource(char* rawBuffer, uint32 rawSize, std::shar
     return true;
 }
 
-uint32 WavResourceLoader::VGetLoadedResourceSize(char* rawBuffer, uint32 rawSize)
-{
-    // TODO: This is inefficent, this resource gets basically loaded twice, once just
-    // to find out how much room it takes and second time to actually create it
-    SDL_RWops* soundRwOps = SDL_RWFromMem((void*)rawBuffer, rawSize);
-    auto pSound = shared_ptr<Mix_Chunk>(Mix_LoadWAV_RW(soundRwOps, 1), DeleteMixChunk);
-    return pSound->alen;
-}
-
 shared_ptr<Mix_Chunk> WavResourceLoader::LoadAndReturnSound(const char* resourceString)
 {
     Resource resource(resourceString);
@@ -12,6 +12,7 @@ public:
     virtual ~WavResourceExtraData();
 
     virtual std::string VToString() { return "WavResourceExtraData"; }
+    virtual uint32 VGetMemorySize() { return _sound ? _sound->alen : 0; }
     void LoadWavSound(char* rawBuffer, uint32 size);
     shared_ptr<Mix_Chunk> GetSound() { return _sound; }
 
@@ -25,7 +26,6 @@ public:
     virtual std::string VGetPattern() { return "*.wav"; }
     virtual bool VUseRawFile() { return false; }
     virtual bool VDiscardRawBufferAfterLoad() { return true; }
-    virtual uint32 VGetLoadedResourceSize(char* rawBuffer, uint32 rawSize);
     virtual bool VLoadResource(char* rawBuffer, uint32 rawSize, std::shared_ptr<ResourceHandle> handle);
 
     static shared_ptr<Mix_Chunk> LoadAndReturnSound(const char* resourceString);
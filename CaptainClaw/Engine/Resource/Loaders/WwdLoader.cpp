@@ -3,6 +3,7 @@
 #include "../../GameApp/BaseGameApp.h"
 //#include "../../Converters.h"
 #include "../../Interfaces.h"
+#include "../Miniz.h"
 
 //=================================================================================================
 // class WwdResourceExtraData
@@ -13,15 +14,16 @@
 
 WwdResourceExtraData::~WwdResourceExtraData()
 {
-    if (_wapWorldLevel != NULL)
+    if (_wwdStream != NULL)
     {
-        WAP_WwdDestroy(_wapWorldLevel);
+        WAP_WwdStreamDestroy(_wwdStream);
     }
 }
 
-void WwdResourceExtraData::LoadWwd(char* rawBuffer, uint32 size)
+void WwdResourceExtraData::LoadWwd(const char* rawBuffer, uint32 size)
 {
-    _wapWorldLevel = WAP_WwdLoadFromData(rawBuffer, size);
+    _wwdStream = WAP_WwdStreamOpenFromData(rawBuffer, size);
+    _checksum = (uint32)mz_crc32(MZ_CRC32_INIT, (const unsigned char*)rawBuffer, size);
 }
 
 //=================================================================================================
@@ -31,39 +33,65 @@ void WwdResourceExtraData::LoadWwd(char* rawBuffer, uint32 size)
 //
 //=================================================================================================
 
-bool WwdResourceLoader::VLoadResource(char* rawBuffer, uint32 rawSize, std::shared_ptr<ResourceHandle> handle)
+shared_ptr<IResourceExtraData> WwdResourceLoader::VDecodeResource(char* rawBuffer, uint32 rawSize, const std::string& resourceName)
 {
     if (rawSize <= 0 || rawBuffer == NULL)
     {
         LOG_ERROR("Received invalid rawBuffer or its size");
-        return false;
+        return nullptr;
     }
 
     shared_ptr<WwdResourceExtraData> extraData = shared_ptr<WwdResourceExtraData>(new WwdResourceExtraData());
     extraData->LoadWwd(rawBuffer, rawSize);
+    if (extraData->GetWwd() == NULL)
+    {
+        LOG_ERROR("Could not open WWD: " + resourceName);
+        return nullptr;
+    }
 
-    handle->SetExtraData(extraData);
-
-    return true;
+    return extraData;
 }
 
-WapWwd* WwdResourceLoader::LoadAndReturnWwd(const char* resourceString)
+shared_ptr<WwdResourceExtraData> WwdResourceLoader::LoadAndReturnExtraData(const char* resourceString)
 {
     Resource resource(resourceString);
 
     shared_ptr<ResourceHandle> wwdHandle = g_pApp->GetResourceCache()->GetHandle(&resource);
-    shared_ptr<WwdResourceExtraData> extraData = std::static_pointer_cast<WwdResourceExtraData>(wwdHandle->GetExtraData());
+    if (!wwdHandle)
+    {
+        LOG_ERROR("Could not load WWD: " + std::string(resourceString));
+        return nullptr;
+    }
 
+    shared_ptr<WwdResourceExtraData> extraData = std::static_pointer_cast<WwdResourceExtraData>(wwdHandle->GetExtraData());
     if (!extraData)
     {
-        LOG_ERROR("Could not cast type to WwdResourceExtraData. Check if WwdResourceLoader is registered.");
-        return NULL;
+        extraData = std::static_pointer_cast<WwdResourceExtraData>(
+            WwdResourceLoader().VDecodeResource(wwdHandle->GetDataBuffer(), wwdHandle->GetSize(), wwdHandle->GetName()));
+        if (!extraData)
+        {
+            return nullptr;
+        }
+
+        wwdHandle->SetExtraData(extraData);
     }
 
-    return extraData->GetWwd();
+    return extraData;
+}
+
+WapWwdStream* WwdResourceLoader::LoadAndReturnWwd(const char* resourceString)
+{
+    shared_ptr<WwdResourceExtraData> extraData = LoadAndReturnExtraData(resourceString);
+    return extraData ? extraData->GetWwd() : NULL;
+}
+
+uint32 WwdResourceLoader::LoadAndReturnWwdChecksum(const char* resourceString)
+{
+    shared_ptr<WwdResourceExtraData> extraData = LoadAndReturnExtraData(resourceString);
+    return extraData ? extraData->GetChecksum() : 0;
 }
 
 std::shared_ptr<WwdResourceLoader> WwdResourceLoader::Create()
 {
     return shared_ptr<WwdResourceLoader>(new WwdResourceLoader());
-}
\ No newline at end of file
+}
@@ -8,27 +8,38 @@
 class WwdResourceExtraData : public IResourceExtraData
 {
 public:
+    WwdResourceExtraData() : _wwdStream(NULL), _checksum(0) { }
     virtual ~WwdResourceExtraData();
 
     virtual std::string VToString() { return "WwdResourceExtraData"; }
-    void LoadWwd(char* rawBuffer, uint32 size);
-    WapWwd* GetWwd() { return _wapWorldLevel; }
+
+    // WWD is parsed lazily straight from raw buffer, which therefore has to outlive this extra data.
+    // Both are owned by the same resource handle.
+    void LoadWwd(const char* rawBuffer, uint32 size);
+    WapWwdStream* GetWwd() { return _wwdStream; }
+    // CRC-32 of raw WWD file, identifies level data derived from it
+    uint32 GetChecksum() const { return _checksum; }
 
 private:
-    WapWwd* _wapWorldLevel;
+    WapWwdStream* _wwdStream;
+    uint32 _checksum;
 };
 
 class WwdResourceLoader : public IResourceLoader
 {
 public:
     virtual std::string VGetPattern() { return "*.wwd"; }
-    virtual bool VUseRawFile() { return false; }
-    virtual bool VDiscardRawBufferAfterLoad() { return true; }
-    virtual uint32 VGetLoadedResourceSize(char* rawBuffer, uint32 rawSize) { return rawSize; }
-    virtual bool VLoadResource(char* rawBuffer, uint32 rawSize, std::shared_ptr<ResourceHandle> handle);
+    virtual bool VUseRawFile() { return true; }
+    virtual bool VDiscardRawBufferAfterLoad() { return false; }
+    virtual bool VLoadResource(char* rawBuffer, uint32 rawSize, std::shared_ptr<ResourceHandle> handle) { return true; }
+    virtual std::shared_ptr<IResourceExtraData> VDecodeResource(char* rawBuffer, uint32 rawSize, const std::string& resourceName);
 
-    static WapWwd* LoadAndReturnWwd(const char* resourceString);
+    static WapWwdStream* LoadAndReturnWwd(const char* resourceString);
+    static uint32 LoadAndReturnWwdChecksum(const char* resourceString);
     static std::shared_ptr<WwdResourceLoader> Create();
+
+private:
+    static std::shared_ptr<WwdResourceExtraData> LoadAndReturnExtraData(const char* resourceString);
 };
 
 #endif
@@ -12,6 +12,7 @@
 void XmlResourceExtraData::ParseXml(char* rawBuffer)
 {
     _xmlDocument.Parse(rawBuffer);
+    _textSize = (uint32)strlen(rawBuffer);
 }
 
 TiXmlElement* XmlResourceExtraData::GetRoot()
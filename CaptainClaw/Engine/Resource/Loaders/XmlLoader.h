@@ -7,12 +7,17 @@
 class XmlResourceExtraData : public IResourceExtraData
 {
 public:
+    XmlResourceExtraData() : _textSize(0) { }
+
     virtual std::string VToString() { return "XmlResourceExtraData"; }
+    // Parsed document takes roughly as much as its text
+    virtual uint32 VGetMemorySize() { return _textSize; }
     void ParseXml(char* rawBuffer);
     TiXmlElement* GetRoot();
 
 private:
     TiXmlDocument _xmlDocument;
+    uint32 _textSize;
 };
 
 class XmlResourceLoader : public IResourceLoader
@@ -21,7 +26,6 @@ public:
     virtual std::string VGetPattern() { return "*.xml"; }
     virtual bool VUseRawFile() { return false; }
     virtual bool VDiscardRawBufferAfterLoad() { return true; }
-    virtual uint32 VGetLoadedResourceSize(char* rawBuffer, uint32 rawSize) { return rawSize; }
     virtual bool VLoadResource(char* rawBuffer, uint32 rawSize, std::shared_ptr<ResourceHandle> handle);
 
     static TiXmlElement* LoadAndReturnRootXmlElement(const char* resourceString, bool fromLocalFile = false);
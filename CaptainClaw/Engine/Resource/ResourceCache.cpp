@@ -1,5 +1,9 @@
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <condition_variable>
+#include <deque>
+#include <thread>
 
 #include <libwap.h>
 
@@ -14,6 +18,7 @@ Resource::Resource(const std::string& name)
     _name = name;
     // Transform resource name into lower case characters
     std::transform(_name.begin(), _name.end(), _name.begin(), (int(*)(int)) std::tolower);
+    _nameHash = WAP_HashRezFilePath(_name.c_str());
 }
 
 //=================================================================================================
@@ -22,10 +27,11 @@ Resource::Resource(const std::string& name)
 //     This class implements the IResourceFile interface with RezArchive
 //
 
-ResourceRezArchive::ResourceRezArchive(const std::string rezArchiveFileName)
+ResourceRezArchive::ResourceRezArchive(const std::string rezArchiveFileName, bool useMemoryMapping)
 {
     _rezArchiveFileName = rezArchiveFileName;
     _rezArchive = NULL;
+    _useMemoryMapping = useMemoryMapping;
 }
 
 ResourceRezArchive::~ResourceRezArchive()
@@ -39,19 +45,37 @@ ResourceRezArchive::~ResourceRezArchive()
 
 bool ResourceRezArchive::VOpen()
 {
-    _rezArchive = WAP_LoadRezArchive(_rezArchiveFileName.c_str());
+    if (_useMemoryMapping)
+    {
+        _rezArchive = WAP_LoadRezArchiveMapped(_rezArchiveFileName.c_str());
+    }
+    else
+    {
+        _rezArchive = WAP_LoadRezArchive(_rezArchiveFileName.c_str());
+    }
+
     if (_rezArchive == NULL)
     {
         LOG_ERROR("Could not load Rez archive: " + _rezArchiveFileName);
         return false;
     }
+
+    if (_useMemoryMapping && !WAP_IsRezArchiveMapped(_rezArchive))
+    {
+        LOG_WARNING("Could not memory-map Rez archive: " + _rezArchiveFileName + ". Falling back to file reads.");
+    }
     
     return true;
 }
 
+RezFile* ResourceRezArchive::GetRezFile(Resource* r)
+{
+    return WAP_GetRezFileFromRezArchiveByHash(_rezArchive, r->GetName().c_str(), r->GetNameHash());
+}
+
 int32 ResourceRezArchive::VGetRawResourceSize(Resource* r)
 {
-    RezFile* rezFile = WAP_GetRezFileFromRezArchive(_rezArchive, r->GetName().c_str());
+    RezFile* rezFile = GetRezFile(r);
     if (rezFile == NULL)
     {
         LOG_ERROR("Could not locate: " + r->GetName() + " in rezArchive: " + _rezArchiveFileName);
@@ -66,29 +90,49 @@ int32 ResourceRezArchive::VGetRawResource(Resource* r, char* outBuffer)
 {
     assert(outBuffer != NULL);
 
-    RezFile* rezFile = WAP_GetRezFileFromRezArchive(_rezArchive, r->GetName().c_str());
+    RezFile* rezFile = GetRezFile(r);
     if (rezFile == NULL)
     {
         LOG_ERROR("Could not locate: " + r->GetName() + " in rezArchive: " + _rezArchiveFileName);
         return -1;
     }
 
-    // This this buffer is owner by libwap => we need to create our own
-    char* data = WAP_GetRezFileData(rezFile);
-    //LOG_WARNING("rezFile->fullName = " + std::string(rezFile->fullPathAndName));
-    if (data == NULL)
+    // Read straight into our buffer, this does not touch any shared state within libwap
+    // so resources can be read from multiple threads
+    if (WAP_ReadRezFileInto(rezFile, outBuffer) < 0)
     {
         LOG_ERROR("Could not load buffer for rez file: " + r->GetName() + " in rezArchive: " + _rezArchiveFileName);
         return -1;
     }
 
-    // 
-    memcpy(outBuffer, data, rezFile->size);
+    return rezFile->size;
+}
+
+bool ResourceRezArchive::VGetResourceStamp(Resource* r, ResourceStamp& outStamp)
+{
+    RezFile* rezFile = GetRezFile(r);
+    if (rezFile == NULL)
+    {
+        return false;
+    }
 
-    // We dont need libwaps data anymore
-    WAP_FreeFileData(rezFile);
+    outStamp.fileId = rezFile->fileId;
+    outStamp.dateAndTime = rezFile->dateAndTime;
+    outStamp.size = rezFile->size;
 
-    return rezFile->size;
+    return true;
+}
+
+// Remark: returned buffer is read-only and owned by libwap, it lives as long as the archive
+const char* ResourceRezArchive::VGetMappedRawResource(Resource* r)
+{
+    RezFile* rezFile = GetRezFile(r);
+    if (rezFile == NULL)
+    {
+        return NULL;
+    }
+
+    return WAP_GetRezFileMappedData(rezFile);
 }
 
 int32 ResourceRezArchive::VGetNumResources() const
@@ -216,20 +260,46 @@ std::vector<std::string> ResourceZipArchive::GetAllFilesInDirectory(const char*
 // class ResourceHandle
 //
 
-ResourceHandle::ResourceHandle(Resource& resource, char* buffer, uint32 size, ResourceCache* resCache)
+ResourceHandle::ResourceHandle(Resource& resource, char* buffer, uint32 size, ResourceCache* resCache, bool ownsBuffer)
     : _resource(resource)
 {
     _buffer = buffer;
     _size = size;
+    _ownsBuffer = ownsBuffer;
     _extraData = NULL;
+    _extraDataSize = 0;
     _resourceCache = resCache;
+    _isInLruList = false;
 }
 
 ResourceHandle::~ResourceHandle()
 {
-    SAFE_DELETE_ARRAY(_buffer);
+    // Borrowed buffers were never allocated from resource cache
+    uint32 freedSize = _extraDataSize;
+    if (_ownsBuffer)
+    {
+        SAFE_DELETE_ARRAY(_buffer);
+        freedSize += _size;
+    }
 
-    _resourceCache->MemoryHasBeenFreed(_size);
+    _resourceCache->MemoryHasBeenFreed(freedSize);
+}
+
+void ResourceHandle::SetExtraData(std::shared_ptr<IResourceExtraData> extraData)
+{
+    _extraData = extraData;
+    UpdateExtraDataSize();
+}
+
+void ResourceHandle::UpdateExtraDataSize()
+{
+    uint32 extraDataSize = _extraData ? _extraData->VGetMemorySize() : 0;
+    if (extraDataSize != _extraDataSize)
+    {
+        uint32 oldExtraDataSize = _extraDataSize;
+        _extraDataSize = extraDataSize;
+        _resourceCache->ExtraDataResized(oldExtraDataSize, extraDataSize);
+    }
 }
 
 //=================================================================================================
@@ -258,6 +328,7 @@ bool ResourceCache::Init()
 {
     if (_resourceFile->VOpen())
     {
+        _nameIndex.Build(_resourceFile);
         return true;
     }
 
@@ -286,74 +357,187 @@ std::shared_ptr<ResourceHandle> ResourceCache::GetHandle(Resource* r)
 
 std::shared_ptr<ResourceHandle> ResourceCache::Load(Resource* r)
 {
-    std::shared_ptr<IResourceLoader> loader;
-    std::shared_ptr<ResourceHandle> handle;
+    if (std::shared_ptr<IResourceLoader> loader = FindLoader(r))
+    {
+        loader->VPrepareDecode();
+    }
 
-    for (auto resourceLoader : _resourceLoaderList)
+    RawResource rawResource;
+    if (!ReadResource(r, rawResource, false))
     {
-        std::shared_ptr<IResourceLoader> testLoader = resourceLoader;
+        return nullptr;
+    }
+
+    return InsertResource(r, rawResource);
+}
 
-        if (WildcardMatch(testLoader->VGetPattern().c_str(), r->GetName().c_str()))
+std::shared_ptr<IResourceLoader> ResourceCache::FindLoader(Resource* r)
+{
+    for (auto resourceLoader : _resourceLoaderList)
+    {
+        if (WildcardMatch(resourceLoader->VGetPattern().c_str(), r->GetName().c_str()))
         {
-            loader = testLoader;
-            break;
+            return resourceLoader;
         }
     }
 
+    return nullptr;
+}
+
+// Remark: This can be called from multiple threads at once, it must not touch any cache state
+bool ResourceCache::ReadResource(Resource* r, RawResource& rawResource, bool decode)
+{
+    std::shared_ptr<IResourceLoader> loader = FindLoader(r);
     if (!loader)
     {
         LOG_ERROR("Default resource loader for resource: " + r->GetName() + " not found");
-        return nullptr;
+        return false;
     }
 
-    int32 rawSize = _resourceFile->VGetRawResourceSize(r);
-    if (rawSize < 0)
+    rawResource.loader = loader;
+
+    // Decoded data from previous runs spare decoding and unless the loader keeps raw data, also reading
+    ResourceStamp stamp;
+    uint32 decodedAssetVariant = 0;
+    const bool useDecodedAssetCache = _decodedAssetCache &&
+        loader->VGetDecodedAssetVariant(decodedAssetVariant) &&
+        _resourceFile->VGetResourceStamp(r, stamp);
+    if (useDecodedAssetCache && LoadDecodedResource(r, stamp, decodedAssetVariant, rawResource) && !loader->VUseRawFile())
     {
-        LOG_ERROR("Resource size return -1 => Resource not found. Resource: " + r->GetName());
-        return nullptr;
+        return true;
     }
 
-    int32 allocSize = rawSize + ((loader->VAddNullZero()) ? (1) : (0));
-    char* rawBuffer = loader->VUseRawFile() ? Allocate(allocSize) : new char[allocSize];
-    if (rawBuffer == NULL)
     {
-        LOG_ERROR("Could not allocate enough memory for resource: " + r->GetName() + 
-            " in resource file: " + _resourceFile->VGetName());
-        return nullptr;
+        std::unique_lock<std::mutex> readLock(_readMutex, std::defer_lock);
+        if (!_resourceFile->VSupportsConcurrentReads())
+        {
+            readLock.lock();
+        }
+
+        int32 rawSize = _resourceFile->VGetRawResourceSize(r);
+        if (rawSize < 0)
+        {
+            LOG_ERROR("Resource size return -1 => Resource not found. Resource: " + r->GetName());
+            return false;
+        }
+
+        rawResource.rawSize = rawSize;
+
+        // Memory-mapped resource files hand out their data directly, so there is nothing to
+        // allocate or copy. Loaders which need null terminated buffer still get their own copy.
+        // Mapped data are read-only, loaders only parse them.
+        const char* mappedBuffer = loader->VAddNullZero() ? NULL : _resourceFile->VGetMappedRawResource(r);
+        if (mappedBuffer != NULL)
+        {
+            rawResource.rawBuffer = const_cast<char*>(mappedBuffer);
+            rawResource.isRawBufferMapped = true;
+        }
+        else
+        {
+            // Memory is accounted for when the resource is inserted into cache
+            int32 allocSize = rawSize + ((loader->VAddNullZero()) ? (1) : (0));
+            rawResource.rawBuffer = new char[allocSize];
+            memset(rawResource.rawBuffer, 0, allocSize);
+
+            if (_resourceFile->VGetRawResource(r, rawResource.rawBuffer) < 0)
+            {
+                LOG_ERROR("Could not retrieve data buffer from resource: " + r->GetName() +
+                    " in resource file: " + _resourceFile->VGetName());
+                SAFE_DELETE_ARRAY(rawResource.rawBuffer);
+                return false;
+            }
+        }
     }
-    memset(rawBuffer, 0, allocSize);
 
-    if (_resourceFile->VGetRawResource(r, rawBuffer) < 0)
+    // Resources which end up in decoded asset cache are always decoded here so that they can be stored
+    if ((decode || useDecodedAssetCache) && !rawResource.extraData)
     {
-        LOG_ERROR("Could not retrieve data buffer from resource: " + r->GetName() + 
-            " in resource file: " + _resourceFile->VGetName());
-        return nullptr;
+        rawResource.extraData = loader->VDecodeResource(rawResource.rawBuffer, rawResource.rawSize, r->GetName());
+        std::vector<char> decodedData;
+        if (rawResource.extraData && useDecodedAssetCache &&
+            loader->VSaveDecodedResource(rawResource.extraData, decodedData))
+        {
+            _decodedAssetCache->Store(r->GetName(), stamp, decodedAssetVariant, decodedData);
+        }
     }
 
-    char* buffer = NULL;
-    uint32 size = 0;
+    return true;
+}
+
+// Remark: This can be called from multiple threads at once, it must not touch any cache state
+bool ResourceCache::LoadDecodedResource(Resource* r, const ResourceStamp& stamp, uint32 variant, RawResource& rawResource)
+{
+    std::vector<char> decodedData;
+    if (!_decodedAssetCache->Load(r->GetName(), stamp, variant, decodedData))
+    {
+        return false;
+    }
+
+    rawResource.extraData = rawResource.loader->VLoadDecodedResource(decodedData, r->GetName());
+    if (!rawResource.extraData)
+    {
+        return false;
+    }
+
+    // Raw data are never read
+    if (!rawResource.loader->VUseRawFile())
+    {
+        rawResource.rawSize = stamp.size;
+    }
+
+    return true;
+}
+
+std::shared_ptr<ResourceHandle> ResourceCache::InsertResource(Resource* r, RawResource& rawResource)
+{
+    std::shared_ptr<IResourceLoader> loader = rawResource.loader;
+    std::shared_ptr<ResourceHandle> handle;
+    char* rawBuffer = rawResource.rawBuffer;
+    const bool isRawBufferMapped = rawResource.isRawBufferMapped;
 
     // Just store binary data + size in handle
     if (loader->VUseRawFile())
     {
-        buffer = rawBuffer;
-        handle = std::shared_ptr<ResourceHandle>(new ResourceHandle(*r, buffer, rawSize, this));
+        if (!isRawBufferMapped && !Reserve(rawResource.rawSize))
+        {
+            LOG_ERROR("Could not allocate enough memory for resource: " + r->GetName() +
+                " in resource file: " + _resourceFile->VGetName());
+            SAFE_DELETE_ARRAY(rawBuffer);
+            return nullptr;
+        }
+
+        handle = std::shared_ptr<ResourceHandle>(new ResourceHandle(*r, rawBuffer, rawResource.rawSize, this, !isRawBufferMapped));
+
+        if (rawResource.extraData)
+        {
+            handle->SetExtraData(rawResource.extraData);
+
+            // Raw data are still there so loader can create its extra data upon first request
+            if (!loader->VFinishDecodedResource(handle))
+            {
+                handle->SetExtraData(nullptr);
+            }
+            handle->UpdateExtraDataSize();
+        }
     }
     else // Or store meaningful arbitrary file format
     {
-        size = loader->VGetLoadedResourceSize(rawBuffer, rawSize);
-        buffer = Allocate(size);
-        if (buffer == NULL)
+        // Nothing is kept besides extra data, they account for their own memory
+        handle = std::shared_ptr<ResourceHandle>(new ResourceHandle(*r, NULL, 0, this, false));
+
+        bool success = false;
+        if (rawResource.extraData)
         {
-            LOG_ERROR("Could not allocate enough memory for resource: " + r->GetName() +
-                " in resource file: " + _resourceFile->VGetName());
-            return shared_ptr<ResourceHandle>();
+            handle->SetExtraData(rawResource.extraData);
+            success = loader->VFinishDecodedResource(handle);
+            handle->UpdateExtraDataSize();
+        }
+        else
+        {
+            success = loader->VLoadResource(rawBuffer, rawResource.rawSize, handle);
         }
-         
-        handle = std::shared_ptr<ResourceHandle>(new ResourceHandle(*r, buffer, size, this));
-        bool success = loader->VLoadResource(rawBuffer, rawSize, handle);
 
-        if (loader->VDiscardRawBufferAfterLoad())
+        if (loader->VDiscardRawBufferAfterLoad() && !isRawBufferMapped)
         {
             SAFE_DELETE_ARRAY(rawBuffer);
         }
@@ -372,59 +556,66 @@ std::shared_ptr<ResourceHandle> ResourceCache::Load(Resource* r)
         return nullptr;
     }
 
+    // Resource could have been inserted meanwhile, e.g. by loader of another resource
+    if (std::shared_ptr<ResourceHandle> oldHandle = Find(r))
+    {
+        Free(oldHandle);
+    }
+
     _lruList.push_front(handle);
-    _resourceMap[r->GetName()] = handle;
+    handle->_lruPosition = _lruList.begin();
+    handle->_isInLruList = true;
+    _resourceMap.insert(std::make_pair(r->GetNameHash(), handle));
 
     return handle;
 }
 
+// Lookup never inserts anything, misses leave the map untouched
 std::shared_ptr<ResourceHandle> ResourceCache::Find(Resource* r)
 {
-    return _resourceMap[r->GetName()];
+    auto range = _resourceMap.equal_range(r->GetNameHash());
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second->GetName() == r->GetName())
+        {
+            return it->second;
+        }
+    }
+
+    return nullptr;
 }
 
 void ResourceCache::Update(std::shared_ptr<ResourceHandle> handle)
 {
-    _lruList.remove(handle);
-    _lruList.push_front(handle);
+    assert(handle->_isInLruList);
+    _lruList.splice(_lruList.begin(), _lruList, handle->_lruPosition);
 }
 
-char* ResourceCache::Allocate(uint32 size)
+// Accounts memory of given size, it can be allocated elsewhere (e.g. by preloading threads)
+bool ResourceCache::Reserve(uint32 size)
 {
     if (!MakeRoom(size))
     {
         LOG_WARNING("Out of memory in resource cache");
-        return NULL;
+        return false;
     }
 
-    char* mem = new char[size];
-    if (mem)
-    {
-        _allocated += size;
-    }
+    _allocated += size;
 
-    return mem;
+    return true;
 }
 
 void ResourceCache::FreeOneResource()
 {
     //LOG("FreeOneResource");
-    ResourceHandleList::iterator gonner = _lruList.end();
-    gonner--;
-
-    shared_ptr<ResourceHandle> handle = *gonner;
-
-    _lruList.pop_back();
-    _resourceMap.erase(handle->GetName());
+    Free(_lruList.back());
 }
 
 void ResourceCache::Flush()
 {
     while (!_lruList.empty())
     {
-        std::shared_ptr<ResourceHandle> handle = *(_lruList.begin());
-        Free(handle);
-        _lruList.pop_front();
+        FreeOneResource();
     }
 }
 
@@ -435,11 +626,8 @@ bool ResourceCache::MakeRoom(uint32 size)
         return false;
     }
 
-    int64 x = _cacheSize - _allocated;
-    //LOG("Room left: " + ToStr(x));
-
     // Return NULL if there is no possibility to allocate memory
-    while (size > (_cacheSize - _allocated))
+    while (_allocated + size > _cacheSize)
     {
         if (_lruList.empty())
         {
@@ -452,10 +640,35 @@ bool ResourceCache::MakeRoom(uint32 size)
     return true;
 }
 
+void ResourceCache::TrimToBudget()
+{
+    // Most recently used resource is kept, it is the one which is just being used
+    while (_allocated > _cacheSize && _lruList.size() > 1)
+    {
+        FreeOneResource();
+    }
+}
+
+// Remark: Memory is accounted for until the handle is destroyed, which may be later if it is still referenced
 void ResourceCache::Free(std::shared_ptr<ResourceHandle> gonner)
 {
-    _lruList.remove(gonner);
-    _resourceMap.erase(gonner->GetName());
+    if (!gonner->_isInLruList)
+    {
+        return;
+    }
+
+    auto range = _resourceMap.equal_range(gonner->GetNameHash());
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second == gonner)
+        {
+            _resourceMap.erase(it);
+            break;
+        }
+    }
+
+    _lruList.erase(gonner->_lruPosition);
+    gonner->_isInLruList = false;
 }
 
 void ResourceCache::MemoryHasBeenFreed(uint32 size)
@@ -463,67 +676,160 @@ void ResourceCache::MemoryHasBeenFreed(uint32 size)
     _allocated -= size;
 }
 
-std::vector<std::string> ResourceCache::Match(const std::string pattern)
+void ResourceCache::ExtraDataResized(uint32 oldSize, uint32 newSize)
 {
-    std::vector<std::string> matchingNames;
+    _allocated = _allocated - oldSize + newSize;
+    if (newSize > oldSize)
+    {
+        TrimToBudget();
+    }
+}
 
+std::vector<std::string> ResourceCache::Match(const std::string pattern)
+{
     if (_resourceFile == NULL)
     {
-        return matchingNames;
+        return std::vector<std::string>();
     }
 
     // Everything is converted into lower case so maintain consistency
-    std::string patternCopy = pattern;
-    std::transform(patternCopy.begin(), patternCopy.end(), patternCopy.begin(), (int(*)(int)) std::tolower);
+    return _nameIndex.Match(pattern);
+}
 
-    uint32 numFiles = _resourceFile->VGetNumResources();
-    for (uint32 fileIdx = 0; fileIdx < numFiles; ++fileIdx)
+std::vector<std::string> ResourceCache::MatchInDirectory(const std::string pattern)
+{
+    if (_resourceFile == NULL)
     {
-        std::string fileNamePath = _resourceFile->VGetResourceName(fileIdx);
-        // Everything is converted into lower case so maintain consistency
-        std::transform(fileNamePath.begin(), fileNamePath.end(), fileNamePath.begin(), (int(*)(int)) std::tolower);
-
-        //std::cout << "Filename: " << fileNamePath << ", Pattern: " << pattern << std::endl;
-
-        if (WildcardMatch(patternCopy.c_str(), fileNamePath.c_str()))
-        {
-            matchingNames.push_back(fileNamePath);
-        }
+        return std::vector<std::string>();
     }
 
-    return matchingNames;
+    return _nameIndex.MatchInDirectory(pattern);
 }
-using namespace std;
+
 int32 ResourceCache::Preload(const std::string pattern, void(*progressCallback)(int32, bool &))
 {
     if (_resourceFile == NULL)
     {
         return 0;
     }
-        
-    int32 numFiles = _resourceFile->VGetNumResources();
+
     int32 loaded = 0;
     bool cancel = false;
 
-    // Everything is converted into lower case so maintain consistency
-    std::string patternCopy = pattern;
-    std::transform(patternCopy.begin(), patternCopy.end(), patternCopy.begin(), (int(*)(int)) std::tolower);
-
-    for (int32 fileIdx = 0; fileIdx < numFiles; ++fileIdx)
+    // Only resources which are not cached yet are loaded, cached ones are just touched
+    std::vector<Resource> pendingResources;
+    for (const std::string& resourceName : Match(pattern))
     {
-        Resource resource(_resourceFile->VGetResourceName(fileIdx));
-        //cout << "Checking pattern for resource: " << resource.GetName() << endl;
+        Resource resource(resourceName);
 
-        if (WildcardMatch(patternCopy.c_str(), resource.GetName().c_str()))
+        if (std::shared_ptr<ResourceHandle> handle = Find(&resource))
         {
-            // This loads unloaded resource and skips loaded ones
-            GetHandle(&resource);
+            Update(handle);
             ++loaded;
         }
+        else
+        {
+            pendingResources.push_back(resource);
+        }
+    }
 
+    const uint32 numPending = pendingResources.size();
+    if (numPending == 0)
+    {
         if (progressCallback != NULL)
         {
-            progressCallback((fileIdx / numFiles) * 100, cancel);
+            progressCallback(100, cancel);
+        }
+        return loaded;
+    }
+
+    // Workers read and decode resources, everything which touches cache state or the renderer
+    // is done here on main thread as the results come in
+    for (std::shared_ptr<IResourceLoader> loader : _resourceLoaderList)
+    {
+        loader->VPrepareDecode();
+    }
+
+    std::vector<RawResource> rawResources(numPending);
+    std::atomic<uint32> nextResourceIdx(0);
+    std::atomic<bool> stopWorkers(false);
+
+    std::mutex finishedMutex;
+    std::condition_variable finishedCondition;
+    std::deque<std::pair<uint32, bool>> finishedResources;
+
+    auto worker = [&]()
+    {
+        while (!stopWorkers)
+        {
+            uint32 resourceIdx = nextResourceIdx++;
+            if (resourceIdx >= numPending)
+            {
+                break;
+            }
+
+            bool success = ReadResource(&pendingResources[resourceIdx], rawResources[resourceIdx], true);
+            {
+                std::lock_guard<std::mutex> lock(finishedMutex);
+                finishedResources.push_back(std::make_pair(resourceIdx, success));
+            }
+            finishedCondition.notify_one();
+        }
+    };
+
+    // Main thread has plenty of work with inserting the results
+    uint32 numWorkers = std::thread::hardware_concurrency();
+    numWorkers = (numWorkers > 2) ? (numWorkers - 1) : 1;
+    numWorkers = std::min(numWorkers, numPending);
+
+    std::vector<std::thread> workers;
+    for (uint32 workerIdx = 0; workerIdx < numWorkers; ++workerIdx)
+    {
+        workers.push_back(std::thread(worker));
+    }
+
+    uint32 numFinished = 0;
+    int32 lastProgress = -1;
+    while (numFinished < numPending && !cancel)
+    {
+        std::deque<std::pair<uint32, bool>> batch;
+        {
+            std::unique_lock<std::mutex> lock(finishedMutex);
+            finishedCondition.wait(lock, [&finishedResources]() { return !finishedResources.empty(); });
+            batch.swap(finishedResources);
+        }
+
+        for (const std::pair<uint32, bool>& finished : batch)
+        {
+            if (finished.second && InsertResource(&pendingResources[finished.first], rawResources[finished.first]))
+            {
+                ++loaded;
+            }
+            rawResources[finished.first] = RawResource();
+            ++numFinished;
+        }
+
+        // Callback is only bothered when the percentage actually changes
+        int32 progress = (int32)(((uint64)numFinished * 100) / numPending);
+        if (progressCallback != NULL && progress != lastProgress)
+        {
+            progressCallback(progress, cancel);
+            lastProgress = progress;
+        }
+    }
+
+    stopWorkers = true;
+    for (std::thread& workerThread : workers)
+    {
+        workerThread.join();
+    }
+
+    // Resources which were already being read when preloading got cancelled
+    for (const std::pair<uint32, bool>& finished : finishedResources)
+    {
+        if (finished.second && InsertResource(&pendingResources[finished.first], rawResources[finished.first]))
+        {
+            ++loaded;
         }
     }
 
@@ -9,16 +9,21 @@
 #include <libwap.h>
 #include "../SharedDefines.h"
 #include "ZipFile.h"
+#include "DecodedAssetCache.h"
+#include "ResourceNameIndex.h"
 
 class Resource
 {
 public:
     Resource(const std::string &name);
 
-    inline std::string GetName() { return _name; }
+    inline const std::string& GetName() const { return _name; }
+    // Precomputed lookup key of resource name, so that it is not rehashed upon each lookup
+    inline uint32 GetNameHash() const { return _nameHash; }
 
 protected:
     std::string _name;
+    uint32 _nameHash;
 };
 
 //-------------------------------------------------------------------------------------------------
@@ -29,6 +34,9 @@ class IResourceExtraData
 {
 public:
     virtual std::string VToString() = 0;
+    // Memory held by extra data (e.g. decoded pixels, textures, sound samples) which is accounted
+    // for in resource cache budget along with the raw buffer
+    virtual uint32 VGetMemorySize() { return 0; }
 };
 
 // This would work well in a perfect universe witihout any code repetition but not all
@@ -66,6 +74,12 @@ public:
     virtual std::string VGetName() const = 0;
     virtual int32 VGetRawResourceSize(Resource* r) = 0;
     virtual int32 VGetRawResource(Resource* r, char* outBuffer) = 0;
+    // Read-only data of the resource if the resource file can provide them without copying, NULL otherwise
+    virtual const char* VGetMappedRawResource(Resource* r) { return NULL; }
+    // True if raw resources can be read from multiple threads at once
+    virtual bool VSupportsConcurrentReads() const { return false; }
+    // False if the resource file cannot tell when its resources change, their decoded data are not cached then
+    virtual bool VGetResourceStamp(Resource* r, ResourceStamp& outStamp) { return false; }
     virtual int32 VGetNumResources() const = 0;
     virtual std::string VGetResourceName(int32 num) const = 0;
     virtual bool VIsUsingDevelopmentDIrectories() const = 0;
@@ -81,8 +95,24 @@ public:
     virtual bool VUseRawFile() = 0;
     virtual bool VDiscardRawBufferAfterLoad() = 0;
     virtual bool VAddNullZero() { return false; }
-    virtual uint32 VGetLoadedResourceSize(char* rawBuffer, uint32 rawSize) = 0;
     virtual bool VLoadResource(char* buffer, uint32 rawSize, std::shared_ptr<ResourceHandle> handle) = 0;
+
+    // Called on main thread before resources are read, loaders capture the main thread state
+    // (e.g. current palette) which VDecodeResource and VGetDecodedAssetVariant depend on
+    virtual void VPrepareDecode() { }
+    // Decodes raw data into resource's extra data while preloading. It is called from worker threads
+    // so it must not touch renderer, resource cache or any other main thread state.
+    // nullptr means that the resource will be loaded by VLoadResource on main thread instead.
+    virtual std::shared_ptr<IResourceExtraData> VDecodeResource(char* rawBuffer, uint32 rawSize, const std::string& resourceName) { return nullptr; }
+    // Called on main thread once handle received extra data from VDecodeResource, e.g. to create textures
+    virtual bool VFinishDecodedResource(std::shared_ptr<ResourceHandle> handle) { return true; }
+
+    // Extra data from VDecodeResource can be stored in decoded asset cache so that they do not have
+    // to be decoded again next time. Loaders which support it return true along with variant of the
+    // decoded data (anything else besides raw data they depend on). Called from worker threads as well.
+    virtual bool VGetDecodedAssetVariant(uint32& outVariant) { return false; }
+    virtual bool VSaveDecodedResource(std::shared_ptr<IResourceExtraData> extraData, std::vector<char>& outData) { return false; }
+    virtual std::shared_ptr<IResourceExtraData> VLoadDecodedResource(const std::vector<char>& data, const std::string& resourceName) { return nullptr; }
 };
 
 //-------------------------------------------------------------------------------------------------
@@ -90,7 +120,7 @@ public:
 class ResourceRezArchive : public IResourceFile
 {
 public:
-    ResourceRezArchive(const std::string rezArchiveFileName);
+    ResourceRezArchive(const std::string rezArchiveFileName, bool useMemoryMapping = false);
     virtual ~ResourceRezArchive();
 
     // Interface
@@ -98,14 +128,20 @@ public:
     virtual std::string VGetName() const { return _rezArchiveFileName; }
     virtual int32 VGetRawResourceSize(Resource* r);
     virtual int32 VGetRawResource(Resource* r, char* outBuffer);
+    virtual const char* VGetMappedRawResource(Resource* r);
+    virtual bool VSupportsConcurrentReads() const { return true; }
+    virtual bool VGetResourceStamp(Resource* r, ResourceStamp& outStamp);
     virtual int32 VGetNumResources() const;
     virtual std::string VGetResourceName(int32 num) const;
     virtual bool VIsUsingDevelopmentDIrectories() const { return false; }
     virtual std::vector<std::string> GetAllFilesInDirectory(const char* directoryPath);
 
 private:
+    RezFile* GetRezFile(Resource* r);
+
     RezArchive* _rezArchive;
     std::string _rezArchiveFileName;
+    bool _useMemoryMapping;
 };
 
 class ResourceZipArchive : public IResourceFile
@@ -131,34 +167,46 @@ private:
 //------------------------------------------------------------------------------------------------
 
 class ResourceCache;
+typedef std::list<std::shared_ptr<ResourceHandle>> ResourceHandleList;
+typedef std::list<std::shared_ptr<IResourceLoader>> ResourceLoaderList;
+// Keyed by precomputed resource name hash, names are compared only within the same bucket
+typedef std::unordered_multimap<uint32, std::shared_ptr<ResourceHandle>> ResourceHandleMap;
+
 class ResourceHandle
 {
+    friend class ResourceCache;
+
 public:
-    ResourceHandle(Resource& resource, char* buffer, uint32 size, ResourceCache* resCache);
+    // If ownsBuffer is false, buffer points to memory owned by resource file (e.g. mapped archive)
+    ResourceHandle(Resource& resource, char* buffer, uint32 size, ResourceCache* resCache, bool ownsBuffer = true);
     virtual ~ResourceHandle();
 
-    const std::string GetName() { return _resource.GetName(); }
+    const std::string& GetName() const { return _resource.GetName(); }
+    uint32 GetNameHash() const { return _resource.GetNameHash(); }
     uint32 GetSize() const { return _size; }
     char* GetDataBuffer() const { return _buffer; }
     char* GetWritableBuffer() { return _buffer; }
 
     std::shared_ptr<IResourceExtraData> GetExtraData() { return _extraData; }
-    void SetExtraData(std::shared_ptr<IResourceExtraData> extraData) { _extraData = extraData; }
+    void SetExtraData(std::shared_ptr<IResourceExtraData> extraData);
+    // Has to be called whenever extra data change their size after being set, e.g. when texture gets created
+    void UpdateExtraDataSize();
 
 protected:
     Resource _resource;
     char* _buffer;
     uint32 _size;
+    bool _ownsBuffer;
     std::shared_ptr<IResourceExtraData> _extraData;
+    uint32 _extraDataSize;
     ResourceCache* _resourceCache;
 
 private:
+    // Position within cache's LRU list so that it can be moved or removed without searching
+    ResourceHandleList::iterator _lruPosition;
+    bool _isInLruList;
 };
 
-typedef std::list<std::shared_ptr<ResourceHandle>> ResourceHandleList;
-typedef std::list<std::shared_ptr<IResourceLoader>> ResourceLoaderList;
-typedef std::map<std::string, std::shared_ptr<ResourceHandle>> ResourceHandleMap;
-
 class ResourceCache
 {
 public:
@@ -170,11 +218,17 @@ public:
     std::string GetName() { return m_Name; }
 
     void RegisterLoader(std::shared_ptr<IResourceLoader> loader);
+    // Resources whose loaders support it are decoded only once and then loaded from this cache
+    void SetDecodedAssetCache(std::shared_ptr<DecodedAssetCache> decodedAssetCache) { _decodedAssetCache = decodedAssetCache; }
 
     std::shared_ptr<ResourceHandle> GetHandle(Resource* r);
 
+    // Loads all matching resources which are not cached yet. Reading and decoding is spread across
+    // worker threads, progress is reported in percents and setting the bool to true cancels preloading
     int32 Preload(const std::string pattern, void(*progressCallback)(int32, bool &));
     std::vector<std::string> Match(const std::string pattern);
+    // Matches only resources directly in pattern's directory, e.g. "/level1/images/officer/*"
+    std::vector<std::string> MatchInDirectory(const std::string pattern);
     std::vector<std::string> GetAllFilesInDirectory(const char* directoryPath);
 
     void Flush();
@@ -182,12 +236,34 @@ public:
     bool IsUsingDevelopmentDirectories() { assert(_resourceFile != NULL); return _resourceFile->VIsUsingDevelopmentDIrectories(); }
 
     void MemoryHasBeenFreed(uint32 size);
+    // Accounts change of memory held by handle's extra data
+    void ExtraDataResized(uint32 oldSize, uint32 newSize);
 
 protected:
     bool MakeRoom(uint32 size);
-    char* Allocate(uint32 size);
+    bool Reserve(uint32 size);
     void Free(std::shared_ptr<ResourceHandle> gonner);
+    // Evicts least recently used resources until allocated memory fits into the budget again
+    void TrimToBudget();
 
+    // Resource data read from resource file but not yet inserted into cache
+    struct RawResource
+    {
+        RawResource() : rawBuffer(NULL), rawSize(0), isRawBufferMapped(false) { }
+
+        std::shared_ptr<IResourceLoader> loader;
+        char* rawBuffer;
+        int32 rawSize;
+        bool isRawBufferMapped;
+        std::shared_ptr<IResourceExtraData> extraData;
+    };
+
+    std::shared_ptr<IResourceLoader> FindLoader(Resource* r);
+    // Thread safe, does not touch any cache state
+    bool ReadResource(Resource* r, RawResource& rawResource, bool decode);
+    // Thread safe, returns true if extra data were loaded from decoded asset cache
+    bool LoadDecodedResource(Resource* r, const ResourceStamp& stamp, uint32 variant, RawResource& rawResource);
+    std::shared_ptr<ResourceHandle> InsertResource(Resource* r, RawResource& rawResource);
     std::shared_ptr<ResourceHandle> Load(Resource* r);
     std::shared_ptr<ResourceHandle> Find(Resource* r);
     void Update(std::shared_ptr<ResourceHandle> handle);
@@ -197,6 +273,7 @@ protected:
 private:
     std::string m_Name;
     IResourceFile* _resourceFile;
+    std::shared_ptr<DecodedAssetCache> _decodedAssetCache;
 
     uint64 _cacheSize;
     uint64 _allocated;
@@ -204,6 +281,12 @@ private:
     ResourceHandleList _lruList;
     ResourceLoaderList _resourceLoaderList;
     ResourceHandleMap _resourceMap;
+
+    // Names of all resources in resource file, built when it is opened
+    ResourceNameIndex _nameIndex;
+
+    // Guards reads from resource files which do not support concurrent reads
+    std::mutex _readMutex;
 };
 
 #endif
\ No newline at end of file
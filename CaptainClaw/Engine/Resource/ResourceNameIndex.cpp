@@ -0,0 +1,175 @@
+#include "ResourceNameIndex.h"
+#include "ResourceCache.h"
+
+static std::string ToLowercase(const std::string& str)
+{
+    std::string lowercase = str;
+    std::transform(lowercase.begin(), lowercase.end(), lowercase.begin(), (int(*)(int)) std::tolower);
+    return lowercase;
+}
+
+ResourceNameIndex::ResourceNameIndex()
+{
+    m_Directories.push_back(DirectoryNode());
+}
+
+void ResourceNameIndex::Build(IResourceFile* pResourceFile)
+{
+    std::lock_guard<std::mutex> lock(m_MemoMutex);
+
+    m_SortedNames.clear();
+    m_Directories.clear();
+    m_Directories.push_back(DirectoryNode());
+    m_MatchMemo.clear();
+    m_DirectoryMatchMemo.clear();
+
+    if (pResourceFile == NULL)
+    {
+        return;
+    }
+
+    int32 numFiles = pResourceFile->VGetNumResources();
+    m_SortedNames.reserve(numFiles);
+    for (int32 fileIdx = 0; fileIdx < numFiles; ++fileIdx)
+    {
+        m_SortedNames.push_back(ToLowercase(pResourceFile->VGetResourceName(fileIdx)));
+    }
+
+    std::sort(m_SortedNames.begin(), m_SortedNames.end());
+    m_SortedNames.erase(std::unique(m_SortedNames.begin(), m_SortedNames.end()), m_SortedNames.end());
+
+    // Names are visited in sorted order so that every directory's file list stays sorted too
+    for (uint32 nameIdx = 0; nameIdx < m_SortedNames.size(); ++nameIdx)
+    {
+        const std::string& name = m_SortedNames[nameIdx];
+
+        uint32 nodeIdx = 0;
+        size_t componentStart = 0;
+        size_t slashPos;
+        while ((slashPos = name.find('/', componentStart)) != std::string::npos)
+        {
+            if (slashPos > componentStart)
+            {
+                std::string component = name.substr(componentStart, slashPos - componentStart);
+                auto findIt = m_Directories[nodeIdx].children.find(component);
+                if (findIt == m_Directories[nodeIdx].children.end())
+                {
+                    uint32 childIdx = m_Directories.size();
+                    m_Directories[nodeIdx].children.insert(std::make_pair(component, childIdx));
+                    m_Directories.push_back(DirectoryNode());
+                    nodeIdx = childIdx;
+                }
+                else
+                {
+                    nodeIdx = findIt->second;
+                }
+            }
+
+            componentStart = slashPos + 1;
+        }
+
+        m_Directories[nodeIdx].files.push_back(nameIdx);
+    }
+}
+
+std::vector<std::string> ResourceNameIndex::Match(const std::string& pattern) const
+{
+    std::string lowercasePattern = ToLowercase(pattern);
+
+    std::lock_guard<std::mutex> lock(m_MemoMutex);
+
+    auto findIt = m_MatchMemo.find(lowercasePattern);
+    if (findIt != m_MatchMemo.end())
+    {
+        return findIt->second;
+    }
+
+    std::vector<std::string> matchingNames;
+    MatchRange(lowercasePattern, matchingNames);
+
+    m_MatchMemo.insert(std::make_pair(lowercasePattern, matchingNames));
+
+    return matchingNames;
+}
+
+std::vector<std::string> ResourceNameIndex::MatchInDirectory(const std::string& pattern) const
+{
+    std::string lowercasePattern = ToLowercase(pattern);
+
+    std::lock_guard<std::mutex> lock(m_MemoMutex);
+
+    auto findIt = m_DirectoryMatchMemo.find(lowercasePattern);
+    if (findIt != m_DirectoryMatchMemo.end())
+    {
+        return findIt->second;
+    }
+
+    std::vector<std::string> matchingNames;
+
+    size_t lastSlashPos = lowercasePattern.find_last_of('/');
+    std::string directoryPath = lastSlashPos != std::string::npos ? lowercasePattern.substr(0, lastSlashPos) : "";
+    if (directoryPath.find_first_of("*?") != std::string::npos)
+    {
+        // Wildcards in directory part are not supported by the trie
+        MatchRange(lowercasePattern, matchingNames);
+    }
+    else if (const DirectoryNode* pDirectory = FindDirectory(directoryPath))
+    {
+        for (uint32 nameIdx : pDirectory->files)
+        {
+            if (WildcardMatch(lowercasePattern.c_str(), m_SortedNames[nameIdx].c_str()))
+            {
+                matchingNames.push_back(m_SortedNames[nameIdx]);
+            }
+        }
+    }
+
+    m_DirectoryMatchMemo.insert(std::make_pair(lowercasePattern, matchingNames));
+
+    return matchingNames;
+}
+
+void ResourceNameIndex::MatchRange(const std::string& lowercasePattern, std::vector<std::string>& outNames) const
+{
+    // Only names starting with literal part of the pattern can match
+    std::string prefix = lowercasePattern.substr(0, lowercasePattern.find_first_of("*?"));
+
+    auto nameIter = std::lower_bound(m_SortedNames.begin(), m_SortedNames.end(), prefix);
+    for (; nameIter != m_SortedNames.end(); ++nameIter)
+    {
+        if (nameIter->compare(0, prefix.length(), prefix) != 0)
+        {
+            break;
+        }
+
+        if (WildcardMatch(lowercasePattern.c_str(), nameIter->c_str()))
+        {
+            outNames.push_back(*nameIter);
+        }
+    }
+}
+
+const ResourceNameIndex::DirectoryNode* ResourceNameIndex::FindDirectory(const std::string& lowercasePath) const
+{
+    std::vector<std::string> components;
+    Split(lowercasePath, components, '/');
+
+    uint32 nodeIdx = 0;
+    for (const std::string& component : components)
+    {
+        if (component.empty())
+        {
+            continue;
+        }
+
+        auto findIt = m_Directories[nodeIdx].children.find(component);
+        if (findIt == m_Directories[nodeIdx].children.end())
+        {
+            return NULL;
+        }
+
+        nodeIdx = findIt->second;
+    }
+
+    return &m_Directories[nodeIdx];
+}
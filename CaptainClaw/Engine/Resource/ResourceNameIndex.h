@@ -0,0 +1,54 @@
+#ifndef __RESOURCE_NAME_INDEX_H__
+#define __RESOURCE_NAME_INDEX_H__
+
+#include "../SharedDefines.h"
+
+class IResourceFile;
+
+//=================================================================================================
+// class ResourceNameIndex
+//
+//     Lowercase names of all resources within resource file, built once when the file is opened.
+//     Names are kept sorted so that patterns with literal prefix (e.g. "/level1/anis/*.ani") are
+//     matched only against names within the prefix range. Directory trie lists files which
+//     reside directly in given directory. Patterns starting with wildcard fall back to full scan.
+//     Results are remembered per pattern for the whole session, resource file is not expected
+//     to change while the game is running.
+//
+//=================================================================================================
+
+class ResourceNameIndex
+{
+public:
+    ResourceNameIndex();
+
+    void Build(IResourceFile* pResourceFile);
+
+    // All resource names matching wildcard pattern, pattern is case insensitive
+    std::vector<std::string> Match(const std::string& pattern) const;
+
+    // Same as Match() but only resources residing directly in pattern's directory are considered,
+    // nested directories are ignored
+    std::vector<std::string> MatchInDirectory(const std::string& pattern) const;
+
+private:
+    struct DirectoryNode
+    {
+        std::map<std::string, uint32> children;
+        // Indices into m_SortedNames
+        std::vector<uint32> files;
+    };
+
+    void MatchRange(const std::string& lowercasePattern, std::vector<std::string>& outNames) const;
+    const DirectoryNode* FindDirectory(const std::string& lowercasePath) const;
+
+    std::vector<std::string> m_SortedNames;
+    // First node is root directory
+    std::vector<DirectoryNode> m_Directories;
+
+    mutable std::mutex m_MemoMutex;
+    mutable std::unordered_map<std::string, std::vector<std::string>> m_MatchMemo;
+    mutable std::unordered_map<std::string, std::vector<std::string>> m_DirectoryMatchMemo;
+};
+
+#endif
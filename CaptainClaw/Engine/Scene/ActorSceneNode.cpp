@@ -2,6 +2,7 @@
 #include "ActorSceneNode.h"
 #include "../Actor/Components/RenderComponent.h"
 #include "../Graphics2D/Image.h"
+#include "../Graphics2D/SpriteBatch.h"
 
 SDL2ActorSceneNode::SDL2ActorSceneNode(const uint32 actorId,
     BaseRenderComponent* pRenderComponent,
@@ -53,20 +54,15 @@ void SDL2ActorSceneNode::VRender(Scene* pScene)
     const SDL_Rect cameraRect = pCamera->GetCameraRect();
     int32 offsetX = arc->IsMirrored() ? -actorImage->GetOffsetX() : actorImage->GetOffsetX();
     int32 offsetY = arc->IsInverted() ? -actorImage->GetOffsetY() : actorImage->GetOffsetY();
+    const Point renderPosition = GetRenderPosition();
     SDL_Rect renderRect =
     {
-        (int)m_Properties.GetPosition().x - actorImage->GetWidth() / 2  + offsetX - cameraRect.x,
-        (int)m_Properties.GetPosition().y - actorImage->GetHeight() / 2 + offsetY - cameraRect.y,
+        (int)renderPosition.x - actorImage->GetWidth() / 2  + offsetX - cameraRect.x,
+        (int)renderPosition.y - actorImage->GetHeight() / 2 + offsetY - cameraRect.y,
         actorImage->GetWidth(),
         actorImage->GetHeight()
     };
 
-    SDL_SetTextureAlphaMod(actorImage->GetTexture(), arc->GetAlpha());
-
-    SDL_Color colorMod = arc->GetColorMod();
-    SDL_SetTextureColorMod(actorImage->GetTexture(), colorMod.r, colorMod.g, colorMod.b);
-
-    SDL_Renderer* renderer = pScene->GetRenderer();
-    SDL_RenderCopyEx(renderer, actorImage->GetTexture(), NULL, &renderRect, 0, NULL, 
-        arc->IsMirrored() ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE);
+    pScene->GetSpriteBatch()->Draw(actorImage->GetTexture(), actorImage->GetSourceRect(), renderRect,
+        arc->IsMirrored() ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE, arc->GetColorMod(), arc->GetAlpha());
 }
@@ -2,6 +2,7 @@
 #include "HUDSceneNode.h"
 #include "../Actor/Components/RenderComponent.h"
 #include "../Graphics2D/Image.h"
+#include "../Graphics2D/SpriteBatch.h"
 #include "../GameApp/BaseGameApp.h"
 
 SDL2HUDSceneNode::SDL2HUDSceneNode(const uint32 actorId,
@@ -68,7 +69,6 @@ void SDL2HUDSceneNode::VRender(Scene* pScene)
         actorImage->GetHeight()
     };
 
-    SDL_Renderer* renderer = pScene->GetRenderer();
-    SDL_RenderCopyEx(renderer, actorImage->GetTexture(), NULL, &renderRect, 0, NULL,
+    pScene->GetSpriteBatch()->Draw(actorImage->GetTexture(), actorImage->GetSourceRect(), renderRect,
         hrc->IsMirrored() ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE);
 }
\ No newline at end of file
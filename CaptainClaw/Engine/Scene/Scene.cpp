@@ -1,6 +1,7 @@
 #include "Scene.h"
 #include "../Events/EventMgr.h"
 #include "../Events/Events.h"
+#include "../Graphics2D/SpriteBatch.h"
 
 //=================================================================================================
 // Scene Implementation
@@ -10,11 +11,13 @@ Scene::Scene(SDL_Renderer* renderer)
 {
     m_pRoot.reset(new RootNode());
     m_pRenderer = renderer;
+    m_pSpriteBatch.reset(new SpriteBatch(renderer));
 
     // Register event delegates here
     IEventMgr* pEventMgr = IEventMgr::Get();
     pEventMgr->VAddListener(MakeDelegate(this, &Scene::NewRenderComponentDelegate), EventData_New_Render_Component::sk_EventType);
     pEventMgr->VAddListener(MakeDelegate(this, &Scene::MoveActorDelegate), EventData_Move_Actor::sk_EventType);
+    pEventMgr->VAddListener(MakeDelegate(this, &Scene::MoveActorBatchDelegate), EventData_Move_Actor_Batch::sk_EventType);
     pEventMgr->VAddListener(MakeDelegate(this, &Scene::DestroyActorDelegate), EventData_Destroy_Actor::sk_EventType);
 }
 
@@ -24,6 +27,12 @@ Scene::~Scene()
     pEventMgr->VRemoveListener(MakeDelegate(this, &Scene::NewRenderComponentDelegate), EventData_New_Render_Component::sk_EventType);
     pEventMgr->VRemoveListener(MakeDelegate(this, &Scene::DestroyActorDelegate), EventData_Destroy_Actor::sk_EventType);
     pEventMgr->VRemoveListener(MakeDelegate(this, &Scene::MoveActorDelegate), EventData_Move_Actor::sk_EventType);
+    pEventMgr->VRemoveListener(MakeDelegate(this, &Scene::MoveActorBatchDelegate), EventData_Move_Actor_Batch::sk_EventType);
+}
+
+bool Scene::OnLostDevice()
+{
+    return m_pRoot->VOnLostDevice(this);
 }
 
 void Scene::OnUpdate(uint32 msDiff)
@@ -90,11 +99,6 @@ bool Scene::RemoveChild(uint32 actorId)
     return m_pRoot->VRemoveChild(actorId);
 }
 
-void Scene::SortSceneNodesByZCoord()
-{
-    m_pRoot->SortChildrenByZCoord();
-}
-
 //---------------------------------------------------------------------------------------------------------------------
 // Event delegates
 //---------------------------------------------------------------------------------------------------------------------
@@ -131,4 +135,18 @@ void Scene::MoveActorDelegate(IEventDataPtr pEventData)
         Point moveDestination = pCastEventData->GetMove();
         pNode->VSetPosition(moveDestination);
     }
+}
+
+void Scene::MoveActorBatchDelegate(IEventDataPtr pEventData)
+{
+    shared_ptr<EventData_Move_Actor_Batch> pCastEventData = static_pointer_cast<EventData_Move_Actor_Batch>(pEventData);
+
+    for (const auto& move : pCastEventData->GetMoves())
+    {
+        SceneActorMap::iterator findIt = m_ActorMap.find(move.first);
+        if (findIt != m_ActorMap.end())
+        {
+            findIt->second->VSetPosition(move.second);
+        }
+    }
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "../SharedDefines.h"
 #include "SceneNodes.h"
 
+class SpriteBatch;
 class Scene
 {
 public:
@@ -11,7 +12,8 @@ public:
     virtual ~Scene();
 
     void OnRender();
-    bool OnLostDevice() { return true; }
+    // Lets scene nodes recreate whatever they prerendered into render targets
+    bool OnLostDevice();
     void OnUpdate(uint32 msDiff);
 
     shared_ptr<ISceneNode> FindActor(uint32 actorId);
@@ -22,19 +24,21 @@ public:
     inline const shared_ptr<CameraNode> GetCamera() const { return m_pCamera; }
 
     inline SDL_Renderer* GetRenderer() { return m_pRenderer; }
-
-    void SortSceneNodesByZCoord();
+    // Scene nodes draw their images through this so that they are submitted per render pass
+    inline SpriteBatch* GetSpriteBatch() { return m_pSpriteBatch.get(); }
 
     // Event delegates
     void NewRenderComponentDelegate(IEventDataPtr pEventData);
     void ModifiedRenderComponentDelegate(IEventDataPtr pEventData);
     void DestroyActorDelegate(IEventDataPtr pEventData);
     void MoveActorDelegate(IEventDataPtr pEventData);
+    void MoveActorBatchDelegate(IEventDataPtr pEventData);
 
 protected:
     shared_ptr<SceneNode>   m_pRoot;
     shared_ptr<CameraNode>  m_pCamera;
     SDL_Renderer*           m_pRenderer;
+    unique_ptr<SpriteBatch> m_pSpriteBatch;
 
     SceneActorMap           m_ActorMap;
 
@@ -1,8 +1,11 @@
 #include "SceneNodes.h"
 #include "Scene.h"
+#include "SceneSpatialGrid.h"
 #include "../Actor/ActorComponent.h"
 #include "../Actor/Components/RenderComponent.h"
 #include "../GameApp/BaseGameApp.h"
+#include "../GameApp/BaseGameLogic.h"
+#include "../Graphics2D/SpriteBatch.h"
 
 //=================================================================================================
 // SceneNodeProperties Implementation
@@ -29,6 +32,11 @@ SceneNode::SceneNode(uint32 actorId, BaseRenderComponent* renderComponent, Rende
     m_Properties.m_RenderPass = renderPass;
     m_Properties.m_ZCoord = zCoord;
     m_pRenderComponent = renderComponent;
+    m_IndexInLayer = 0;
+    m_RenderOrder = 0;
+    m_NextChildRenderOrder = 0;
+    m_PreviousPosition = position;
+    m_LastMoveTick = 0;
 
     /*if (m_Properties.m_Width == 0 || m_Properties.m_Height == 0)
     {
@@ -41,10 +49,19 @@ SceneNode::~SceneNode()
     //LOG("Destroyed SceneNode: " + ToStr(m_Properties.GetActorId()));
 }
 
-// Idk now, SDL2 should handle everything on its own
+// Regular textures are left to SDL2, nodes only have to recreate what they rendered into render targets
 bool SceneNode::VOnLostDevice(Scene* pScene)
 {
-    return true;
+    bool success = true;
+    for (auto& layer : m_ChildrenLayers)
+    {
+        for (auto child : layer.second)
+        {
+            success &= child->VOnLostDevice(pScene);
+        }
+    }
+
+    return success;
 }
 
 void SceneNode::VOnUpdate(Scene* pScene, uint32 msDiff)
@@ -53,33 +70,34 @@ void SceneNode::VOnUpdate(Scene* pScene, uint32 msDiff)
     // that inherits from SceneNode and overloads
     // VOnUpdate()
 
-    /*SceneNodeList::iterator i = m_ChildrenList.begin();
-    SceneNodeList::iterator end = m_ChildrenList.end();
-
-    while (i != end)
+    for (auto& layer : m_ChildrenLayers)
     {
-    (*i)->VOnUpdate(pScene, msDiff);
-    ++i;
-    }*/
-
-    for (auto child : m_ChildrenList)
-    {
-        child->VOnUpdate(pScene, msDiff);
+        for (auto child : layer.second)
+        {
+            child->VOnUpdate(pScene, msDiff);
+        }
     }
 }
 
 void SceneNode::VRenderChildren(Scene* pScene)
 {
-    for (auto childNode : m_ChildrenList)
+    if (m_pSpatialIndex)
     {
-        // TODO: Huge overhead from testing visibility of every single actor each frame
-        // Possible solution: Use Box2D Broadphase to retrieve all actors within AABB
-        if (childNode->VIsVisible(pScene))
+        RenderChildrenFromSpatialIndex(pScene);
+        return;
+    }
+
+    for (auto& layer : m_ChildrenLayers)
+    {
+        for (auto childNode : layer.second)
         {
-            childNode->VPreRender(pScene);
-            childNode->VRender(pScene);
-            childNode->VRenderChildren(pScene);
-            childNode->VPostRender(pScene);
+            if (childNode->VIsVisible(pScene))
+            {
+                childNode->VPreRender(pScene);
+                childNode->VRender(pScene);
+                childNode->VRenderChildren(pScene);
+                childNode->VPostRender(pScene);
+            }
         }
     }
 }
@@ -100,56 +118,179 @@ bool SceneNode::VIsVisible(Scene* pScene) const
         return false;
     }
 
-    const SDL_Rect cameraRect = pCamera->GetCameraRect();
-    SDL_Rect actorRect = m_pRenderComponent->VGetPositionRect();
+    return IntersectsWithRect(pCamera->GetCameraRect());
+}
+
+bool SceneNode::IntersectsWithRect(const SDL_Rect& rect) const
+{
+    if (!m_pRenderComponent)
+    {
+        return false;
+    }
 
     SDL_Rect result;
     SDL_Rect position = m_pRenderComponent->VGetPositionRect();
-    if (!SDL_IntersectRect(&cameraRect, &position, &result))
+    return SDL_IntersectRect(&rect, &position, &result) == SDL_TRUE;
+}
+
+SDL_Rect SceneNode::GetPositionRect() const
+{
+    if (!m_pRenderComponent)
     {
-        return false;
+        SDL_Rect emptyRect = { 0 };
+        return emptyRect;
     }
 
-    return true;
+    return m_pRenderComponent->VGetPositionRect();
 }
 
-bool SceneNode::VAddChild(shared_ptr<ISceneNode> ikid)
+void SceneNode::VSetPosition(const Point& position)
 {
-    m_ChildrenList.push_back(ikid);
+    // Remember where this node was before the current simulation step so that it can be interpolated
+    if (BaseGameLogic* pGameLogic = g_pApp->GetGameLogic())
+    {
+        uint32 simulationTick = pGameLogic->GetSimulationTick();
+        if (simulationTick != m_LastMoveTick)
+        {
+            m_PreviousPosition = m_Properties.m_Position;
+            m_LastMoveTick = simulationTick;
+        }
+    }
+
+    m_Properties.m_Position = position;
 
+    if (m_pParent && m_pParent->m_pSpatialIndex)
+    {
+        m_pParent->m_pSpatialIndex->Move(this, position, GetPositionRect());
+    }
+}
+
+Point SceneNode::GetRenderPosition() const
+{
+    BaseGameLogic* pGameLogic = g_pApp->GetGameLogic();
+    if (!pGameLogic || pGameLogic->GetSimulationTick() != m_LastMoveTick)
+    {
+        // Did not move during last simulation step
+        return m_Properties.m_Position;
+    }
+
+    double alpha = pGameLogic->GetInterpolationAlpha();
+    return Point(
+        m_PreviousPosition.x + (m_Properties.m_Position.x - m_PreviousPosition.x) * alpha,
+        m_PreviousPosition.y + (m_Properties.m_Position.y - m_PreviousPosition.y) * alpha);
+}
+
+bool SceneNode::VAddChild(shared_ptr<ISceneNode> ikid)
+{
     shared_ptr<SceneNode> kid = static_pointer_cast<SceneNode>(ikid);
+
+    uint32 actorId = kid->m_Properties.GetActorId();
+    if (actorId != INVALID_ACTOR_ID)
+    {
+        // Only one node per actor, replaced node would otherwise never be removed
+        VRemoveChild(actorId);
+        m_ActorChildMap[actorId] = kid.get();
+    }
+
+    SceneNodeList& layer = m_ChildrenLayers[kid->m_Properties.GetZCoord()];
+    kid->m_IndexInLayer = layer.size();
+    layer.push_back(ikid);
+
     kid->m_pParent = this;
+    kid->m_RenderOrder = m_NextChildRenderOrder++;
+
+    if (m_pSpatialIndex)
+    {
+        m_pSpatialIndex->Insert(kid.get(), kid->GetPosition(), kid->GetPositionRect());
+    }
 
     return true;
 }
 
 bool SceneNode::VRemoveChild(uint32 actorId)
 {
-    for (SceneNodeList::iterator iter = m_ChildrenList.begin(); iter != m_ChildrenList.end(); ++iter)
+    if (actorId == INVALID_ACTOR_ID)
     {
-        const SceneNodeProperties* pProperties = (*iter)->VGetProperties();
-        if (pProperties->GetActorId() != INVALID_ACTOR_ID && actorId == pProperties->GetActorId())
-        {
-            iter = m_ChildrenList.erase(iter);
-            return true;
-        }
+        return false;
     }
 
-    return false;
+    auto findIt = m_ActorChildMap.find(actorId);
+    if (findIt == m_ActorChildMap.end())
+    {
+        return false;
+    }
+
+    SceneNode* pKid = findIt->second;
+    m_ActorChildMap.erase(findIt);
+
+    if (m_pSpatialIndex)
+    {
+        m_pSpatialIndex->Remove(pKid);
+    }
+
+    SceneNodeList& layer = m_ChildrenLayers[pKid->m_Properties.GetZCoord()];
+    assert(pKid->m_IndexInLayer < layer.size() && layer[pKid->m_IndexInLayer].get() == pKid);
+
+    // Keep the node alive until it is fully detached, this list may hold the last reference
+    shared_ptr<ISceneNode> pKeepAlive = layer[pKid->m_IndexInLayer];
+    pKid->m_pParent = NULL;
+
+    // Swap with last node in the layer, nodes within one layer have no defined order
+    shared_ptr<ISceneNode>& pLastNode = layer.back();
+    if (pLastNode.get() != pKid)
+    {
+        static_pointer_cast<SceneNode>(pLastNode)->m_IndexInLayer = pKid->m_IndexInLayer;
+        layer[pKid->m_IndexInLayer] = pLastNode;
+    }
+    layer.pop_back();
+
+    return true;
 }
 
-void SceneNode::SortChildrenByZCoord()
+void SceneNode::EnableSpatialIndex(int32 cellSize)
 {
-    for (auto pChildNode : m_ChildrenList)
+    assert(m_ChildrenLayers.empty() && "Spatial index has to be enabled before adding any children");
+
+    m_pSpatialIndex.reset(new SceneSpatialGrid(cellSize));
+}
+
+void SceneNode::RenderChildrenFromSpatialIndex(Scene* pScene)
+{
+    shared_ptr<CameraNode> pCamera = pScene->GetCamera();
+    if (!pCamera)
     {
-        pChildNode->SortChildrenByZCoord();
+        LOG_ERROR("Rendering children without available scene camera");
+        return;
     }
 
-    std::sort(m_ChildrenList.begin(), m_ChildrenList.end(), 
-        [](const shared_ptr<ISceneNode>& lhs, const shared_ptr<ISceneNode>& rhs)
+    const SDL_Rect cameraRect = pCamera->GetCameraRect();
+
+    m_VisibleCandidates.clear();
+    m_pSpatialIndex->Query(cameraRect, m_VisibleCandidates);
+
+    std::sort(m_VisibleCandidates.begin(), m_VisibleCandidates.end(),
+        [](const ISceneNode* lhs, const ISceneNode* rhs)
     {
-        return lhs->GetZCoord() < rhs->GetZCoord();
+        const SceneNode* pLhs = static_cast<const SceneNode*>(lhs);
+        const SceneNode* pRhs = static_cast<const SceneNode*>(rhs);
+        if (pLhs->m_Properties.m_ZCoord != pRhs->m_Properties.m_ZCoord)
+        {
+            return pLhs->m_Properties.m_ZCoord < pRhs->m_Properties.m_ZCoord;
+        }
+
+        return pLhs->m_RenderOrder < pRhs->m_RenderOrder;
     });
+
+    for (ISceneNode* pChildNode : m_VisibleCandidates)
+    {
+        if (static_cast<SceneNode*>(pChildNode)->IntersectsWithRect(cameraRect))
+        {
+            pChildNode->VPreRender(pScene);
+            pChildNode->VRender(pScene);
+            pChildNode->VRenderChildren(pScene);
+            pChildNode->VPostRender(pScene);
+        }
+    }
 }
 
 //=================================================================================================
@@ -158,58 +299,55 @@ void SceneNode::SortChildrenByZCoord()
 
 RootNode::RootNode() : SceneNode(INVALID_ACTOR_ID, NULL, RenderPass_0, { 0, 0 })
 {
-    m_ChildrenList.reserve(RenderPass_Last);
-
-    shared_ptr<SceneNode> backgroundGroup(new SceneNode(INVALID_ACTOR_ID, NULL, RenderPass_Background, { 0, 0 }));
-    m_ChildrenList.push_back(backgroundGroup);
-
-    shared_ptr<SceneNode> actionGroup(new SceneNode(INVALID_ACTOR_ID, NULL, RenderPass_Action, { 0, 0 }));
-    m_ChildrenList.push_back(actionGroup);
+    m_RenderPassGroups[RenderPass_Background].reset(new SceneNode(INVALID_ACTOR_ID, NULL, RenderPass_Background, { 0, 0 }));
+    m_RenderPassGroups[RenderPass_Action].reset(new SceneNode(INVALID_ACTOR_ID, NULL, RenderPass_Action, { 0, 0 }));
 
-    shared_ptr<SceneNode> actorGroup(new SceneNode(INVALID_ACTOR_ID, NULL, RenderPass_Actor, { 0, 0 }));
-    m_ChildrenList.push_back(actorGroup);
+    // Levels have thousands of actors but only handful of them is on screen at once
+    m_RenderPassGroups[RenderPass_Actor].reset(new SceneNode(INVALID_ACTOR_ID, NULL, RenderPass_Actor, { 0, 0 }));
+    m_RenderPassGroups[RenderPass_Actor]->EnableSpatialIndex(512);
 
-    shared_ptr<SceneNode> foregroundGroup(new SceneNode(INVALID_ACTOR_ID, NULL, RenderPass_Foreground, { 0, 0 }));
-    m_ChildrenList.push_back(foregroundGroup);
+    m_RenderPassGroups[RenderPass_Foreground].reset(new SceneNode(INVALID_ACTOR_ID, NULL, RenderPass_Foreground, { 0, 0 }));
+    m_RenderPassGroups[RenderPass_HUD].reset(new SceneNode(INVALID_ACTOR_ID, NULL, RenderPass_HUD, { 0, 0 }));
+    m_RenderPassGroups[RenderPass_NotRendered].reset(new SceneNode(INVALID_ACTOR_ID, NULL, RenderPass_NotRendered, { 0, 0 }));
 
-    shared_ptr<SceneNode> HUDGroup(new SceneNode(INVALID_ACTOR_ID, NULL, RenderPass_HUD, { 0, 0 }));
-    m_ChildrenList.push_back(HUDGroup); 
-
-    shared_ptr<SceneNode> invisibleGroup(new SceneNode(INVALID_ACTOR_ID, NULL, RenderPass_NotRendered, { 0, 0 }));
-    m_ChildrenList.push_back(invisibleGroup);
+    for (uint16 pass = RenderPass_0; pass < RenderPass_Last; ++pass)
+    {
+        SceneNode::VAddChild(m_RenderPassGroups[pass]);
+    }
 }
 
 bool RootNode::VAddChild(shared_ptr<ISceneNode> kid)
 {
     RenderPass pass = kid->VGetProperties()->GetRenderPass();
-    if ((uint16)pass >= m_ChildrenList.size() || !m_ChildrenList[pass])
+    if ((uint16)pass >= RenderPass_Last || !m_RenderPassGroups[pass])
     {
         assert(0 && "There is not such render pass");
         return false;
     }
 
     //LOG("Adding child to render pass: " + ToStr(pass));
-    m_ChildrenList[pass]->VAddChild(kid);
+    m_RenderPassGroups[pass]->VAddChild(kid);
     return true;
 }
 
 bool RootNode::VRemoveChild(uint32 actorId)
 {
-    bool anythingRemoved = false;
+    // Actor's node lives in exactly one render pass and each pass finds it in O(1)
     for (uint16 pass = RenderPass_0; pass < RenderPass_Last; ++pass)
     {
-        if (m_ChildrenList[pass]->VRemoveChild(actorId))
+        if (m_RenderPassGroups[pass]->VRemoveChild(actorId))
         {
-            anythingRemoved = true;
+            return true;
         }
     }
 
-    return anythingRemoved;
+    return false;
 }
 
 
 void RootNode::VRenderChildren(Scene* pScene)
 {
+    SpriteBatch* pSpriteBatch = pScene->GetSpriteBatch();
     for (uint16 pass = RenderPass_0; pass < RenderPass_Last; ++pass)
     {
         switch (pass)
@@ -217,15 +355,22 @@ void RootNode::VRenderChildren(Scene* pScene)
             case RenderPass_Background:
             case RenderPass_Action:
             case RenderPass_Foreground:
-                m_ChildrenList[pass]->VRenderChildren(pScene);
+                // Each of these passes holds one tile plane whose tiles never overlap
+                pSpriteBatch->Begin(SpriteSortMode_Disjoint);
+                m_RenderPassGroups[pass]->VRenderChildren(pScene);
+                pSpriteBatch->Flush();
                 break;
 
             case RenderPass_Actor:
-                m_ChildrenList[pass]->VRenderChildren(pScene);
+                pSpriteBatch->Begin(SpriteSortMode_PreserveOverlaps);
+                m_RenderPassGroups[pass]->VRenderChildren(pScene);
+                pSpriteBatch->Flush();
                 break;
 
             case RenderPass_HUD:
-                m_ChildrenList[pass]->VRenderChildren(pScene);
+                pSpriteBatch->Begin(SpriteSortMode_PreserveOverlaps);
+                m_RenderPassGroups[pass]->VRenderChildren(pScene);
+                pSpriteBatch->Flush();
                 break;
         }
     }
@@ -261,7 +406,7 @@ void CameraNode::SetViewPosition(Scene* pScene)
     // If there is a target, make sure target is in the center of the camera
     if (m_pTarget)
     {
-        Point targetPos = m_pTarget->VGetProperties()->GetPosition();
+        Point targetPos = m_pTarget->GetRenderPosition();
         // Center camera
         Point scale = g_pApp->GetScale();
         Point cameraPos = targetPos - Point((m_Width / 2) / scale.x, (m_Height / 2) / scale.y);
@@ -17,6 +17,7 @@ enum RenderPass
 
 // Forward declarations
 class SceneNode;
+class SceneSpatialGrid;
 class Scene;
 class MovementController;
 class BaseRenderComponent;
@@ -42,7 +43,6 @@ public:
     virtual bool VRemoveChild(uint32 actorId) = 0;
     virtual bool VOnLostDevice(Scene* pScene) = 0;
 
-    virtual void SortChildrenByZCoord() = 0;
     virtual int32 GetZCoord() const = 0;
 };
 
@@ -71,6 +71,9 @@ protected:
 
 typedef std::vector <shared_ptr<ISceneNode>> SceneNodeList;
 
+// Children of scene node bucketed by their Z coordinate, std::map keeps the buckets in render order
+typedef std::map<int32, SceneNodeList> SceneNodeZLayerMap;
+
 class SceneNode : public ISceneNode
 {
 public:
@@ -92,20 +95,46 @@ public:
     virtual bool VRemoveChild(uint32 actorId);
     virtual bool VOnLostDevice(Scene* pScene);
 
-    virtual void VSetPosition(const Point& position) { m_Properties.m_Position = position; }
+    virtual void VSetPosition(const Point& position);
     Point GetPosition() { return m_Properties.m_Position; }
 
+    // Position interpolated between last two simulation steps, same as GetPosition() with variable timestep
+    Point GetRenderPosition() const;
+
     int32 GetOrientation() const { return m_Properties.m_Orientation; }
 
     virtual int32 GetZCoord() const { return m_Properties.m_ZCoord; }
 
-    virtual void SortChildrenByZCoord();
+    // Children of this node will be kept in spatial grid and only those near camera
+    // will be tested for visibility when rendering. Has to be called before any child is added.
+    void EnableSpatialIndex(int32 cellSize);
 
 protected:
-    SceneNodeList           m_ChildrenList;
+    bool IntersectsWithRect(const SDL_Rect& rect) const;
+    SDL_Rect GetPositionRect() const;
+
+    SceneNodeZLayerMap      m_ChildrenLayers;
     SceneNode*              m_pParent;
     SceneNodeProperties     m_Properties;
     BaseRenderComponent*    m_pRenderComponent;
+
+    // Position of this node within its Z layer in parent's m_ChildrenLayers
+    uint32                  m_IndexInLayer;
+
+    // Order in which this node was added to its parent, breaks ties between nodes with same Z coord
+    uint32                  m_RenderOrder;
+
+    // Position before the simulation step in which this node last moved
+    Point                   m_PreviousPosition;
+    uint32                  m_LastMoveTick;
+
+private:
+    void RenderChildrenFromSpatialIndex(Scene* pScene);
+
+    std::unordered_map<uint32, SceneNode*> m_ActorChildMap;
+    shared_ptr<SceneSpatialGrid> m_pSpatialIndex;
+    uint32 m_NextChildRenderOrder;
+    std::vector<ISceneNode*> m_VisibleCandidates;
 };
 
 typedef std::map<uint32, shared_ptr<ISceneNode>> SceneActorMap;
@@ -118,6 +147,9 @@ public:
     virtual void VRenderChildren(Scene* pScene);
     virtual bool VRemoveChild(uint32 actorId);
     virtual bool VIsVisible(Scene* pScene) { return true; }
+
+private:
+    shared_ptr<SceneNode> m_RenderPassGroups[RenderPass_Last];
 };
 
 class CameraNode : public SceneNode
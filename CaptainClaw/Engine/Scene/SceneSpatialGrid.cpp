@@ -0,0 +1,142 @@
+#include "SceneSpatialGrid.h"
+#include "SceneNodes.h"
+
+//=================================================================================================
+// SceneSpatialGrid Implementation
+//
+
+SceneSpatialGrid::SceneSpatialGrid(int32 cellSize)
+    :
+    m_CellSize(cellSize),
+    m_MaxExtent(cellSize)
+{
+    assert(cellSize > 0);
+}
+
+void SceneSpatialGrid::Insert(ISceneNode* pNode, const Point& position, const SDL_Rect& positionRect)
+{
+    if (m_NodeLocationMap.count(pNode) > 0)
+    {
+        Move(pNode, position, positionRect);
+        return;
+    }
+
+    GrowExtent(position, positionRect);
+
+    int64 cellKey = MakeCellKey(GetCellCoord(position.x), GetCellCoord(position.y));
+    CellNodeList& cell = m_CellMap[cellKey];
+
+    NodeLocation location;
+    location.cellKey = cellKey;
+    location.indexInCell = cell.size();
+    cell.push_back(pNode);
+
+    m_NodeLocationMap.insert(std::make_pair(pNode, location));
+}
+
+void SceneSpatialGrid::Move(ISceneNode* pNode, const Point& position, const SDL_Rect& positionRect)
+{
+    NodeLocationMap::iterator findIt = m_NodeLocationMap.find(pNode);
+    if (findIt == m_NodeLocationMap.end())
+    {
+        return;
+    }
+
+    GrowExtent(position, positionRect);
+
+    int64 cellKey = MakeCellKey(GetCellCoord(position.x), GetCellCoord(position.y));
+    if (cellKey == findIt->second.cellKey)
+    {
+        return;
+    }
+
+    RemoveFromCell(findIt->second);
+
+    CellNodeList& cell = m_CellMap[cellKey];
+    findIt->second.cellKey = cellKey;
+    findIt->second.indexInCell = cell.size();
+    cell.push_back(pNode);
+}
+
+void SceneSpatialGrid::Remove(ISceneNode* pNode)
+{
+    NodeLocationMap::iterator findIt = m_NodeLocationMap.find(pNode);
+    if (findIt == m_NodeLocationMap.end())
+    {
+        return;
+    }
+
+    RemoveFromCell(findIt->second);
+    m_NodeLocationMap.erase(findIt);
+}
+
+void SceneSpatialGrid::Clear()
+{
+    m_CellMap.clear();
+    m_NodeLocationMap.clear();
+    m_MaxExtent = m_CellSize;
+}
+
+void SceneSpatialGrid::Query(const SDL_Rect& rect, std::vector<ISceneNode*>& outNodes) const
+{
+    const int32 fromCellX = GetCellCoord(rect.x - m_MaxExtent);
+    const int32 fromCellY = GetCellCoord(rect.y - m_MaxExtent);
+    const int32 toCellX = GetCellCoord(rect.x + rect.w + m_MaxExtent);
+    const int32 toCellY = GetCellCoord(rect.y + rect.h + m_MaxExtent);
+
+    for (int32 cellX = fromCellX; cellX <= toCellX; ++cellX)
+    {
+        for (int32 cellY = fromCellY; cellY <= toCellY; ++cellY)
+        {
+            CellMap::const_iterator cellIt = m_CellMap.find(MakeCellKey(cellX, cellY));
+            if (cellIt != m_CellMap.end())
+            {
+                outNodes.insert(outNodes.end(), cellIt->second.begin(), cellIt->second.end());
+            }
+        }
+    }
+}
+
+void SceneSpatialGrid::GrowExtent(const Point& position, const SDL_Rect& positionRect)
+{
+    if (positionRect.w <= 0 || positionRect.h <= 0)
+    {
+        return;
+    }
+
+    const int32 posX = (int32)position.x;
+    const int32 posY = (int32)position.y;
+
+    int32 extent = abs(positionRect.x - posX);
+    extent = max(extent, abs(positionRect.x + positionRect.w - posX));
+    extent = max(extent, abs(positionRect.y - posY));
+    extent = max(extent, abs(positionRect.y + positionRect.h - posY));
+
+    if (extent > m_MaxExtent)
+    {
+        m_MaxExtent = extent;
+    }
+}
+
+void SceneSpatialGrid::RemoveFromCell(const NodeLocation& location)
+{
+    CellMap::iterator cellIt = m_CellMap.find(location.cellKey);
+    assert(cellIt != m_CellMap.end());
+
+    CellNodeList& cell = cellIt->second;
+    assert(location.indexInCell < cell.size());
+
+    // Swap with last node in the cell so that removal is O(1)
+    ISceneNode* pLastNode = cell.back();
+    if (pLastNode != cell[location.indexInCell])
+    {
+        cell[location.indexInCell] = pLastNode;
+        m_NodeLocationMap[pLastNode].indexInCell = location.indexInCell;
+    }
+    cell.pop_back();
+
+    if (cell.empty())
+    {
+        m_CellMap.erase(cellIt);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef __SCENE_SPATIAL_GRID_H__
+#define __SCENE_SPATIAL_GRID_H__
+
+#include "../SharedDefines.h"
+
+class ISceneNode;
+
+//=================================================================================================
+// class SceneSpatialGrid
+//
+//     Loose uniform grid of scene nodes. Every node is stored in exactly one cell - the one its
+//     position falls into - so that moving a node is O(1). Node rects can stick out of their cell,
+//     the largest seen distance between node position and its rect edge is remembered and every
+//     query rect is inflated by it. Query therefore returns superset of nodes which overlap
+//     given rect, exact test is left to the caller.
+//
+//=================================================================================================
+
+class SceneSpatialGrid
+{
+public:
+    SceneSpatialGrid(int32 cellSize = 512);
+
+    // positionRect is used only to track how far node rects can reach from their position
+    void Insert(ISceneNode* pNode, const Point& position, const SDL_Rect& positionRect);
+    void Move(ISceneNode* pNode, const Point& position, const SDL_Rect& positionRect);
+    void Remove(ISceneNode* pNode);
+    void Clear();
+
+    // Appends nodes whose cells overlap given world rect to outNodes
+    void Query(const SDL_Rect& rect, std::vector<ISceneNode*>& outNodes) const;
+
+    uint32 GetCount() const { return m_NodeLocationMap.size(); }
+
+private:
+    struct NodeLocation
+    {
+        int64 cellKey;
+        uint32 indexInCell;
+    };
+
+    typedef std::vector<ISceneNode*> CellNodeList;
+    typedef std::unordered_map<int64, CellNodeList> CellMap;
+    typedef std::unordered_map<ISceneNode*, NodeLocation> NodeLocationMap;
+
+    int32 GetCellCoord(double worldCoord) const { return (int32)std::floor(worldCoord / m_CellSize); }
+    static int64 MakeCellKey(int32 cellX, int32 cellY) { return (int64)(((uint64)(uint32)cellX << 32) | (uint32)cellY); }
+
+    void GrowExtent(const Point& position, const SDL_Rect& positionRect);
+    void RemoveFromCell(const NodeLocation& location);
+
+    int32 m_CellSize;
+    int32 m_MaxExtent;
+
+    CellMap m_CellMap;
+    NodeLocationMap m_NodeLocationMap;
+};
+
+#endif
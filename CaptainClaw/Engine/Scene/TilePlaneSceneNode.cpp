@@ -3,20 +3,55 @@
 #include "TilePlaneSceneNode.h"
 #include "../Actor/Components/RenderComponent.h"
 #include "../Graphics2D/Image.h"
+#include "../Graphics2D/SpriteBatch.h"
+#include "../Graphics2D/TextureResidencyManager.h"
 #include "../GameApp/BaseGameApp.h"
 
+// Approximate size of one prerendered chunk, it always holds whole tiles
+const int32 TILE_CHUNK_PIXEL_SIZE = 512;
+// How many chunks are kept compared to how many are needed to cover the screen
+const uint32 TILE_CHUNK_BUDGET_FACTOR = 2;
+
+// Rounds towards negative infinity so that planes can be wrapped on the negative side too
+static int32 FloorDiv(int32 value, int32 divisor)
+{
+    int32 result = value / divisor;
+    if ((value % divisor != 0) && ((value < 0) != (divisor < 0)))
+    {
+        result--;
+    }
+
+    return result;
+}
+
+static int32 PositiveModulo(int32 value, int32 divisor)
+{
+    int32 result = value % divisor;
+    return result < 0 ? result + divisor : result;
+}
+
 SDL2TilePlaneSceneNode::SDL2TilePlaneSceneNode(const uint32 actorId,
     BaseRenderComponent* pRenderComponent,
     RenderPass renderPass,
     Point position)
-    : SceneNode(actorId, pRenderComponent, renderPass, position)
+    : SceneNode(actorId, pRenderComponent, renderPass, position),
+    m_FrameIdx(0),
+    m_UseChunks(true)
 {
 
 }
 
 SDL2TilePlaneSceneNode::~SDL2TilePlaneSceneNode()
 {
+    ClearChunks();
+}
+
+bool SDL2TilePlaneSceneNode::VOnLostDevice(Scene* pScene)
+{
+    // Chunks are prerendered again as they come into view
+    ClearChunks();
 
+    return SceneNode::VOnLostDevice(pScene);
 }
 
 void SDL2TilePlaneSceneNode::VRender(Scene* pScene)
@@ -24,79 +59,368 @@ void SDL2TilePlaneSceneNode::VRender(Scene* pScene)
     TilePlaneRenderComponent* pRenderComponent = static_cast<TilePlaneRenderComponent*>(m_pRenderComponent);
 
     const TilePlaneProperties* pProperties = pRenderComponent->GetTilePlaneProperties();
-    const TileImageList* pImageList = pRenderComponent->GetTileImageList();
+    if (pProperties->tilePixelWidth <= 0 || pProperties->tilePixelHeight <= 0 ||
+        pProperties->tilesOnAxisX <= 0 || pProperties->tilesOnAxisY <= 0)
+    {
+        return;
+    }
 
     shared_ptr<CameraNode> camera = pScene->GetCamera();
     SDL_Renderer* renderer = pScene->GetRenderer();
 
-    // Multiple times user variables
-    int32 tilePixelWidth = pProperties->tilePixelWidth;
-    int32 tilePixelHeight = pProperties->tilePixelHeight;
-
-    // TODO: Optimize so that we dont render anything which is not seen
-    // (older commit was better ?)
-    int32_t numTilesPadding = 2;
-
     Point scale = g_pApp->GetScale();
 
     float movementRatioX = pProperties->movementPercentX / 100.0f;
     float movementRatioY = pProperties->movementPercentY / 100.0f;
 
-    int32_t parallaxCameraPosX = (int32_t)(camera->GetPosition().x * movementRatioX);
-    int32_t parallaxCameraPosY = (int32_t)(camera->GetPosition().y * movementRatioY);
+    // Part of the plane which is seen by the camera, in plane's pixels
+    SDL_Rect planeViewRect =
+    {
+        (int32)std::floor(camera->GetPosition().x * movementRatioX),
+        (int32)std::floor(camera->GetPosition().y * movementRatioY),
+        (int32)std::ceil(camera->GetWidth() / scale.x),
+        (int32)std::ceil(camera->GetHeight() / scale.y)
+    };
 
-    int32_t startCol = (parallaxCameraPosX / tilePixelWidth) - numTilesPadding;
-    int32_t startRow = parallaxCameraPosY / tilePixelHeight - numTilesPadding;
+    m_FrameIdx++;
 
-    int32_t colTilesToRender = (uint32_t)((camera->GetWidth() / tilePixelWidth) / scale.x) +
-        3 * numTilesPadding;
+    SpriteBatch* pSpriteBatch = pScene->GetSpriteBatch();
+    if (m_UseChunks && SDL_RenderTargetSupported(renderer))
+    {
+        if (RenderChunks(renderer, pSpriteBatch, planeViewRect))
+        {
+            return;
+        }
+
+        LOG_WARNING("Could not prerender tiles of plane: " + pProperties->name + ". Tiles will be rendered one by one");
+        m_UseChunks = false;
+        ClearChunks();
+    }
+
+    RenderTiles(pSpriteBatch, planeViewRect);
+}
 
-    int32_t rowTilesToRender = (uint32_t)((camera->GetHeight() / tilePixelHeight) / scale.y) +
-        3 * numTilesPadding;
+shared_ptr<Image> SDL2TilePlaneSceneNode::GetTileImage(int32 col, int32 row) const
+{
+    TilePlaneRenderComponent* pRenderComponent = static_cast<TilePlaneRenderComponent*>(m_pRenderComponent);
+
+    const TilePlaneProperties* pProperties = pRenderComponent->GetTilePlaneProperties();
+    const TileImageList* pImageList = pRenderComponent->GetTileImageList();
 
     // Some planes (Back, Front) repeat themselves, which means they can be rendered
     // even when out of bounds
-    int32_t maxTileIdxX = pProperties->tilesOnAxisX;
-    int32_t maxTileIdxY = pProperties->tilesOnAxisY;
-    int32_t minTileIdxX = 0;
-    int32_t minTileIdxY = 0;
-    // TODO: Wrap even when when out of bounds on the negative side
     if (pProperties->isWrappedX)
     {
-        maxTileIdxX = INT32_MAX;
-        minTileIdxX = 0;
+        col = PositiveModulo(col, pProperties->tilesOnAxisX);
     }
     if (pProperties->isWrappedY)
     {
-        maxTileIdxY = INT32_MAX;
-        minTileIdxY = 0;
+        row = PositiveModulo(row, pProperties->tilesOnAxisY);
     }
 
-    int32_t row, col;
-    for (row = startRow; row < (startRow + rowTilesToRender); row++)
+    if (col < 0 || col >= pProperties->tilesOnAxisX ||
+        row < 0 || row >= pProperties->tilesOnAxisY)
     {
-        for (col = startCol; col < (startCol + colTilesToRender); col++)
+        return NULL;
+    }
+
+    uint32 tileIdx = row * pProperties->tilesOnAxisX + col;
+    if (tileIdx >= pImageList->size())
+    {
+        return nullptr;
+    }
+
+    const shared_ptr<Image>& pImage = (*pImageList)[tileIdx];
+    if (!pImage || pImage->GetTexture() == NULL)
+    {
+        return nullptr;
+    }
+
+    return pImage;
+}
+
+void SDL2TilePlaneSceneNode::RenderTiles(SpriteBatch* pSpriteBatch, const SDL_Rect& planeViewRect)
+{
+    TilePlaneRenderComponent* pRenderComponent = static_cast<TilePlaneRenderComponent*>(m_pRenderComponent);
+    const TilePlaneProperties* pProperties = pRenderComponent->GetTilePlaneProperties();
+
+    int32 tilePixelWidth = pProperties->tilePixelWidth;
+    int32 tilePixelHeight = pProperties->tilePixelHeight;
+
+    int32 startCol = FloorDiv(planeViewRect.x, tilePixelWidth);
+    int32 startRow = FloorDiv(planeViewRect.y, tilePixelHeight);
+    int32 endCol = FloorDiv(planeViewRect.x + planeViewRect.w - 1, tilePixelWidth);
+    int32 endRow = FloorDiv(planeViewRect.y + planeViewRect.h - 1, tilePixelHeight);
+
+    for (int32 row = startRow; row <= endRow; row++)
+    {
+        for (int32 col = startCol; col <= endCol; col++)
+        {
+            shared_ptr<Image> image = GetTileImage(col, row);
+            if (image)
+            {
+                SDL_Rect tileRect = { col * tilePixelWidth - planeViewRect.x,
+                    row * tilePixelHeight - planeViewRect.y,
+                    tilePixelWidth,
+                    tilePixelHeight };
+
+                pSpriteBatch->Draw(image->GetTexture(), image->GetSourceRect(), tileRect);
+            }
+        }
+    }
+}
+
+bool SDL2TilePlaneSceneNode::RenderChunks(SDL_Renderer* pRenderer, SpriteBatch* pSpriteBatch, const SDL_Rect& planeViewRect)
+{
+    TilePlaneRenderComponent* pRenderComponent = static_cast<TilePlaneRenderComponent*>(m_pRenderComponent);
+    const TilePlaneProperties* pProperties = pRenderComponent->GetTilePlaneProperties();
+
+    int32 chunkPixelWidth = max(1, TILE_CHUNK_PIXEL_SIZE / pProperties->tilePixelWidth) * pProperties->tilePixelWidth;
+    int32 chunkPixelHeight = max(1, TILE_CHUNK_PIXEL_SIZE / pProperties->tilePixelHeight) * pProperties->tilePixelHeight;
+
+    int32 startChunkX = FloorDiv(planeViewRect.x, chunkPixelWidth);
+    int32 startChunkY = FloorDiv(planeViewRect.y, chunkPixelHeight);
+    int32 endChunkX = FloorDiv(planeViewRect.x + planeViewRect.w - 1, chunkPixelWidth);
+    int32 endChunkY = FloorDiv(planeViewRect.y + planeViewRect.h - 1, chunkPixelHeight);
+
+    // Chunks which are about to be seen are built ahead, one per frame so that scrolling does not
+    // stutter. Everything is built before anything is drawn so that nothing is queued on failure
+    bool hasPrefetchedChunk = false;
+    for (int32 chunkY = startChunkY - 1; chunkY <= endChunkY + 1; chunkY++)
+    {
+        for (int32 chunkX = startChunkX - 1; chunkX <= endChunkX + 1; chunkX++)
         {
-            // Dont render anything out of bounds
-            if ((col < minTileIdxX) || (col > maxTileIdxX) ||
-                (row < minTileIdxY) || (row > maxTileIdxY))
+            auto findIt = m_Chunks.find(std::make_pair(chunkX, chunkY));
+            if (findIt != m_Chunks.end())
             {
+                findIt->second.lastUsedFrame = m_FrameIdx;
                 continue;
             }
 
-            int32_t x = (col - startCol - numTilesPadding) * tilePixelWidth;
-            int32_t y = (row - startRow - numTilesPadding) * tilePixelHeight;
-            Image* image = (*pImageList)[(row % pProperties->tilesOnAxisY) * pProperties->tilesOnAxisX + (col % pProperties->tilesOnAxisX)];
+            bool isVisible = chunkX >= startChunkX && chunkX <= endChunkX &&
+                             chunkY >= startChunkY && chunkY <= endChunkY;
+            if (!isVisible)
+            {
+                if (hasPrefetchedChunk)
+                {
+                    continue;
+                }
+                hasPrefetchedChunk = true;
+            }
+
+            TileChunk chunk;
+            if (!CreateChunk(pRenderer, chunkX, chunkY, chunk))
+            {
+                return false;
+            }
+
+            m_Chunks.insert(std::make_pair(std::make_pair(chunkX, chunkY), chunk));
+        }
+    }
+
+    for (int32 chunkY = startChunkY; chunkY <= endChunkY; chunkY++)
+    {
+        for (int32 chunkX = startChunkX; chunkX <= endChunkX; chunkX++)
+        {
+            const TileChunk& chunk = m_Chunks[std::make_pair(chunkX, chunkY)];
+            if (chunk.pTexture)
+            {
+                SDL_Rect chunkRect = { chunkX * chunkPixelWidth - planeViewRect.x,
+                    chunkY * chunkPixelHeight - planeViewRect.y,
+                    chunk.width,
+                    chunk.height };
+
+                pSpriteBatch->Draw(chunk.pTexture.get(), NULL, chunkRect);
+            }
+        }
+    }
+
+    // Tiles of visible chunks stay resident so that their neighbours can be built without reloading them
+    for (auto& chunkIter : m_Chunks)
+    {
+        bool isVisible = chunkIter.first.first >= startChunkX && chunkIter.first.first <= endChunkX &&
+                         chunkIter.first.second >= startChunkY && chunkIter.first.second <= endChunkY;
+        SetChunkPinned(chunkIter.second, isVisible);
+    }
+
+    uint32 neededChunks = (endChunkX - startChunkX + 3) * (endChunkY - startChunkY + 3);
+    EvictChunks(neededChunks * TILE_CHUNK_BUDGET_FACTOR);
+
+    return true;
+}
+
+bool SDL2TilePlaneSceneNode::CreateChunk(SDL_Renderer* pRenderer, int32 chunkX, int32 chunkY, TileChunk& outChunk)
+{
+    TilePlaneRenderComponent* pRenderComponent = static_cast<TilePlaneRenderComponent*>(m_pRenderComponent);
+    const TilePlaneProperties* pProperties = pRenderComponent->GetTilePlaneProperties();
+
+    int32 tilePixelWidth = pProperties->tilePixelWidth;
+    int32 tilePixelHeight = pProperties->tilePixelHeight;
+    int32 chunkTilesX = max(1, TILE_CHUNK_PIXEL_SIZE / tilePixelWidth);
+    int32 chunkTilesY = max(1, TILE_CHUNK_PIXEL_SIZE / tilePixelHeight);
+
+    int32 startCol = chunkX * chunkTilesX;
+    int32 startRow = chunkY * chunkTilesY;
+
+    // Chunks on the edge of not wrapped plane only cover what is left of it
+    int32 colsCount = chunkTilesX;
+    int32 rowsCount = chunkTilesY;
+    if (!pProperties->isWrappedX)
+    {
+        colsCount = std::min(colsCount, pProperties->tilesOnAxisX - startCol);
+    }
+    if (!pProperties->isWrappedY)
+    {
+        rowsCount = std::min(rowsCount, pProperties->tilesOnAxisY - startRow);
+    }
+
+    outChunk.pTexture.reset();
+    outChunk.width = colsCount * tilePixelWidth;
+    outChunk.height = rowsCount * tilePixelHeight;
+    outChunk.lastUsedFrame = m_FrameIdx;
+    outChunk.tileImages.clear();
+    outChunk.isPinned = false;
+
+    for (int32 row = startRow; row < startRow + rowsCount; row++)
+    {
+        for (int32 col = startCol; col < startCol + colsCount; col++)
+        {
+            shared_ptr<Image> image = GetTileImage(col, row);
+            if (image && std::find(outChunk.tileImages.begin(), outChunk.tileImages.end(), image) == outChunk.tileImages.end())
+            {
+                outChunk.tileImages.push_back(image);
+            }
+        }
+    }
+
+    if (outChunk.tileImages.empty())
+    {
+        return true;
+    }
+
+    SDL_Texture* pTexture = SDL_CreateTexture(pRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET,
+        outChunk.width, outChunk.height);
+    if (pTexture == NULL)
+    {
+        LOG_ERROR("Failed to create tile chunk texture: " + std::string(SDL_GetError()));
+        return false;
+    }
+
+    // Chunks count towards video memory budget, so that tile images get evicted sooner
+    uint32 textureSize = outChunk.width * outChunk.height * 4;
+    if (TextureResidencyManager* pResidencyMgr = TextureResidencyManager::Get())
+    {
+        pResidencyMgr->OnRenderTargetCreated(textureSize);
+    }
+
+    outChunk.pTexture.reset(pTexture, [textureSize](SDL_Texture* pChunkTexture)
+    {
+        if (TextureResidencyManager* pResidencyMgr = TextureResidencyManager::Get())
+        {
+            pResidencyMgr->OnRenderTargetDestroyed(textureSize);
+        }
+        SDL_DestroyTexture(pChunkTexture);
+    });
+    SDL_SetTextureBlendMode(pTexture, SDL_BLENDMODE_BLEND);
+
+    SDL_Texture* pPreviousTarget = SDL_GetRenderTarget(pRenderer);
+    if (SDL_SetRenderTarget(pRenderer, pTexture) != 0)
+    {
+        LOG_ERROR("Failed to render into tile chunk texture: " + std::string(SDL_GetError()));
+        return false;
+    }
 
-            if (image && image->GetTexture() != NULL)
+    Uint8 r, g, b, a;
+    SDL_GetRenderDrawColor(pRenderer, &r, &g, &b, &a);
+    SDL_SetRenderDrawColor(pRenderer, 0, 0, 0, 0);
+    SDL_RenderClear(pRenderer);
+    SDL_SetRenderDrawColor(pRenderer, r, g, b, a);
+
+    for (int32 row = startRow; row < startRow + rowsCount; row++)
+    {
+        for (int32 col = startCol; col < startCol + colsCount; col++)
+        {
+            shared_ptr<Image> image = GetTileImage(col, row);
+            if (image)
             {
-                SDL_Rect tileRect = { x - (parallaxCameraPosX % tilePixelWidth),
-                    y - (parallaxCameraPosY % tilePixelHeight),
+                SDL_Rect tileRect = { (col - startCol) * tilePixelWidth,
+                    (row - startRow) * tilePixelHeight,
                     tilePixelWidth,
                     tilePixelHeight };
 
-                SDL_RenderCopy(renderer, image->GetTexture(), NULL, &tileRect);
+                SDL_RenderCopy(pRenderer, image->GetTexture(), image->GetSourceRect(), &tileRect);
             }
         }
     }
+
+    SDL_SetRenderTarget(pRenderer, pPreviousTarget);
+
+    return true;
+}
+
+void SDL2TilePlaneSceneNode::EvictChunks(uint32 maxChunks)
+{
+    if (m_Chunks.size() <= maxChunks)
+    {
+        return;
+    }
+
+    // Least recently used chunks go first, chunks used this frame are never evicted
+    std::vector<std::pair<uint32, TileChunkMap::iterator>> candidates;
+    for (auto iter = m_Chunks.begin(); iter != m_Chunks.end(); ++iter)
+    {
+        if (iter->second.lastUsedFrame != m_FrameIdx)
+        {
+            candidates.push_back(std::make_pair(iter->second.lastUsedFrame, iter));
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(),
+        [](const std::pair<uint32, TileChunkMap::iterator>& lhs, const std::pair<uint32, TileChunkMap::iterator>& rhs)
+    {
+        return lhs.first < rhs.first;
+    });
+
+    for (auto& candidate : candidates)
+    {
+        if (m_Chunks.size() <= maxChunks)
+        {
+            break;
+        }
+
+        SetChunkPinned(candidate.second->second, false);
+        m_Chunks.erase(candidate.second);
+    }
+}
+
+void SDL2TilePlaneSceneNode::SetChunkPinned(TileChunk& chunk, bool pinned)
+{
+    if (chunk.isPinned == pinned)
+    {
+        return;
+    }
+
+    for (shared_ptr<Image>& pImage : chunk.tileImages)
+    {
+        if (pinned)
+        {
+            pImage->Pin();
+        }
+        else
+        {
+            pImage->Unpin();
+        }
+    }
+
+    chunk.isPinned = pinned;
+}
+
+void SDL2TilePlaneSceneNode::ClearChunks()
+{
+    for (auto& chunkIter : m_Chunks)
+    {
+        SetChunkPinned(chunkIter.second, false);
+    }
+
+    m_Chunks.clear();
 }
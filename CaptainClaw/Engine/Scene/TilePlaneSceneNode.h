@@ -4,6 +4,8 @@
 #include "../SharedDefines.h"
 #include "../Scene/SceneNodes.h"
 
+class Image;
+class SpriteBatch;
 class SDL2TilePlaneSceneNode : public SceneNode
 {
 public:
@@ -16,8 +18,44 @@ public:
 
     // Interface overrides
     virtual void VRender(Scene* pScene);
+    virtual bool VOnLostDevice(Scene* pScene);
 
 protected:
+
+private:
+    // Tiles never change once the plane is loaded, so fixed-size regions of them are
+    // prerendered into target textures and every frame only a handful of them is drawn
+    struct TileChunk
+    {
+        // NULL if there are no tiles within the chunk
+        shared_ptr<SDL_Texture> pTexture;
+        int32 width;
+        int32 height;
+        uint32 lastUsedFrame;
+        // Distinct images the chunk was rendered from, pinned while the chunk is visible
+        std::vector<shared_ptr<Image>> tileImages;
+        bool isPinned;
+    };
+
+    // Keyed by chunk column and row, wrapped planes are not wrapped here
+    typedef std::map<std::pair<int32, int32>, TileChunk> TileChunkMap;
+
+    // Takes care of wrapping, returns NULL if there is no tile at given position
+    shared_ptr<Image> GetTileImage(int32 col, int32 row) const;
+
+    void RenderTiles(SpriteBatch* pSpriteBatch, const SDL_Rect& planeViewRect);
+    bool RenderChunks(SDL_Renderer* pRenderer, SpriteBatch* pSpriteBatch, const SDL_Rect& planeViewRect);
+
+    bool CreateChunk(SDL_Renderer* pRenderer, int32 chunkX, int32 chunkY, TileChunk& outChunk);
+    void EvictChunks(uint32 maxChunks);
+    void SetChunkPinned(TileChunk& chunk, bool pinned);
+    void ClearChunks();
+
+    TileChunkMap m_Chunks;
+    uint32 m_FrameIdx;
+
+    // Turned off when target textures cannot be created, tiles are then drawn one by one
+    bool m_UseChunks;
 };
 
-#endif
\ No newline at end of file
+#endif
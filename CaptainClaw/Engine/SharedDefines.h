@@ -8,6 +8,8 @@
 #include <vector>
 #include <list>
 #include <map>
+#include <unordered_map>
+#include <mutex>
 #include <tinyxml.h>
 #include <Box2D/Box2D.h>
 #include <algorithm>
@@ -4,6 +4,7 @@
 #include "../Events/EventMgr.h"
 #include "../Events/Events.h"
 #include "../Audio/Audio.h"
+#include "../Graphics2D/TextureResidencyManager.h"
 #include "../Resource/Loaders/MidiLoader.h"
 #include "../Resource/Loaders/WavLoader.h"
 #include "../Util/PrimeSearch.h"
@@ -100,6 +101,11 @@ void HumanView::VOnRender(uint32 msDiff)
 
         m_pConsole->OnRender(renderer);
 
+        if (TextureResidencyManager* pResidencyMgr = g_pApp->GetTextureResidencyManager())
+        {
+            pResidencyMgr->OnFrameRendered();
+        }
+
         if (!m_bPostponeRenderPresent)
         {
             SDL_RenderPresent(renderer);
@@ -228,7 +234,10 @@ bool HumanView::VOnEvent(SDL_Event& evt)
 
 void HumanView::VOnLostDevice()
 {
-
+    for (shared_ptr<IScreenElement> screenElement : m_ScreenElements)
+    {
+        screenElement->VOnLostDevice();
+    }
 }
 
 bool HumanView::EnterMenu(TiXmlElement* pMenuData)
@@ -278,8 +287,6 @@ void HumanView::LoadScoreScreen(TiXmlElement* pScoreScreenRootElem)
 
 bool HumanView::LoadGame(TiXmlElement* pLevelXmlElem, LevelData* pLevelData)
 {
-    m_pScene->SortSceneNodesByZCoord();
-
     // Start playing background music
     m_CurrentLevelMusic = "/LEVEL" + ToStr(pLevelData->GetLevelNumber()) +
         "/MUSIC/PLAY.XMI";
@@ -849,7 +849,7 @@ void ScreenElementMenuItem::VOnRender(uint32 msDiff)
     renderRect.w = (int)(pCurrImage->GetWidth() * g_MenuScale.x);
     renderRect.h = (int)(pCurrImage->GetHeight() * g_MenuScale.y);
 
-    SDL_RenderCopy(m_pRenderer, pCurrImage->GetTexture(), NULL, &renderRect);
+    SDL_RenderCopy(m_pRenderer, pCurrImage->GetTexture(), pCurrImage->GetSourceRect(), &renderRect);
 }
 
 bool ScreenElementMenuItem::VOnEvent(SDL_Event& evt)
@@ -1210,8 +1210,9 @@ void ScreenElementMenuItem::OnStateChanged(MenuItemState newState, MenuItemState
 
 SDL_Rect ScreenElementMenuItem::GetMenuItemRect()
 {
-    int itemWidth, itemHeight;
-    SDL_QueryTexture(m_Images[m_State]->GetTexture(), NULL, NULL, &itemWidth, &itemHeight);
+    // Image can be only a part of its texture
+    int itemWidth = m_Images[m_State]->GetWidth();
+    int itemHeight = m_Images[m_State]->GetHeight();
 
     SDL_Rect itemRect;
     itemRect.x = (int)m_Position.x;
@@ -16,7 +16,7 @@ public:
     virtual ~ScreenElementScene() { }
 
     // IScreenElement implementation
-    virtual void VOnLostDevice() { }
+    virtual void VOnLostDevice() { OnLostDevice(); }
     virtual void VOnUpdate(uint32 msDiff) { OnUpdate(msDiff); }
     virtual void VOnRender(uint32 msDiff) { OnRender(); }
 
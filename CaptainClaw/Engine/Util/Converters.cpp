@@ -1,9 +1,20 @@
 #include "Converters.h"
 //#include <regex>
 
-TiXmlElement* WwdToXml(WapWwd* wapWwd, int levelNumber)
+TiXmlElement* WwdToXml(WapWwdStream* pWwd, int levelNumber)
 {
     PROFILE_CPU("WWD->XML");
+
+    // Planes, tiles and objects are read from WWD only as they are needed
+    const WwdProperties* pWwdProperties = WAP_WwdStreamGetProperties(pWwd);
+    const WwdTileDescription* pWwdTileDescriptions = NULL;
+    int numTileDescriptions = WAP_WwdStreamGetTileDescriptions(pWwd, &pWwdTileDescriptions);
+    if (pWwdProperties == NULL || numTileDescriptions < 0)
+    {
+        LOG_ERROR("Could not read WWD level data");
+        return NULL;
+    }
+
     TiXmlDocument xmlDoc;
 
     //----- [Level]
@@ -14,37 +25,36 @@ TiXmlElement* WwdToXml(WapWwd* wapWwd, int levelNumber)
     TiXmlElement* levelProperties = new TiXmlElement("LevelProperties");
     root->LinkEndChild(levelProperties);
 
-    XML_ADD_TEXT_ELEMENT("LevelName", wapWwd->properties.levelName, levelProperties);
-    XML_ADD_TEXT_ELEMENT("Author", wapWwd->properties.author, levelProperties);
-    XML_ADD_TEXT_ELEMENT("Created", wapWwd->properties.birth, levelProperties);
-    XML_ADD_TEXT_ELEMENT("RezFile", wapWwd->properties.rezFile, levelProperties);
-    XML_ADD_TEXT_ELEMENT("TileDirectory", wapWwd->properties.imageDirectoryPath, levelProperties);
-    XML_ADD_TEXT_ELEMENT("Palette", wapWwd->properties.rezPalettePath, levelProperties);
-    XML_ADD_TEXT_ELEMENT("LaunchApp", wapWwd->properties.launchApp, levelProperties);
-    XML_ADD_TEXT_ELEMENT("ImageSet1", wapWwd->properties.imageSet1, levelProperties);
-    XML_ADD_TEXT_ELEMENT("ImageSet2", wapWwd->properties.imageSet2, levelProperties);
-    XML_ADD_TEXT_ELEMENT("ImageSet3", wapWwd->properties.imageSet3, levelProperties);
-    XML_ADD_TEXT_ELEMENT("ImageSet4", wapWwd->properties.imageSet4, levelProperties);
-    XML_ADD_TEXT_ELEMENT("Prefix1", wapWwd->properties.prefix1, levelProperties);
-    XML_ADD_TEXT_ELEMENT("Prefix2", wapWwd->properties.prefix1, levelProperties);
-    XML_ADD_TEXT_ELEMENT("Prefix3", wapWwd->properties.prefix1, levelProperties);
-    XML_ADD_TEXT_ELEMENT("Prefix4", wapWwd->properties.prefix1, levelProperties);
-
-    XML_ADD_TEXT_ELEMENT("UseZCoords", ToStr((wapWwd->properties.flags & 2) != 0).c_str(), levelProperties);
+    XML_ADD_TEXT_ELEMENT("LevelName", pWwdProperties->levelName, levelProperties);
+    XML_ADD_TEXT_ELEMENT("Author", pWwdProperties->author, levelProperties);
+    XML_ADD_TEXT_ELEMENT("Created", pWwdProperties->birth, levelProperties);
+    XML_ADD_TEXT_ELEMENT("RezFile", pWwdProperties->rezFile, levelProperties);
+    XML_ADD_TEXT_ELEMENT("TileDirectory", pWwdProperties->imageDirectoryPath, levelProperties);
+    XML_ADD_TEXT_ELEMENT("Palette", pWwdProperties->rezPalettePath, levelProperties);
+    XML_ADD_TEXT_ELEMENT("LaunchApp", pWwdProperties->launchApp, levelProperties);
+    XML_ADD_TEXT_ELEMENT("ImageSet1", pWwdProperties->imageSet1, levelProperties);
+    XML_ADD_TEXT_ELEMENT("ImageSet2", pWwdProperties->imageSet2, levelProperties);
+    XML_ADD_TEXT_ELEMENT("ImageSet3", pWwdProperties->imageSet3, levelProperties);
+    XML_ADD_TEXT_ELEMENT("ImageSet4", pWwdProperties->imageSet4, levelProperties);
+    XML_ADD_TEXT_ELEMENT("Prefix1", pWwdProperties->prefix1, levelProperties);
+    XML_ADD_TEXT_ELEMENT("Prefix2", pWwdProperties->prefix1, levelProperties);
+    XML_ADD_TEXT_ELEMENT("Prefix3", pWwdProperties->prefix1, levelProperties);
+    XML_ADD_TEXT_ELEMENT("Prefix4", pWwdProperties->prefix1, levelProperties);
+
+    XML_ADD_TEXT_ELEMENT("UseZCoords", ToStr((pWwdProperties->flags & 2) != 0).c_str(), levelProperties);
 
     TiXmlElement* spawnPos = new TiXmlElement("Spawn");
-    spawnPos->SetAttribute("x", wapWwd->properties.startX);
-    spawnPos->SetAttribute("y", wapWwd->properties.startY);
+    spawnPos->SetAttribute("x", pWwdProperties->startX);
+    spawnPos->SetAttribute("y", pWwdProperties->startY);
     levelProperties->LinkEndChild(spawnPos);
 
-    XML_ADD_TEXT_ELEMENT("PlanesCount", ToStr(wapWwd->properties.numPlanes).c_str(), levelProperties);
+    XML_ADD_TEXT_ELEMENT("PlanesCount", ToStr(pWwdProperties->numPlanes).c_str(), levelProperties);
 
     TiXmlElement* tileDescRootElem = new TiXmlElement("TileDescriptions");
     levelProperties->LinkEndChild(tileDescRootElem);
-    int numTileDescriptions = wapWwd->tileDescriptionsCount;
     for (int tileDescIdx = 0; tileDescIdx < numTileDescriptions; tileDescIdx++)
     {
-        WwdTileDescription wwdTileDesc = wapWwd->tileDescriptions[tileDescIdx];
+        WwdTileDescription wwdTileDesc = pWwdTileDescriptions[tileDescIdx];
 
         TiXmlElement* tileDescElem = new TiXmlElement("TileDescription");
         tileDescRootElem->LinkEndChild(tileDescElem);
@@ -80,7 +90,7 @@ TiXmlElement* WwdToXml(WapWwd* wapWwd, int levelNumber)
     // Defalt
     int mainPlaneIdx = -1;
 
-    std::string tileRootDirPath = wapWwd->properties.imageDirectoryPath;
+    std::string tileRootDirPath = pWwdProperties->imageDirectoryPath;
     std::replace(tileRootDirPath.begin(), tileRootDirPath.end(), '\\', '/');
     // Level 2 does not have /LEVEL2/TILES but only LEVEL2/TILES
     if (tileRootDirPath[0] != '/')
@@ -89,9 +99,14 @@ TiXmlElement* WwdToXml(WapWwd* wapWwd, int levelNumber)
     }
 
     //---- [Level::Actor type=Plane]
-    for (uint16 planeIdx = 0; planeIdx < wapWwd->properties.numPlanes; ++planeIdx)
+    for (uint16 planeIdx = 0; planeIdx < pWwdProperties->numPlanes; ++planeIdx)
     {
-        WwdPlane wwdPlane = wapWwd->planes[planeIdx];
+        const WwdPlaneProperties* pWwdPlane = WAP_WwdStreamGetPlaneProperties(pWwd, planeIdx);
+        assert(pWwdPlane != NULL);
+
+        int32 tilesCount = WAP_WwdStreamReadPlaneTiles(pWwd, planeIdx, NULL, 0);
+        std::vector<int32> planeTiles(tilesCount > 0 ? tilesCount : 0);
+        WAP_WwdStreamReadPlaneTiles(pWwd, planeIdx, planeTiles.data(), (uint32)planeTiles.size());
 
         TiXmlElement* plane = new TiXmlElement("Actor");
         plane->SetAttribute("Type", "Plane");
@@ -105,10 +120,10 @@ TiXmlElement* WwdToXml(WapWwd* wapWwd, int levelNumber)
 
         //---- [Level::Actor::TilePlaneRenderComponent::Images]
         std::string tileDirName;
-        if (std::string(wwdPlane.properties.name) == "Background") { tileDirName = "BACK"; }
-        else if (std::string(wwdPlane.properties.name) == "Action") { tileDirName = "ACTION"; }
-        else if (std::string(wwdPlane.properties.name) == "Front") { tileDirName = "FRONT"; }
-        else { LOG_ERROR("Unknown tile plane name: " + std::string(wwdPlane.properties.name)); }
+        if (std::string(pWwdPlane->name) == "Background") { tileDirName = "BACK"; }
+        else if (std::string(pWwdPlane->name) == "Action") { tileDirName = "ACTION"; }
+        else if (std::string(pWwdPlane->name) == "Front") { tileDirName = "FRONT"; }
+        else { LOG_ERROR("Unknown tile plane name: " + std::string(pWwdPlane->name)); }
         std::string planeImageDirPath = tileRootDirPath + "/" + tileDirName + "/*";
         XML_ADD_TEXT_ELEMENT("ImagePath", planeImageDirPath.c_str(), planeRenderComponentElem);
 
@@ -116,48 +131,46 @@ TiXmlElement* WwdToXml(WapWwd* wapWwd, int levelNumber)
         TiXmlElement* planeProperties = new TiXmlElement("PlaneProperties");
         planeRenderComponentElem->LinkEndChild(planeProperties);
 
-        XML_ADD_TEXT_ELEMENT("PlaneName", wwdPlane.properties.name, planeProperties);
+        XML_ADD_TEXT_ELEMENT("PlaneName", pWwdPlane->name, planeProperties);
 
-        XML_ADD_TEXT_ELEMENT("MainPlane", ToStr((wwdPlane.properties.flags & WAP_PLANE_FLAG_MAIN_PLANE) != 0).c_str(), planeProperties);
-        XML_ADD_TEXT_ELEMENT("NoDraw", ToStr((wwdPlane.properties.flags & WAP_PLANE_FLAG_NO_DRAW) != 0).c_str(), planeProperties);
-        XML_ADD_TEXT_ELEMENT("WrappedX", ToStr((wwdPlane.properties.flags & WAP_PLANE_FLAG_X_WRAPPING) != 0).c_str(), planeProperties);
-        XML_ADD_TEXT_ELEMENT("WrappedY", ToStr((wwdPlane.properties.flags & WAP_PLANE_FLAG_Y_WRAPPING) != 0).c_str(), planeProperties);
-        XML_ADD_TEXT_ELEMENT("TileAutoSized", ToStr((wwdPlane.properties.flags & WAP_PLANE_FLAG_AUTO_TILE_SIZE) != 0).c_str(), planeProperties);
+        XML_ADD_TEXT_ELEMENT("MainPlane", ToStr((pWwdPlane->flags & WAP_PLANE_FLAG_MAIN_PLANE) != 0).c_str(), planeProperties);
+        XML_ADD_TEXT_ELEMENT("NoDraw", ToStr((pWwdPlane->flags & WAP_PLANE_FLAG_NO_DRAW) != 0).c_str(), planeProperties);
+        XML_ADD_TEXT_ELEMENT("WrappedX", ToStr((pWwdPlane->flags & WAP_PLANE_FLAG_X_WRAPPING) != 0).c_str(), planeProperties);
+        XML_ADD_TEXT_ELEMENT("WrappedY", ToStr((pWwdPlane->flags & WAP_PLANE_FLAG_Y_WRAPPING) != 0).c_str(), planeProperties);
+        XML_ADD_TEXT_ELEMENT("TileAutoSized", ToStr((pWwdPlane->flags & WAP_PLANE_FLAG_AUTO_TILE_SIZE) != 0).c_str(), planeProperties);
 
-        XML_ADD_TEXT_ELEMENT("TotalTileCount", ToStr(wwdPlane.tilesCount).c_str(), planeProperties);
+        XML_ADD_TEXT_ELEMENT("TotalTileCount", ToStr(planeTiles.size()).c_str(), planeProperties);
 
         TiXmlElement* tileSize = new TiXmlElement("TilePixelSize");
-        tileSize->SetAttribute("width", wwdPlane.properties.tilePixelWidth);
-        tileSize->SetAttribute("height", wwdPlane.properties.tilePixelHeight);
+        tileSize->SetAttribute("width", pWwdPlane->tilePixelWidth);
+        tileSize->SetAttribute("height", pWwdPlane->tilePixelHeight);
         planeProperties->LinkEndChild(tileSize);
 
         TiXmlElement* planeSize = new TiXmlElement("PlanePixelSize");
-        planeSize->SetAttribute("width", wwdPlane.properties.pixelWidth);
-        planeSize->SetAttribute("height", wwdPlane.properties.pixelHeight);
+        planeSize->SetAttribute("width", pWwdPlane->pixelWidth);
+        planeSize->SetAttribute("height", pWwdPlane->pixelHeight);
         planeProperties->LinkEndChild(planeSize);
 
 
         TiXmlElement* moveSpeed = new TiXmlElement("MoveSpeedPercentage");
-        moveSpeed->SetAttribute("x", wwdPlane.properties.movementPercentX);
-        moveSpeed->SetAttribute("y", wwdPlane.properties.movementPercentY);
+        moveSpeed->SetAttribute("x", pWwdPlane->movementPercentX);
+        moveSpeed->SetAttribute("y", pWwdPlane->movementPercentY);
         planeProperties->LinkEndChild(moveSpeed);
 
-        XML_ADD_TEXT_ELEMENT("FillColor", ToStr(wwdPlane.properties.fillColor).c_str(), planeProperties);
-        XML_ADD_TEXT_ELEMENT("ImageSetsCount", ToStr(wwdPlane.properties.imageSetsCount).c_str(), planeProperties);
-        XML_ADD_TEXT_ELEMENT("ZCoord", ToStr(wwdPlane.properties.coordZ).c_str(), planeProperties);
+        XML_ADD_TEXT_ELEMENT("FillColor", ToStr(pWwdPlane->fillColor).c_str(), planeProperties);
+        XML_ADD_TEXT_ELEMENT("ImageSetsCount", ToStr(pWwdPlane->imageSetsCount).c_str(), planeProperties);
+        XML_ADD_TEXT_ELEMENT("ZCoord", ToStr(pWwdPlane->coordZ).c_str(), planeProperties);
 
         //[Level::Actor::TilePlaneRenderComponent::Tiles]
         TiXmlElement* tiles = new TiXmlElement("Tiles");
         planeRenderComponentElem->LinkEndChild(tiles);
 
-        uint32 tilesCount = wwdPlane.tilesCount;
-        int32* pTiles = wwdPlane.tiles;
-        for (uint32 tileIdx = 0; tileIdx < tilesCount; ++tileIdx)
+        for (int32 tileId : planeTiles)
         {
-            XML_ADD_TEXT_ELEMENT("Tile", ToStr(pTiles[tileIdx]).c_str(), tiles);
+            XML_ADD_TEXT_ELEMENT("Tile", ToStr(tileId).c_str(), tiles);
         }
 
-        if (wwdPlane.properties.flags & WAP_PLANE_FLAG_MAIN_PLANE)
+        if (pWwdPlane->flags & WAP_PLANE_FLAG_MAIN_PLANE)
         {
             mainPlaneIdx = planeIdx;
         }
@@ -170,17 +183,18 @@ TiXmlElement* WwdToXml(WapWwd* wapWwd, int levelNumber)
     TiXmlElement* actorsElem = new TiXmlElement("Actors");
     root->LinkEndChild(actorsElem);
 
-    WwdObject* wwdActors = wapWwd->planes[mainPlaneIdx].objects;
-    uint32 actorsCount = wapWwd->planes[mainPlaneIdx].objectsCount;
+    WapWwdObjectIterator* pWwdObjectIterator = WAP_WwdStreamIterateObjects(pWwd, mainPlaneIdx);
+    assert(pWwdObjectIterator != NULL);
 
-    std::string imagesRootPath = wapWwd->properties.imageSet1;
+    std::string imagesRootPath = pWwdProperties->imageSet1;
     std::replace(imagesRootPath.begin(), imagesRootPath.end(), '\\', '/');
     imagesRootPath += '/';
     imagesRootPath.insert(0, 1, '/');
 
-    for (uint32 actorIdx = 0; actorIdx < actorsCount; actorIdx++)
+    // Object and its strings are valid only until next object is read
+    while (const WwdObject* pWwdObject = WAP_WwdObjectIteratorNext(pWwdObjectIterator))
     {
-        WwdObject actorProperties = wwdActors[actorIdx];
+        WwdObject actorProperties = *pWwdObject;
 
         std::string name = actorProperties.name;
         std::string logic = actorProperties.logic;
@@ -604,8 +618,9 @@ TiXmlElement* WwdToXml(WapWwd* wapWwd, int levelNumber)
 #endif
     }
 
+    WAP_WwdObjectIteratorDestroy(pWwdObjectIterator);
 
-    root->LinkEndChild(CreateClawActor(wapWwd));
+    root->LinkEndChild(CreateClawActor(pWwdProperties));
 
     // Create HUD
     root->LinkEndChild(CreateHUDElement("/GAME/IMAGES/INTERFACE/TREASURECHEST/*", 150, "/GAME/ANIS/INTERFACE/CHEST.ANI", Point(20, 20), false, false, "score"));
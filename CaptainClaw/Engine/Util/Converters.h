@@ -1311,7 +1311,7 @@ inline TiXmlElement* WwdObjectToXml(WwdObject* wwdObject, std::string& imagesRoo
 // Claw to Xml
 //=====================================================================================================================
 
-inline TiXmlElement* CreateClawActor(WapWwd* pWapWwd)
+inline TiXmlElement* CreateClawActor(const WwdProperties* pWwdProperties)
 {
     TiXmlElement* pClawActor = new TiXmlElement("Actor");
     pClawActor->SetAttribute("Type", "Claw");
@@ -1329,7 +1329,7 @@ inline TiXmlElement* CreateClawActor(WapWwd* pWapWwd)
     clawBodyDef.fixtureType = FixtureType_Controller;
     pClawActor->LinkEndChild(ActorTemplates::CreatePhysicsComponent(&clawBodyDef));*/
 
-    pClawActor->LinkEndChild(CreatePositionComponent(pWapWwd->properties.startX, pWapWwd->properties.startY));
+    pClawActor->LinkEndChild(CreatePositionComponent(pWwdProperties->startX, pWwdProperties->startY));
     //pClawActor->LinkEndChild(CreatePositionComponent(6250, 4350));
     pClawActor->LinkEndChild(CreateCollisionComponent(40, 110));
     pClawActor->LinkEndChild(CreatePhysicsComponent(true, false, true, g_pApp->GetGlobalOptions()->maxJumpHeight, 40, 110, 4.0, 0.0, 0.5));
@@ -1459,7 +1459,7 @@ inline TiXmlElement* CreateHUDElement(const HUDElementDef& def)
         def.isVisible);
 }
 
-TiXmlElement* WwdToXml(WapWwd* wapWwd, int levelNumber);
+TiXmlElement* WwdToXml(WapWwdStream* pWwd, int levelNumber);
 
 
 #endif
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <vector>
 #include <stdint.h>
@@ -5,170 +7,277 @@
 #include "libwap.h"
 #include "IO.h"
 
-#include <iostream>
-using namespace std;
-WapPid* WAP_PidLoadFromData(char* data, size_t size, WapPal* palette)
+// Header consists of 8 uint32_t values, pixels follow right after it
+static const size_t PID_HEADER_SIZE = 8 * sizeof(uint32_t);
+
+// Color of pixels skipped by compressed PIDs
+static const WAP_ColorRGBA PID_TRANSPARENT_COLOR = { 0, 0, 0, 1 };
+
+static inline uint32_t ColorToPixel(const WAP_ColorRGBA& color)
 {
-    uint32_t x, y;
-    uint8_t byte;
-    WapPid* wapPid = NULL;
+    // Pixel has the same memory layout as WAP_ColorRGBA
+    uint32_t pixel;
+    memcpy(&pixel, &color, sizeof(pixel));
+    return pixel;
+}
 
-    if ((data == NULL) || (size == 0))
+// Helper which walks destination buffer row by row, so that runs are written in one go
+// instead of pixel by pixel
+class PidPixelWriter
+{
+public:
+    PidPixelWriter(void* dest, uint32_t width, uint32_t height, uint32_t pitch)
+        : m_dest((uint8_t*)dest), m_width(width), m_height(height), m_pitch(pitch), m_x(0), m_y(0)
     {
-        return NULL;
+        m_row = (uint32_t*)m_dest;
     }
 
-    /********************** PID HEADER/PROPERTIES **********************/
+    inline bool IsDone() const { return m_y >= m_height; }
 
-    wapPid = new WapPid;
+    // Returns how many pixels can be written to current row, at most count
+    inline uint32_t GetRowSpan(uint32_t count) const { return std::min(count, m_width - m_x); }
+    inline uint32_t* GetRowPixels() const { return m_row + m_x; }
 
-    // Set default values;
-    (*wapPid) = { 0 };
-
-    InputStream pidFileStream(data, size);
-
-    pidFileStream.read(wapPid->fileDesc,
-        wapPid->flags,
-        wapPid->width,
-        wapPid->height,
-        wapPid->offsetX,
-        wapPid->offsetY,
-        wapPid->unk0,
-        wapPid->unk1);
-
-    /********************** PID PALETTE **********************/
-
-    WapPal* imagePalette = NULL;
-
-    // If image has embedded palette within it, extract it
-    if (wapPid->flags & WAP_PID_FLAG_EMBEDDED_PALETTE)
+    inline void Advance(uint32_t count)
     {
-        uint32_t paletteOffset = size - WAP_PALETTE_SIZE_BYTES;
-        char* paletteData = &(data[paletteOffset]);
-        imagePalette = WAP_PalLoadFromData(paletteData, paletteOffset);
-    }
-    else
-    {
-        imagePalette = palette;
+        m_x += count;
+        if (m_x == m_width)
+        {
+            m_x = 0;
+            m_y++;
+            m_row = (uint32_t*)(m_dest + (size_t)m_y * m_pitch);
+        }
     }
 
-    // Make sure we have loaded a palette
-    if (imagePalette == NULL)
+    // Writes count pixels of the same color, run can span over multiple rows
+    inline void Fill(uint32_t pixel, uint32_t count)
     {
-        return NULL;
+        while ((count > 0) && !IsDone())
+        {
+            uint32_t span = GetRowSpan(count);
+            std::fill_n(GetRowPixels(), span, pixel);
+            Advance(span);
+            count -= span;
+        }
     }
 
-    /********************** PID PIXELS **********************/
-
-    wapPid->colorsCount = wapPid->width * wapPid->height;
-    wapPid->colors = new WAP_ColorRGBA[wapPid->colorsCount];
-
-    if (wapPid->colors == NULL)
-    {
-        delete wapPid;
-        return NULL;
-    }
+private:
+    uint8_t* m_dest;
+    uint32_t* m_row;
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_pitch;
+    uint32_t m_x;
+    uint32_t m_y;
+};
+
+// Expands RLE encoded pixels through 32-bit palette lookup table, returns false on truncated data
+static bool DecodePidPixels(const uint8_t* src, const uint8_t* srcEnd, uint32_t flags,
+    const uint32_t* colorTable, PidPixelWriter& writer)
+{
+    const uint32_t transparentPixel = ColorToPixel(PID_TRANSPARENT_COLOR);
 
-    x = 0;
-    y = 0;
     // PID is compressed, RLE
-    try {
-        if (wapPid->flags & WAP_PID_FLAG_COMPRESSION)
+    if (flags & WAP_PID_FLAG_COMPRESSION)
+    {
+        while (!writer.IsDone())
         {
-            while (y < wapPid->height)
+            if (src >= srcEnd)
             {
-                pidFileStream.read(byte);
+                return false;
+            }
 
-                if (byte > 128)
+            uint8_t byte = *src++;
+            if (byte > 128)
+            {
+                writer.Fill(transparentPixel, byte - 128);
+            }
+            else
+            {
+                // Literal run of palette indices
+                uint32_t count = byte;
+                while ((count > 0) && !writer.IsDone())
                 {
-                    int32_t i = byte - 128;
-                    while ((i > 0) && (y < wapPid->height))
+                    uint32_t span = writer.GetRowSpan(count);
+                    if ((size_t)(srcEnd - src) < span)
                     {
-                        wapPid->colors[y * wapPid->width + x] = WAP_ColorRGBA{ 0, 0, 0, 1 };
-                        x++;
-                        if (x == wapPid->width)
-                        {
-                            x = 0;
-                            y++;
-                        }
-                        i--;
+                        return false;
                     }
-                }
-                else
-                {
-                    int32_t i = byte;
-                    while ((i > 0) && (y < wapPid->height))
+
+                    uint32_t* pixels = writer.GetRowPixels();
+                    for (uint32_t i = 0; i < span; i++)
                     {
-                        pidFileStream.read(byte);
-
-                        wapPid->colors[y * wapPid->width + x] = WAP_ColorRGBA{ imagePalette->colors[byte].r,
-                            imagePalette->colors[byte].g,
-                            imagePalette->colors[byte].b,
-                            imagePalette->colors[byte].a };
-
-                        x++;
-                        if (x == wapPid->width)
-                        {
-                            x = 0;
-                            y++;
-                        }
-                        i--;
+                        pixels[i] = colorTable[src[i]];
                     }
+
+                    src += span;
+                    writer.Advance(span);
+                    count -= span;
                 }
             }
         }
-        else
+    }
+    else
+    {
+        while (!writer.IsDone())
         {
-            while (y < wapPid->height)
+            if (src >= srcEnd)
             {
-                int32_t i = 1;
-                pidFileStream.read(byte);
+                return false;
+            }
 
-                // PID related encoding probably, this means how many same pixels are following.
-                // e.g. if byte = 220, then 220-192=28 same pixels are next to each other
-                if (byte > 192)
-                {
-                    i = byte - 192;
-                    pidFileStream.read(byte);
-                }
+            uint32_t count = 1;
+            uint8_t byte = *src++;
 
-                while ((i > 0) && (y < wapPid->height))
+            // PID related encoding probably, this means how many same pixels are following.
+            // e.g. if byte = 220, then 220-192=28 same pixels are next to each other
+            if (byte > 192)
+            {
+                if (src >= srcEnd)
                 {
-                    wapPid->colors[y * wapPid->width + x] = WAP_ColorRGBA{ imagePalette->colors[byte].r,
-                        imagePalette->colors[byte].g,
-                        imagePalette->colors[byte].b,
-                        imagePalette->colors[byte].a };
-
-                    x++;
-                    if (x == wapPid->width)
-                    {
-                        x = 0;
-                        y++;
-                    }
-                    i--;
+                    return false;
                 }
+
+                count = byte - 192;
+                byte = *src++;
             }
+
+            writer.Fill(colorTable[byte], count);
         }
     }
-    catch (...)
+
+    return true;
+}
+
+int32_t WAP_PidLoadHeaderFromData(const char* data, size_t size, WapPid* outPid)
+{
+    if ((data == NULL) || (outPid == NULL) || (size < PID_HEADER_SIZE))
+    {
+        return -1;
+    }
+
+    // Set default values;
+    (*outPid) = { 0 };
+
+    InputStream pidFileStream(data, size);
+
+    pidFileStream.read(outPid->fileDesc,
+        outPid->flags,
+        outPid->width,
+        outPid->height,
+        outPid->offsetX,
+        outPid->offsetY,
+        outPid->unk0,
+        outPid->unk1);
+
+    // Dimensions come straight from file, do not let them overflow pixel count computations
+    if ((outPid->width > WAP_PID_MAX_DIMENSION) || (outPid->height > WAP_PID_MAX_DIMENSION))
     {
-        // If we created new palette, destroy it
-        if (wapPid->flags & WAP_PID_FLAG_EMBEDDED_PALETTE)
+        return -1;
+    }
+
+    return 0;
+}
+
+int32_t WAP_PidDecodeIntoBuffer(const char* data, size_t size, WapPal* palette, void* dest, uint32_t pitch)
+{
+    WapPid pidHeader;
+    if ((dest == NULL) || (WAP_PidLoadHeaderFromData(data, size, &pidHeader) < 0))
+    {
+        return -1;
+    }
+
+    if (pitch < pidHeader.width * sizeof(uint32_t))
+    {
+        return -1;
+    }
+
+    /********************** PID PALETTE **********************/
+
+    WapPal* imagePalette = palette;
+
+    // If image has embedded palette within it, extract it
+    if (pidHeader.flags & WAP_PID_FLAG_EMBEDDED_PALETTE)
+    {
+        if (size < PID_HEADER_SIZE + WAP_PALETTE_SIZE_BYTES)
         {
-            WAP_PalDestroy(imagePalette);
+            return -1;
         }
-        
-        WAP_PidDestroy(wapPid);
 
-        return NULL;
+        char* paletteData = const_cast<char*>(&(data[size - WAP_PALETTE_SIZE_BYTES]));
+        imagePalette = WAP_PalLoadFromData(paletteData, WAP_PALETTE_SIZE_BYTES);
+    }
+
+    // Make sure we have loaded a palette
+    if (imagePalette == NULL)
+    {
+        return -1;
+    }
+
+    // Palette lookup is done through plain 32-bit values, each pixel is then a single store
+    uint32_t colorTable[WAP_COLORS_IN_PALETTE];
+    for (uint32_t colorIdx = 0; colorIdx < WAP_COLORS_IN_PALETTE; colorIdx++)
+    {
+        colorTable[colorIdx] = ColorToPixel(imagePalette->colors[colorIdx]);
     }
 
     // If we created new palette, destroy it
-    if (wapPid->flags & WAP_PID_FLAG_EMBEDDED_PALETTE)
+    if (pidHeader.flags & WAP_PID_FLAG_EMBEDDED_PALETTE)
     {
         WAP_PalDestroy(imagePalette);
     }
 
+    /********************** PID PIXELS **********************/
+
+    if (pidHeader.width == 0)
+    {
+        return 0;
+    }
+
+    const uint8_t* src = (const uint8_t*)data + PID_HEADER_SIZE;
+    const uint8_t* srcEnd = (const uint8_t*)data + size;
+
+    PidPixelWriter writer(dest, pidHeader.width, pidHeader.height, pitch);
+    if (!DecodePidPixels(src, srcEnd, pidHeader.flags, colorTable, writer))
+    {
+        return -1;
+    }
+
+    return 0;
+}
+
+WapPid* WAP_PidLoadFromData(char* data, size_t size, WapPal* palette)
+{
+    WapPid* wapPid = NULL;
+
+    if ((data == NULL) || (size == 0))
+    {
+        return NULL;
+    }
+
+    /********************** PID HEADER/PROPERTIES **********************/
+
+    wapPid = new WapPid;
+
+    if (WAP_PidLoadHeaderFromData(data, size, wapPid) < 0)
+    {
+        delete wapPid;
+        return NULL;
+    }
+
+    /********************** PID PIXELS **********************/
+
+    wapPid->colorsCount = wapPid->width * wapPid->height;
+    wapPid->colors = new WAP_ColorRGBA[wapPid->colorsCount];
+
+    // Colors are tightly packed rows of RGBA pixels
+    uint32_t pitch = wapPid->width * sizeof(WAP_ColorRGBA);
+    if (WAP_PidDecodeIntoBuffer(data, size, palette, wapPid->colors, pitch) < 0)
+    {
+        WAP_PidDestroy(wapPid);
+        return NULL;
+    }
+
     return wapPid;
 }
 
@@ -224,6 +333,24 @@ WapPid* WAP_PidLoadFromRezArchive(RezArchive* rezArchive, const char* pidRezPath
     return WAP_PidLoadFromRezFile(pidRezFile, palette);
 }
 
+WapPid* WAP_PidCreate(uint32_t width, uint32_t height)
+{
+    if ((width == 0) || (height == 0))
+    {
+        return NULL;
+    }
+
+    WapPid* wapPid = new WapPid;
+    memset(wapPid, 0, sizeof(WapPid));
+
+    wapPid->width = width;
+    wapPid->height = height;
+    wapPid->colorsCount = width * height;
+    wapPid->colors = new WAP_ColorRGBA[wapPid->colorsCount];
+
+    return wapPid;
+}
+
 void WAP_PidDestroy(WapPid* wapPid)
 {
     if (wapPid == NULL)
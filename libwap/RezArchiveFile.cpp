@@ -12,17 +12,54 @@
 #include "libwap.h"
 #include <iostream>
 
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
 using namespace std;
 
 /*************************************************************************/
 /**************************** PRIVATE STRUCTURES *************************/
 /*************************************************************************/
 
+struct RezFileIndexEntry
+{
+    uint32_t hash;
+    RezFile* rezFile;
+};
+
+// Open addressing (linear probing) hash table of all files within REZ archive keyed
+// by their full lower case path. Size of entries is always power of two.
+struct RezFileIndex
+{
+    std::vector<RezFileIndexEntry> entries;
+    uint32_t mask;
+};
+
 struct RezArchiveFileEntry
 {
     RezArchive* rezArchive;
-    std::ifstream* fileStream;
-    std::mutex mutex;
+
+    // File is only read at explicit offsets (pread / overlapped ReadFile) so it can be shared between threads
+#ifdef _WIN32
+    HANDLE fileHandle;
+    HANDLE mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+
+    // Read-only view of the whole REZ archive, NULL if archive is not memory-mapped
+    const char* mappedData;
+    size_t mappedSize;
+
+    RezFileIndex fileIndex;
 };
 
 /*************************************************************************/
@@ -33,6 +70,9 @@ typedef std::vector<RezFile*> RezFileVec;
 
 static std::map<RezArchive*, RezArchiveFileEntry*> g_rezArchiveFileEntryMap;
 static std::map<RezFile*, char*> g_rezFileDataMap;
+
+static std::mutex g_rezArchiveFileEntryMapMutex;
+static std::mutex g_rezFileDataMapMutex;
 static std::map<RezArchive*, RezFileVec*> g_rezArchiveFilesMap;
 
 uint8_t directorySeparator = '/';
@@ -94,6 +134,149 @@ static std::vector<std::string> SplitStringIntoTokens(const char* input, char de
     return tokensVector;
 }
 
+// Reads REZ path character by character in the same form in which full paths of REZ files
+// are stored - lower case, starting with directory separator and without repeated separators.
+// This way paths do not have to be copied and transformed before each lookup.
+class NormalizedPathReader
+{
+public:
+    NormalizedPathReader(const char* path) : m_pCurrent(path), m_bAtStart(true) { }
+
+    // Returns next character of normalized path or 0 at its end
+    char Next()
+    {
+        if (m_bAtStart)
+        {
+            m_bAtStart = false;
+            SkipSeparators();
+            return directorySeparator;
+        }
+
+        char c = *m_pCurrent;
+        if (c == 0)
+        {
+            return 0;
+        }
+
+        m_pCurrent++;
+        if (c == directorySeparator)
+        {
+            SkipSeparators();
+            return c;
+        }
+
+        return (char)std::tolower((unsigned char)c);
+    }
+
+private:
+    void SkipSeparators()
+    {
+        while (*m_pCurrent == directorySeparator)
+        {
+            m_pCurrent++;
+        }
+    }
+
+    const char* m_pCurrent;
+    bool m_bAtStart;
+};
+
+// FNV-1a over normalized path
+static uint32_t HashRezPath(const char* path)
+{
+    uint32_t hash = 2166136261u;
+    NormalizedPathReader pathReader(path);
+    for (char c = pathReader.Next(); c != 0; c = pathReader.Next())
+    {
+        hash ^= (uint8_t)c;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+// Compares already normalized stored path with arbitrary path
+static bool IsSameRezPath(const char* normalizedPath, const char* path)
+{
+    NormalizedPathReader pathReader(path);
+    while (true)
+    {
+        char c = pathReader.Next();
+        if (*normalizedPath != c)
+        {
+            return false;
+        }
+        if (c == 0)
+        {
+            return true;
+        }
+        normalizedPath++;
+    }
+}
+
+static void BuildRezFileIndex(RezFileIndex& fileIndex, const RezFileVec& rezFiles)
+{
+    // Keep load factor at most 0.5 so that probe sequences stay short
+    uint32_t capacity = 16;
+    while (capacity < rezFiles.size() * 2)
+    {
+        capacity <<= 1;
+    }
+
+    RezFileIndexEntry emptyEntry = { 0, NULL };
+    fileIndex.entries.assign(capacity, emptyEntry);
+    fileIndex.mask = capacity - 1;
+
+    for (RezFile* rezFile : rezFiles)
+    {
+        uint32_t hash = HashRezPath(rezFile->fullPathAndName);
+        uint32_t slot = hash & fileIndex.mask;
+        while (fileIndex.entries[slot].rezFile != NULL)
+        {
+            slot = (slot + 1) & fileIndex.mask;
+        }
+
+        fileIndex.entries[slot].hash = hash;
+        fileIndex.entries[slot].rezFile = rezFile;
+    }
+}
+
+static RezFile* FindRezFileInIndex(const RezFileIndex& fileIndex, const char* rezFilePath, uint32_t hash)
+{
+    if (fileIndex.entries.empty())
+    {
+        return NULL;
+    }
+
+    uint32_t slot = hash & fileIndex.mask;
+    while (fileIndex.entries[slot].rezFile != NULL)
+    {
+        const RezFileIndexEntry& entry = fileIndex.entries[slot];
+        if ((entry.hash == hash) && IsSameRezPath(entry.rezFile->fullPathAndName, rezFilePath))
+        {
+            return entry.rezFile;
+        }
+
+        slot = (slot + 1) & fileIndex.mask;
+    }
+
+    return NULL;
+}
+
+static std::string GetRezDirectoryFullPath(RezDirectory* rezDirectory)
+{
+    std::string dirPath;
+
+    // Root directory has no name
+    while ((rezDirectory != NULL) && (rezDirectory->parent != NULL))
+    {
+        dirPath = (char)directorySeparator + std::string(rezDirectory->name) + dirPath;
+        rezDirectory = rezDirectory->parent;
+    }
+
+    return dirPath;
+}
+
 void ToLower(char* string)
 {
     if (string == NULL)
@@ -105,6 +288,157 @@ void ToLower(char* string)
     std::transform(string, string + len, string, (int(*)(int)) std::tolower);
 }
 
+static bool OpenRezArchiveFile(RezArchiveFileEntry* rezArchiveFileEntry, const char* rezFilePath)
+{
+#ifdef _WIN32
+    rezArchiveFileEntry->fileHandle = CreateFileA(rezFilePath, GENERIC_READ, FILE_SHARE_READ, NULL, 
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+    return rezArchiveFileEntry->fileHandle != INVALID_HANDLE_VALUE;
+#else
+    rezArchiveFileEntry->fileDescriptor = open(rezFilePath, O_RDONLY);
+    return rezArchiveFileEntry->fileDescriptor >= 0;
+#endif
+}
+
+static void CloseRezArchiveFile(RezArchiveFileEntry* rezArchiveFileEntry)
+{
+#ifdef _WIN32
+    if (rezArchiveFileEntry->fileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(rezArchiveFileEntry->fileHandle);
+        rezArchiveFileEntry->fileHandle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (rezArchiveFileEntry->fileDescriptor >= 0)
+    {
+        close(rezArchiveFileEntry->fileDescriptor);
+        rezArchiveFileEntry->fileDescriptor = -1;
+    }
+#endif
+}
+
+static bool MapRezArchiveFile(RezArchiveFileEntry* rezArchiveFileEntry)
+{
+#ifdef _WIN32
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(rezArchiveFileEntry->fileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        return false;
+    }
+
+    HANDLE mappingHandle = CreateFileMappingA(rezArchiveFileEntry->fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mappingHandle == NULL)
+    {
+        return false;
+    }
+
+    void* mappedData = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (mappedData == NULL)
+    {
+        CloseHandle(mappingHandle);
+        return false;
+    }
+
+    rezArchiveFileEntry->mappingHandle = mappingHandle;
+    rezArchiveFileEntry->mappedData = (const char*)mappedData;
+    rezArchiveFileEntry->mappedSize = (size_t)fileSize.QuadPart;
+#else
+    struct stat fileStat;
+    if (fstat(rezArchiveFileEntry->fileDescriptor, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        return false;
+    }
+
+    void* mappedData = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, rezArchiveFileEntry->fileDescriptor, 0);
+    if (mappedData == MAP_FAILED)
+    {
+        return false;
+    }
+
+    rezArchiveFileEntry->mappedData = (const char*)mappedData;
+    rezArchiveFileEntry->mappedSize = (size_t)fileStat.st_size;
+#endif
+
+    return true;
+}
+
+static void UnmapRezArchiveFile(RezArchiveFileEntry* rezArchiveFileEntry)
+{
+    if (rezArchiveFileEntry->mappedData == NULL)
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(rezArchiveFileEntry->mappedData);
+    CloseHandle(rezArchiveFileEntry->mappingHandle);
+#else
+    munmap((void*)rezArchiveFileEntry->mappedData, rezArchiveFileEntry->mappedSize);
+#endif
+
+    rezArchiveFileEntry->mappedData = NULL;
+    rezArchiveFileEntry->mappedSize = 0;
+}
+
+// Reads data at given offset without any shared file position, so it can be called
+// from multiple threads at the same time
+static bool ReadRezArchiveFile(RezArchiveFileEntry* rezArchiveFileEntry, uint32_t offset, uint32_t size, char* dest)
+{
+    if (rezArchiveFileEntry->mappedData != NULL)
+    {
+        if ((size_t)offset + size > rezArchiveFileEntry->mappedSize)
+        {
+            return false;
+        }
+
+        memcpy(dest, rezArchiveFileEntry->mappedData + offset, size);
+        return true;
+    }
+
+    uint32_t bytesRead = 0;
+    while (bytesRead < size)
+    {
+#ifdef _WIN32
+        // Offset in OVERLAPPED structure makes ReadFile ignore (and not depend on) file pointer
+        OVERLAPPED overlapped = { 0 };
+        overlapped.Offset = offset + bytesRead;
+
+        DWORD chunkSize = 0;
+        if (!ReadFile(rezArchiveFileEntry->fileHandle, dest + bytesRead, size - bytesRead, &chunkSize, &overlapped) ||
+            chunkSize == 0)
+        {
+            return false;
+        }
+#else
+        ssize_t chunkSize = pread(rezArchiveFileEntry->fileDescriptor, dest + bytesRead, size - bytesRead, (off_t)offset + bytesRead);
+        if (chunkSize < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (chunkSize <= 0)
+        {
+            return false;
+        }
+#endif
+        bytesRead += (uint32_t)chunkSize;
+    }
+
+    return true;
+}
+
+static RezArchiveFileEntry* FindRezArchiveFileEntry(RezArchive* rezArchive)
+{
+    std::lock_guard<std::mutex> lock(g_rezArchiveFileEntryMapMutex);
+
+    auto findIt = g_rezArchiveFileEntryMap.find(rezArchive);
+    if (findIt == g_rezArchiveFileEntryMap.end())
+    {
+        return NULL;
+    }
+
+    return findIt->second;
+}
+
 /*************************************************************************/
 /************************** API IMPLEMENTATIONS **************************/
 /*************************************************************************/
@@ -118,79 +452,107 @@ char* WAP_GetRezFileData(RezFile* rezFile)
     }
 
     // Check if we already accessed this file
-    if (g_rezFileDataMap.count(rezFile) != 0)
-    {
-        return g_rezFileDataMap[rezFile];
-    }
-    else
     {
-        // First time accessing it, we have to allocate it and load it
+        std::lock_guard<std::mutex> lock(g_rezFileDataMapMutex);
 
-        // Check if there is REZ archive entry
-        if (g_rezArchiveFileEntryMap.count(rezFile->owner) == 0)
+        auto findIt = g_rezFileDataMap.find(rezFile);
+        if (findIt != g_rezFileDataMap.end())
         {
-            return NULL;
+            return findIt->second;
         }
+    }
 
-        // Create new entry for rez file and allocate its data buffer
-        g_rezFileDataMap.insert(std::pair<RezFile*, char*>(rezFile, new char[rezFile->size]));
+    // First time accessing it, we have to allocate it and load it
+    char* data = new char[rezFile->size];
+    if (WAP_ReadRezFileInto(rezFile, data) < 0)
+    {
+        delete[] data;
+        return NULL;
+    }
 
-        RezArchiveFileEntry* rezArchiveFileEntry = g_rezArchiveFileEntryMap[rezFile->owner];
+    std::lock_guard<std::mutex> lock(g_rezFileDataMapMutex);
+
+    // Some other thread could have loaded the same file in the meantime
+    auto insertResult = g_rezFileDataMap.insert(std::pair<RezFile*, char*>(rezFile, data));
+    if (!insertResult.second)
+    {
+        delete[] data;
+    }
 
-        std::lock_guard<std::mutex> lock(rezArchiveFileEntry->mutex);
+    return insertResult.first->second;
+}
 
-        // Seek to file's offset within REZ file and load it
-        rezArchiveFileEntry->fileStream->seekg(rezFile->offset, std::ios::beg);
-        rezArchiveFileEntry->fileStream->read(g_rezFileDataMap[rezFile], rezFile->size);
+int32_t WAP_ReadRezFileInto(RezFile* rezFile, void* dest)
+{
+    // Check if we got valid input
+    if ((rezFile == NULL) || (rezFile->owner == NULL) || (dest == NULL))
+    {
+        return -1;
+    }
+
+    RezArchiveFileEntry* rezArchiveFileEntry = FindRezArchiveFileEntry(rezFile->owner);
+    if (rezArchiveFileEntry == NULL)
+    {
+        return -1;
+    }
+
+    if (!ReadRezArchiveFile(rezArchiveFileEntry, rezFile->offset, rezFile->size, (char*)dest))
+    {
+        return -1;
     }
 
-    return g_rezFileDataMap[rezFile];
+    return (int32_t)rezFile->size;
 }
 
-void WAP_FreeFileData(RezFile* rezFile)
+const char* WAP_GetRezFileMappedData(RezFile* rezFile)
 {
-    // Check validity
-    if (rezFile == NULL)
+    // Check if we got valid input
+    if ((rezFile == NULL) || (rezFile->owner == NULL))
     {
-        return;
+        return NULL;
     }
 
-    // Check if file data for this REZ file are loaded
-    if (g_rezFileDataMap.count(rezFile) == 0)
+    RezArchiveFileEntry* rezArchiveFileEntry = FindRezArchiveFileEntry(rezFile->owner);
+    if ((rezArchiveFileEntry == NULL) || (rezArchiveFileEntry->mappedData == NULL) ||
+        ((size_t)rezFile->offset + rezFile->size > rezArchiveFileEntry->mappedSize))
     {
-        // Nothing to do
-        return;
+        return NULL;
     }
 
-    delete[] g_rezFileDataMap[rezFile];
-    g_rezFileDataMap[rezFile] = NULL;
-    g_rezFileDataMap.erase(rezFile);
+    return rezArchiveFileEntry->mappedData + rezFile->offset;
 }
 
-static RezFile* GetChildFile(RezDirectory* rezFileDirectory, std::string fileName)
+int WAP_IsRezArchiveMapped(RezArchive* rezArchive)
 {
-    uint32_t i;
-    RezFile* searchedFile = NULL;
+    RezArchiveFileEntry* rezArchiveFileEntry = FindRezArchiveFileEntry(rezArchive);
+    if (rezArchiveFileEntry == NULL)
+    {
+        return 0;
+    }
+
+    return rezArchiveFileEntry->mappedData != NULL;
+}
 
+void WAP_FreeFileData(RezFile* rezFile)
+{
     // Check validity
-    if ((rezFileDirectory == NULL) || (rezFileDirectory->directoryContents == NULL) ||
-        (fileName.length() == 0))
+    if (rezFile == NULL)
     {
-        return NULL;
+        return;
     }
 
-    for (i = 0; i < rezFileDirectory->directoryContents->rezFilesCount; i++)
+    std::lock_guard<std::mutex> lock(g_rezFileDataMapMutex);
+
+    // Check if file data for this REZ file are loaded
+    auto findIt = g_rezFileDataMap.find(rezFile);
+    if (findIt == g_rezFileDataMap.end())
     {
-        std::string rezFileName(rezFileDirectory->directoryContents->rezFiles[i]->name);
-        rezFileName.append(".").append(rezFileDirectory->directoryContents->rezFiles[i]->extension);
-        if (fileName.compare(rezFileName) == 0)
-        {
-            searchedFile = rezFileDirectory->directoryContents->rezFiles[i];
-            break;
-        }
+        // Nothing to do
+        return;
     }
 
-    return searchedFile;
+    delete[] findIt->second;
+    g_rezFileDataMap.erase(findIt);
 }
 
 static RezDirectory* GetChildDirectory(RezDirectory* currentDirectory, std::string& searchedDirectoryName)
@@ -268,8 +630,6 @@ RezDirectory* WAP_GetRezDirectoryFromRezDirectory(RezDirectory* rezDirectory, co
 
 RezFile* WAP_GetRezFileFromRezArchive(RezArchive* rezArchive, const char* rezFilePath)
 {
-    static std::mutex mutex;
-
     // Check if we got valid input
     if ((rezArchive == NULL) || (rezArchive->rootDirectory == NULL) ||
         (rezFilePath == NULL) || (strlen(rezFilePath) == 0))
@@ -277,27 +637,34 @@ RezFile* WAP_GetRezFileFromRezArchive(RezArchive* rezArchive, const char* rezFil
         return NULL;
     }
 
-    return WAP_GetRezFileFromRezDirectory(rezArchive->rootDirectory, rezFilePath);
-
-    //--- Remnants of the past, possible optimalization for the future, saves ~3 microseconds upon each lookup
+    return WAP_GetRezFileFromRezArchiveByHash(rezArchive, rezFilePath, WAP_HashRezFilePath(rezFilePath));
+}
 
-    // We always start from root. Make it easier for users to be able to
-    // specify path both as "LEVEL1/IMAGES/ASDF.PID" same as "/LEVEL1/IMAGES/ASDF.PID"
-    /*std::string fileKey(rezFilePath);
-    if (fileKey[0] != directorySeparator)
+RezFile* WAP_GetRezFileFromRezArchiveByHash(RezArchive* rezArchive, const char* rezFilePath, uint32_t rezFilePathHash)
+{
+    // Check if we got valid input
+    if ((rezArchive == NULL) || (rezFilePath == NULL))
     {
-        fileKey.insert(0, 1, directorySeparator);
+        return NULL;
     }
-    
-    // Critical section
-    std::lock_guard<std::mutex> lock(mutex);
 
-    if (g_rezArchiveFileMap.count(rezArchive) == 0)
+    RezArchiveFileEntry* rezArchiveFileEntry = FindRezArchiveFileEntry(rezArchive);
+    if (rezArchiveFileEntry == NULL)
     {
         return NULL;
     }
 
-    return (*g_rezArchiveFileMap[rezArchive])[std::string(fileKey)];*/
+    return FindRezFileInIndex(rezArchiveFileEntry->fileIndex, rezFilePath, rezFilePathHash);
+}
+
+uint32_t WAP_HashRezFilePath(const char* rezFilePath)
+{
+    if (rezFilePath == NULL)
+    {
+        return 0;
+    }
+
+    return HashRezPath(rezFilePath);
 }
 
 RezFile* WAP_GetRezFileFromRezDirectory(RezDirectory* rezDirectory, const char* rezFilePath)
@@ -309,53 +676,53 @@ RezFile* WAP_GetRezFileFromRezDirectory(RezDirectory* rezDirectory, const char*
         return NULL;
     }
 
-    std::string fullFilePath(rezFilePath);
-
-    // Transform file path to lower case
-    std::transform(fullFilePath.begin(), fullFilePath.end(), fullFilePath.begin(), (int(*)(int)) std::tolower);
-
-    size_t fileNamePos = fullFilePath.find_last_of(directorySeparator);
-    // In case rezFilePath is only filename, like CLAW.PID and not /CLAW/IMAGE/CLAW.PID
-    if (fileNamePos == std::string::npos)
+    // Root directory, path is already full path
+    if (rezDirectory->parent == NULL)
     {
-        return GetChildFile(rezDirectory, std::string(fullFilePath.c_str()));
+        return WAP_GetRezFileFromRezArchive(rezDirectory->owner, rezFilePath);
     }
 
-    std::string fullFileName = fullFilePath.substr(fileNamePos + 1);
-    std::string directoryPath = fullFilePath.substr(0, fileNamePos);
-
-    // Try to get directory in which searched file resides
-    RezDirectory* searchedFileDirectory = WAP_GetRezDirectoryFromRezDirectory(rezDirectory, directoryPath.c_str());
-    if (searchedFileDirectory == NULL)
-    {
-        return NULL;
-    }
+    // Path is relative to given directory, repeated separators are skipped upon lookup
+    std::string fullFilePath = GetRezDirectoryFullPath(rezDirectory);
+    fullFilePath.append(1, (char)directorySeparator).append(rezFilePath);
 
-    // Try to retrieve file from its directory
-    return GetChildFile(searchedFileDirectory, fullFileName);
+    return WAP_GetRezFileFromRezArchive(rezDirectory->owner, fullFilePath.c_str());
 }
 
-static void RegisterRezArchiveFile(RezArchive* rezArchive, std::ifstream* rezArchiveFileStream)
+static RezArchiveFileEntry* RegisterRezArchiveFile(RezArchive* rezArchive, const char* rezFilePath)
 {
     // Create loaded REZ file entry
     RezArchiveFileEntry* rezArchiveFileEntry = new RezArchiveFileEntry;
     rezArchiveFileEntry->rezArchive = rezArchive;
-    rezArchiveFileEntry->fileStream = rezArchiveFileStream;
+    rezArchiveFileEntry->mappedData = NULL;
+    rezArchiveFileEntry->mappedSize = 0;
 
+    if (!OpenRezArchiveFile(rezArchiveFileEntry, rezFilePath))
+    {
+        delete rezArchiveFileEntry;
+        return NULL;
+    }
+
+    std::lock_guard<std::mutex> lock(g_rezArchiveFileEntryMapMutex);
     g_rezArchiveFileEntryMap.insert(std::pair<RezArchive*, RezArchiveFileEntry*>(rezArchive, rezArchiveFileEntry));
+
+    return rezArchiveFileEntry;
 }
 
 static void UnregisterRezArchiveFile(RezArchive* rezArchive)
 {
+    std::lock_guard<std::mutex> lock(g_rezArchiveFileEntryMapMutex);
+
     // First check if there is given rez archive registered
-    if (g_rezArchiveFileEntryMap.count(rezArchive) != 0)
+    auto findIt = g_rezArchiveFileEntryMap.find(rezArchive);
+    if (findIt != g_rezArchiveFileEntryMap.end())
     {
         // Unregister loaded REZ file entry
-        RezArchiveFileEntry* rezArchiveFileEntry = g_rezArchiveFileEntryMap[rezArchive];
-        delete rezArchiveFileEntry->fileStream;
+        RezArchiveFileEntry* rezArchiveFileEntry = findIt->second;
+        UnmapRezArchiveFile(rezArchiveFileEntry);
+        CloseRezArchiveFile(rezArchiveFileEntry);
         delete rezArchiveFileEntry;
-        rezArchiveFileEntry = NULL;
-        g_rezArchiveFileEntryMap.erase(rezArchive);
+        g_rezArchiveFileEntryMap.erase(findIt);
     }
 }
 
@@ -481,6 +848,7 @@ static void ReadRezDirectory(RezArchive*& rezArchive, RezDirectory* rezDirectory
             RezDirectory* newRezDirectory = new RezDirectory;
             (*newRezDirectory) = { 0 };
             newRezDirectory->parent = rezDirectory;
+            newRezDirectory->owner = rezArchive;
 
             loadedRezDirectories.emplace_back(newRezDirectory);
 
@@ -599,11 +967,12 @@ static void ReadRezDirectory(RezArchive*& rezArchive, RezDirectory* rezDirectory
     }
 }
 
-RezArchive* WAP_LoadRezArchive(const char* rezFilePath)
+static RezArchive* LoadRezArchive(const char* rezFilePath, bool mapArchive)
 {
     std::ifstream* fileStream = new std::ifstream(rezFilePath, std::ifstream::binary);
     if (!fileStream->is_open())
     {
+        delete fileStream;
         return NULL;
     }
 
@@ -612,6 +981,7 @@ RezArchive* WAP_LoadRezArchive(const char* rezFilePath)
     // Initialize to default values
     (*rezArchive->rootDirectory) = { 0 };
     rezArchive->rootDirectory->name = StdStringToCharArray(std::string(""));
+    rezArchive->rootDirectory->owner = rezArchive;
 
     // Read rez file header which is 127 bytes long
     fileStream->read(rezArchive->header, 127);
@@ -630,6 +1000,7 @@ RezArchive* WAP_LoadRezArchive(const char* rezFilePath)
     // If this check fails, we did not load valid REZ file
     if (expectedRezArchiveSize != actualLoadedFileSize)
     {
+        delete fileStream;
         WAP_DestroyRezArchive(rezArchive);
         return NULL;
     }
@@ -637,16 +1008,43 @@ RezArchive* WAP_LoadRezArchive(const char* rezFilePath)
     // Recursively read all directories
     ReadRezDirectory(rezArchive, rezArchive->rootDirectory, fileStream);
 
+    // Directory structure is loaded, file contents are read by offset from now on
+    delete fileStream;
+
     // Register loaded REZ archive file
-    RegisterRezArchiveFile(rezArchive, fileStream);
+    RezArchiveFileEntry* rezArchiveFileEntry = RegisterRezArchiveFile(rezArchive, rezFilePath);
+    if (rezArchiveFileEntry == NULL)
+    {
+        WAP_DestroyRezArchive(rezArchive);
+        return NULL;
+    }
+
+    // If mapping fails we silently fall back to file reads, WAP_IsRezArchiveMapped tells which one is used
+    if (mapArchive)
+    {
+        MapRezArchiveFile(rezArchiveFileEntry);
+    }
 
     // Create map of REZ files with key being their full file path
     //START_QUERY_PERFORMANCE_TIMER;
     CreateRezArchiveFileMap(rezArchive);
     //END_QUERY_PERFORMANCE_TIMER;
+
+    // Hash index over full paths of all files, all file lookups go through it
+    BuildRezFileIndex(rezArchiveFileEntry->fileIndex, *g_rezArchiveFilesMap[rezArchive]);
     return rezArchive;
 }
 
+RezArchive* WAP_LoadRezArchive(const char* rezFilePath)
+{
+    return LoadRezArchive(rezFilePath, false);
+}
+
+RezArchive* WAP_LoadRezArchiveMapped(const char* rezFilePath)
+{
+    return LoadRezArchive(rezFilePath, true);
+}
+
 static void DestroyRezDirectory(RezDirectory* rezDirectory)
 {
     // Directory name is always set, delete
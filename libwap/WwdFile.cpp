@@ -5,6 +5,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <exception>
+#include <stdexcept>
 
 #include "libwap.h"
 #include "IO.h"
@@ -18,6 +19,186 @@ static void ReadRect(InputStream &stream, WwdRect &rect)
     stream.read(rect.left, rect.top, rect.right, rect.bottom);
 }
 
+static bool ReadWwdProperties(InputStream& inputStream, WwdProperties& properties)
+{
+    inputStream.read(properties.wwdSignature);
+    // Signature holds WWD header size, if size doesnt match then it is not
+    // supported WWD file
+    if (properties.wwdSignature != EXPECTED_HEADER_SIZE)
+    {
+        return false;
+    }
+
+    inputStream.read(properties.null0,
+        properties.flags,
+        properties.null1,
+        properties.levelName,
+        properties.author,
+        properties.birth,
+        properties.rezFile,
+        properties.imageDirectoryPath,
+        properties.rezPalettePath,
+        properties.startX,
+        properties.startY,
+        properties.null2,
+        properties.numPlanes,
+        properties.planesOffset,
+        properties.tileDescriptionsOffset,
+        properties.mainBlockLength,
+        properties.checksum,
+        properties.null3,
+        properties.launchApp,
+        properties.imageSet1,
+        properties.imageSet2,
+        properties.imageSet3,
+        properties.imageSet4,
+        properties.prefix1,
+        properties.prefix2,
+        properties.prefix3,
+        properties.prefix4);
+
+    return true;
+}
+
+// Main block is stored prefixed by WWD header so that offsets stored in WWD can be used as they are
+static bool InflateMainBlock(const char* data, uint32_t length, const WwdProperties& properties, std::vector<char>& mainBlock)
+{
+    if (properties.planesOffset > length)
+    {
+        return false;
+    }
+
+    // Compressed WWD file payload info
+    const char* compressedMainBlock = data + properties.planesOffset;
+    size_t compressedMainBlockSize = length - properties.planesOffset;
+
+    // Uncompressed WWD file payload info
+    mainBlock.resize((size_t)properties.planesOffset + properties.mainBlockLength);
+    memcpy(mainBlock.data(), data, properties.planesOffset);
+    char* decompressedMainBlock = mainBlock.data() + properties.planesOffset;
+
+    // Inflate compressed WWD file payload
+    uLong decompressedMainBlockSize = properties.mainBlockLength;
+    int32_t ret = uncompress((Bytef*)decompressedMainBlock, &decompressedMainBlockSize,
+        (const Bytef*)compressedMainBlock, compressedMainBlockSize);
+    if (ret != Z_OK)
+    {
+        mainBlock.clear();
+        return false;
+    }
+
+    return true;
+}
+
+static void ReadPlaneProperties(InputStream& inputStream, WwdPlaneProperties& properties)
+{
+    inputStream.read(properties.signature,
+        properties.null0,
+        properties.flags,
+        properties.null1,
+        properties.name,
+        properties.pixelWidth,
+        properties.pixelHeight,
+        properties.tilePixelWidth,
+        properties.tilePixelHeight,
+        properties.tilesOnAxisX,
+        properties.tilesOnAxisY,
+        properties.null2,
+        properties.null3,
+        properties.movementPercentX,
+        properties.movementPercentY,
+        properties.fillColor,
+        properties.imageSetsCount,
+        properties.objectsCount,
+        properties.tilesOffset,
+        properties.imageSetsOffset,
+        properties.objectsOffset,
+        properties.coordZ,
+        properties.null4,
+        properties.null5,
+        properties.null6);
+}
+
+// Reads all object's fields except its strings which immediately follow them
+static void ReadObjectProperties(InputStream& inputStream, WwdObject& object)
+{
+    inputStream.read(object.id,
+        object.nameLength,
+        object.logicLength,
+        object.imageSetLength,
+        object.soundLength,
+        object.x,
+        object.y,
+        object.z,
+        object.i,
+        object.addFlags,
+        object.dynamicFlags,
+        object.drawFlags,
+        object.userFlags,
+        object.score,
+        object.points,
+        object.powerup,
+        object.damage,
+        object.smarts,
+        object.health);
+
+    ReadRect(inputStream, object.moveRect);
+    ReadRect(inputStream, object.hitRect);
+    ReadRect(inputStream, object.attackRect);
+    ReadRect(inputStream, object.clipRect);
+    ReadRect(inputStream, object.userRect1);
+    ReadRect(inputStream, object.userRect2);
+
+    inputStream.read(object.userValue1,
+        object.userValue2,
+        object.userValue3,
+        object.userValue4,
+        object.userValue5,
+        object.userValue6,
+        object.userValue7,
+        object.userValue8,
+        object.minX,
+        object.minY,
+        object.maxX,
+        object.maxY,
+        object.speedX,
+        object.speedY,
+        object.tweakX,
+        object.tweakY,
+        object.counter,
+        object.speed,
+        object.width,
+        object.height,
+        object.direction,
+        object.faceDir,
+        object.timeDelay,
+        object.frameDelay,
+        object.objectType,
+        object.hitTypeFlags,
+        object.moveResX,
+        object.moveResY);
+}
+
+static void ReadTileDescription(InputStream& inputStream, WwdTileDescription& tileDescription)
+{
+    inputStream.read(tileDescription.type,
+        tileDescription.unk0,
+        tileDescription.width,
+        tileDescription.height);
+
+    if (tileDescription.type == WAP_TILE_TYPE_SINGLE)
+    {
+        inputStream.read(tileDescription.insideAttrib);
+    }
+    else
+    {
+        inputStream.read(tileDescription.outsideAttrib,
+            tileDescription.insideAttrib);
+
+        ReadRect(inputStream, tileDescription.rect);
+    }
+}
+
 static void ReadPlaneTiles(WwdPlane* plane, InputStream& inputStream)
 {
     uint32_t i;
@@ -72,61 +253,7 @@ static void ReadPlaneObjects(WwdPlane* plane, InputStream& inputStream)
 
         for (i = 0; i < plane->objectsCount; i++)
         {
-            inputStream.read(plane->objects[i].id,
-                plane->objects[i].nameLength,
-                plane->objects[i].logicLength,
-                plane->objects[i].imageSetLength,
-                plane->objects[i].soundLength,
-                plane->objects[i].x,
-                plane->objects[i].y,
-                plane->objects[i].z,
-                plane->objects[i].i,
-                plane->objects[i].addFlags,
-                plane->objects[i].dynamicFlags,
-                plane->objects[i].drawFlags,
-                plane->objects[i].userFlags,
-                plane->objects[i].score,
-                plane->objects[i].points,
-                plane->objects[i].powerup,
-                plane->objects[i].damage,
-                plane->objects[i].smarts,
-                plane->objects[i].health);
-
-            ReadRect(inputStream, plane->objects[i].moveRect);
-            ReadRect(inputStream, plane->objects[i].hitRect);
-            ReadRect(inputStream, plane->objects[i].attackRect);
-            ReadRect(inputStream, plane->objects[i].clipRect);
-            ReadRect(inputStream, plane->objects[i].userRect1);
-            ReadRect(inputStream, plane->objects[i].userRect2);
-
-            inputStream.read(plane->objects[i].userValue1,
-                plane->objects[i].userValue2,
-                plane->objects[i].userValue3,
-                plane->objects[i].userValue4,
-                plane->objects[i].userValue5,
-                plane->objects[i].userValue6,
-                plane->objects[i].userValue7,
-                plane->objects[i].userValue8,
-                plane->objects[i].minX,
-                plane->objects[i].minY,
-                plane->objects[i].maxX,
-                plane->objects[i].maxY,
-                plane->objects[i].speedX,
-                plane->objects[i].speedY,
-                plane->objects[i].tweakX,
-                plane->objects[i].tweakY,
-                plane->objects[i].counter,
-                plane->objects[i].speed,
-                plane->objects[i].width,
-                plane->objects[i].height,
-                plane->objects[i].direction,
-                plane->objects[i].faceDir,
-                plane->objects[i].timeDelay,
-                plane->objects[i].frameDelay,
-                plane->objects[i].objectType,
-                plane->objects[i].hitTypeFlags,
-                plane->objects[i].moveResX,
-                plane->objects[i].moveResY);
+            ReadObjectProperties(inputStream, plane->objects[i]);
 
             plane->objects[i].name = ReadAndAllocateString(inputStream, plane->objects[i].nameLength);
             plane->objects[i].logic = ReadAndAllocateString(inputStream, plane->objects[i].logicLength);
@@ -156,31 +283,7 @@ static void ReadPlanes(WapWwd* wapWwd, InputStream& inputStream)
         /********************** PLANE'S PROPERTIES **********************/
 
         // Read plane's properties
-        inputStream.read(wapWwd->planes[i].properties.signature,
-            wapWwd->planes[i].properties.null0,
-            wapWwd->planes[i].properties.flags,
-            wapWwd->planes[i].properties.null1,
-            wapWwd->planes[i].properties.name,
-            wapWwd->planes[i].properties.pixelWidth,
-            wapWwd->planes[i].properties.pixelHeight,
-            wapWwd->planes[i].properties.tilePixelWidth,
-            wapWwd->planes[i].properties.tilePixelHeight,
-            wapWwd->planes[i].properties.tilesOnAxisX,
-            wapWwd->planes[i].properties.tilesOnAxisY,
-            wapWwd->planes[i].properties.null2,
-            wapWwd->planes[i].properties.null3,
-            wapWwd->planes[i].properties.movementPercentX,
-            wapWwd->planes[i].properties.movementPercentY,
-            wapWwd->planes[i].properties.fillColor,
-            wapWwd->planes[i].properties.imageSetsCount,
-            wapWwd->planes[i].properties.objectsCount,
-            wapWwd->planes[i].properties.tilesOffset,
-            wapWwd->planes[i].properties.imageSetsOffset,
-            wapWwd->planes[i].properties.objectsOffset,
-            wapWwd->planes[i].properties.coordZ,
-            wapWwd->planes[i].properties.null4,
-            wapWwd->planes[i].properties.null5,
-            wapWwd->planes[i].properties.null6);
+        ReadPlaneProperties(inputStream, wapWwd->planes[i].properties);
 
         // Data duplication for sanity reasons
         wapWwd->planes[i].tilesCount = wapWwd->planes[i].properties.tilesOnAxisX * wapWwd->planes[i].properties.tilesOnAxisY;
@@ -220,22 +323,7 @@ void ReadTileDescriptions(WapWwd* wapWwd, InputStream& inputStream)
 
     for (i = 0; i < wapWwd->tileDescriptionsCount; i++)
     {
-        inputStream.read(wapWwd->tileDescriptions[i].type,
-            wapWwd->tileDescriptions[i].unk0,
-            wapWwd->tileDescriptions[i].width,
-            wapWwd->tileDescriptions[i].height);
-
-        if (wapWwd->tileDescriptions[i].type == WAP_TILE_TYPE_SINGLE)
-        {
-            inputStream.read(wapWwd->tileDescriptions[i].insideAttrib);
-        }
-        else
-        {
-            inputStream.read(wapWwd->tileDescriptions[i].outsideAttrib,
-                wapWwd->tileDescriptions[i].insideAttrib);
-
-            ReadRect(inputStream, wapWwd->tileDescriptions[i].rect);
-        }
+        ReadTileDescription(inputStream, wapWwd->tileDescriptions[i]);
     }
 }
 
@@ -256,60 +344,18 @@ WapWwd* WAP_TryWwdLoadFromImpl(char* data, uint32_t length)
     (*wapWwd) = { 0 };
 
     InputStream wwdFileStream(data, length);
-    wwdFileStream.read(wapWwd->properties.wwdSignature);
-    // Signature holds WWD header size, if size doesnt match then it is not
-    // supported WWD file
-    if (wapWwd->properties.wwdSignature != EXPECTED_HEADER_SIZE)
+    if (!ReadWwdProperties(wwdFileStream, wapWwd->properties))
     {
         delete wapWwd;
         return NULL;
     }
 
-    wwdFileStream.read(wapWwd->properties.null0,
-        wapWwd->properties.flags,
-        wapWwd->properties.null1,
-        wapWwd->properties.levelName,
-        wapWwd->properties.author,
-        wapWwd->properties.birth,
-        wapWwd->properties.rezFile,
-        wapWwd->properties.imageDirectoryPath,
-        wapWwd->properties.rezPalettePath,
-        wapWwd->properties.startX,
-        wapWwd->properties.startY,
-        wapWwd->properties.null2,
-        wapWwd->properties.numPlanes,
-        wapWwd->properties.planesOffset,
-        wapWwd->properties.tileDescriptionsOffset,
-        wapWwd->properties.mainBlockLength,
-        wapWwd->properties.checksum,
-        wapWwd->properties.null3,
-        wapWwd->properties.launchApp,
-        wapWwd->properties.imageSet1,
-        wapWwd->properties.imageSet2,
-        wapWwd->properties.imageSet3,
-        wapWwd->properties.imageSet4,
-        wapWwd->properties.prefix1,
-        wapWwd->properties.prefix2,
-        wapWwd->properties.prefix3,
-        wapWwd->properties.prefix4);
-
     // Data duplication for sanity reasons
     wapWwd->planesCount = wapWwd->properties.numPlanes;
 
-    // Compressed WWD file payload info
-    const char* compressedMainBlock = data + wapWwd->properties.planesOffset;
-    size_t compressedMainBlockSize = length - wapWwd->properties.planesOffset;
-
-    // Uncompressed WWD file payload info
-    std::vector<char> decompressedMainBlockVector(wapWwd->properties.planesOffset + wapWwd->properties.mainBlockLength);
-    memcpy(decompressedMainBlockVector.data(), data, wapWwd->properties.planesOffset);
-    char* decompressedMainBlock = decompressedMainBlockVector.data() + wapWwd->properties.planesOffset;
-
-    // Inflate compressed WWD file payload
-    int32_t ret = uncompress((Bytef*)decompressedMainBlock, (uLong*)(&(wapWwd->properties.mainBlockLength)),
-        (Bytef*)compressedMainBlock, compressedMainBlockSize);
-    // Check if inflation succeeded, if not, free allocated resources and return NULL
-    if (ret != Z_OK)
+    // Inflate compressed WWD file payload, if it fails, free allocated resources and return NULL
+    std::vector<char> decompressedMainBlockVector;
+    if (!InflateMainBlock(data, length, wapWwd->properties, decompressedMainBlockVector))
     {
         delete wapWwd;
         return NULL;
@@ -492,4 +538,312 @@ void WAP_WwdDestroy(WapWwd* wapWwd)
     // Delete WAP_WWD
     delete wapWwd;
     wapWwd = NULL;
-}
\ No newline at end of file
+}
+
+/**************************************************************************************/
+/********************************** WWD STREAM ****************************************/
+/**************************************************************************************/
+
+struct WapWwdStream
+{
+    enum MainBlockState
+    {
+        MainBlock_NotInflated,
+        MainBlock_Inflated,
+        MainBlock_Invalid
+    };
+
+    const char* data;
+    uint32_t length;
+
+    WwdProperties properties;
+
+    MainBlockState mainBlockState;
+    std::vector<char> mainBlock;
+    std::vector<WwdPlaneProperties> planes;
+    std::vector<WwdTileDescription> tileDescriptions;
+};
+
+struct WapWwdObjectIterator
+{
+    WapWwdStream* stream;
+    uint32_t objectsLeft;
+    uint32_t offset;
+
+    // Current object and storage for its null-terminated strings, reused between objects
+    WwdObject object;
+    std::string name;
+    std::string logic;
+    std::string imageSet;
+    std::string sound;
+};
+
+static bool TryInflateWwdStreamImpl(WapWwdStream* stream)
+{
+    if (!InflateMainBlock(stream->data, stream->length, stream->properties, stream->mainBlock))
+    {
+        return false;
+    }
+
+    InputStream inputStream(stream->mainBlock.data(), stream->mainBlock.size());
+
+    stream->planes.resize(stream->properties.numPlanes);
+    inputStream.seek(stream->properties.planesOffset);
+    for (uint32_t i = 0; i < stream->properties.numPlanes; i++)
+    {
+        ReadPlaneProperties(inputStream, stream->planes[i]);
+    }
+
+    // Read count of tile descriptions along with junk values
+    uint32_t tileDescriptionsCount = 0;
+    inputStream.seek(stream->properties.tileDescriptionsOffset);
+    inputStream.read(32, 0, tileDescriptionsCount, 0, 0, 0, 0, 0);
+
+    stream->tileDescriptions.clear();
+    for (uint32_t i = 0; i < tileDescriptionsCount; i++)
+    {
+        WwdTileDescription tileDescription = { 0 };
+        ReadTileDescription(inputStream, tileDescription);
+        stream->tileDescriptions.push_back(tileDescription);
+    }
+
+    return true;
+}
+
+// Inflates main block upon first access to anything but WWD header
+static bool EnsureWwdStreamInflated(WapWwdStream* stream)
+{
+    if (stream->mainBlockState == WapWwdStream::MainBlock_NotInflated)
+    {
+        bool inflated = false;
+        try
+        {
+            inflated = TryInflateWwdStreamImpl(stream);
+        }
+        catch (...)
+        {
+            inflated = false;
+        }
+
+        if (inflated)
+        {
+            stream->mainBlockState = WapWwdStream::MainBlock_Inflated;
+        }
+        else
+        {
+            stream->mainBlockState = WapWwdStream::MainBlock_Invalid;
+            stream->mainBlock = std::vector<char>();
+            stream->planes.clear();
+            stream->tileDescriptions.clear();
+        }
+    }
+
+    return stream->mainBlockState == WapWwdStream::MainBlock_Inflated;
+}
+
+WapWwdStream* WAP_WwdStreamOpenFromData(const char* data, uint32_t length)
+{
+    if (data == NULL)
+    {
+        return NULL;
+    }
+
+    WapWwdStream* stream = new WapWwdStream;
+    stream->data = data;
+    stream->length = length;
+    stream->properties = { 0 };
+    stream->mainBlockState = WapWwdStream::MainBlock_NotInflated;
+
+    bool headerRead = false;
+    try
+    {
+        InputStream wwdFileStream(data, length);
+        headerRead = ReadWwdProperties(wwdFileStream, stream->properties);
+    }
+    catch (...)
+    {
+        headerRead = false;
+    }
+
+    if (!headerRead)
+    {
+        delete stream;
+        return NULL;
+    }
+
+    return stream;
+}
+
+const WwdProperties* WAP_WwdStreamGetProperties(WapWwdStream* stream)
+{
+    if (stream == NULL)
+    {
+        return NULL;
+    }
+
+    return &stream->properties;
+}
+
+const WwdPlaneProperties* WAP_WwdStreamGetPlaneProperties(WapWwdStream* stream, uint32_t planeIdx)
+{
+    if (stream == NULL || !EnsureWwdStreamInflated(stream) || planeIdx >= stream->planes.size())
+    {
+        return NULL;
+    }
+
+    return &stream->planes[planeIdx];
+}
+
+int32_t WAP_WwdStreamReadPlaneTiles(WapWwdStream* stream, uint32_t planeIdx, int32_t* dest, uint32_t destCount)
+{
+    const WwdPlaneProperties* plane = WAP_WwdStreamGetPlaneProperties(stream, planeIdx);
+    if (plane == NULL)
+    {
+        return -1;
+    }
+
+    uint64_t tilesCount = (uint64_t)plane->tilesOnAxisX * plane->tilesOnAxisY;
+    uint64_t tilesEnd = plane->tilesOffset + tilesCount * sizeof(int32_t);
+    if (tilesCount > INT32_MAX || tilesEnd > stream->mainBlock.size())
+    {
+        return -1;
+    }
+
+    if (dest == NULL)
+    {
+        return (int32_t)tilesCount;
+    }
+
+    if (destCount < tilesCount)
+    {
+        return -1;
+    }
+
+    memcpy(dest, stream->mainBlock.data() + plane->tilesOffset, (size_t)tilesCount * sizeof(int32_t));
+    if (system_is_big_endian())
+    {
+        for (uint32_t i = 0; i < tilesCount; i++)
+        {
+            char* tile = reinterpret_cast<char*>(&dest[i]);
+            std::reverse(tile, tile + sizeof(int32_t));
+        }
+    }
+
+    return (int32_t)tilesCount;
+}
+
+const char* WAP_WwdStreamGetPlaneImageSet(WapWwdStream* stream, uint32_t planeIdx, uint32_t imageSetIdx)
+{
+    const WwdPlaneProperties* plane = WAP_WwdStreamGetPlaneProperties(stream, planeIdx);
+    if (plane == NULL || imageSetIdx >= plane->imageSetsCount)
+    {
+        return NULL;
+    }
+
+    // Image sets are stored as consecutive null-terminated strings
+    const char* mainBlockEnd = stream->mainBlock.data() + stream->mainBlock.size();
+    const char* imageSet = stream->mainBlock.data() + std::min<size_t>(plane->imageSetsOffset, stream->mainBlock.size());
+    for (uint32_t i = 0; ; i++)
+    {
+        const char* terminator = (const char*)memchr(imageSet, '\0', mainBlockEnd - imageSet);
+        if (terminator == NULL)
+        {
+            return NULL;
+        }
+
+        if (i == imageSetIdx)
+        {
+            return imageSet;
+        }
+
+        imageSet = terminator + 1;
+    }
+}
+
+int32_t WAP_WwdStreamGetTileDescriptions(WapWwdStream* stream, const WwdTileDescription** tileDescriptions)
+{
+    if (stream == NULL || tileDescriptions == NULL || !EnsureWwdStreamInflated(stream))
+    {
+        return -1;
+    }
+
+    *tileDescriptions = stream->tileDescriptions.data();
+
+    return (int32_t)stream->tileDescriptions.size();
+}
+
+WapWwdObjectIterator* WAP_WwdStreamIterateObjects(WapWwdStream* stream, uint32_t planeIdx)
+{
+    const WwdPlaneProperties* plane = WAP_WwdStreamGetPlaneProperties(stream, planeIdx);
+    if (plane == NULL)
+    {
+        return NULL;
+    }
+
+    WapWwdObjectIterator* iterator = new WapWwdObjectIterator;
+    iterator->stream = stream;
+    iterator->objectsLeft = plane->objectsCount;
+    iterator->offset = plane->objectsOffset;
+    iterator->object = { 0 };
+
+    return iterator;
+}
+
+static void AssignObjectString(InputStream& inputStream, const std::vector<char>& mainBlock, uint32_t length, std::string& str)
+{
+    uint32_t offset = inputStream.tell();
+    if (offset > mainBlock.size() || length > mainBlock.size() - offset)
+    {
+        throw std::runtime_error("Error: Invalid data\n");
+    }
+
+    str.assign(mainBlock.data() + offset, length);
+    inputStream.seek(offset + length);
+}
+
+const WwdObject* WAP_WwdObjectIteratorNext(WapWwdObjectIterator* iterator)
+{
+    if (iterator == NULL || iterator->objectsLeft == 0)
+    {
+        return NULL;
+    }
+
+    const std::vector<char>& mainBlock = iterator->stream->mainBlock;
+    WwdObject& object = iterator->object;
+    try
+    {
+        InputStream inputStream(mainBlock.data(), mainBlock.size(), iterator->offset);
+        ReadObjectProperties(inputStream, object);
+
+        AssignObjectString(inputStream, mainBlock, object.nameLength, iterator->name);
+        AssignObjectString(inputStream, mainBlock, object.logicLength, iterator->logic);
+        AssignObjectString(inputStream, mainBlock, object.imageSetLength, iterator->imageSet);
+        AssignObjectString(inputStream, mainBlock, object.soundLength, iterator->sound);
+
+        iterator->offset = inputStream.tell();
+    }
+    catch (...)
+    {
+        iterator->objectsLeft = 0;
+        return NULL;
+    }
+
+    object.name = &iterator->name[0];
+    object.logic = &iterator->logic[0];
+    object.imageSet = &iterator->imageSet[0];
+    object.sound = &iterator->sound[0];
+
+    iterator->objectsLeft--;
+
+    return &object;
+}
+
+void WAP_WwdObjectIteratorDestroy(WapWwdObjectIterator* iterator)
+{
+    delete iterator;
+}
+
+void WAP_WwdStreamDestroy(WapWwdStream* stream)
+{
+    delete stream;
+}
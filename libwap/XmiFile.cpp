@@ -477,6 +477,21 @@ MidiFile* WAP_XmiToMidiFromRezArchive(RezArchive* rezArchive, char* xmiFilePath)
     return WAP_XmiToMidiFromRezFile(xmiRezFile);
 }
 
+MidiFile* WAP_MidiCreateFromData(const char* midiData, size_t midiLength)
+{
+    if ((midiData == NULL) || (midiLength == 0))
+    {
+        return NULL;
+    }
+
+    MidiFile* midiFile = new MidiFile;
+    midiFile->data = new char[midiLength];
+    midiFile->size = midiLength;
+    memcpy(midiFile->data, midiData, midiLength);
+
+    return midiFile;
+}
+
 void WAP_MidiDestroy(MidiFile* midiFile)
 {
     if (midiFile == NULL)
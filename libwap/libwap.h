@@ -52,6 +52,7 @@ typedef struct RezDirectory
     uint32_t offset;
 
     RezDirectory* parent;
+    RezArchive* owner;
 } RezDirectory;
 
 typedef struct RezDirectoryContents
@@ -79,6 +80,24 @@ typedef struct RezArchive
  */
 LIBWAP_API RezArchive* WAP_LoadRezArchive(const char* rezFilePath);
 
+/**
+ * @brief Loads file structure of REZ format archive and maps whole archive into memory
+ * @note For destroying use supplied function WAP_DestroyRezArchive
+ * @note If archive cannot be mapped, it is loaded the same way as by WAP_LoadRezArchive
+ *
+ * @param rezFilePath Path to REZ archive
+ * @return Returns pointer to RezArchive struct or NULL upon failure
+ */
+LIBWAP_API RezArchive* WAP_LoadRezArchiveMapped(const char* rezFilePath);
+
+/**
+ * @brief Checks whether given REZ archive is memory-mapped
+ *
+ * @param rezArchive Pointer to REZ archive
+ * @return Returns non-zero value if archive is memory-mapped, 0 otherwise
+ */
+LIBWAP_API int WAP_IsRezArchiveMapped(RezArchive* rezArchive);
+
 /**
  * @brief Destroys RezArchive structure and thus frees memory
  *
@@ -113,6 +132,27 @@ LIBWAP_API uint8_t WAP_GetDirectorySeparator();
  */
 LIBWAP_API char* WAP_GetRezFileData(RezFile* rezFile);
 
+/**
+ * @brief Gets read-only file content (data buffer) of given RezFile directly from memory-mapped REZ archive
+ * @note Nothing is allocated or copied, returned buffer is valid until owning RezArchive is destroyed
+ * @note Only works for archives loaded by WAP_LoadRezArchiveMapped
+ *
+ * @param rezFile Given pointer to RezFile structure
+ * @return Pointer to rezFile->size bytes long data buffer or NULL if owning archive is not mapped
+ */
+LIBWAP_API const char* WAP_GetRezFileMappedData(RezFile* rezFile);
+
+/**
+ * @brief Reads file content of given RezFile into caller supplied buffer
+ * @note Does not use any shared file position and does not cache anything, so it is safe
+ *       to call it from multiple threads at the same time, even for the same RezArchive
+ *
+ * @param rezFile Given pointer to RezFile structure
+ * @param dest Buffer which is at least rezFile->size bytes long
+ * @return Number of read bytes (= rezFile->size) or -1 upon failure
+ */
+LIBWAP_API int32_t WAP_ReadRezFileInto(RezFile* rezFile, void* dest);
+
 /**
  * @brief Frees data buffer allocated by WAP_GetRezFileData function
  * @note All REZ file datas allocated by this function are automatically freed upon destroying RezArchive
@@ -132,6 +172,28 @@ LIBWAP_API void WAP_FreeFileData(RezFile* rezFile);
  */
 LIBWAP_API RezFile* WAP_GetRezFileFromRezArchive(RezArchive* rezArchive, const char* rezFilePath);
 
+/**
+ * @brief Computes lookup key of given path to RezFile
+ * @note Path is hashed case insensitively, leading and repeated directory separators are ignored
+ * @usage uint32_t hash = WAP_HashRezFilePath("CLAW/IMAGES/001.PID");
+ *
+ * @param rezFilePath Full path from RezArchive root directory to file
+ * @return Hash of given path
+ */
+LIBWAP_API uint32_t WAP_HashRezFilePath(const char* rezFilePath);
+
+/**
+ * @brief Gets RezFile from given RezArchive, path to the RezFile and its precomputed hash
+ * @note Useful when the same path is looked up repeatedly, e.g. by resource caches
+ * @usage RezFile* rezFile = WAP_GetRezFileFromRezArchiveByHash(rezArchive, path, WAP_HashRezFilePath(path));
+ *
+ * @param rezArchive REZ archive in which the search is done
+ * @param rezFilePath Full path from RezArchive root directory to file
+ * @param rezFilePathHash Hash of rezFilePath returned by WAP_HashRezFilePath
+ * @return Pointer to RezFile structure or NULL upon failure
+ */
+LIBWAP_API RezFile* WAP_GetRezFileFromRezArchiveByHash(RezArchive* rezArchive, const char* rezFilePath, uint32_t rezFilePathHash);
+
 /**
  * @brief Gets RezFile from given RezDirectory and path to the RezFile
  * @usage RezFile* rezFile = WAP_GetRezFileFromRezDirectory(rezDirectory, "FOLDER/SUBFOLDER/FILE.EXT");
@@ -471,6 +533,106 @@ LIBWAP_API WapWwd* WAP_WwdLoadFromRezArchive(RezArchive* rezArchive, const char*
  */
 LIBWAP_API void WAP_WwdDestroy(WapWwd* wapWwd);
 
+/**
+ * WWD file parsed lazily. Opening it reads only its header, main block is inflated upon first
+ * access to planes, tiles, objects or tile descriptions and nothing else is allocated per plane
+ * or per object.
+ */
+typedef struct WapWwdStream WapWwdStream;
+typedef struct WapWwdObjectIterator WapWwdObjectIterator;
+
+/**
+ * @brief Opens WWD file from given data buffer reading only its header
+ * @note Data buffer is not copied, it has to stay valid until the stream is destroyed
+ *
+ * @param data WWD data buffer
+ * @param length WWD data buffer length
+ * @return Opened WWD stream or NULL if data buffer does not contain WWD header
+ */
+LIBWAP_API WapWwdStream* WAP_WwdStreamOpenFromData(const char* data, uint32_t length);
+
+/**
+ * @brief Returns WWD header properties, does not inflate main block
+ *
+ * @param stream Opened WWD stream
+ * @return Pointer to properties owned by the stream or NULL if stream is NULL
+ */
+LIBWAP_API const WwdProperties* WAP_WwdStreamGetProperties(WapWwdStream* stream);
+
+/**
+ * @brief Returns properties of given plane
+ *
+ * @param stream Opened WWD stream
+ * @param planeIdx Index of plane, less than numPlanes in WWD properties
+ * @return Pointer to plane properties owned by the stream or NULL upon failure
+ */
+LIBWAP_API const WwdPlaneProperties* WAP_WwdStreamGetPlaneProperties(WapWwdStream* stream, uint32_t planeIdx);
+
+/**
+ * @brief Copies tiles of given plane into caller supplied buffer
+ * @note Tiles are ordered from top left to bottom right corner, there are tilesOnAxisX * tilesOnAxisY of them
+ *
+ * @param stream Opened WWD stream
+ * @param planeIdx Index of plane
+ * @param dest Destination buffer or NULL to only query tiles count
+ * @param destCount Number of tiles destination buffer can hold
+ * @return Number of plane tiles or -1 upon failure or if destination buffer is too small
+ */
+LIBWAP_API int32_t WAP_WwdStreamReadPlaneTiles(WapWwdStream* stream, uint32_t planeIdx, int32_t* dest, uint32_t destCount);
+
+/**
+ * @brief Returns image set of given plane
+ *
+ * @param stream Opened WWD stream
+ * @param planeIdx Index of plane
+ * @param imageSetIdx Index of image set, less than imageSetsCount in plane properties
+ * @return Null-terminated image set name owned by the stream or NULL upon failure
+ */
+LIBWAP_API const char* WAP_WwdStreamGetPlaneImageSet(WapWwdStream* stream, uint32_t planeIdx, uint32_t imageSetIdx);
+
+/**
+ * @brief Returns tile descriptions of WWD file
+ *
+ * @param stream Opened WWD stream
+ * @param tileDescriptions Receives array of tile descriptions owned by the stream
+ * @return Number of tile descriptions or -1 upon failure
+ */
+LIBWAP_API int32_t WAP_WwdStreamGetTileDescriptions(WapWwdStream* stream, const WwdTileDescription** tileDescriptions);
+
+/**
+ * @brief Creates iterator over objects of given plane
+ * @note Iterator must not outlive the stream
+ *
+ * @param stream Opened WWD stream
+ * @param planeIdx Index of plane
+ * @return Object iterator which has to be destroyed by WAP_WwdObjectIteratorDestroy or NULL upon failure
+ */
+LIBWAP_API WapWwdObjectIterator* WAP_WwdStreamIterateObjects(WapWwdStream* stream, uint32_t planeIdx);
+
+/**
+ * @brief Reads next object of plane
+ * @note Returned object, including its strings, is owned by the iterator and stays valid only until
+ *       next call, no memory is allocated per object
+ *
+ * @param iterator Object iterator
+ * @return Next object or NULL if there are no more objects or object data are corrupted
+ */
+LIBWAP_API const WwdObject* WAP_WwdObjectIteratorNext(WapWwdObjectIterator* iterator);
+
+/**
+ * @brief Destroys object iterator
+ *
+ * @param iterator Object iterator
+ */
+LIBWAP_API void WAP_WwdObjectIteratorDestroy(WapWwdObjectIterator* iterator);
+
+/**
+ * @brief Destroys WWD stream and frees its inflated main block
+ *
+ * @param stream Opened WWD stream
+ */
+LIBWAP_API void WAP_WwdStreamDestroy(WapWwdStream* stream);
+
 
 /***************************************************************/
 /********************* ANI FORMAT ******************************/
@@ -595,6 +757,16 @@ LIBWAP_API MidiFile* WAP_XmiToMidiFromRezFile(RezFile* rezFile);
  */
 LIBWAP_API MidiFile* WAP_XmiToMidiFromRezArchive(RezArchive* rezArchive, char* xmiFilePath);
 
+/**
+ * @brief Creates MIDI file structure from already converted MIDI data, e.g. cached result of previous conversion
+ * @note Data are copied, caller keeps ownership of given buffer
+ *
+ * @param midiData MIDI music data buffer
+ * @param midiLength MIDI music data length
+ * @return Pointer to MIDI file structure which has to be destroyed by WAP_MidiDestroy or NULL upon failure
+ */
+LIBWAP_API MidiFile* WAP_MidiCreateFromData(const char* midiData, size_t midiLength);
+
 /**
  * @brief Destroys and frees loaded MIDI file
  *
@@ -682,6 +854,9 @@ enum
     WAP_PID_FLAG_EMBEDDED_PALETTE = 1 << 7,
 };
 
+// Upper bound of PID width and height, headers with larger dimensions are rejected
+const uint32_t WAP_PID_MAX_DIMENSION = 8192;
+
 typedef struct
 {
     uint32_t fileDesc;
@@ -708,6 +883,31 @@ typedef struct
  */
 LIBWAP_API WapPid* WAP_PidLoadFromData(char* data, size_t size, WapPal* palette);
 
+/**
+ * @brief Reads PID header (dimensions, offsets and flags) from given data buffer without decoding its pixels
+ * @note Colors of filled structure are always NULL
+ *
+ * @param data PID data buffer
+ * @param size PID data length
+ * @param outPid Structure to be filled with PID header
+ * @return 0 on success, -1 if data buffer does not contain PID header or its dimensions exceed WAP_PID_MAX_DIMENSION
+ */
+LIBWAP_API int32_t WAP_PidLoadHeaderFromData(const char* data, size_t size, WapPid* outPid);
+
+/**
+ * @brief Decodes PID image pixels from given data buffer straight into caller's 32-bit RGBA buffer
+ * @note Pixels are stored with the same memory layout as WAP_ColorRGBA. Destination can be any
+ *       pitched buffer, e.g. locked texture. If PID has embedded palette, embedded palette always takes preference
+ *
+ * @param data PID data buffer
+ * @param size PID data length
+ * @param palette Color palette to be used when decoding PID image. Pass NULL if you want to use embedded palette.
+ * @param dest Destination buffer, it has to hold at least height * pitch bytes
+ * @param pitch Length of one destination row in bytes, at least width * 4
+ * @return 0 on success, -1 upon failure
+ */
+LIBWAP_API int32_t WAP_PidDecodeIntoBuffer(const char* data, size_t size, WapPal* palette, void* dest, uint32_t pitch);
+
 /**
  * @brief Loads PID file (= 2D image format) from filesystem's file path
  * @note If PID has embedded palette, embedded palette always takes preference
@@ -739,6 +939,16 @@ LIBWAP_API WapPid* WAP_PidLoadFromRezFile(RezFile* rezFile, WapPal* palette);
  */
 LIBWAP_API WapPid* WAP_PidLoadFromRezArchive(RezArchive* rezArchive, const char* pidRezPath, WapPal* palette);
 
+/**
+ * @brief Creates empty PID image of given dimensions, e.g. to be filled with cached decoded pixels
+ * @note All header fields except dimensions are zeroed, colors are allocated but not initialized
+ *
+ * @param width Image width in pixels
+ * @param height Image height in pixels
+ * @return Pointer to PID file structure which has to be destroyed by WAP_PidDestroy or NULL upon failure
+ */
+LIBWAP_API WapPid* WAP_PidCreate(uint32_t width, uint32_t height);
+
 /**
 * @brief Destroys and frees loaded PID image file
 *
@@ -4,6 +4,10 @@
 #include <libwap.h>
 #include "TestUtil.h"
 
+#include <cstring>
+#include <thread>
+#include <vector>
+
 TEST_CASE("----- REZ ARCHIVE FILE -----")
 {
     SECTION("Loading file with wrong path to REZ archive returns NULL")
@@ -253,6 +257,110 @@ TEST_CASE("----- REZ ARCHIVE FILE -----")
         WAP_FreeFileData(rezFile);
     }
 
+    SECTION("Getting valid file by its precomputed path hash returns the same file structure as lookup by path")
+    {
+        // Official CLAW.REZ file
+        RezArchive* rezArchive = WAP_LoadRezArchive("CLAW.REZ");
+
+        REQUIRE(rezArchive != NULL);
+
+        const char* path = "/claw/anis/climb.ani";
+        RezFile* rezFile = WAP_GetRezFileFromRezArchiveByHash(rezArchive, path, WAP_HashRezFilePath(path));
+        REQUIRE(rezFile != NULL);
+        REQUIRE(rezFile == WAP_GetRezFileFromRezArchive(rezArchive, "CLAW/ANIS/CLIMB.ANI"));
+        REQUIRE(rezFile == WAP_GetRezFileFromRezArchive(rezArchive, "CLAW//ANIS/CLIMB.ANI"));
+
+        // Hash is case insensitive and ignores leading separator
+        REQUIRE(WAP_HashRezFilePath(path) == WAP_HashRezFilePath("CLAW/ANIS/CLIMB.ANI"));
+
+        rezFile = WAP_GetRezFileFromRezArchiveByHash(rezArchive, "/claw/anis/invalid.ani", WAP_HashRezFilePath("/claw/anis/invalid.ani"));
+        REQUIRE(rezFile == NULL);
+
+        WAP_DestroyRezArchive(rezArchive);
+    }
+
+    SECTION("Getting mapped file data from valid mapped REZ archive returns same data as copied file data")
+    {
+        // Official CLAW.REZ file
+        RezArchive* rezArchive = WAP_LoadRezArchiveMapped("CLAW.REZ");
+
+        REQUIRE(rezArchive != NULL);
+        REQUIRE(WAP_IsRezArchiveMapped(rezArchive) != 0);
+
+        RezFile* rezFile = WAP_GetRezFileFromRezArchive(rezArchive, "CLAW/ANIS/DUCKPISTOL.ANI");
+        REQUIRE(rezFile != NULL);
+
+        const char* mappedData = WAP_GetRezFileMappedData(rezFile);
+        REQUIRE(mappedData != NULL);
+
+        char* data = WAP_GetRezFileData(rezFile);
+        REQUIRE(data != NULL);
+        REQUIRE(memcmp(mappedData, data, rezFile->size) == 0);
+
+        WapAni* aniFile = WAP_AniLoadFromData((char*)mappedData, rezFile->size);
+        REQUIRE(aniFile != NULL);
+        REQUIRE(aniFile->animationFramesCount == 11);
+
+        WAP_AniDestroy(aniFile);
+        WAP_FreeFileData(rezFile);
+        WAP_DestroyRezArchive(rezArchive);
+    }
+
+    SECTION("Reading file data into caller buffer from multiple threads returns valid data")
+    {
+        // Official CLAW.REZ file
+        RezArchive* rezArchive = WAP_LoadRezArchive("CLAW.REZ");
+
+        REQUIRE(rezArchive != NULL);
+
+        RezFile* rezFile = WAP_GetRezFileFromRezArchive(rezArchive, "CLAW/ANIS/DUCKPISTOL.ANI");
+        REQUIRE(rezFile != NULL);
+
+        std::vector<char> expectedData(WAP_GetRezFileData(rezFile), WAP_GetRezFileData(rezFile) + rezFile->size);
+        WAP_FreeFileData(rezFile);
+
+        const int threadsCount = 8;
+        std::vector<std::vector<char>> threadData(threadsCount, std::vector<char>(rezFile->size));
+        std::vector<int32_t> threadReadSize(threadsCount, -1);
+        std::vector<std::thread> threads;
+        for (int threadIdx = 0; threadIdx < threadsCount; threadIdx++)
+        {
+            threads.push_back(std::thread([&, threadIdx]()
+            {
+                threadReadSize[threadIdx] = WAP_ReadRezFileInto(rezFile, threadData[threadIdx].data());
+            }));
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        for (int threadIdx = 0; threadIdx < threadsCount; threadIdx++)
+        {
+            REQUIRE(threadReadSize[threadIdx] == (int32_t)rezFile->size);
+            REQUIRE(threadData[threadIdx] == expectedData);
+        }
+
+        REQUIRE(WAP_ReadRezFileInto(NULL, threadData[0].data()) == -1);
+
+        WAP_DestroyRezArchive(rezArchive);
+    }
+
+    SECTION("Getting mapped file data from REZ archive which is not mapped returns NULL")
+    {
+        // Official CLAW.REZ file
+        RezArchive* rezArchive = WAP_LoadRezArchive("CLAW.REZ");
+
+        REQUIRE(rezArchive != NULL);
+        REQUIRE(WAP_IsRezArchiveMapped(rezArchive) == 0);
+
+        RezFile* rezFile = WAP_GetRezFileFromRezArchive(rezArchive, "CLAW/ANIS/DUCKPISTOL.ANI");
+        REQUIRE(rezFile != NULL);
+        REQUIRE(WAP_GetRezFileMappedData(rezFile) == NULL);
+
+        WAP_DestroyRezArchive(rezArchive);
+    }
+
     SECTION("Getting valid directory from valid REZ directory with non-compliant directory separator set returns NULL")
     {
         // Official CLAW.REZ file
@@ -428,6 +536,62 @@ TEST_CASE("----- WWD FILE -----")
 
         WAP_WwdDestroy(wwdFile);
     }
+
+    SECTION("[WAP_WwdStreamOpenFromData]: Lazily parsed WWD stream matches eagerly loaded WWD structure")
+    {
+        // Offical Claw REZ archive
+        RezArchive* rezArchive = WAP_LoadRezArchive("CLAW.REZ");
+        REQUIRE(rezArchive != NULL);
+
+        RezFile* rezFile = WAP_GetRezFileFromRezArchive(rezArchive, "LEVEL1/WORLDS/WORLD.WWD");
+        REQUIRE(rezFile != NULL);
+
+        char* wwdData = WAP_GetRezFileData(rezFile);
+        REQUIRE(wwdData != NULL);
+
+        REQUIRE(WAP_WwdStreamOpenFromData(wwdData, 100) == NULL);
+
+        WapWwdStream* wwdStream = WAP_WwdStreamOpenFromData(wwdData, rezFile->size);
+        REQUIRE(wwdStream != NULL);
+
+        const WwdProperties* properties = WAP_WwdStreamGetProperties(wwdStream);
+        REQUIRE(properties != NULL);
+        REQUIRE(properties->numPlanes == 3);
+        REQUIRE(properties->wwdSignature == 1524);
+        REQUIRE(strcmp(properties->levelName, "Claw - Level 1") == 0);
+
+        REQUIRE(WAP_WwdStreamGetPlaneProperties(wwdStream, 3) == NULL);
+        REQUIRE(WAP_WwdStreamGetPlaneProperties(wwdStream, 1)->tilePixelHeight == 64);
+        REQUIRE(strcmp(WAP_WwdStreamGetPlaneProperties(wwdStream, 2)->name, "Front") == 0);
+
+        WapWwd* wwdFile = WAP_WwdLoadFromRezFile(rezFile);
+        REQUIRE(wwdFile != NULL);
+
+        int32_t tilesCount = WAP_WwdStreamReadPlaneTiles(wwdStream, 1, NULL, 0);
+        REQUIRE(tilesCount == (int32_t)wwdFile->planes[1].tilesCount);
+        int32_t* tiles = new int32_t[tilesCount];
+        REQUIRE(WAP_WwdStreamReadPlaneTiles(wwdStream, 1, tiles, tilesCount) == tilesCount);
+        REQUIRE(memcmp(tiles, wwdFile->planes[1].tiles, tilesCount * sizeof(int32_t)) == 0);
+        delete[] tiles;
+
+        const WwdTileDescription* tileDescriptions = NULL;
+        REQUIRE(WAP_WwdStreamGetTileDescriptions(wwdStream, &tileDescriptions) == (int32_t)wwdFile->tileDescriptionsCount);
+
+        WapWwdObjectIterator* objectIterator = WAP_WwdStreamIterateObjects(wwdStream, 1);
+        REQUIRE(objectIterator != NULL);
+        uint32_t objectsCount = 0;
+        while (const WwdObject* object = WAP_WwdObjectIteratorNext(objectIterator))
+        {
+            REQUIRE(strcmp(object->logic, wwdFile->planes[1].objects[objectsCount].logic) == 0);
+            objectsCount++;
+        }
+        REQUIRE(objectsCount == 1479);
+        WAP_WwdObjectIteratorDestroy(objectIterator);
+
+        WAP_WwdDestroy(wwdFile);
+        WAP_WwdStreamDestroy(wwdStream);
+        WAP_DestroyRezArchive(rezArchive);
+    }
 }
 
 TEST_CASE("----- ANI FILE -----")
@@ -645,6 +809,166 @@ TEST_CASE("----- PAL FILE -----")
         wapPal = WAP_PalLoadFromRezArchive(rezArchive, "LEVEL1/PALETTES/MAIN.PAL");
         REQUIRE(wapPal != NULL);
 
+        WAP_PalDestroy(wapPal);
+    }
+}
+
+// Builds PID file in memory from header values and raw pixel bytes, values are little endian
+static std::vector<char> BuildTestPid(uint32_t flags, uint32_t width, uint32_t height, const std::vector<uint8_t>& pixelBytes)
+{
+    const uint32_t header[8] = { 10, flags, width, height, (uint32_t)-3, 7, 0, 0 };
+
+    std::vector<char> data;
+    for (uint32_t value : header)
+    {
+        for (int byteIdx = 0; byteIdx < 4; byteIdx++)
+        {
+            data.push_back((char)((value >> (byteIdx * 8)) & 0xFF));
+        }
+    }
+    data.insert(data.end(), pixelBytes.begin(), pixelBytes.end());
+
+    return data;
+}
+
+// Palette where every color is unique so that decoded pixels can be traced back to their index
+static WapPal* CreateTestPidPalette()
+{
+    char paletteData[WAP_PALETTE_SIZE_BYTES];
+    for (uint32_t i = 0; i < WAP_COLORS_IN_PALETTE; i++)
+    {
+        paletteData[i * 3 + 0] = (char)i;
+        paletteData[i * 3 + 1] = (char)(255 - i);
+        paletteData[i * 3 + 2] = (char)(i ^ 0x55);
+    }
+
+    return WAP_PalLoadFromData(paletteData, WAP_PALETTE_SIZE_BYTES);
+}
+
+TEST_CASE("----- PID FILE -----")
+{
+    SECTION("[WAP_PidLoadHeaderFromData]: Loading PID header from too short data returns -1")
+    {
+        char data[4] = { 0 };
+        WapPid pidHeader;
+
+        REQUIRE(WAP_PidLoadHeaderFromData(data, sizeof(data), &pidHeader) == -1);
+    }
+
+    SECTION("[WAP_PidLoadHeaderFromData]: Loading PID header with oversized dimensions returns -1")
+    {
+        std::vector<char> data = BuildTestPid(0, WAP_PID_MAX_DIMENSION + 1, 1, {});
+        WapPid pidHeader;
+
+        REQUIRE(WAP_PidLoadHeaderFromData(data.data(), data.size(), &pidHeader) == -1);
+    }
+
+    SECTION("[WAP_PidDecodeIntoBuffer]: Decoding uncompressed PID expands literal pixels and runs spanning rows")
+    {
+        WapPal* wapPal = CreateTestPidPalette();
+        REQUIRE(wapPal != NULL);
+
+        // 4x2 image: 5 | run of 5 x 7 (wraps to second row) | 192 is still a literal index | 2
+        std::vector<char> data = BuildTestPid(0, 4, 2, { 5, 192 + 5, 7, 192, 2 });
+        const uint8_t expected[] = { 5, 7, 7, 7,
+                                     7, 7, 192, 2 };
+
+        // Rows are padded, padding has to stay untouched
+        uint32_t rowSize = 4 * sizeof(WAP_ColorRGBA);
+        uint32_t pitch = rowSize + 16;
+        std::vector<uint8_t> pixels(pitch * 2, 0xCD);
+        REQUIRE(WAP_PidDecodeIntoBuffer(data.data(), data.size(), wapPal, pixels.data(), pitch) == 0);
+
+        bool valid = true;
+        for (uint32_t y = 0; y < 2; y++)
+        {
+            const WAP_ColorRGBA* row = (const WAP_ColorRGBA*)&pixels[y * pitch];
+            for (uint32_t x = 0; x < 4; x++)
+            {
+                if (memcmp(&row[x], &wapPal->colors[expected[y * 4 + x]], sizeof(WAP_ColorRGBA)) != 0)
+                {
+                    valid = false;
+                }
+            }
+            if (pixels[y * pitch + rowSize] != 0xCD || pixels[y * pitch + pitch - 1] != 0xCD)
+            {
+                valid = false;
+            }
+        }
+        REQUIRE(valid == true);
+
+        WAP_PalDestroy(wapPal);
+    }
+
+    SECTION("[WAP_PidDecodeIntoBuffer]: Decoding compressed PID expands transparent skips and literal runs")
+    {
+        WapPal* wapPal = CreateTestPidPalette();
+        REQUIRE(wapPal != NULL);
+
+        // 4x3 image: skip 2 | 3 literals (wrap) | skip 5 (wraps) | 2 literals
+        std::vector<char> data = BuildTestPid(WAP_PID_FLAG_COMPRESSION, 4, 3,
+            { 128 + 2, 3, 10, 11, 12, 128 + 5, 2, 200, 201 });
+
+        // -1 marks transparent pixel
+        const int expected[] = { -1, -1, 10, 11,
+                                 12, -1, -1, -1,
+                                 -1, -1, 200, 201 };
+        const WAP_ColorRGBA transparent = { 0, 0, 0, 1 };
+
+        std::vector<WAP_ColorRGBA> pixels(4 * 3);
+        REQUIRE(WAP_PidDecodeIntoBuffer(data.data(), data.size(), wapPal, pixels.data(), 4 * sizeof(WAP_ColorRGBA)) == 0);
+
+        bool valid = true;
+        for (uint32_t i = 0; i < pixels.size(); i++)
+        {
+            const WAP_ColorRGBA& expectedColor = (expected[i] < 0) ? transparent : wapPal->colors[expected[i]];
+            if (memcmp(&pixels[i], &expectedColor, sizeof(WAP_ColorRGBA)) != 0)
+            {
+                valid = false;
+            }
+        }
+        REQUIRE(valid == true);
+
+        WAP_PalDestroy(wapPal);
+    }
+
+    SECTION("[WAP_PidDecodeIntoBuffer]: Decoding truncated PID returns -1")
+    {
+        WapPal* wapPal = CreateTestPidPalette();
+        REQUIRE(wapPal != NULL);
+
+        // Literal run announces 3 pixels but only 1 follows
+        std::vector<char> compressed = BuildTestPid(WAP_PID_FLAG_COMPRESSION, 2, 2, { 3, 10 });
+        // Run of 3 pixels is missing its color index
+        std::vector<char> uncompressed = BuildTestPid(0, 2, 2, { 1, 192 + 3 });
+
+        std::vector<WAP_ColorRGBA> pixels(2 * 2);
+        uint32_t pitch = 2 * sizeof(WAP_ColorRGBA);
+        REQUIRE(WAP_PidDecodeIntoBuffer(compressed.data(), compressed.size(), wapPal, pixels.data(), pitch) == -1);
+        REQUIRE(WAP_PidDecodeIntoBuffer(uncompressed.data(), uncompressed.size(), wapPal, pixels.data(), pitch) == -1);
+
+        WAP_PalDestroy(wapPal);
+    }
+
+    SECTION("[WAP_PidLoadFromData]: Loading hand built PID returns its header and pixels")
+    {
+        WapPal* wapPal = CreateTestPidPalette();
+        REQUIRE(wapPal != NULL);
+
+        std::vector<char> data = BuildTestPid(0, 3, 1, { 192 + 2, 40, 41 });
+        WapPid* wapPid = WAP_PidLoadFromData(data.data(), data.size(), wapPal);
+        REQUIRE(wapPid != NULL);
+        REQUIRE(wapPid->width == 3);
+        REQUIRE(wapPid->height == 1);
+        REQUIRE(wapPid->offsetX == -3);
+        REQUIRE(wapPid->offsetY == 7);
+        REQUIRE(wapPid->colorsCount == 3);
+
+        REQUIRE(memcmp(&wapPid->colors[0], &wapPal->colors[40], sizeof(WAP_ColorRGBA)) == 0);
+        REQUIRE(memcmp(&wapPid->colors[1], &wapPal->colors[40], sizeof(WAP_ColorRGBA)) == 0);
+        REQUIRE(memcmp(&wapPid->colors[2], &wapPal->colors[41], sizeof(WAP_ColorRGBA)) == 0);
+
+        WAP_PidDestroy(wapPid);
         WAP_PalDestroy(wapPal);
     }
 }
\ No newline at end of file